@@ -8,6 +8,7 @@
  * (at your option) any later version.
  */
 #include "AnnotationManager.h"
+#include "AnnotationSpatialIndex.h"
 #include "../core/Document.h"
 #include "../core/Page.h"
 #include "Annotation.h" // Assuming base Annotation class exists
@@ -45,13 +46,39 @@ public:
     mutable QMutex mutex; // Protect access to the annotation maps
     QHash<AnnotationKey, QPointer<Annotation>> annotations; // Map key -> Annotation*
     QHash<Document*, QSet<Annotation*>> docToAnnotations; // Map Document* -> Set of its annotations
-    QHash<Document*, QHash<int, QSet<Annotation*>>> docPageToAnnotations; // Map Document* -> (PageIndex -> Set of its annotations)
+    QHash<Document*, QHash<int, AnnotationSpatialIndex>> docPageToAnnotations; // Map Document* -> (PageIndex -> spatial index of its annotations)
+    QHash<Annotation*, QPair<Document*, int>> annotationOwners; // Reverse map: Annotation* -> (Document*, PageIndex)
+    QHash<Document*, QSet<Annotation*>> dirtyAnnotations; // Per-document annotations changed since the last save
     QSet<Document*> modifiedDocs; // Set of documents with modified annotations
 
+    // Mark a document modified; returns true if it was not already (caller holds the mutex)
+    bool markModified(Document* doc) {
+        if (modifiedDocs.contains(doc)) return false;
+        modifiedDocs.insert(doc);
+        return true;
+    }
+
+    // Spatial index of a page, or nullptr if the page has no annotations
+    const AnnotationSpatialIndex* pageIndex(Document* doc, int pageIndex) const {
+        auto docIt = docPageToAnnotations.constFind(doc);
+        if (docIt == docPageToAnnotations.constEnd()) return nullptr;
+        auto pageIt = docIt.value().constFind(pageIndex);
+        return pageIt != docIt.value().constEnd() ? &pageIt.value() : nullptr;
+    }
+
     // Helper to remove an annotation from all internal maps
     void removeAnnotationInternal(Document* doc, Annotation* annot, int pageIndex) {
         AnnotationKey key{doc, pageIndex, annot};
         annotations.remove(key);
+        annotationOwners.remove(annot);
+
+        auto dirtyIt = dirtyAnnotations.find(doc);
+        if (dirtyIt != dirtyAnnotations.end()) {
+            dirtyIt.value().remove(annot);
+            if (dirtyIt.value().isEmpty()) {
+                dirtyAnnotations.erase(dirtyIt);
+            }
+        }
 
         if (docToAnnotations.contains(doc)) {
             docToAnnotations[doc].remove(annot);
@@ -101,9 +128,36 @@ void AnnotationManager::registerDocument(Document* doc)
 {
     if (!doc) return;
 
+    // Annotations stored in the file: page renders for display leave them out,
+    // so DocumentView draws them from here like the ones added in this session
+    QList<QPair<int, Annotation*>> existing;
+    for (int i = 0; i < doc->pageCount(); ++i) {
+        Page* page = doc->page(i);
+        if (!page) continue;
+        for (Annotation* annotation : page->annotations()) {
+            existing.append(qMakePair(i, annotation));
+        }
+    }
+
     QMutexLocker locker(&d->mutex);
-    // Initialization for the document's annotation tracking happens implicitly when annotations are added.
-    LOG_DEBUG("Registered document with AnnotationManager: " << (doc ? doc->filePath() : "nullptr"));
+    int registered = 0;
+    for (const QPair<int, Annotation*>& entry : existing) {
+        Annotation* annotation = entry.second;
+        if (!annotation || d->annotationOwners.contains(annotation)) continue;
+
+        // Neither dirty nor a modification: they are already in the file
+        d->annotations.insert(AnnotationKey{doc, entry.first, annotation}, annotation);
+        d->annotationOwners.insert(annotation, qMakePair(doc, entry.first));
+        d->docToAnnotations[doc].insert(annotation);
+        d->docPageToAnnotations[doc][entry.first].insert(annotation, annotation->bounds());
+        ++registered;
+    }
+
+    if (registered > 0) {
+        emit annotationAreaChanged(doc, -1, QRectF());
+        emit annotationsChanged(doc);
+    }
+    LOG_DEBUG("Registered document with AnnotationManager: " << doc->filePath() << ", " << registered << " annotations from the file");
 }
 
 void AnnotationManager::unregisterDocument(Document* doc)
@@ -116,21 +170,17 @@ void AnnotationManager::unregisterDocument(Document* doc)
     if (it != d->docToAnnotations.end()) {
         const QSet<Annotation*>& annots = it.value();
         for (Annotation* annot : annots) {
-            // Find the page index for this annotation (requires annotation to know its page)
-            // This is tricky if the annotation object itself doesn't store its page index.
-            // A better map might be QHash<Annotation*, QPair<Document*, int>>.
-            // For now, assume we can find it or iterate the page map.
-            for (auto pageIt = d->docPageToAnnotations[doc].begin(); pageIt != d->docPageToAnnotations[doc].end(); ++pageIt) {
-                if (pageIt.value().contains(annot)) {
-                    d->removeAnnotationInternal(doc, annot, pageIt.key());
-                    emit annotationRemoved(doc, annot);
-                    break; // Found on this page, stop searching
-                }
-            }
+            // The reverse map gives the page directly; the per-document and
+            // per-page maps are dropped wholesale below
+            const QPair<Document*, int> owner = d->annotationOwners.take(annot);
+            d->annotations.remove(AnnotationKey{doc, owner.second, annot});
+            emit annotationRemoved(doc, annot);
         }
         d->docToAnnotations.erase(it);
         d->docPageToAnnotations.remove(doc);
+        d->dirtyAnnotations.remove(doc);
         d->modifiedDocs.remove(doc);
+        emit annotationAreaChanged(doc, -1, QRectF());
         emit annotationsChanged(doc);
         LOG_DEBUG("Unregistered document and removed its annotations from AnnotationManager: " << doc->filePath());
     }
@@ -143,24 +193,72 @@ bool AnnotationManager::addAnnotation(Document* doc, int pageIndex, Annotation*
     QMutexLocker locker(&d->mutex);
 
     AnnotationKey key{doc, pageIndex, annotation};
-    if (d->annotations.contains(key)) {
+    if (d->annotationOwners.contains(annotation)) {
         LOG_WARN("Annotation already registered with AnnotationManager for doc/page.");
         return false; // Or maybe update? For now, prevent duplicates.
     }
 
     d->annotations.insert(key, annotation);
+    d->annotationOwners.insert(annotation, qMakePair(doc, pageIndex));
     d->docToAnnotations[doc].insert(annotation);
-    d->docPageToAnnotations[doc][pageIndex].insert(annotation);
+    d->docPageToAnnotations[doc][pageIndex].insert(annotation, annotation->bounds());
+    d->dirtyAnnotations[doc].insert(annotation); // New since the last save
 
     // Mark document as modified as adding an annotation is a change
-    markDocumentAsModified(doc);
+    if (d->markModified(doc)) {
+        emit documentModifiedChanged(doc, true);
+    }
 
     emit annotationAdded(doc, pageIndex, annotation);
+    emit annotationAreaChanged(doc, pageIndex, annotation->bounds());
     emit annotationsChanged(doc);
     LOG_DEBUG("Added annotation to AnnotationManager for doc: " << doc->filePath() << ", page: " << pageIndex);
     return true;
 }
 
+int AnnotationManager::addAnnotations(Document* doc, const QList<QPair<int, Annotation*>>& annotations)
+{
+    if (!doc || annotations.isEmpty()) return 0;
+
+    QMutexLocker locker(&d->mutex);
+
+    d->annotations.reserve(d->annotations.size() + annotations.size());
+    d->annotationOwners.reserve(d->annotationOwners.size() + annotations.size());
+    QSet<Annotation*>& docAnnotations = d->docToAnnotations[doc];
+    QSet<Annotation*>& dirty = d->dirtyAnnotations[doc];
+    QHash<int, AnnotationSpatialIndex>& pages = d->docPageToAnnotations[doc];
+
+    int added = 0;
+    for (const QPair<int, Annotation*>& entry : annotations) {
+        const int pageIndex = entry.first;
+        Annotation* annotation = entry.second;
+        if (!annotation || d->annotationOwners.contains(annotation)) continue;
+
+        d->annotations.insert(AnnotationKey{doc, pageIndex, annotation}, annotation);
+        d->annotationOwners.insert(annotation, qMakePair(doc, pageIndex));
+        docAnnotations.insert(annotation);
+        pages[pageIndex].insert(annotation, annotation->bounds());
+        dirty.insert(annotation);
+        ++added;
+    }
+
+    if (added == 0) {
+        // Do not leave empty containers behind
+        if (docAnnotations.isEmpty()) d->docToAnnotations.remove(doc);
+        if (dirty.isEmpty()) d->dirtyAnnotations.remove(doc);
+        if (pages.isEmpty()) d->docPageToAnnotations.remove(doc);
+        return 0;
+    }
+
+    if (d->markModified(doc)) {
+        emit documentModifiedChanged(doc, true);
+    }
+    emit annotationAreaChanged(doc, -1, QRectF());
+    emit annotationsChanged(doc);
+    LOG_DEBUG("Added " << added << " annotations in one batch to AnnotationManager for doc: " << doc->filePath());
+    return added;
+}
+
 bool AnnotationManager::removeAnnotation(Document* doc, Annotation* annotation)
 {
     if (!doc || !annotation) return false;
@@ -168,21 +266,17 @@ bool AnnotationManager::removeAnnotation(Document* doc, Annotation* annotation)
     QMutexLocker locker(&d->mutex);
 
     // Find the page index for this annotation
-    int pageIndex = -1;
-    auto docPageIt = d->docPageToAnnotations.find(doc);
-    if (docPageIt != d->docPageToAnnotations.end()) {
-        for (auto pageIt = docPageIt.value().begin(); pageIt != docPageIt.value().end(); ++pageIt) {
-            if (pageIt.value().contains(annotation)) {
-                pageIndex = pageIt.key();
-                break;
-            }
-        }
-    }
+    auto ownerIt = d->annotationOwners.constFind(annotation);
+    const int pageIndex = (ownerIt != d->annotationOwners.constEnd() && ownerIt->first == doc) ? ownerIt->second : -1;
 
     if (pageIndex != -1) {
+        const QRectF oldBounds = d->pageIndex(doc, pageIndex)->bounds(annotation);
         d->removeAnnotationInternal(doc, annotation, pageIndex);
-        markDocumentAsModified(doc); // Removing an annotation is also a change
+        if (d->markModified(doc)) { // Removing an annotation is also a change
+            emit documentModifiedChanged(doc, true);
+        }
         emit annotationRemoved(doc, annotation);
+        emit annotationAreaChanged(doc, pageIndex, oldBounds);
         emit annotationsChanged(doc);
         LOG_DEBUG("Removed annotation from AnnotationManager for doc: " << doc->filePath() << ", page: " << pageIndex);
         return true;
@@ -209,35 +303,65 @@ QList<Annotation*> AnnotationManager::annotationsForPage(Document* doc, int page
     if (!doc) return {};
 
     QMutexLocker locker(&d->mutex);
-    auto docIt = d->docPageToAnnotations.constFind(doc);
-    if (docIt != d->docPageToAnnotations.constEnd()) {
-        auto pageIt = docIt.value().constFind(pageIndex);
-        if (pageIt != docIt.value().constEnd()) {
-            return pageIt.value().values(); // Convert QSet to QList
-        }
-    }
-    return {};
+    const AnnotationSpatialIndex* index = d->pageIndex(doc, pageIndex);
+    return index ? index->annotations() : QList<Annotation*>();
 }
 
 QList<Annotation*> AnnotationManager::findAnnotationsInRect(Document* doc, int pageIndex, const QRectF& rect) const
 {
-    QList<Annotation*> results;
-    if (!doc) return results;
+    if (!doc) return {};
 
     QMutexLocker locker(&d->mutex);
-    auto docIt = d->docPageToAnnotations.constFind(doc);
-    if (docIt != d->docPageToAnnotations.constEnd()) {
-        auto pageIt = docIt.value().constFind(pageIndex);
-        if (pageIt != docIt.value().constEnd()) {
-            for (Annotation* annot : pageIt.value()) {
-                // This requires the Annotation class to have a 'bounds()' method returning QRectF
-                if (annot->bounds().intersects(rect)) { // Assuming bounds() exists and returns QRectF
-                    results.append(annot);
-                }
-            }
-        }
+    const AnnotationSpatialIndex* index = d->pageIndex(doc, pageIndex);
+    return index ? index->query(rect) : QList<Annotation*>();
+}
+
+QList<Annotation*> AnnotationManager::findAnnotationsAt(Document* doc, int pageIndex, const QPointF& point) const
+{
+    if (!doc) return {};
+
+    QMutexLocker locker(&d->mutex);
+    const AnnotationSpatialIndex* index = d->pageIndex(doc, pageIndex);
+    return index ? index->queryPoint(point) : QList<Annotation*>();
+}
+
+bool AnnotationManager::updateAnnotationBounds(Document* doc, Annotation* annotation)
+{
+    if (!doc || !annotation) return false;
+
+    QMutexLocker locker(&d->mutex);
+    auto ownerIt = d->annotationOwners.constFind(annotation);
+    if (ownerIt == d->annotationOwners.constEnd() || ownerIt->first != doc) {
+        LOG_WARN("updateAnnotationBounds: annotation not found in AnnotationManager for doc: " << doc->filePath());
+        return false;
     }
-    return results;
+
+    const int pageIndex = ownerIt->second;
+    AnnotationSpatialIndex& index = d->docPageToAnnotations[doc][pageIndex];
+    const QRectF oldBounds = index.bounds(annotation);
+    const QRectF newBounds = annotation->bounds();
+    index.update(annotation, newBounds);
+    d->dirtyAnnotations[doc].insert(annotation);
+    if (d->markModified(doc)) {
+        emit documentModifiedChanged(doc, true);
+    }
+    emit annotationAreaChanged(doc, pageIndex, oldBounds);
+    emit annotationAreaChanged(doc, pageIndex, newBounds);
+    emit annotationsChanged(doc);
+    return true;
+}
+
+Document* AnnotationManager::documentForAnnotation(Annotation* annotation) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->annotationOwners.value(annotation).first;
+}
+
+int AnnotationManager::pageIndexForAnnotation(Annotation* annotation) const
+{
+    QMutexLocker locker(&d->mutex);
+    auto it = d->annotationOwners.constFind(annotation);
+    return it != d->annotationOwners.constEnd() ? it->second : -1;
 }
 
 int AnnotationManager::totalAnnotationCount() const
@@ -260,32 +384,36 @@ QList<Annotation*> AnnotationManager::getModifiedAnnotationsForDocument(Document
     if (!doc) return {};
 
     QMutexLocker locker(&d->mutex);
-    QList<Annotation*> results;
-
-    // Iterate through all annotations associated with the document
-    auto docAnnotsIt = d->docToAnnotations.constFind(doc);
-    if (docAnnotsIt != d->docToAnnotations.constEnd()) {
-        for (Annotation* annot : docAnnotsIt.value()) {
-            // Check if the specific annotation object reports itself as modified
-            // This requires the Annotation base class or its subclasses (like PdfAnnotation) to have an isModified() method.
-            // Assuming PdfAnnotation implements isModified().
-            PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annot);
-            if (pdfAnnot && pdfAnnot->isModified()) {
-                results.append(annot);
-            }
-        }
-    }
-    LOG_DEBUG("AnnotationManager: Found " << results.size() << " modified annotations for document: " << (doc ? doc->filePath() : "nullptr"));
+    // The dirty set is maintained on add/modify/move, so this is proportional to the changes
+    const QList<Annotation*> results = d->dirtyAnnotations.value(doc).values();
+    LOG_DEBUG("AnnotationManager: Found " << results.size() << " modified annotations for document: " << doc->filePath());
     return results;
 }
 
+void AnnotationManager::markAnnotationModified(Document* doc, Annotation* annotation)
+{
+    if (!doc) return;
+
+    QMutexLocker locker(&d->mutex);
+    auto ownerIt = d->annotationOwners.constFind(annotation);
+    if (ownerIt != d->annotationOwners.constEnd() && ownerIt->first == doc) {
+        d->dirtyAnnotations[doc].insert(annotation);
+        // Colour or contents changed: the annotation needs repainting in place
+        const int pageIndex = ownerIt->second;
+        emit annotationAreaChanged(doc, pageIndex, d->pageIndex(doc, pageIndex)->bounds(annotation));
+    }
+    if (d->markModified(doc)) {
+        LOG_DEBUG("AnnotationManager: Marked document as modified (annotations): " << doc->filePath());
+        emit documentModifiedChanged(doc, true);
+    }
+}
+
 void AnnotationManager::markDocumentAsModified(Document* doc)
 {
     if (!doc) return;
 
     QMutexLocker locker(&d->mutex);
-    bool wasModified = d->modifiedDocs.contains(doc);
-    d->modifiedDocs.insert(doc);
+    bool wasModified = !d->markModified(doc);
 
     // Also mark the *document's* internal flag (if it has one, like d->inMemoryStateModified in PdfDocument)
     // This requires PdfDocument to have a public method or friend access, or for this manager to know about PdfDocument specifically.
@@ -325,7 +453,8 @@ bool AnnotationManager::prepareAnnotationsForSave(Document* doc)
     // that change back to the underlying document format.
     // For PDF (Poppler), this requires an external library or tool capable of writing PDFs.
 
-    auto docAnnots = annotationsForDocument(doc); // Get list under lock
+    // Only the annotations changed since the last save need preparing
+    const QList<Annotation*> docAnnots = d->dirtyAnnotations.value(doc).values();
     locker.unlock(); // Release lock before potentially long-running external processes
 
     bool allPrepared = true;
@@ -354,8 +483,16 @@ bool AnnotationManager::prepareAnnotationsForSave(Document* doc)
 
     if (allPrepared) {
         locker.relock(); // Re-acquire lock to update modification state
-        d->modifiedDocs.remove(doc); // Mark as no longer modified internally
-        emit documentModifiedChanged(doc, false);
+        // Keep annotations changed while the lock was released
+        QSet<Annotation*>& dirty = d->dirtyAnnotations[doc];
+        for (Annotation* annot : docAnnots) {
+            dirty.remove(annot);
+        }
+        if (dirty.isEmpty()) {
+            d->dirtyAnnotations.remove(doc);
+            d->modifiedDocs.remove(doc); // Mark as no longer modified internally
+            emit documentModifiedChanged(doc, false);
+        }
         LOG_INFO("Prepared annotations for save for doc: " << doc->filePath());
     }
 
@@ -14,6 +14,8 @@
 #include <QHash>
 #include <QList>
 #include <QPointer>
+#include <QPointF>
+#include <QRectF>
 #include <memory>
 
 namespace QuantilyxDoc {
@@ -55,7 +57,9 @@ public:
 
     /**
      * @brief Register a document with the annotation manager.
-     * This allows the manager to track annotations for this document.
+     * Tracks the annotations already stored in the document's pages, without
+     * marking the document modified or the annotations dirty; the pages keep
+     * owning them.
      * @param doc The document to register.
      */
     void registerDocument(Document* doc);
@@ -76,6 +80,17 @@ public:
      */
     bool addAnnotation(Document* doc, int pageIndex, Annotation* annotation);
 
+    /**
+     * @brief Add many annotations to a document at once (bulk import).
+     * All annotations are inserted under one lock. Listeners get a single
+     * annotationsChanged() for the batch, plus one annotationAreaChanged() for
+     * the whole document; annotationAdded() is not emitted per annotation.
+     * @param doc The document to add the annotations to.
+     * @param annotations Pairs of (0-based page index, annotation).
+     * @return Number of annotations added (duplicates and null entries are skipped).
+     */
+    int addAnnotations(Document* doc, const QList<QPair<int, Annotation*>>& annotations);
+
     /**
      * @brief Remove an annotation from a document.
      * @param doc The document the annotation belongs to.
@@ -101,6 +116,7 @@ public:
 
     /**
      * @brief Find annotations intersecting a specific rectangle on a page.
+     * Uses the page's spatial index, so only annotations near the rectangle are tested.
      * @param doc The document containing the page.
      * @param pageIndex The 0-based index of the page.
      * @param rect The rectangle in page coordinates to search within.
@@ -108,6 +124,39 @@ public:
      */
     QList<Annotation*> findAnnotationsInRect(Document* doc, int pageIndex, const QRectF& rect) const;
 
+    /**
+     * @brief Find annotations under a point on a page (hover and click hit-testing).
+     * @param doc The document containing the page.
+     * @param pageIndex The 0-based index of the page.
+     * @param point The point in page coordinates.
+     * @return List of annotation objects whose bounds contain the point.
+     */
+    QList<Annotation*> findAnnotationsAt(Document* doc, int pageIndex, const QPointF& point) const;
+
+    /**
+     * @brief Re-index an annotation after its bounds changed (moved or resized).
+     * The spatial index keeps the bounds an annotation had when it was added or
+     * last updated, so callers that move an annotation must call this.
+     * @param doc The document the annotation belongs to.
+     * @param annotation The annotation whose bounds() changed.
+     * @return True if the annotation is managed and was re-indexed.
+     */
+    bool updateAnnotationBounds(Document* doc, Annotation* annotation);
+
+    /**
+     * @brief Get the document a managed annotation belongs to.
+     * @param annotation The annotation.
+     * @return The document, or nullptr if the annotation is not managed.
+     */
+    Document* documentForAnnotation(Annotation* annotation) const;
+
+    /**
+     * @brief Get the page a managed annotation is on.
+     * @param annotation The annotation.
+     * @return The 0-based page index, or -1 if the annotation is not managed.
+     */
+    int pageIndexForAnnotation(Annotation* annotation) const;
+
     /**
      * @brief Get the total number of annotations managed.
      * @return Count of all annotations.
@@ -128,6 +177,22 @@ public:
      */
     void markDocumentAsModified(Document* doc);
 
+    /**
+     * @brief Record that an annotation changed and mark its document as modified.
+     * The annotation joins the document's dirty set, which save and modified-only
+     * export walk instead of every annotation.
+     * @param doc The document the annotation belongs to.
+     * @param annotation The modified annotation.
+     */
+    void markAnnotationModified(Document* doc, Annotation* annotation);
+
+    /**
+     * @brief Get the annotations added, modified or moved since the last save.
+     * @param doc The document.
+     * @return List of dirty annotation objects.
+     */
+    QList<Annotation*> getModifiedAnnotationsForDocument(Document* doc) const;
+
     /**
      * @brief Check if a document has annotations that have been modified since the last save.
      * @param doc The document to check.
@@ -167,6 +232,16 @@ signals:
      */
     void annotationsChanged(QuantilyxDoc::Document* doc);
 
+    /**
+     * @brief Emitted when the appearance of part of a page changes because an
+     * annotation was added, removed, moved or modified. Views repaint only
+     * this area of their annotation overlay.
+     * @param doc The document.
+     * @param pageIndex The page index, or -1 for every page of the document.
+     * @param rect The affected area in page coordinates (ignored when pageIndex is -1).
+     */
+    void annotationAreaChanged(QuantilyxDoc::Document* doc, int pageIndex, const QRectF& rect);
+
     /**
      * @brief Emitted when the modification state of a document changes.
      * @param doc The document whose modification state changed.
@@ -177,6 +252,7 @@ signals:
 private:
     class Private;
     std::unique_ptr<Private> d;
+    static AnnotationManager* s_instance;
 };
 
 } // namespace QuantilyxDoc
@@ -0,0 +1,224 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "AnnotationSpatialIndex.h"
+#include <cmath>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+// An annotation overlapping more cells than this goes to the oversized list
+constexpr int MaxCellsPerAnnotation = 64;
+constexpr qreal MaxCellCoordinate = 1 << 30;
+
+// Inclusive overlap test: degenerate bounds (horizontal lines) still hit
+bool overlaps(const QRectF& a, const QRectF& b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+bool containsPoint(const QRectF& rect, const QPointF& point)
+{
+    return point.x() >= rect.left() && point.x() <= rect.right()
+        && point.y() >= rect.top() && point.y() <= rect.bottom();
+}
+
+} // namespace
+
+AnnotationSpatialIndex::AnnotationSpatialIndex(qreal cellSize)
+    : m_cellSize(cellSize > 0 ? cellSize : 32.0)
+{
+}
+
+void AnnotationSpatialIndex::insert(Annotation* annotation, const QRectF& bounds)
+{
+    if (!annotation) return;
+    auto it = m_bounds.find(annotation);
+    if (it != m_bounds.end()) {
+        unlink(annotation, it.value());
+        it.value() = bounds.normalized();
+    } else {
+        it = m_bounds.insert(annotation, bounds.normalized());
+    }
+    link(annotation, it.value());
+}
+
+bool AnnotationSpatialIndex::remove(Annotation* annotation)
+{
+    auto it = m_bounds.find(annotation);
+    if (it == m_bounds.end()) return false;
+    unlink(annotation, it.value());
+    m_bounds.erase(it);
+    return true;
+}
+
+bool AnnotationSpatialIndex::update(Annotation* annotation, const QRectF& bounds)
+{
+    if (!m_bounds.contains(annotation)) return false;
+    insert(annotation, bounds);
+    return true;
+}
+
+bool AnnotationSpatialIndex::contains(Annotation* annotation) const
+{
+    return m_bounds.contains(annotation);
+}
+
+QRectF AnnotationSpatialIndex::bounds(Annotation* annotation) const
+{
+    return m_bounds.value(annotation);
+}
+
+QList<Annotation*> AnnotationSpatialIndex::query(const QRectF& rect) const
+{
+    QList<Annotation*> results;
+    if (m_bounds.isEmpty()) return results;
+
+    const QRectF r = rect.normalized();
+    for (Annotation* annot : m_oversized) {
+        if (overlaps(m_bounds.value(annot), r)) {
+            results.append(annot);
+        }
+    }
+
+    // An annotation listed in several cells is reported only from the cell
+    // holding the top-left corner of its overlap with the query, so no
+    // de-duplication set is needed.
+    const CellRange range = cellRange(r);
+    auto visitCell = [&](int x, int y, const QVector<Annotation*>& cell) {
+        for (Annotation* annot : cell) {
+            const QRectF b = m_bounds.value(annot);
+            if (!overlaps(b, r)) continue;
+            if (cellOf(qMax(b.left(), r.left())) == x && cellOf(qMax(b.top(), r.top())) == y) {
+                results.append(annot);
+            }
+        }
+    };
+
+    // Walk whichever is smaller: the cells under the query, or the occupied cells
+    if (range.cellCount() <= m_cells.size()) {
+        for (int y = range.top; y <= range.bottom; ++y) {
+            for (int x = range.left; x <= range.right; ++x) {
+                auto it = m_cells.constFind(cellKey(x, y));
+                if (it != m_cells.constEnd()) {
+                    visitCell(x, y, it.value());
+                }
+            }
+        }
+    } else {
+        for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
+            const int x = static_cast<qint32>(it.key() >> 32);
+            const int y = static_cast<qint32>(it.key() & 0xffffffffu);
+            if (x >= range.left && x <= range.right && y >= range.top && y <= range.bottom) {
+                visitCell(x, y, it.value());
+            }
+        }
+    }
+    return results;
+}
+
+QList<Annotation*> AnnotationSpatialIndex::queryPoint(const QPointF& point) const
+{
+    QList<Annotation*> results;
+    for (Annotation* annot : m_oversized) {
+        if (containsPoint(m_bounds.value(annot), point)) {
+            results.append(annot);
+        }
+    }
+    auto it = m_cells.constFind(cellKey(cellOf(point.x()), cellOf(point.y())));
+    if (it != m_cells.constEnd()) {
+        for (Annotation* annot : it.value()) {
+            if (containsPoint(m_bounds.value(annot), point)) {
+                results.append(annot);
+            }
+        }
+    }
+    return results;
+}
+
+QList<Annotation*> AnnotationSpatialIndex::annotations() const
+{
+    return m_bounds.keys();
+}
+
+int AnnotationSpatialIndex::size() const
+{
+    return m_bounds.size();
+}
+
+bool AnnotationSpatialIndex::isEmpty() const
+{
+    return m_bounds.isEmpty();
+}
+
+void AnnotationSpatialIndex::clear()
+{
+    m_bounds.clear();
+    m_cells.clear();
+    m_oversized.clear();
+}
+
+AnnotationSpatialIndex::CellRange AnnotationSpatialIndex::cellRange(const QRectF& rect) const
+{
+    return CellRange{cellOf(rect.left()), cellOf(rect.top()), cellOf(rect.right()), cellOf(rect.bottom())};
+}
+
+int AnnotationSpatialIndex::cellOf(qreal coordinate) const
+{
+    const qreal cell = std::floor(coordinate / m_cellSize);
+    return static_cast<int>(qBound(-MaxCellCoordinate, cell, MaxCellCoordinate));
+}
+
+quint64 AnnotationSpatialIndex::cellKey(int x, int y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+void AnnotationSpatialIndex::link(Annotation* annotation, const QRectF& bounds)
+{
+    const CellRange range = cellRange(bounds);
+    if (range.cellCount() > MaxCellsPerAnnotation) {
+        m_oversized.append(annotation);
+        return;
+    }
+    for (int y = range.top; y <= range.bottom; ++y) {
+        for (int x = range.left; x <= range.right; ++x) {
+            m_cells[cellKey(x, y)].append(annotation);
+        }
+    }
+}
+
+void AnnotationSpatialIndex::unlink(Annotation* annotation, const QRectF& bounds)
+{
+    const CellRange range = cellRange(bounds);
+    if (range.cellCount() > MaxCellsPerAnnotation) {
+        m_oversized.removeOne(annotation);
+        return;
+    }
+    for (int y = range.top; y <= range.bottom; ++y) {
+        for (int x = range.left; x <= range.right; ++x) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end()) continue;
+            QVector<Annotation*>& cell = it.value();
+            const int pos = cell.indexOf(annotation);
+            if (pos >= 0) {
+                // Order within a cell does not matter: swap-remove
+                cell[pos] = cell.last();
+                cell.removeLast();
+            }
+            if (cell.isEmpty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,123 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_ANNOTATIONSPATIALINDEX_H
+#define QUANTILYX_ANNOTATIONSPATIALINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+namespace QuantilyxDoc {
+
+class Annotation;
+
+/**
+ * @brief Uniform-grid spatial index of the annotations on one page.
+ *
+ * The page is divided into square cells (in page coordinates) and each
+ * annotation is listed in every cell its bounds overlap, so a rect query or
+ * a hover hit-test only looks at the annotations near the query instead of
+ * the whole page. Annotations that would span too many cells (page-sized
+ * stamps, watermarks) are kept in a separate list that every query scans;
+ * there are few of them on real pages.
+ *
+ * The index stores the bounds it was given; when an annotation moves, call
+ * update() with the new bounds. Not thread-safe; AnnotationManager guards
+ * it with its mutex.
+ */
+class AnnotationSpatialIndex
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param cellSize Cell edge length in page units (points).
+     */
+    explicit AnnotationSpatialIndex(qreal cellSize = 32.0);
+
+    /**
+     * @brief Add an annotation, or move it if it is already indexed.
+     */
+    void insert(Annotation* annotation, const QRectF& bounds);
+
+    /**
+     * @brief Remove an annotation.
+     * @return True if it was indexed.
+     */
+    bool remove(Annotation* annotation);
+
+    /**
+     * @brief Move an indexed annotation to new bounds.
+     * @return True if it was indexed.
+     */
+    bool update(Annotation* annotation, const QRectF& bounds);
+
+    /**
+     * @brief Check if an annotation is indexed.
+     */
+    bool contains(Annotation* annotation) const;
+
+    /**
+     * @brief Get the bounds an annotation was indexed with.
+     */
+    QRectF bounds(Annotation* annotation) const;
+
+    /**
+     * @brief Get the annotations whose bounds intersect a rectangle.
+     */
+    QList<Annotation*> query(const QRectF& rect) const;
+
+    /**
+     * @brief Get the annotations whose bounds contain a point.
+     */
+    QList<Annotation*> queryPoint(const QPointF& point) const;
+
+    /**
+     * @brief Get all indexed annotations.
+     */
+    QList<Annotation*> annotations() const;
+
+    /**
+     * @brief Get the number of indexed annotations.
+     */
+    int size() const;
+
+    /**
+     * @brief Check if the index is empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Remove all annotations.
+     */
+    void clear();
+
+private:
+    struct CellRange {
+        int left, top, right, bottom;
+        qint64 cellCount() const { return (qint64(right) - left + 1) * (qint64(bottom) - top + 1); }
+    };
+
+    CellRange cellRange(const QRectF& rect) const;
+    int cellOf(qreal coordinate) const;
+    static quint64 cellKey(int x, int y);
+    void link(Annotation* annotation, const QRectF& bounds);
+    void unlink(Annotation* annotation, const QRectF& bounds);
+
+    qreal m_cellSize;
+    QHash<Annotation*, QRectF> m_bounds;            // Indexed bounds per annotation
+    QHash<quint64, QVector<Annotation*>> m_cells;   // Cell -> annotations overlapping it
+    QVector<Annotation*> m_oversized;               // Annotations spanning too many cells
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_ANNOTATIONSPATIALINDEX_H
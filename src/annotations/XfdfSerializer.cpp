@@ -0,0 +1,449 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "XfdfSerializer.h"
+#include "AnnotationManager.h"
+#include "Annotation.h"
+#include "../core/Document.h"
+#include "../core/Page.h"
+#include "../core/Logger.h"
+#include "../formats/pdf/PdfDocument.h"
+#include "../formats/pdf/PdfAnnotation.h"
+#include <QHash>
+#include <QIODevice>
+#include <QPair>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+const QString XfdfNamespace = QStringLiteral("http://ns.adobe.com/xfdf/");
+constexpr int ExportProgressInterval = 1000;
+
+// XFDF element names for the PDF annotation subtypes
+const QList<QPair<PdfAnnotation::Type, QString>>& subtypeNames()
+{
+    static const QList<QPair<PdfAnnotation::Type, QString>> names = {
+        {PdfAnnotation::Type::Text, QStringLiteral("text")},
+        {PdfAnnotation::Type::Link, QStringLiteral("link")},
+        {PdfAnnotation::Type::FreeText, QStringLiteral("freetext")},
+        {PdfAnnotation::Type::Line, QStringLiteral("line")},
+        {PdfAnnotation::Type::Square, QStringLiteral("square")},
+        {PdfAnnotation::Type::Circle, QStringLiteral("circle")},
+        {PdfAnnotation::Type::Polygon, QStringLiteral("polygon")},
+        {PdfAnnotation::Type::PolyLine, QStringLiteral("polyline")},
+        {PdfAnnotation::Type::Highlight, QStringLiteral("highlight")},
+        {PdfAnnotation::Type::Underline, QStringLiteral("underline")},
+        {PdfAnnotation::Type::Squiggly, QStringLiteral("squiggly")},
+        {PdfAnnotation::Type::StrikeOut, QStringLiteral("strikeout")},
+        {PdfAnnotation::Type::Stamp, QStringLiteral("stamp")},
+        {PdfAnnotation::Type::Caret, QStringLiteral("caret")},
+        {PdfAnnotation::Type::Ink, QStringLiteral("ink")},
+        {PdfAnnotation::Type::FileAttachment, QStringLiteral("fileattachment")},
+        {PdfAnnotation::Type::Sound, QStringLiteral("sound")},
+    };
+    return names;
+}
+
+QString subtypeName(PdfAnnotation::Type type)
+{
+    for (const auto& entry : subtypeNames()) {
+        if (entry.first == type) return entry.second;
+    }
+    return QString();
+}
+
+PdfAnnotation::Type subtypeFromName(const QString& name)
+{
+    for (const auto& entry : subtypeNames()) {
+        if (entry.second == name) return entry.first;
+    }
+    return PdfAnnotation::Type::Unknown;
+}
+
+bool isAnnotationElement(const QStringRef& name)
+{
+    for (const auto& entry : subtypeNames()) {
+        if (entry.second == name) return true;
+    }
+    return false;
+}
+
+// PDF date string (D:YYYYMMDDHHmmSS+HH'mm') <-> QDateTime
+QString formatPdfDate(const QDateTime& date)
+{
+    return date.isValid() ? QStringLiteral("D:") + date.toUTC().toString(QStringLiteral("yyyyMMddHHmmss")) + QStringLiteral("+00'00'")
+                          : QString();
+}
+
+QDateTime parsePdfDate(QString text)
+{
+    if (text.startsWith(QLatin1String("D:"))) text = text.mid(2);
+    if (text.size() < 14) return QDateTime();
+
+    QDateTime date = QDateTime::fromString(text.left(14), QStringLiteral("yyyyMMddHHmmss"));
+    if (!date.isValid()) return QDateTime();
+    date.setTimeSpec(Qt::UTC);
+
+    // Offset suffix: Z, or +HH'mm' / -HH'mm'
+    const QString offset = text.mid(14);
+    if (offset.size() >= 3 && (offset[0] == QLatin1Char('+') || offset[0] == QLatin1Char('-'))) {
+        const int hours = offset.midRef(1, 2).toInt();
+        const int minutes = offset.size() >= 6 ? offset.midRef(4, 2).toInt() : 0;
+        const int seconds = (hours * 60 + minutes) * 60;
+        date = date.addSecs(offset[0] == QLatin1Char('+') ? -seconds : seconds);
+    }
+    return date;
+}
+
+} // namespace
+
+class XfdfSerializer::Private {
+public:
+    Private(XfdfSerializer* q_ptr) : q(q_ptr), batchSize(1000) {}
+
+    XfdfSerializer* q;
+    AnnotationFactory factory;
+    int batchSize;
+    QString lastError;
+    QHash<int, qreal> pageHeights; // Per-operation cache
+
+    qreal pageHeight(Document* doc, int pageIndex) {
+        auto it = pageHeights.constFind(pageIndex);
+        if (it != pageHeights.constEnd()) return it.value();
+        Page* page = doc->page(pageIndex);
+        const qreal height = page ? page->size().height() : 0.0;
+        pageHeights.insert(pageIndex, height);
+        return height;
+    }
+
+    // Page coordinates (top-left origin) <-> PDF user space (bottom-left origin)
+    QPointF toPdf(const QPointF& p, qreal height) const { return QPointF(p.x(), height - p.y()); }
+    QPointF fromPdf(const QPointF& p, qreal height) const { return QPointF(p.x(), height - p.y()); }
+
+    static Annotation* createPdfAnnotation(Document* doc, const XfdfAnnotationData& data) {
+        PdfDocument* pdfDoc = qobject_cast<PdfDocument*>(doc);
+        if (!pdfDoc) return nullptr;
+        const PdfAnnotation::Type type = subtypeFromName(data.subtype);
+        if (type == PdfAnnotation::Type::Unknown) return nullptr;
+
+        PdfAnnotation* annot = new PdfAnnotation(type, data.bounds, pdfDoc, data.pageIndex, pdfDoc);
+        annot->setName(data.name);
+        annot->setContents(data.contents);
+        annot->setColor(data.color);
+        annot->setOpacity(data.opacity);
+        annot->setAuthor(data.author);
+        if (!data.inkPaths.isEmpty()) {
+            annot->setInkPaths(data.inkPaths);
+        }
+        annot->setModificationDate(data.modificationDate);
+        return annot;
+    }
+
+    // Apply a re-imported record to the annotation of the same name. Poppler-
+    // backed annotations only take the properties PdfAnnotation can change.
+    static bool updatePdfAnnotation(Annotation* existing, const XfdfAnnotationData& data) {
+        PdfAnnotation* annot = qobject_cast<PdfAnnotation*>(existing);
+        if (!annot || subtypeFromName(data.subtype) != annot->type()) return false;
+
+        annot->setContents(data.contents);
+        annot->setColor(data.color);
+        if (!annot->popplerAnnotation()) {
+            annot->setBounds(data.bounds);
+            annot->setOpacity(data.opacity);
+            annot->setAuthor(data.author);
+            if (!data.inkPaths.isEmpty()) {
+                annot->setInkPaths(data.inkPaths);
+            }
+            annot->setModificationDate(data.modificationDate);
+        }
+        return true;
+    }
+
+    void writeAnnotation(QXmlStreamWriter& xml, Document* doc, int pageIndex, Annotation* annot) {
+        PdfAnnotation* pdfAnnot = qobject_cast<PdfAnnotation*>(annot);
+        QString element = pdfAnnot ? subtypeName(pdfAnnot->type()) : QString();
+        if (element.isEmpty()) element = QStringLiteral("square");
+
+        const qreal height = pageHeight(doc, pageIndex);
+        const QRectF bounds = annot->bounds();
+        const QPointF bottomLeft = toPdf(bounds.bottomLeft(), height);
+        const QPointF topRight = toPdf(bounds.topRight(), height);
+
+        xml.writeStartElement(element);
+        xml.writeAttribute(QStringLiteral("page"), QString::number(pageIndex));
+        xml.writeAttribute(QStringLiteral("rect"), QStringLiteral("%1,%2,%3,%4")
+                           .arg(bottomLeft.x()).arg(bottomLeft.y()).arg(topRight.x()).arg(topRight.y()));
+        if (annot->color().isValid()) {
+            xml.writeAttribute(QStringLiteral("color"), annot->color().name());
+        }
+        if (!annot->author().isEmpty()) {
+            xml.writeAttribute(QStringLiteral("title"), annot->author());
+        }
+        const QString date = formatPdfDate(annot->modificationDate());
+        if (!date.isEmpty()) {
+            xml.writeAttribute(QStringLiteral("date"), date);
+        }
+        if (pdfAnnot) {
+            if (!pdfAnnot->name().isEmpty()) {
+                xml.writeAttribute(QStringLiteral("name"), pdfAnnot->name());
+            }
+            if (pdfAnnot->opacity() < 1.0) {
+                xml.writeAttribute(QStringLiteral("opacity"), QString::number(pdfAnnot->opacity()));
+            }
+        }
+        if (!annot->contents().isEmpty()) {
+            xml.writeTextElement(QStringLiteral("contents"), annot->contents());
+        }
+        const QList<QList<QPointF>> paths = pdfAnnot ? pdfAnnot->inkPaths() : QList<QList<QPointF>>();
+        if (!paths.isEmpty()) {
+            xml.writeStartElement(QStringLiteral("inklist"));
+            for (const QList<QPointF>& path : paths) {
+                QStringList points;
+                points.reserve(path.size());
+                for (const QPointF& p : path) {
+                    const QPointF pdf = toPdf(p, height);
+                    points.append(QStringLiteral("%1,%2").arg(pdf.x()).arg(pdf.y()));
+                }
+                xml.writeTextElement(QStringLiteral("gesture"), points.join(QLatin1Char(';')));
+            }
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+    }
+
+    // Read one annotation element (the reader is on its start element) up to its end element
+    bool readAnnotation(QXmlStreamReader& xml, Document* doc, XfdfAnnotationData& data) {
+        const QXmlStreamAttributes attrs = xml.attributes();
+        data.subtype = xml.name().toString();
+        data.pageIndex = attrs.value(QLatin1String("page")).toInt();
+        data.author = attrs.value(QLatin1String("title")).toString();
+        data.name = attrs.value(QLatin1String("name")).toString();
+        data.modificationDate = parsePdfDate(attrs.value(QLatin1String("date")).toString());
+        if (attrs.hasAttribute(QLatin1String("color"))) {
+            data.color = QColor(attrs.value(QLatin1String("color")).toString());
+        }
+        if (attrs.hasAttribute(QLatin1String("opacity"))) {
+            data.opacity = attrs.value(QLatin1String("opacity")).toDouble();
+        }
+
+        const qreal height = pageHeight(doc, data.pageIndex);
+        const QVector<QStringRef> rect = attrs.value(QLatin1String("rect")).split(QLatin1Char(','));
+        if (rect.size() == 4) {
+            const QPointF a = fromPdf(QPointF(rect[0].toDouble(), rect[1].toDouble()), height);
+            const QPointF b = fromPdf(QPointF(rect[2].toDouble(), rect[3].toDouble()), height);
+            data.bounds = QRectF(a, b).normalized();
+        }
+
+        while (xml.readNextStartElement()) {
+            if (xml.name() == QLatin1String("contents")) {
+                data.contents = xml.readElementText();
+            } else if (xml.name() == QLatin1String("inklist")) {
+                while (xml.readNextStartElement()) {
+                    if (xml.name() != QLatin1String("gesture")) {
+                        xml.skipCurrentElement();
+                        continue;
+                    }
+                    QList<QPointF> path;
+                    const QString gesture = xml.readElementText();
+                    for (const QStringRef& point : gesture.splitRef(QLatin1Char(';'), Qt::SkipEmptyParts)) {
+                        const QVector<QStringRef> xy = point.split(QLatin1Char(','));
+                        if (xy.size() == 2) {
+                            path.append(fromPdf(QPointF(xy[0].toDouble(), xy[1].toDouble()), height));
+                        }
+                    }
+                    data.inkPaths.append(path);
+                }
+            } else {
+                xml.skipCurrentElement(); // popup, contents-richtext, ...
+            }
+        }
+        return !xml.hasError();
+    }
+};
+
+XfdfSerializer::XfdfSerializer(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    d->factory = &Private::createPdfAnnotation;
+}
+
+XfdfSerializer::~XfdfSerializer() = default;
+
+int XfdfSerializer::exportAnnotations(Document* doc, QIODevice* device, bool modifiedOnly)
+{
+    d->lastError.clear();
+    if (!doc || !device || !device->isWritable()) {
+        d->lastError = tr("No document or writable device for XFDF export");
+        LOG_ERROR(d->lastError);
+        return -1;
+    }
+
+    AnnotationManager& manager = AnnotationManager::instance();
+    const QList<Annotation*> annotations = modifiedOnly ? manager.getModifiedAnnotationsForDocument(doc)
+                                                        : manager.annotationsForDocument(doc);
+    d->pageHeights.clear();
+
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeDefaultNamespace(XfdfNamespace);
+    xml.writeStartElement(XfdfNamespace, QStringLiteral("xfdf"));
+    xml.writeAttribute(QStringLiteral("xml:space"), QStringLiteral("preserve"));
+    if (!doc->filePath().isEmpty()) {
+        xml.writeStartElement(QStringLiteral("f"));
+        xml.writeAttribute(QStringLiteral("href"), doc->filePath());
+        xml.writeEndElement();
+    }
+    xml.writeStartElement(QStringLiteral("annots"));
+
+    int written = 0;
+    for (Annotation* annot : annotations) {
+        const int pageIndex = manager.pageIndexForAnnotation(annot);
+        if (pageIndex < 0) continue; // Removed meanwhile
+        d->writeAnnotation(xml, doc, pageIndex, annot);
+        if (++written % ExportProgressInterval == 0) {
+            emit progress(written);
+        }
+    }
+
+    xml.writeEndElement(); // annots
+    xml.writeEndElement(); // xfdf
+    xml.writeEndDocument();
+    d->pageHeights.clear();
+
+    if (xml.hasError()) {
+        d->lastError = tr("Failed to write XFDF: %1").arg(device->errorString());
+        LOG_ERROR(d->lastError);
+        return -1;
+    }
+    emit progress(written);
+    LOG_INFO("Exported " << written << " annotations as XFDF for doc: " << doc->filePath());
+    return written;
+}
+
+int XfdfSerializer::importAnnotations(Document* doc, QIODevice* device)
+{
+    d->lastError.clear();
+    if (!doc || !device || !device->isReadable()) {
+        d->lastError = tr("No document or readable device for XFDF import");
+        LOG_ERROR(d->lastError);
+        return -1;
+    }
+
+    AnnotationManager& manager = AnnotationManager::instance();
+    d->pageHeights.clear();
+    QList<QPair<int, Annotation*>> batch;
+    batch.reserve(d->batchSize);
+    int imported = 0;
+    int updated = 0;
+    int skipped = 0;
+
+    // Re-importing a file updates the annotations it created instead of
+    // duplicating them; XFDF identifies annotations by name
+    QHash<QString, Annotation*> byName;
+    for (Annotation* annot : manager.annotationsForDocument(doc)) {
+        PdfAnnotation* pdfAnnot = qobject_cast<PdfAnnotation*>(annot);
+        if (pdfAnnot && !pdfAnnot->name().isEmpty()) {
+            byName.insert(pdfAnnot->name(), annot);
+        }
+    }
+
+    auto flush = [&]() {
+        if (batch.isEmpty()) return;
+        imported += manager.addAnnotations(doc, batch);
+        batch.clear();
+        emit progress(imported);
+    };
+
+    QXmlStreamReader xml(device);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement() || !isAnnotationElement(xml.name())) continue;
+
+        XfdfAnnotationData data;
+        if (!d->readAnnotation(xml, doc, data)) break;
+        if (data.pageIndex < 0 || data.pageIndex >= doc->pageCount()) {
+            ++skipped;
+            continue;
+        }
+        Annotation* existing = data.name.isEmpty() ? nullptr : byName.value(data.name);
+        if (existing) {
+            const bool managed = manager.documentForAnnotation(existing) == doc;
+            if (managed && manager.pageIndexForAnnotation(existing) != data.pageIndex) {
+                ++skipped; // Same name on another page: not the same annotation
+                continue;
+            }
+            if (!Private::updatePdfAnnotation(existing, data)) {
+                ++skipped;
+                continue;
+            }
+            if (managed) {
+                manager.updateAnnotationBounds(doc, existing);
+            }
+            ++updated;
+            continue;
+        }
+
+        Annotation* annot = d->factory ? d->factory(doc, data) : nullptr;
+        if (!annot) {
+            ++skipped;
+            continue;
+        }
+        if (!data.name.isEmpty()) {
+            byName.insert(data.name, annot); // A repeated name later in the file updates this one
+        }
+        batch.append(qMakePair(data.pageIndex, annot));
+        if (batch.size() >= d->batchSize) {
+            flush();
+        }
+    }
+    flush();
+    d->pageHeights.clear();
+
+    if (skipped > 0) {
+        LOG_WARN("XFDF import skipped " << skipped << " annotations (unsupported type, page out of range,"
+                 " or a name already used by a different annotation)");
+    }
+    if (xml.hasError()) {
+        d->lastError = tr("Malformed XFDF at line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        LOG_ERROR(d->lastError << " (" << imported << " annotations imported and " << updated
+                  << " updated before the error)");
+        return -1;
+    }
+    LOG_INFO("Imported " << imported << " and updated " << updated << " annotations from XFDF into doc: " << doc->filePath());
+    return imported + updated;
+}
+
+void XfdfSerializer::setAnnotationFactory(AnnotationFactory factory)
+{
+    d->factory = std::move(factory);
+}
+
+void XfdfSerializer::setBatchSize(int size)
+{
+    if (size > 0) {
+        d->batchSize = size;
+    }
+}
+
+int XfdfSerializer::batchSize() const
+{
+    return d->batchSize;
+}
+
+QString XfdfSerializer::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,137 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_XFDFSERIALIZER_H
+#define QUANTILYX_XFDFSERIALIZER_H
+
+#include <QObject>
+#include <QColor>
+#include <QDateTime>
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+
+namespace QuantilyxDoc {
+
+class Document;
+class Annotation;
+
+/**
+ * @brief One annotation as read from or written to XFDF, independent of format.
+ */
+struct XfdfAnnotationData {
+    QString subtype;                    // XFDF element name: "square", "highlight", "ink", ...
+    int pageIndex = 0;                  // 0-based
+    QRectF bounds;                      // Page coordinates (points, top-left origin)
+    QColor color;
+    qreal opacity = 1.0;
+    QString author;                     // XFDF "title"
+    QString name;                       // Unique annotation name (NM)
+    QDateTime modificationDate;
+    QString contents;
+    QList<QList<QPointF>> inkPaths;     // Page coordinates, for "ink"
+};
+
+/**
+ * @brief Streaming XFDF import and export of annotations.
+ *
+ * Export walks the document's annotations and writes each one straight to
+ * the device with QXmlStreamWriter. Import reads with QXmlStreamReader,
+ * creates annotations through a factory and hands them to AnnotationManager
+ * in batches (AnnotationManager::addAnnotations), so a large review set costs
+ * one change notification per batch instead of one per annotation. Neither
+ * direction builds the whole XML document in memory.
+ *
+ * XFDF uses PDF user space (origin at the bottom-left of the page); bounds
+ * are converted with the page height.
+ */
+class XfdfSerializer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Creates the annotation for an imported record, or returns nullptr to skip it.
+     */
+    using AnnotationFactory = std::function<Annotation*(Document*, const XfdfAnnotationData&)>;
+
+    /**
+     * @brief Constructor.
+     * @param parent Parent object.
+     */
+    explicit XfdfSerializer(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~XfdfSerializer() override;
+
+    /**
+     * @brief Write a document's annotations as XFDF.
+     * @param doc The document.
+     * @param device Open, writable device.
+     * @param modifiedOnly Only export annotations changed since the last save.
+     * @return Number of annotations written, or -1 on error.
+     */
+    int exportAnnotations(Document* doc, QIODevice* device, bool modifiedOnly = false);
+
+    /**
+     * @brief Read XFDF and add the annotations to a document.
+     * A record whose name matches an annotation already in the document
+     * (on the same page) updates that annotation instead, so importing the
+     * same file twice does not duplicate it. Records without a name are
+     * always added.
+     * @param doc The document.
+     * @param device Open, readable device.
+     * @return Number of annotations imported or updated, or -1 if the XML is
+     *         malformed (annotations before the error are kept).
+     */
+    int importAnnotations(Document* doc, QIODevice* device);
+
+    /**
+     * @brief Set the factory used on import.
+     * The default creates PdfAnnotation objects for PDF documents.
+     */
+    void setAnnotationFactory(AnnotationFactory factory);
+
+    /**
+     * @brief Set how many imported annotations are added to AnnotationManager at once.
+     * @param size Batch size (default 1000).
+     */
+    void setBatchSize(int size);
+
+    /**
+     * @brief Get the import batch size.
+     */
+    int batchSize() const;
+
+    /**
+     * @brief Get the description of the last error.
+     */
+    QString lastError() const;
+
+signals:
+    /**
+     * @brief Emitted after each import batch and periodically during export.
+     * @param processed Annotations processed so far.
+     */
+    void progress(int processed);
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_XFDFSERIALIZER_H
@@ -0,0 +1,137 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// quantilyxdoc-ocr: makes PDF files searchable. Every page without a text
+// layer is recognized, the words are written into the file as an invisible
+// text layer, and the page text is added to the application's full-text index.
+
+#include "formats/pdf/PdfDocument.h"
+#include "ocr/OcrBatchProcessor.h"
+#include "ocr/OcrEngine.h"
+#include "search/FullTextIndex.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QEventLoop>
+#include <QStandardPaths>
+#include <QTextStream>
+
+using QuantilyxDoc::FullTextIndex;
+using QuantilyxDoc::OcrBatchProcessor;
+using QuantilyxDoc::OcrEngine;
+using QuantilyxDoc::PdfDocument;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // The default index is the one the application searches
+    QCoreApplication::setOrganizationName("R² Innovative Software");
+    QCoreApplication::setApplicationName("QuantilyxDoc");
+    const QString defaultIndex = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/fts_index";
+    QCoreApplication::setApplicationName("quantilyxdoc-ocr");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Add a searchable text layer to PDF files with OCR.");
+    parser.addHelpOption();
+
+    QCommandLineOption languageOption(QStringList() << "l" << "language",
+                                      "OCR language(s), e.g. eng or eng+deu (default eng).", "lang", "eng");
+    QCommandLineOption dataOption(QStringList() << "d" << "data",
+                                  "Tesseract tessdata directory, or PaddleOCR model directory.", "dir");
+    QCommandLineOption paddleOption(QStringList() << "paddle", "Recognize with PaddleOCR instead of Tesseract.");
+    QCommandLineOption indexOption(QStringList() << "i" << "index",
+                                   "Full-text index directory (default: the application's).", "dir", defaultIndex);
+    QCommandLineOption pagesOption(QStringList() << "j" << "pages",
+                                   "Pages recognized at once (default: cores - 1).", "count", "0");
+    QCommandLineOption allOption(QStringList() << "all",
+                                 "Recognize whole pages, even blank ones or ones with some text.");
+    parser.addOption(languageOption);
+    parser.addOption(dataOption);
+    parser.addOption(paddleOption);
+    parser.addOption(indexOption);
+    parser.addOption(pagesOption);
+    parser.addOption(allOption);
+    parser.addPositionalArgument("file", "PDF file to process; it is updated in place.", "<file>...");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    OcrEngine& engine = OcrEngine::instance();
+    engine.setBackend(parser.isSet(paddleOption) ? OcrEngine::Backend::PaddleOcr : OcrEngine::Backend::Tesseract);
+    if (!engine.initialize(parser.value(languageOption), parser.value(dataOption))) {
+        err << "Cannot initialize OCR for language " << parser.value(languageOption) << '\n';
+        return 1;
+    }
+
+    const QString indexPath = parser.value(indexOption);
+    QDir().mkpath(indexPath);
+    if (!FullTextIndex::instance().initialize(indexPath)) {
+        err << "Cannot open the full-text index in " << indexPath << '\n';
+        return 1;
+    }
+
+    // Files run one after another; the processor parallelizes within a file
+    int failures = 0;
+    for (const QString& path : files) {
+        PdfDocument document;
+        if (!document.load(path)) {
+            err << path << ": " << document.lastError() << '\n';
+            err.flush();
+            ++failures;
+            continue;
+        }
+
+        OcrBatchProcessor processor;
+        processor.setSkipExistingText(!parser.isSet(allOption));
+        const int pages = parser.value(pagesOption).toInt();
+        if (pages > 0) {
+            processor.setMaxConcurrentPages(pages);
+        }
+        // Signals come from worker threads; page text reaches the index
+        // through this thread's event loop, so the loop runs until the end
+        QEventLoop loop;
+        QObject::connect(&processor, &OcrBatchProcessor::progress, &loop, [&out, &path](int done, int total) {
+            out << path << ": " << done << "/" << total << '\r';
+            out.flush();
+        }, Qt::QueuedConnection);
+        QObject::connect(&processor, &OcrBatchProcessor::error, &loop, [&err, &path](const QString& message) {
+            err << path << ": " << message << '\n';
+            err.flush();
+        }, Qt::QueuedConnection);
+        bool succeeded = false;
+        QObject::connect(&processor, &OcrBatchProcessor::finished, &loop, [&loop, &succeeded](bool success) {
+            succeeded = success;
+            loop.quit();
+        }, Qt::QueuedConnection);
+
+        // finished() follows every successful start, even with nothing to do
+        if (!processor.start(&document)) {
+            err << path << ": cannot start OCR\n";
+            err.flush();
+            ++failures;
+            continue;
+        }
+        loop.exec();
+        const int recognized = processor.pagesDone() - processor.pagesSkipped() - processor.pagesFailed();
+        out << path << ": " << recognized << " pages recognized, " << processor.pagesSkipped() << " skipped, "
+            << processor.pagesFailed() << " failed" << (succeeded ? "" : " (incomplete)") << '\n';
+        out.flush();
+        if (!succeeded) {
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 2;
+}
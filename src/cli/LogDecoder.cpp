@@ -0,0 +1,88 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// quantilyxdoc-logdecode: converts a binary structured log (.qlb) written by
+// BinaryLog into text lines or JSON (one object per line).
+
+#include "core/BinaryLog.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quantilyxdoc-logdecode");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode QuantilyxDoc binary log files.");
+    parser.addHelpOption();
+
+    QCommandLineOption jsonOption(QStringList() << "j" << "json",
+                                  "Output JSON lines instead of text.");
+    QCommandLineOption levelOption(QStringList() << "l" << "level",
+                                   "Only show events at or above this level.",
+                                   "level");
+    parser.addOption(jsonOption);
+    parser.addOption(levelOption);
+    parser.addPositionalArgument("file", "Binary log file (.qlb).", "<file>...");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QuantilyxDoc::LogLevel minLevel = QuantilyxDoc::LogLevel::Trace;
+    if (parser.isSet(levelOption)) {
+        bool ok = false;
+        minLevel = QuantilyxDoc::Logger::levelFromString(parser.value(levelOption), &ok);
+        if (!ok) {
+            QTextStream(stderr) << "Unknown level: " << parser.value(levelOption) << '\n';
+            return 1;
+        }
+    }
+
+    const bool json = parser.isSet(jsonOption);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    int exitCode = 0;
+
+    for (const QString& path : files) {
+        QuantilyxDoc::BinaryLogReader reader;
+        if (!reader.open(path)) {
+            err << path << ": " << reader.errorString() << '\n';
+            err.flush();
+            exitCode = 1;
+            continue;
+        }
+
+        QuantilyxDoc::BinaryLogEvent event;
+        while (reader.next(event)) {
+            if (event.level < minLevel) {
+                continue;
+            }
+            if (json) {
+                out << QJsonDocument(event.toJson()).toJson(QJsonDocument::Compact) << '\n';
+            } else {
+                out << event.toText() << '\n';
+            }
+        }
+        if (!reader.errorString().isEmpty()) {
+            // A truncated tail is expected if the writer was killed mid-flush
+            err << path << ": " << reader.errorString() << '\n';
+            err.flush();
+        }
+    }
+
+    out.flush();
+    return exitCode;
+}
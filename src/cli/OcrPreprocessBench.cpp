@@ -0,0 +1,130 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// quantilyxdoc-ocrbench: times the OCR preprocessing stages on sample page
+// images, per kernel set, without running OCR.
+
+#include "ocr/OcrPreprocessor.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QImage>
+#include <QTextStream>
+
+using QuantilyxDoc::OcrPreprocessOptions;
+using QuantilyxDoc::OcrPreprocessStats;
+using QuantilyxDoc::OcrPreprocessor;
+
+namespace {
+
+struct Totals {
+    double grayscale = 0, rescale = 0, deskew = 0, binarize = 0, despeckle = 0;
+    void add(const OcrPreprocessStats& s) {
+        grayscale += s.grayscaleNs / 1e6;
+        rescale += s.rescaleNs / 1e6;
+        deskew += s.deskewNs / 1e6;
+        binarize += s.binarizeNs / 1e6;
+        despeckle += s.despeckleNs / 1e6;
+    }
+    double total() const { return grayscale + rescale + deskew + binarize + despeckle; }
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quantilyxdoc-ocrbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark OCR image preprocessing.");
+    parser.addHelpOption();
+
+    QCommandLineOption iterationsOption(QStringList() << "n" << "iterations",
+                                        "Runs per image and kernel (default 10).", "count", "10");
+    QCommandLineOption kernelOption(QStringList() << "k" << "kernel",
+                                    "Kernel set: scalar, sse2, avx2, auto or all (default all).", "kernel", "all");
+    QCommandLineOption sauvolaOption(QStringList() << "sauvola",
+                                     "Use Sauvola instead of Otsu binarization.");
+    QCommandLineOption dpiOption(QStringList() << "dpi",
+                                 "Resolution of the input images (default: no rescale).", "dpi", "0");
+    parser.addOption(iterationsOption);
+    parser.addOption(kernelOption);
+    parser.addOption(sauvolaOption);
+    parser.addOption(dpiOption);
+    parser.addPositionalArgument("image", "Page image to process.", "<image>...");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const int dpi = parser.value(dpiOption).toInt();
+
+    QList<OcrPreprocessOptions::Kernel> kernels;
+    const QString kernelName = parser.value(kernelOption);
+    for (auto kernel : {OcrPreprocessOptions::Kernel::Scalar, OcrPreprocessOptions::Kernel::Sse2,
+                        OcrPreprocessOptions::Kernel::Avx2, OcrPreprocessOptions::Kernel::Auto}) {
+        const bool all = kernelName == "all" && kernel != OcrPreprocessOptions::Kernel::Auto;
+        if (all || kernelName == OcrPreprocessor::kernelName(kernel)) {
+            // Skip kernels the CPU cannot run rather than timing the fallback twice
+            if (kernel == OcrPreprocessOptions::Kernel::Auto || int(kernel) <= int(OcrPreprocessor::bestKernel())) {
+                kernels.append(kernel);
+            }
+        }
+    }
+    if (kernels.isEmpty()) {
+        err << "Unknown or unsupported kernel: " << kernelName << '\n';
+        return 1;
+    }
+
+    out << "best kernel: " << OcrPreprocessor::kernelName(OcrPreprocessor::bestKernel()) << '\n';
+    out << "image\tkernel\tgray_ms\trescale_ms\tdeskew_ms\tbinarize_ms\tdespeckle_ms\ttotal_ms\tskew_deg\n";
+
+    int exitCode = 0;
+    for (const QString& path : files) {
+        const QImage image(path);
+        if (image.isNull()) {
+            err << path << ": cannot read image\n";
+            err.flush();
+            exitCode = 1;
+            continue;
+        }
+
+        for (auto kernel : kernels) {
+            OcrPreprocessOptions options;
+            options.kernel = kernel;
+            options.binarization = parser.isSet(sauvolaOption) ? OcrPreprocessOptions::Binarization::Sauvola
+                                                               : OcrPreprocessOptions::Binarization::Otsu;
+            const OcrPreprocessor preprocessor(options);
+
+            Totals totals;
+            OcrPreprocessStats stats;
+            preprocessor.process(image, dpi, &stats); // Warm-up
+            for (int i = 0; i < iterations; ++i) {
+                preprocessor.process(image, dpi, &stats);
+                totals.add(stats);
+            }
+            out << path << '\t' << stats.kernel
+                << '\t' << QString::number(totals.grayscale / iterations, 'f', 2)
+                << '\t' << QString::number(totals.rescale / iterations, 'f', 2)
+                << '\t' << QString::number(totals.deskew / iterations, 'f', 2)
+                << '\t' << QString::number(totals.binarize / iterations, 'f', 2)
+                << '\t' << QString::number(totals.despeckle / iterations, 'f', 2)
+                << '\t' << QString::number(totals.total() / iterations, 'f', 2)
+                << '\t' << QString::number(stats.skewDegrees, 'f', 2) << '\n';
+            out.flush();
+        }
+    }
+    return exitCode;
+}
@@ -0,0 +1,124 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+// quantilyxdoc-paddlebench: measures PaddleOCR recognition throughput on a
+// CPU, with page images recognized concurrently as the batch OCR does.
+
+#include "ocr/PaddleOcrBackend.h"
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QTextStream>
+#include <QThread>
+#include <memory>
+#include <vector>
+
+using QuantilyxDoc::PaddleOcrBackend;
+using QuantilyxDoc::PaddleOcrStats;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("quantilyxdoc-paddlebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark batched PaddleOCR inference on the CPU.");
+    parser.addHelpOption();
+
+    QCommandLineOption modelsOption(QStringList() << "m" << "models",
+                                    "Directory with det/, rec/ and dict.txt.", "dir");
+    QCommandLineOption iterationsOption(QStringList() << "n" << "iterations",
+                                        "Runs over the image set (default 3).", "count", "3");
+    QCommandLineOption pagesOption(QStringList() << "j" << "pages",
+                                   "Pages recognized at once (default: cores - 1).", "count",
+                                   QString::number(qMax(1, QThread::idealThreadCount() - 1)));
+    QCommandLineOption batchOption(QStringList() << "b" << "batch",
+                                   "Largest recognition batch (default 16).", "lines", "16");
+    QCommandLineOption threadsOption(QStringList() << "t" << "intra-op",
+                                     "Recognition math threads (default 0 = automatic).", "count", "0");
+    QCommandLineOption latencyOption(QStringList() << "latency",
+                                     "Longest wait for a batch to fill, in ms (default 10).", "ms", "10");
+    parser.addOption(modelsOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(pagesOption);
+    parser.addOption(batchOption);
+    parser.addOption(threadsOption);
+    parser.addOption(latencyOption);
+    parser.addPositionalArgument("image", "Page image to recognize.", "<image>...");
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty() || !parser.isSet(modelsOption)) {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    QList<QImage> images;
+    for (const QString& path : files) {
+        const QImage image(path);
+        if (image.isNull()) {
+            err << path << ": cannot read image\n";
+            return 1;
+        }
+        images.append(image);
+    }
+
+    PaddleOcrBackend& backend = PaddleOcrBackend::instance();
+    backend.setMaxBatchSize(parser.value(batchOption).toInt());
+    backend.setIntraOpThreads(parser.value(threadsOption).toInt());
+    backend.setBatchLatency(parser.value(latencyOption).toInt());
+    if (!backend.initialize(parser.value(modelsOption))) {
+        err << "Cannot load models (Paddle " << PaddleOcrBackend::engineVersion() << ")\n";
+        return 1;
+    }
+
+    backend.recognize(images.first()); // Warm-up: first runs compile the kernels
+    backend.resetStats();
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    const int pages = qMax(1, parser.value(pagesOption).toInt());
+    const int jobs = iterations * images.size();
+    QAtomicInt next(0);
+    QElapsedTimer wall;
+    wall.start();
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < pages; ++i) {
+        threads.emplace_back(QThread::create([&]() {
+            for (int job = next.fetchAndAddRelaxed(1); job < jobs; job = next.fetchAndAddRelaxed(1)) {
+                backend.recognize(images.at(job % images.size()));
+            }
+        }));
+        threads.back()->start();
+    }
+    for (auto& thread : threads) {
+        thread->wait();
+    }
+    const double seconds = wall.nsecsElapsed() / 1e9;
+
+    const PaddleOcrStats stats = backend.stats();
+    const qint64 slots = stats.regions + stats.paddedSlots;
+    out << "paddle: " << PaddleOcrBackend::engineVersion()
+        << ", cores: " << QThread::idealThreadCount()
+        << ", pages at once: " << pages
+        << ", intra-op threads: " << backend.effectiveIntraOpThreads() << '\n';
+    out << "pages\tregions\tbatches\tmean_batch\tpadding_pct\twall_s\tregions_per_s\tinference_regions_per_s\n";
+    out << jobs
+        << '\t' << stats.regions
+        << '\t' << stats.batches
+        << '\t' << QString::number(stats.batches > 0 ? double(stats.regions) / stats.batches : 0.0, 'f', 1)
+        << '\t' << QString::number(slots > 0 ? 100.0 * stats.paddedSlots / slots : 0.0, 'f', 1)
+        << '\t' << QString::number(seconds, 'f', 2)
+        << '\t' << QString::number(seconds > 0 ? stats.regions / seconds : 0.0, 'f', 1)
+        << '\t' << QString::number(stats.regionsPerSecond(), 'f', 1) << '\n';
+    return 0;
+}
@@ -22,6 +22,7 @@
 #include "security/PasswordRemover.h"
 #include "security/RestrictionBypass.h"
 #include "ocr/OcrEngine.h"
+#include "editing/EditCommands.h"
 #include "ui/SplashScreen.h"
 #include "ui/MainWindow.h"
 #include <QDir>
@@ -160,6 +161,11 @@ bool Application::initialize()
         RecentFiles::instance().load();
     }
 
+    // Edits the crash-recovery journal can replay; needed before the first document opens
+    if (initSuccess) {
+        registerEditCommandJournalTypes();
+    }
+
     // 7. Initialize Backup Manager (settings dependent)
     if (initSuccess) {
         // BackupManager::instance().setEnabled(Settings::instance().value<bool>("General/EnableAutoBackup", true));
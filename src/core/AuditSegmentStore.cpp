@@ -0,0 +1,660 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "AuditSegmentStore.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace QuantilyxDoc {
+
+namespace {
+
+// A sparse index point is written every this many entries or bytes
+constexpr quint64 IndexIntervalEntries = 256;
+constexpr qint64 IndexIntervalBytes = 64 * 1024;
+
+// Index points are only used to bound a scan; entries whose clock went
+// backwards by less than this are still found.
+constexpr qint64 ClockSkewToleranceMs = 5 * 60 * 1000;
+
+constexpr qint64 MinTime = std::numeric_limits<qint64>::min();
+constexpr qint64 MaxTime = std::numeric_limits<qint64>::max();
+
+struct IndexPoint {
+    qint64 offset = 0;        // Byte offset of the entry in the segment
+    quint64 id = 0;
+    qint64 timeMs = 0;        // Timestamp of the entry
+    qint64 runningMaxMs = 0;  // Max timestamp of all entries up to and including this one
+    quint64 ordinal = 0;      // Entry number within the segment
+};
+
+struct Segment {
+    QString logPath;
+    QString indexPath;
+    quint64 firstId = 0;
+    quint64 lastId = 0;
+    quint64 count = 0;
+    qint64 minTimeMs = MaxTime;
+    qint64 maxTimeMs = MinTime;
+    qint64 size = 0;
+    bool sealed = false;
+    bool indexed = true; // False for the legacy single-file log
+    QVector<IndexPoint> index;
+    QSet<QString> documents;
+
+    void account(const AuditEntry& entry, qint64 timeMs) {
+        if (count == 0) firstId = entry.id;
+        lastId = entry.id;
+        ++count;
+        minTimeMs = qMin(minTimeMs, timeMs);
+        maxTimeMs = qMax(maxTimeMs, timeMs);
+    }
+};
+
+QByteArray escapeField(const QString& value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    QByteArray out;
+    out.reserve(utf8.size());
+    for (char c : utf8) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '|':  out += "\\p"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default:   out += c; break;
+        }
+    }
+    return out;
+}
+
+QList<QString> splitFields(const QByteArray& line)
+{
+    QList<QString> fields;
+    QByteArray current;
+    for (int i = 0; i < line.size(); ++i) {
+        const char c = line.at(i);
+        if (c == '\\' && i + 1 < line.size()) {
+            const char next = line.at(++i);
+            switch (next) {
+                case 'p': current += '|'; break;
+                case 'n': current += '\n'; break;
+                case 'r': current += '\r'; break;
+                default:  current += next; break;
+            }
+        } else if (c == '|') {
+            fields.append(QString::fromUtf8(current));
+            current.clear();
+        } else if (c != '\n' && c != '\r') {
+            current += c;
+        }
+    }
+    fields.append(QString::fromUtf8(current));
+    return fields;
+}
+
+QString segmentBaseName(quint64 firstId)
+{
+    return QString("seg-%1").arg(firstId, 20, 10, QLatin1Char('0'));
+}
+
+// Cut a file back to its last complete line. A crash can leave the last
+// append half written; without this the next entry would be glued onto it.
+void truncateTornTail(const QString& path, qint64 completeEnd, qint64 size)
+{
+    if (completeEnd >= size) return;
+    if (QFile::resize(path, completeEnd)) {
+        LOG_WARN("Dropped " << size - completeEnd << " bytes of a torn record from " << path);
+    } else {
+        LOG_ERROR("Failed to truncate torn record in " << path);
+    }
+}
+
+bool syncFile(QFile* file)
+{
+    if (!file || !file->isOpen()) return true;
+    if (!file->flush()) return false;
+#ifdef Q_OS_UNIX
+    return ::fdatasync(file->handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+} // namespace
+
+class AuditSegmentStore::Private {
+public:
+    Private()
+        : activeLog(nullptr), activeIndex(nullptr),
+          maxSegmentBytes(16 * 1024 * 1024), maxSegmentAgeSecs(24 * 60 * 60),
+          opened(false) {}
+
+    ~Private() {
+        closeActive();
+    }
+
+    QString directory;
+    QList<Segment> segments; // Oldest first; the last one may be active
+    QFile* activeLog;
+    QFile* activeIndex;
+    qint64 maxSegmentBytes;
+    qint64 maxSegmentAgeSecs;
+    bool opened;
+
+    Segment* active() {
+        if (segments.isEmpty() || segments.last().sealed || !segments.last().indexed) return nullptr;
+        return &segments.last();
+    }
+
+    quint64 lastId() const {
+        for (int i = segments.size() - 1; i >= 0; --i) {
+            if (segments.at(i).count > 0) return segments.at(i).lastId;
+        }
+        return 0;
+    }
+
+    void closeActive() {
+        syncFile(activeLog);
+        syncFile(activeIndex);
+        delete activeLog;
+        delete activeIndex;
+        activeLog = nullptr;
+        activeIndex = nullptr;
+    }
+
+    // Scan [offset, EOF) of a segment, folding entries into its summary.
+    // Used for unsealed segments (active at shutdown or after a crash) whose
+    // index may trail the log, and for the legacy log.
+    void scanTail(Segment& seg, qint64 offset, quint64 ordinal) {
+        QFile file(seg.logPath);
+        if (!file.open(QIODevice::ReadOnly)) return;
+        file.seek(offset);
+
+        qint64 runningMax = seg.index.isEmpty() ? MinTime : seg.index.last().runningMaxMs;
+        qint64 lastPointOffset = seg.index.isEmpty() ? -IndexIntervalBytes : seg.index.last().offset;
+        quint64 lastPointOrdinal = seg.index.isEmpty() ? 0 : seg.index.last().ordinal;
+        // Segments are only ever appended to whole lines; the legacy log is read as is
+        const bool dropTorn = seg.indexed && !seg.sealed;
+        qint64 completeEnd = offset;
+
+        while (!file.atEnd()) {
+            const qint64 lineOffset = file.pos();
+            const QByteArray line = file.readLine();
+            if (dropTorn && !line.endsWith('\n')) break;
+            completeEnd = file.pos();
+            AuditEntry entry;
+            if (!AuditSegmentStore::parseEntry(line, entry)) continue;
+            const qint64 timeMs = entry.timestamp.toMSecsSinceEpoch();
+            seg.account(entry, timeMs);
+            runningMax = qMax(runningMax, timeMs);
+            if (!entry.documentPath.isEmpty()) seg.documents.insert(entry.documentPath);
+
+            if (seg.indexed && (seg.index.isEmpty()
+                                || ordinal - lastPointOrdinal >= IndexIntervalEntries
+                                || lineOffset - lastPointOffset >= IndexIntervalBytes)) {
+                IndexPoint point{lineOffset, entry.id, timeMs, runningMax, ordinal};
+                seg.index.append(point);
+                lastPointOffset = lineOffset;
+                lastPointOrdinal = ordinal;
+            }
+            ++ordinal;
+        }
+        seg.size = file.size();
+        if (dropTorn && completeEnd < seg.size) {
+            file.close();
+            truncateTornTail(seg.logPath, completeEnd, seg.size);
+            seg.size = completeEnd;
+        }
+    }
+
+    bool loadSegment(Segment& seg) {
+        QFile indexFile(seg.indexPath);
+        if (indexFile.open(QIODevice::ReadOnly)) {
+            qint64 completeEnd = 0;
+            while (!indexFile.atEnd()) {
+                const QByteArray line = indexFile.readLine();
+                if (!line.endsWith('\n')) break; // Torn by a crash
+                completeEnd = indexFile.pos();
+                const QList<QString> f = splitFields(line);
+                if (f.isEmpty()) continue;
+                if (f.at(0) == "I" && f.size() >= 6) {
+                    IndexPoint point;
+                    point.offset = f.at(1).toLongLong();
+                    point.id = f.at(2).toULongLong();
+                    point.timeMs = f.at(3).toLongLong();
+                    point.runningMaxMs = f.at(4).toLongLong();
+                    point.ordinal = f.at(5).toULongLong();
+                    seg.index.append(point);
+                } else if (f.at(0) == "D" && f.size() >= 2) {
+                    seg.documents.insert(f.at(1));
+                } else if (f.at(0) == "S" && f.size() >= 6) {
+                    seg.count = f.at(1).toULongLong();
+                    seg.firstId = f.at(2).toULongLong();
+                    seg.lastId = f.at(3).toULongLong();
+                    seg.minTimeMs = f.at(4).toLongLong();
+                    seg.maxTimeMs = f.at(5).toLongLong();
+                    seg.sealed = true;
+                }
+            }
+            const qint64 indexSize = indexFile.size();
+            indexFile.close();
+            if (!seg.sealed) truncateTornTail(seg.indexPath, completeEnd, indexSize);
+        }
+
+        if (seg.sealed) {
+            seg.size = QFileInfo(seg.logPath).size();
+            return true;
+        }
+
+        // Unsealed: rebuild the summary from the last index point onwards.
+        // Points past the end of the log refer to entries lost in a crash.
+        const qint64 logSize = QFileInfo(seg.logPath).size();
+        bool staleIndex = false;
+        while (!seg.index.isEmpty() && seg.index.last().offset >= logSize) {
+            seg.index.removeLast();
+            staleIndex = true;
+        }
+        if (staleIndex) rewriteIndex(seg);
+        qint64 offset = 0;
+        quint64 ordinal = 0;
+        if (!seg.index.isEmpty()) {
+            const IndexPoint& last = seg.index.last();
+            offset = last.offset;
+            ordinal = last.ordinal;
+            seg.count = last.ordinal;
+            seg.firstId = seg.index.first().id;
+            for (const IndexPoint& p : seg.index) {
+                seg.minTimeMs = qMin(seg.minTimeMs, p.timeMs);
+            }
+            seg.maxTimeMs = last.runningMaxMs;
+        }
+        scanTail(seg, offset, ordinal);
+        return true;
+    }
+
+    // Write an unsealed segment's index file from its in-memory points
+    void rewriteIndex(const Segment& seg) {
+        QFile file(seg.indexPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            LOG_ERROR("Failed to rewrite audit index " << seg.indexPath << ": " << file.errorString());
+            return;
+        }
+        QByteArray lines;
+        for (const IndexPoint& point : seg.index) {
+            lines += "I|" + QByteArray::number(point.offset) + "|" + QByteArray::number(point.id)
+                + "|" + QByteArray::number(point.timeMs) + "|" + QByteArray::number(point.runningMaxMs)
+                + "|" + QByteArray::number(point.ordinal) + "\n";
+        }
+        for (const QString& document : seg.documents) {
+            lines += "D|" + escapeField(document) + "\n";
+        }
+        file.write(lines);
+        syncFile(&file);
+    }
+
+    bool openSegmentFiles(Segment& seg) {
+        activeLog = new QFile(seg.logPath);
+        activeIndex = new QFile(seg.indexPath);
+        if (!activeLog->open(QIODevice::Append) || !activeIndex->open(QIODevice::Append)) {
+            LOG_ERROR("Failed to open audit segment " << seg.logPath << ": " << activeLog->errorString());
+            delete activeLog;
+            delete activeIndex;
+            activeLog = nullptr;
+            activeIndex = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool startSegment(quint64 firstId) {
+        Segment seg;
+        const QString base = QDir(directory).filePath(segmentBaseName(firstId));
+        seg.logPath = base + ".log";
+        seg.indexPath = base + ".idx";
+        segments.append(seg);
+        return openSegmentFiles(segments.last());
+    }
+
+    void sealActive() {
+        Segment* seg = active();
+        if (!seg) return;
+        if (activeIndex) {
+            QByteArray line = "S|" + QByteArray::number(seg->count) + "|"
+                + QByteArray::number(seg->firstId) + "|" + QByteArray::number(seg->lastId) + "|"
+                + QByteArray::number(seg->minTimeMs) + "|" + QByteArray::number(seg->maxTimeMs) + "\n";
+            activeIndex->write(line);
+        }
+        closeActive();
+        seg->sealed = true;
+        LOG_INFO("Sealed audit segment " << seg->logPath << " (" << seg->count << " entries)");
+    }
+
+    bool needsRoll(const Segment& seg, qint64 nowMs) const {
+        if (seg.count == 0) return false;
+        if (seg.size >= maxSegmentBytes) return true;
+        return maxSegmentAgeSecs > 0 && nowMs - seg.minTimeMs >= maxSegmentAgeSecs * 1000;
+    }
+
+    bool appendOne(const AuditEntry& entry) {
+        const qint64 timeMs = entry.timestamp.toMSecsSinceEpoch();
+
+        Segment* seg = active();
+        if (seg && needsRoll(*seg, timeMs)) {
+            sealActive();
+            seg = nullptr;
+        }
+        if (!seg) {
+            if (!startSegment(entry.id)) return false;
+            seg = &segments.last();
+        } else if (!activeLog && !openSegmentFiles(*seg)) {
+            return false;
+        }
+
+        const QByteArray line = AuditSegmentStore::formatEntry(entry);
+        const qint64 offset = seg->size;
+        QByteArray indexLines;
+
+        const qint64 runningMax = qMax(seg->maxTimeMs, timeMs);
+        const bool wantPoint = seg->index.isEmpty()
+            || seg->count - seg->index.last().ordinal >= IndexIntervalEntries
+            || offset - seg->index.last().offset >= IndexIntervalBytes;
+        if (wantPoint) {
+            IndexPoint point{offset, entry.id, timeMs, runningMax, seg->count};
+            seg->index.append(point);
+            indexLines += "I|" + QByteArray::number(point.offset) + "|" + QByteArray::number(point.id)
+                + "|" + QByteArray::number(point.timeMs) + "|" + QByteArray::number(point.runningMaxMs)
+                + "|" + QByteArray::number(point.ordinal) + "\n";
+        }
+        if (!entry.documentPath.isEmpty() && !seg->documents.contains(entry.documentPath)) {
+            seg->documents.insert(entry.documentPath);
+            indexLines += "D|" + escapeField(entry.documentPath) + "\n";
+        }
+
+        if (activeLog->write(line) != line.size()) return false;
+        if (!indexLines.isEmpty() && activeIndex->write(indexLines) != indexLines.size()) return false;
+
+        seg->size += line.size();
+        seg->account(entry, timeMs);
+        return true;
+    }
+
+    // Byte range of a segment that can hold entries in [startMs, endMs]
+    void scanRange(const Segment& seg, qint64 startMs, qint64 endMs, qint64& begin, qint64& end) const {
+        begin = 0;
+        end = seg.size;
+        if (!seg.indexed) return;
+        for (const IndexPoint& p : seg.index) {
+            if (p.runningMaxMs < startMs) {
+                begin = p.offset;
+            } else if (endMs != MaxTime && p.timeMs > endMs + ClockSkewToleranceMs) {
+                end = p.offset;
+                break;
+            }
+        }
+    }
+};
+
+AuditSegmentStore::AuditSegmentStore()
+    : d(new Private())
+{
+}
+
+AuditSegmentStore::~AuditSegmentStore() = default;
+
+bool AuditSegmentStore::open(const QString& directory, const QString& legacyLogPath)
+{
+    close();
+    d->segments.clear();
+    d->directory = directory;
+
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        LOG_ERROR("Failed to create audit segment directory: " << directory);
+        return false;
+    }
+
+    const QStringList logs = dir.entryList(QStringList() << "seg-*.log", QDir::Files, QDir::Name);
+    for (const QString& name : logs) {
+        Segment seg;
+        seg.logPath = dir.filePath(name);
+        seg.indexPath = seg.logPath.left(seg.logPath.size() - 4) + ".idx";
+        d->loadSegment(seg);
+        d->segments.append(seg);
+    }
+
+    // Pre-segment log: import once into segments, or keep it as an unindexed
+    // segment if segments already exist (e.g. an import was interrupted).
+    if (!legacyLogPath.isEmpty() && QFile::exists(legacyLogPath)) {
+        if (d->segments.isEmpty()) {
+            QFile legacy(legacyLogPath);
+            if (legacy.open(QIODevice::ReadOnly)) {
+                d->opened = true;
+                QList<AuditEntry> batch;
+                quint64 nextId = 1;
+                while (!legacy.atEnd()) {
+                    AuditEntry entry;
+                    if (!parseEntry(legacy.readLine(), entry)) continue;
+                    entry.id = nextId++; // Legacy ids restarted every session
+                    batch.append(entry);
+                    if (batch.size() >= 1024) {
+                        append(batch);
+                        batch.clear();
+                    }
+                }
+                append(batch);
+                sync();
+                legacy.close();
+                QFile::rename(legacyLogPath, legacyLogPath + ".migrated");
+                LOG_INFO("Migrated legacy audit log " << legacyLogPath << " into " << directory);
+            }
+        } else {
+            Segment seg;
+            seg.logPath = legacyLogPath;
+            seg.indexed = false;
+            seg.sealed = true;
+            d->scanTail(seg, 0, 0);
+            d->segments.prepend(seg);
+        }
+    }
+
+    d->opened = true;
+    LOG_INFO("Opened audit segment store " << directory << " with " << d->segments.size() << " segments");
+    return true;
+}
+
+void AuditSegmentStore::close()
+{
+    d->closeActive();
+    d->opened = false;
+}
+
+bool AuditSegmentStore::isOpen() const
+{
+    return d->opened;
+}
+
+QString AuditSegmentStore::directory() const
+{
+    return d->directory;
+}
+
+bool AuditSegmentStore::append(const QList<AuditEntry>& entries)
+{
+    if (!d->opened) return false;
+
+    bool ok = true;
+    for (const AuditEntry& entry : entries) {
+        if (!d->appendOne(entry)) {
+            LOG_ERROR("Failed to append audit entry " << entry.id);
+            ok = false;
+            break;
+        }
+    }
+    // One write to the OS per batch; durability is left to sync()
+    if (d->activeLog) ok = d->activeLog->flush() && ok;
+    if (d->activeIndex) ok = d->activeIndex->flush() && ok;
+    return ok;
+}
+
+bool AuditSegmentStore::sync()
+{
+    return syncFile(d->activeLog) && syncFile(d->activeIndex);
+}
+
+QList<AuditEntry> AuditSegmentStore::query(const AuditQuery& query) const
+{
+    QList<AuditEntry> results;
+    const qint64 startMs = query.startTime.isValid() ? query.startTime.toMSecsSinceEpoch() : MinTime;
+    const qint64 endMs = query.endTime.isValid() ? query.endTime.toMSecsSinceEpoch() : MaxTime;
+
+    for (int i = d->segments.size() - 1; i >= 0; --i) {
+        const Segment& seg = d->segments.at(i);
+        if (seg.count == 0) continue;
+        if (seg.maxTimeMs < startMs || seg.minTimeMs > endMs) continue;
+        if (!query.documentPath.isEmpty() && !seg.documents.contains(query.documentPath)) continue;
+
+        qint64 begin = 0, end = 0;
+        d->scanRange(seg, startMs, endMs, begin, end);
+
+        QFile file(seg.logPath);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(begin)) {
+            LOG_ERROR("Failed to read audit segment " << seg.logPath << ": " << file.errorString());
+            continue;
+        }
+
+        QList<AuditEntry> matches;
+        while (file.pos() < end && !file.atEnd()) {
+            AuditEntry entry;
+            if (!parseEntry(file.readLine(), entry)) continue;
+            const qint64 timeMs = entry.timestamp.toMSecsSinceEpoch();
+            if (timeMs < startMs || timeMs > endMs) continue;
+            if (!query.user.isEmpty() && entry.user != query.user) continue;
+            if (!query.documentPath.isEmpty() && entry.documentPath != query.documentPath) continue;
+            if (query.type != AuditEntry::EventType::Unknown && entry.type != query.type) continue;
+            matches.append(entry);
+        }
+
+        for (int j = matches.size() - 1; j >= 0; --j) {
+            results.append(matches.at(j));
+        }
+        if (query.limit > 0 && results.size() >= query.limit) break;
+    }
+
+    std::stable_sort(results.begin(), results.end(), [](const AuditEntry& a, const AuditEntry& b) {
+        return a.timestamp > b.timestamp;
+    });
+    if (query.limit > 0 && results.size() > query.limit) {
+        results.erase(results.begin() + query.limit, results.end());
+    }
+    return results;
+}
+
+quint64 AuditSegmentStore::entryCount() const
+{
+    quint64 count = 0;
+    for (const Segment& seg : d->segments) {
+        count += seg.count;
+    }
+    return count;
+}
+
+quint64 AuditSegmentStore::lastId() const
+{
+    return d->lastId();
+}
+
+int AuditSegmentStore::segmentCount() const
+{
+    int count = 0;
+    for (const Segment& seg : d->segments) {
+        if (seg.indexed) ++count;
+    }
+    return count;
+}
+
+void AuditSegmentStore::setMaxSegmentBytes(qint64 bytes)
+{
+    if (bytes > 0) d->maxSegmentBytes = bytes;
+}
+
+void AuditSegmentStore::setMaxSegmentAgeSecs(qint64 seconds)
+{
+    d->maxSegmentAgeSecs = seconds;
+}
+
+int AuditSegmentStore::removeSegmentsBefore(const QDateTime& cutoff)
+{
+    const qint64 cutoffMs = cutoff.toMSecsSinceEpoch();
+    int removed = 0;
+    for (int i = d->segments.size() - 1; i >= 0; --i) {
+        const Segment& seg = d->segments.at(i);
+        // The legacy log (unindexed) may hold entries newer than the cutoff
+        if (!seg.sealed || !seg.indexed || seg.count == 0 || seg.maxTimeMs >= cutoffMs) continue;
+        QFile::remove(seg.logPath);
+        if (!seg.indexPath.isEmpty()) QFile::remove(seg.indexPath);
+        d->segments.removeAt(i);
+        ++removed;
+    }
+    return removed;
+}
+
+QByteArray AuditSegmentStore::formatEntry(const AuditEntry& entry)
+{
+    // Format: ID|Timestamp|Type|User|Document|Action|Details|IP|Result|SessionID
+    QByteArray line;
+    line.reserve(128);
+    line += QByteArray::number(entry.id) + "|";
+    line += entry.timestamp.toString(Qt::ISODateWithMs).toUtf8() + "|";
+    line += QByteArray::number(static_cast<int>(entry.type)) + "|";
+    line += escapeField(entry.user) + "|";
+    line += escapeField(entry.documentPath) + "|";
+    line += escapeField(entry.action) + "|";
+    line += escapeField(entry.details) + "|";
+    line += escapeField(entry.ipAddress.toString()) + "|";
+    line += escapeField(entry.result) + "|";
+    line += escapeField(entry.sessionId) + "\n";
+    return line;
+}
+
+bool AuditSegmentStore::parseEntry(const QByteArray& line, AuditEntry& entry)
+{
+    if (line.isEmpty() || line.startsWith('#')) return false;
+
+    const QList<QString> parts = splitFields(line);
+    if (parts.size() < 10) return false;
+
+    bool ok = false;
+    entry.id = parts[0].toULongLong(&ok);
+    if (!ok) return false;
+    entry.timestamp = QDateTime::fromString(parts[1], Qt::ISODateWithMs);
+    if (!entry.timestamp.isValid()) return false;
+    entry.type = static_cast<AuditEntry::EventType>(parts[2].toInt(&ok));
+    if (!ok) return false;
+    entry.user = parts[3];
+    entry.documentPath = parts[4];
+    entry.action = parts[5];
+    entry.details = parts[6];
+    entry.ipAddress = QHostAddress(parts[7]);
+    entry.result = parts[8];
+    entry.sessionId = parts[9];
+    return true;
+}
+
+} // namespace QuantilyxDoc
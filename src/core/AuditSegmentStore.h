@@ -0,0 +1,145 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_AUDITSEGMENTSTORE_H
+#define QUANTILYX_AUDITSEGMENTSTORE_H
+
+#include "AuditTrail.h"
+#include <QString>
+#include <QList>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Filter for audit queries.
+ */
+struct AuditQuery {
+    QDateTime startTime;            // Earliest time to include (invalid = unbounded)
+    QDateTime endTime;              // Latest time to include (invalid = unbounded)
+    QString user;                   // Empty for all
+    QString documentPath;           // Empty for all
+    AuditEntry::EventType type = AuditEntry::EventType::Unknown; // Unknown for all
+    int limit = 0;                  // Newest N matches (0 for all)
+};
+
+/**
+ * @brief Segmented, indexed on-disk storage for audit entries.
+ *
+ * Entries are appended to size- or time-bounded segment files inside a
+ * directory. Each segment has a companion ".idx" file holding a sparse time
+ * index (one point every few hundred entries), the set of document paths the
+ * segment mentions and, once the segment is sealed, its summary. The indexes
+ * are loaded at open, so time-range and per-document queries only read the
+ * byte ranges of segments that can match.
+ *
+ * Writes go to the OS on append(); sync() makes them durable with a single
+ * fdatasync, so callers can group several appends into one commit.
+ *
+ * Not thread-safe; AuditTrail serializes access.
+ */
+class AuditSegmentStore
+{
+public:
+    AuditSegmentStore();
+    ~AuditSegmentStore();
+
+    /**
+     * @brief Open (or create) a store directory and load segment indexes.
+     * @param directory Segment directory.
+     * @param legacyLogPath Pre-segment single-file log to include in queries (may be empty).
+     * @return True on success.
+     */
+    bool open(const QString& directory, const QString& legacyLogPath = QString());
+
+    /**
+     * @brief Close the active segment (without sealing it).
+     */
+    void close();
+
+    /**
+     * @brief Check if the store is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the segment directory.
+     */
+    QString directory() const;
+
+    /**
+     * @brief Append entries in order; written to the OS but not yet fsynced.
+     * @param entries Entries with id and timestamp already assigned.
+     * @return True if every entry was written.
+     */
+    bool append(const QList<AuditEntry>& entries);
+
+    /**
+     * @brief Make all appended entries durable (one fdatasync per file).
+     * @return True on success.
+     */
+    bool sync();
+
+    /**
+     * @brief Query entries, touching only segments that can match.
+     * @param query Filter.
+     * @return Matching entries, newest first.
+     */
+    QList<AuditEntry> query(const AuditQuery& query) const;
+
+    /**
+     * @brief Total number of entries across all segments.
+     */
+    quint64 entryCount() const;
+
+    /**
+     * @brief Highest entry id stored (0 if empty).
+     */
+    quint64 lastId() const;
+
+    /**
+     * @brief Number of segment files (excluding the legacy log).
+     */
+    int segmentCount() const;
+
+    /**
+     * @brief Set the size at which the active segment is sealed.
+     */
+    void setMaxSegmentBytes(qint64 bytes);
+
+    /**
+     * @brief Set the age (seconds since its first entry) at which the active segment is sealed.
+     */
+    void setMaxSegmentAgeSecs(qint64 seconds);
+
+    /**
+     * @brief Remove sealed segments whose newest entry is older than the cutoff.
+     * The legacy log is never removed here; it is only retired by migration.
+     * @return Number of segments removed.
+     */
+    int removeSegmentsBefore(const QDateTime& cutoff);
+
+    /**
+     * @brief Serialize an entry as one log line (pipe-delimited, escaped).
+     */
+    static QByteArray formatEntry(const AuditEntry& entry);
+
+    /**
+     * @brief Parse a log line; returns false for comments and malformed lines.
+     */
+    static bool parseEntry(const QByteArray& line, AuditEntry& entry);
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_AUDITSEGMENTSTORE_H
@@ -8,6 +8,7 @@
  * (at your option) any later version.
  */
 #include "AuditTrail.h"
+#include "AuditSegmentStore.h"
 #include "Document.h"
 #include "Logger.h"
 #include "utils/FileUtils.h" // Assuming this exists for file operations
@@ -19,122 +20,244 @@
 #include <QTextStream>
 #include <QCryptographicHash>
 #include <QCoreApplication>
-#include <QThread> // For current thread ID in logs
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QWaitCondition>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
 
 namespace QuantilyxDoc {
 
-class AuditTrail::Private {
+/**
+ * @brief Background appender for audit entries.
+ *
+ * Callers enqueue entries (ids assigned in enqueue order); this thread writes
+ * everything queued in one batch and issues fdatasync once the oldest
+ * unsynced entry reaches the group-commit delay (or the compliance ack
+ * latency, if lower) or enough entries are pending. Waiters are woken when
+ * their entry is durable.
+ */
+class AuditAppender : public QThread
+{
 public:
-    Private(AuditTrail* q_ptr)
-        : q(q_ptr), file(nullptr), maxFileSizeBytes(10 * 1024 * 1024), // 10 MB default
-          enabled(true), nextId(1) {}
-
-    AuditTrail* q;
-    mutable QMutex mutex; // Protect access to log file and entries list
-    QFile* file;
-    QString logFilePath;
-    qint64 maxFileSizeBytes;
-    bool enabled;
-    quint64 nextId;
-    QList<AuditEntry> recentEntries; // Keep a short-term in-memory list if needed, or just use file
+    AuditAppender(AuditSegmentStore* store, QMutex* storeMutex, AuditTrail* trail)
+        : store(store), storeMutex(storeMutex), trail(trail),
+          shouldQuit(false), flushRequested(false), unsynced(0),
+          enqueuedId(0), writtenId(0), durableId(0), failedId(0),
+          syncEveryEntries(32), syncIntervalMs(200), maxAckLatencyMs(0) {}
+
+    // Queue state (guarded by queueMutex)
+    QMutex queueMutex;
+    QWaitCondition workAvailable;
+    QWaitCondition progress;
+    QList<AuditEntry> queue;
+
+    AuditSegmentStore* store;
+    QMutex* storeMutex;
+    AuditTrail* trail;
+    bool shouldQuit;
+    bool flushRequested;
+    int unsynced;
+    quint64 enqueuedId;
+    quint64 writtenId;
+    quint64 durableId;
+    quint64 failedId;     // Highest id whose write or sync failed
+    int syncEveryEntries;
+    int syncIntervalMs;
+    int maxAckLatencyMs; // > 0: compliance mode, callers wait for durability
+    QElapsedTimer oldestUnsynced;
+
+    int syncDeadlineMs() const {
+        return maxAckLatencyMs > 0 ? qMin(syncIntervalMs, maxAckLatencyMs) : syncIntervalMs;
+    }
 
-    // Helper to open the log file
-    bool openLogFile() {
-        if (!enabled) return false;
+    void enqueue(const AuditEntry& entry) {
+        queue.append(entry);
+        enqueuedId = entry.id;
+        workAvailable.wakeOne();
+    }
 
-        if (file && file->isOpen()) {
-            return true; // Already open
+    // Block until the entry is durable (or its write/sync failed)
+    bool waitDurable(quint64 id) {
+        QMutexLocker locker(&queueMutex);
+        while (durableId < id && failedId < id && isRunning()) {
+            progress.wait(&queueMutex);
         }
+        return durableId >= id;
+    }
 
-        if (logFilePath.isEmpty()) {
-            // Generate default path
-            QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-            QDir dir(configDir);
-            if (!dir.exists()) dir.mkpath(".");
-            logFilePath = dir.filePath("audit_trail.log");
+    // Block until everything enqueued so far has reached the store
+    void waitWritten() {
+        QMutexLocker locker(&queueMutex);
+        const quint64 target = enqueuedId;
+        workAvailable.wakeOne();
+        while (writtenId < target && !shouldQuit) {
+            progress.wait(&queueMutex);
         }
+    }
 
-        file = new QFile(logFilePath);
-        bool opened = file->open(QIODevice::Append | QIODevice::Text);
-        if (!opened) {
-            LOG_ERROR("Failed to open audit log file: " << file->errorString());
-            delete file;
-            file = nullptr;
-            return false;
+    void stop() {
+        {
+            QMutexLocker locker(&queueMutex);
+            shouldQuit = true;
+            workAvailable.wakeAll();
         }
+        wait();
+    }
 
-        // Optionally, write a header or separator if file was just created/reopened
-        if (file->size() == 0) {
-            QTextStream stream(file);
-            stream << "# QuantilyxDoc Audit Trail\n";
-            stream << "# Format: ID|Timestamp|Type|User|Document|Action|Details|IP|Result|SessionID\n";
-            stream.flush();
+protected:
+    void run() override {
+        QMutexLocker locker(&queueMutex);
+        for (;;) {
+            if (queue.isEmpty() && !shouldQuit && !flushRequested) {
+                if (unsynced == 0) {
+                    workAvailable.wait(&queueMutex);
+                } else {
+                    const qint64 remaining = syncDeadlineMs() - oldestUnsynced.elapsed();
+                    if (remaining > 0) {
+                        workAvailable.wait(&queueMutex, static_cast<unsigned long>(remaining));
+                    }
+                }
+            }
+
+            QList<AuditEntry> batch;
+            batch.swap(queue);
+            if (unsynced == 0 && !batch.isEmpty()) oldestUnsynced.start();
+            const bool quitting = shouldQuit;
+            const bool forceSync = flushRequested || quitting;
+            const int pending = unsynced + batch.size();
+            const int deadlineMs = syncDeadlineMs();
+            const bool due = pending > 0 && (pending >= syncEveryEntries || forceSync
+                || deadlineMs == 0 || oldestUnsynced.elapsed() >= deadlineMs);
+            flushRequested = false;
+            locker.unlock();
+
+            bool writeOk = true;
+            bool synced = false;
+            bool syncOk = true;
+            bool rotated = false;
+            {
+                QMutexLocker storeLocker(storeMutex);
+                if (!batch.isEmpty()) {
+                    const int segmentsBefore = store->segmentCount();
+                    writeOk = store->append(batch);
+                    rotated = segmentsBefore > 0 && store->segmentCount() > segmentsBefore;
+                    if (!writeOk) {
+                        LOG_ERROR("Failed to append " << batch.size() << " audit entries.");
+                    }
+                }
+                if (due) {
+                    syncOk = store->sync();
+                    synced = true;
+                    if (!syncOk) {
+                        LOG_ERROR("Failed to sync audit log segment.");
+                    }
+                }
+            }
+            if (rotated) {
+                emit trail->logRotated();
+            }
+
+            locker.relock();
+            if (!batch.isEmpty()) {
+                unsynced += batch.size();
+                writtenId = batch.last().id;
+            }
+            if (synced) {
+                unsynced = 0;
+                if (writeOk && syncOk) {
+                    durableId = writtenId;
+                } else {
+                    failedId = writtenId;
+                }
+            } else if (!writeOk) {
+                failedId = writtenId;
+            }
+            progress.wakeAll();
+
+            if (quitting && queue.isEmpty()) break;
         }
-
-        LOG_INFO("Opened audit log file: " << logFilePath);
-        return true;
     }
+};
 
-    // Helper to write an entry to the file
-    bool writeEntryToFile(const AuditEntry& entry) {
-        if (!file || !file->isOpen()) {
-            if (!openLogFile()) return false;
-        }
+class AuditTrail::Private {
+public:
+    Private(AuditTrail* q_ptr)
+        : q(q_ptr), maxFileSizeBytes(10 * 1024 * 1024), // 10 MB default
+          enabled(true), nextId(1), started(false), retentionDays(0) {}
 
-        // Check file size and rotate if necessary
-        if (file->size() >= maxFileSizeBytes) {
-            rotateLog();
-            if (!openLogFile()) return false; // Re-open new file
-        }
+    ~Private() {
+        stopAppender();
+    }
 
-        QTextStream stream(file);
-        // Format: ID|Timestamp|Type|User|Document|Action|Details|IP|Result|SessionID
-        // Use a delimiter unlikely to appear in data, or escape/quote fields properly.
-        // For simplicity here, we'll use a pipe, assuming user/document names don't contain it often.
-        stream << entry.id << "|"
-               << entry.timestamp.toString(Qt::ISODateWithMs) << "|"
-               << static_cast<int>(entry.type) << "|"
-               << entry.user << "|"
-               << entry.documentPath << "|"
-               << entry.action << "|"
-               << entry.details << "|"
-               << entry.ipAddress.toString() << "|"
-               << entry.result << "|"
-               << entry.sessionId << "\n";
-        stream.flush(); // Ensure data is written
+    AuditTrail* q;
+    mutable QMutex mutex; // Protect access to the segment store
+    mutable AuditSegmentStore store;
+    std::unique_ptr<AuditAppender> appender;
+    QString logFilePath;  // Legacy single-file log; segments live next to it
+    qint64 maxFileSizeBytes;
+    bool enabled;
+    quint64 nextId;       // Guarded by appender->queueMutex once started
+    std::atomic<bool> started;
+    int retentionDays;
 
-        // Optionally, keep a small in-memory cache
-        // recentEntries.append(entry);
-        // if (recentEntries.size() > 100) recentEntries.removeFirst(); // Keep last 100
+    QString segmentDirectory() const {
+        QFileInfo info(logFilePath);
+        return info.absolutePath() + "/" + info.completeBaseName() + ".segments";
+    }
+
+    // Helper to open the segment store (caller holds mutex)
+    bool openStore() const {
+        if (store.isOpen()) return true;
+        if (!store.open(segmentDirectory(), logFilePath)) {
+            LOG_ERROR("Failed to open audit segment store: " << segmentDirectory());
+            return false;
+        }
+        store.setMaxSegmentBytes(maxFileSizeBytes);
+        return true;
+    }
 
+    // Open the store and start the appender on first use
+    bool ensureStarted() {
+        if (started.load(std::memory_order_acquire)) return true;
+        QMutexLocker locker(&mutex);
+        if (started.load(std::memory_order_relaxed)) return true;
+        if (!openStore()) return false;
+        nextId = store.lastId() + 1;
+        appender->shouldQuit = false;
+        appender->start(QThread::LowPriority);
+        started.store(true, std::memory_order_release);
         return true;
     }
 
-    // Helper to rotate the log file
-    void rotateLog() {
-        if (!file || !file->isOpen()) return;
+    // Drain and stop the appender; everything queued is written and synced
+    void stopAppender() {
+        if (started.exchange(false)) {
+            appender->stop();
+        }
+    }
 
-        file->close();
-        QString oldPath = logFilePath;
-        QString newPath = logFilePath + "." + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".old";
-        QFile::rename(oldPath, newPath); // Rename current to timestamped old file
-        LOG_INFO("Rotated audit log: " << oldPath << " -> " << newPath);
-        emit q->logRotated();
+    // Everything enqueued so far is visible to queries
+    void drain() const {
+        if (started.load(std::memory_order_acquire)) {
+            appender->waitWritten();
+        }
     }
 
     // Helper to convert EventType enum to string for logging/reading
-    QString eventTypeToString(EventType type) {
+    QString eventTypeToString(AuditEntry::EventType type) {
         switch (type) {
-            case EventType::DocumentOpen: return "DOC_OPEN";
-            case EventType::DocumentSave: return "DOC_SAVE";
-            case EventType::DocumentClose: return "DOC_CLOSE";
-            case EventType::DocumentEdit: return "DOC_EDIT";
-            case EventType::DocumentPrint: return "DOC_PRINT";
-            case EventType::DocumentExport: return "DOC_EXPORT";
-            case EventType::UserLogin: return "USER_LOGIN";
-            case EventType::UserLogout: return "USER_LOGOUT";
-            case EventType::SecurityEvent: return "SECURITY";
-            case EventType::SystemEvent: return "SYSTEM";
+            case AuditEntry::EventType::DocumentOpen: return "DOC_OPEN";
+            case AuditEntry::EventType::DocumentSave: return "DOC_SAVE";
+            case AuditEntry::EventType::DocumentClose: return "DOC_CLOSE";
+            case AuditEntry::EventType::DocumentEdit: return "DOC_EDIT";
+            case AuditEntry::EventType::DocumentPrint: return "DOC_PRINT";
+            case AuditEntry::EventType::DocumentExport: return "DOC_EXPORT";
+            case AuditEntry::EventType::UserLogin: return "USER_LOGIN";
+            case AuditEntry::EventType::UserLogout: return "USER_LOGOUT";
+            case AuditEntry::EventType::SecurityEvent: return "SECURITY";
+            case AuditEntry::EventType::SystemEvent: return "SYSTEM";
             default: return "UNKNOWN";
         }
     }
@@ -162,32 +285,89 @@ AuditTrail::AuditTrail(QObject* parent)
     if (!dir.exists()) {
         dir.mkpath(".");
     }
+
+    d->appender.reset(new AuditAppender(&d->store, &d->mutex, this));
+
+    // The singleton is never destroyed; drain the queue before the app exits
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            d->stopAppender();
+        });
+    }
 }
 
 AuditTrail::~AuditTrail()
 {
-    if (d->file && d->file->isOpen()) {
-        d->file->close();
-    }
-    delete d->file;
+    d->stopAppender();
+    QMutexLocker locker(&d->mutex);
+    d->store.close();
 }
 
 bool AuditTrail::logEvent(const AuditEntry& entry)
 {
     if (!d->enabled) return true; // Silently succeed if disabled
+    if (!d->ensureStarted()) {
+        LOG_ERROR("Failed to log audit event: " << entry.action);
+        return false;
+    }
 
-    QMutexLocker locker(&d->mutex);
     AuditEntry mutableEntry = entry; // Copy to set ID
-    mutableEntry.id = d->nextId++;
-    mutableEntry.timestamp = QDateTime::currentDateTime();
-
-    bool success = d->writeEntryToFile(mutableEntry);
-    if (success) {
-        emit eventLogged(mutableEntry);
-    } else {
-        LOG_ERROR("Failed to log audit event: " << mutableEntry.action);
+    bool compliance = false;
+    {
+        // Id and timestamp are assigned under the queue lock so ids, timestamps
+        // and on-disk order all agree.
+        QMutexLocker locker(&d->appender->queueMutex);
+        mutableEntry.id = d->nextId++;
+        mutableEntry.timestamp = QDateTime::currentDateTime();
+        d->appender->enqueue(mutableEntry);
+        compliance = d->appender->maxAckLatencyMs > 0;
+    }
+
+    emit eventLogged(mutableEntry);
+
+    if (compliance && !d->appender->waitDurable(mutableEntry.id)) {
+        LOG_ERROR("Audit event was not made durable: " << mutableEntry.action);
+        return false;
     }
-    return success;
+    return true;
+}
+
+bool AuditTrail::flush()
+{
+    if (!d->started.load(std::memory_order_acquire)) return true;
+    quint64 lastId = 0;
+    {
+        QMutexLocker locker(&d->appender->queueMutex);
+        lastId = d->appender->enqueuedId;
+        d->appender->flushRequested = true;
+        d->appender->workAvailable.wakeOne();
+    }
+    return lastId == 0 || d->appender->waitDurable(lastId);
+}
+
+void AuditTrail::setGroupCommit(int maxEntries, int maxDelayMs)
+{
+    QMutexLocker locker(&d->appender->queueMutex);
+    d->appender->syncEveryEntries = qMax(1, maxEntries);
+    d->appender->syncIntervalMs = qMax(0, maxDelayMs);
+    d->appender->workAvailable.wakeOne();
+    LOG_INFO("Audit group commit set to " << d->appender->syncEveryEntries << " entries / "
+             << d->appender->syncIntervalMs << " ms");
+}
+
+void AuditTrail::setMaxAckLatencyMs(int latencyMs)
+{
+    QMutexLocker locker(&d->appender->queueMutex);
+    d->appender->maxAckLatencyMs = qMax(0, latencyMs);
+    d->appender->workAvailable.wakeOne();
+    LOG_INFO("Audit compliance mode " << (latencyMs > 0 ? "enabled" : "disabled")
+             << ", max ack latency " << latencyMs << " ms");
+}
+
+int AuditTrail::maxAckLatencyMs() const
+{
+    QMutexLocker locker(&d->appender->queueMutex);
+    return d->appender->maxAckLatencyMs;
 }
 
 bool AuditTrail::logEvent(AuditEntry::EventType type, const QString& user, Document* document,
@@ -215,79 +395,26 @@ QList<AuditEntry> AuditTrail::getEntries(const QDateTime& startTime, const QDate
                                          const QString& userFilter, const QString& docPathFilter,
                                          AuditEntry::EventType typeFilter, int limit) const
 {
+    d->drain();
     QMutexLocker locker(&d->mutex);
-    QList<AuditEntry> results;
-
-    // This is a simplified implementation that reads the log file.
-    // For performance with large logs, an index or database would be better.
-    QFile readFile(d->logFilePath);
-    if (!readFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        LOG_ERROR("Failed to open audit log for reading: " << readFile.errorString());
-        return results;
-    }
-
-    QTextStream stream(&readFile);
-    QString line;
-    while (readFile.canReadLine()) {
-        line = readFile.readLine();
-        if (line.startsWith('#')) continue; // Skip header/comment lines
-
-        QStringList parts = line.split('|');
-        if (parts.size() < 10) continue; // Malformed line
-
-        bool ok;
-        AuditEntry entry;
-        entry.id = parts[0].toULongLong(&ok);
-        if (!ok) continue;
-        entry.timestamp = QDateTime::fromString(parts[1], Qt::ISODateWithMs);
-        if (!entry.timestamp.isValid()) continue;
-        entry.type = static_cast<AuditEntry::EventType>(parts[2].toInt(&ok));
-        if (!ok) continue;
-        entry.user = parts[3];
-        entry.documentPath = parts[4];
-        entry.action = parts[5];
-        entry.details = parts[6];
-        entry.ipAddress = QHostAddress(parts[7]);
-        entry.result = parts[8];
-        entry.sessionId = parts[9];
-
-        // Apply filters
-        if (startTime.isValid() && entry.timestamp < startTime) continue;
-        if (endTime.isValid() && entry.timestamp > endTime) continue;
-        if (!userFilter.isEmpty() && entry.user != userFilter) continue;
-        if (!docPathFilter.isEmpty() && entry.documentPath != docPathFilter) continue;
-        if (typeFilter != AuditEntry::EventType::Unknown && entry.type != typeFilter) continue;
-
-        results.append(entry);
-
-        if (limit > 0 && results.size() >= limit) break;
-    }
-
-    // Sort by timestamp descending by default, or as requested
-    std::sort(results.begin(), results.end(), [](const AuditEntry& a, const AuditEntry& b) {
-        return a.timestamp > b.timestamp;
-    });
-
-    return results;
+    if (!d->openStore()) return QList<AuditEntry>();
+
+    AuditQuery query;
+    query.startTime = startTime;
+    query.endTime = endTime;
+    query.user = userFilter;
+    query.documentPath = docPathFilter;
+    query.type = typeFilter;
+    query.limit = limit;
+    return d->store.query(query);
 }
 
 quint64 AuditTrail::entryCount() const
 {
-    // This requires counting lines in the file or maintaining a counter.
-    // Counting lines is slow for large files.
-    // A better approach is to maintain a counter in memory and persist it.
-    // For now, we'll count lines.
+    d->drain();
     QMutexLocker locker(&d->mutex);
-    QFile countFile(d->logFilePath);
-    if (!countFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return 0;
-    }
-    quint64 count = 0;
-    while (countFile.readLine().size() > 0) {
-        if (!countFile.atEnd()) count++; // Read one past the last line
-    }
-    if (!countFile.readLine().isEmpty()) count++; // Count the last line if it doesn't end with \n
-    return count;
+    if (!d->openStore()) return 0;
+    return d->store.entryCount();
 }
 
 QString AuditTrail::logFilePath() const
@@ -298,17 +425,22 @@ QString AuditTrail::logFilePath() const
 
 void AuditTrail::setLogFilePath(const QString& path)
 {
+    d->stopAppender();
     QMutexLocker locker(&d->mutex);
     if (d->logFilePath != path) {
-        if (d->file && d->file->isOpen()) {
-            d->file->close();
-        }
+        d->store.close();
         d->logFilePath = path;
-        // Directory check is done on write
+        // Store is reopened at the new location on next use
         LOG_INFO("Audit log file path changed to: " << path);
     }
 }
 
+QString AuditTrail::segmentDirectory() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->segmentDirectory();
+}
+
 qint64 AuditTrail::maxLogFileSizeBytes() const
 {
     QMutexLocker locker(&d->mutex);
@@ -321,10 +453,23 @@ void AuditTrail::setMaxLogFileSizeBytes(qint64 size)
     QMutexLocker locker(&d->mutex);
     if (d->maxFileSizeBytes != size) {
         d->maxFileSizeBytes = size;
-        LOG_INFO("Audit log max file size changed to " << size << " bytes.");
+        d->store.setMaxSegmentBytes(size);
+        LOG_INFO("Audit log max segment size changed to " << size << " bytes.");
     }
 }
 
+void AuditTrail::setMaxSegmentAgeSecs(qint64 seconds)
+{
+    QMutexLocker locker(&d->mutex);
+    d->store.setMaxSegmentAgeSecs(seconds);
+}
+
+void AuditTrail::setRetentionDays(int days)
+{
+    QMutexLocker locker(&d->mutex);
+    d->retentionDays = qMax(0, days);
+}
+
 bool AuditTrail::isEnabled() const
 {
     QMutexLocker locker(&d->mutex);
@@ -342,22 +487,23 @@ void AuditTrail::setEnabled(bool enabled)
 
 void AuditTrail::purgeOldEntries()
 {
-    // This is a stub. Purging based on time/size usually means log rotation.
-    // The current rotation happens implicitly when the file gets too big.
-    // Purging old *rotated* files would require managing multiple log files.
-    LOG_WARN("purgeOldEntries: Currently implemented as log rotation on size. Purging old rotated files not implemented.");
-    // To implement purging old files:
-    // QDir logDir(QFileInfo(d->logFilePath).absolutePath());
-    // QStringList oldLogs = logDir.entryList({"audit_trail.log.*.old"}, QDir::Files, QDir::Time);
-    // Remove old files based on age/number/total size.
+    QMutexLocker locker(&d->mutex);
+    if (d->retentionDays <= 0 || !d->openStore()) return;
+
+    // Whole sealed segments are dropped; the active segment is never touched
+    const QDateTime cutoff = QDateTime::currentDateTime().addDays(-d->retentionDays);
+    const int removed = d->store.removeSegmentsBefore(cutoff);
+    if (removed > 0) {
+        LOG_INFO("Purged " << removed << " audit segments older than " << cutoff.toString(Qt::ISODate));
+    }
 }
 
 bool AuditTrail::exportEntries(const QString& filePath, const QDateTime& startTime,
+                               const QDateTime& endTime,
                                const QString& userFilter, const QString& docPathFilter,
                                AuditEntry::EventType typeFilter)
 {
-    QMutexLocker locker(&d->mutex);
-    QList<AuditEntry> entries = getEntries(startTime, QDateTime(), userFilter, docPathFilter, typeFilter, 0);
+    QList<AuditEntry> entries = getEntries(startTime, endTime, userFilter, docPathFilter, typeFilter, 0);
 
     QFile exportFile(filePath);
     if (!exportFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -391,8 +537,8 @@ bool AuditTrail::verifyIntegrity() const
     // 2. Storing the hash securely (e.g., signed file, separate file).
     // 3. Re-calculating and comparing hashes on verification.
     LOG_WARN("verifyIntegrity: Basic implementation only. Full tamper-proofing requires cryptographic checksums per entry/block.");
-    QFile verifyFile(d->logFilePath);
-    return verifyFile.exists() && verifyFile.size() > 0;
+    QMutexLocker locker(&d->mutex);
+    return d->openStore() && d->store.entryCount() > 0;
 }
 
 bool AuditTrail::signLog() const
@@ -85,6 +85,9 @@ public:
 
     /**
      * @brief Log an event to the audit trail.
+     *
+     * The entry is queued for the background appender; in compliance mode
+     * the call waits until it is durable.
      * @param entry The audit entry to log.
      * @return True if logging was successful.
      */
@@ -105,15 +108,54 @@ public:
                   const QString& action, const QString& details = QString(),
                   const QString& result = QString(), const QVariantMap& extraData = QVariantMap());
 
+    /**
+     * @brief Write everything queued so far and make it durable (fsync).
+     *
+     * Blocks until the background appender has synced all entries logged
+     * before the call.
+     * @return True on success.
+     */
+    bool flush();
+
+    /**
+     * @brief Set group-commit parameters.
+     *
+     * logEvent() only enqueues; a background appender writes queued entries in
+     * order, coalescing them into one write, and issues the fsync once per
+     * group, when maxEntries entries are unsynced or the oldest has waited
+     * maxDelayMs.
+     * @param maxEntries Entries per fsync (1 = fsync every batch).
+     * @param maxDelayMs Maximum time an entry waits for its fsync.
+     */
+    void setGroupCommit(int maxEntries, int maxDelayMs);
+
+    /**
+     * @brief Enable compliance mode with a maximum acknowledgment latency.
+     *
+     * With a latency > 0, logEvent() returns only once the entry is durable
+     * and the appender syncs no later than latencyMs after the oldest unsynced
+     * entry was queued. 0 disables compliance mode (fire-and-forget).
+     * @param latencyMs Maximum acknowledgment latency in milliseconds.
+     */
+    void setMaxAckLatencyMs(int latencyMs);
+
+    /**
+     * @brief Get the compliance-mode acknowledgment latency (0 if disabled).
+     */
+    int maxAckLatencyMs() const;
+
     /**
      * @brief Get audit entries based on filters.
+     *
+     * Only segments whose time range (and, with a document filter, whose
+     * document set) can match are read, starting at the nearest index point.
      * @param startTime Earliest time to include.
      * @param endTime Latest time to include.
      * @param userFilter Filter by user name (empty for all).
      * @param docPathFilter Filter by document path (empty for all).
      * @param typeFilter Filter by event type (Unknown for all).
-     * @param limit Maximum number of entries to return (0 for all).
-     * @return List of matching audit entries.
+     * @param limit Maximum number of entries to return, newest first (0 for all).
+     * @return List of matching audit entries, newest first.
      */
     QList<AuditEntry> getEntries(const QDateTime& startTime = QDateTime(),
                                  const QDateTime& endTime = QDateTime(),
@@ -141,17 +183,35 @@ public:
     void setLogFilePath(const QString& path);
 
     /**
-     * @brief Get the maximum size of the audit log file in bytes.
+     * @brief Get the directory holding the audit log segments.
+     * @return Segment directory path.
+     */
+    QString segmentDirectory() const;
+
+    /**
+     * @brief Get the maximum size of an audit log segment in bytes.
      * @return Maximum size in bytes.
      */
     qint64 maxLogFileSizeBytes() const;
 
     /**
-     * @brief Set the maximum size of the audit log file in bytes.
+     * @brief Set the maximum size of an audit log segment in bytes.
      * @param size Maximum size in bytes.
      */
     void setMaxLogFileSizeBytes(qint64 size);
 
+    /**
+     * @brief Set the maximum time span of an audit log segment.
+     * @param seconds Segment age after which a new segment is started (0 = size only).
+     */
+    void setMaxSegmentAgeSecs(qint64 seconds);
+
+    /**
+     * @brief Set how long purgeOldEntries() keeps segments.
+     * @param days Retention in days (0 = keep everything).
+     */
+    void setRetentionDays(int days);
+
     /**
      * @brief Check if audit logging is enabled.
      * @return True if enabled.
@@ -165,7 +225,7 @@ public:
     void setEnabled(bool enabled);
 
     /**
-     * @brief Purge old log entries based on time or size limits.
+     * @brief Remove sealed segments older than the retention period.
      */
     void purgeOldEntries();
 
@@ -206,7 +266,7 @@ signals:
     void eventLogged(const QuantilyxDoc::AuditEntry& entry);
 
     /**
-     * @brief Emitted when the log file is rotated due to size limits.
+     * @brief Emitted when a segment is sealed and a new one started.
      */
     void logRotated();
 
@@ -219,6 +279,7 @@ signals:
 private:
     class Private;
     std::unique_ptr<Private> d;
+    static AuditTrail* s_instance;
 };
 
 } // namespace QuantilyxDoc
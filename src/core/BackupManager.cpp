@@ -8,6 +8,7 @@
  * (at your option) any later version.
  */
 #include "BackupManager.h"
+#include "ChunkStore.h"
 #include "Document.h"
 #include "Logger.h"
 #include <QTimer>
@@ -20,9 +21,66 @@
 #include <QMutexLocker>
 #include <QCoreApplication>
 #include <QThread>
+#include <QWaitCondition>
+#include <QSet>
+#include "ThreadPool.h"
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
 
 namespace QuantilyxDoc {
 
+namespace {
+
+// Clone a file with a copy-on-write reflink (btrfs, XFS); false if the
+// filesystem cannot do it, in which case nothing is left behind.
+bool reflinkFile(const QString& sourcePath, const QString& targetPath)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    QFile source(sourcePath);
+    QFile target(targetPath);
+    if (!source.open(QIODevice::ReadOnly) || !target.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    if (::ioctl(target.handle(), FICLONE, source.handle()) == 0) {
+        return true;
+    }
+    target.close();
+    target.remove();
+    return false;
+#else
+    Q_UNUSED(sourcePath);
+    Q_UNUSED(targetPath);
+    return false;
+#endif
+}
+
+// Identifies the on-disk state of an unmodified document
+struct FileFingerprint {
+    qint64 size = -1;
+    QDateTime lastModified;
+
+    bool operator==(const FileFingerprint& other) const {
+        return size == other.size && lastModified == other.lastModified;
+    }
+};
+
+FileFingerprint fingerprintOf(const QString& path)
+{
+    QFileInfo info(path);
+    FileFingerprint fingerprint;
+    if (info.exists()) {
+        fingerprint.size = info.size();
+        fingerprint.lastModified = info.lastModified();
+    }
+    return fingerprint;
+}
+
+} // namespace
+
 class BackupManager::Private {
 public:
     Private()
@@ -53,21 +111,136 @@ public:
         }
     }
 
-    // Helper to clean up old backups for a specific document path
-    void cleanupOldBackupsForPath(const QString& originalPath) {
-        QMutexLocker locker(&mutex);
-        if (!backupDir.exists()) return;
+    ChunkStore chunkStore; // Deduplicated chunk storage under backupDir
+    QMutex storeMutex;     // Serializes chunkStore and manifest access; always taken after mutex
+
+    // Background backup jobs (guarded by mutex)
+    QSet<Document*> inFlight;                          // At most one pending job per document
+    QHash<Document*, FileFingerprint> lastBackedUp;    // Original file state at its last backup
+    QHash<Document*, quint64> lastBackedUpRevision;    // Edit revision at the last backup of unsaved changes
+    QSet<Document*> warnedNoCopy;                      // Told once that unsaved edits cannot be backed up
+    int pendingJobs = 0;
+    QWaitCondition jobsDone;
+
+    // Everything a backup job needs, captured on the GUI thread
+    struct BackupJob {
+        Document* doc = nullptr;
+        QString originalPath;
+        QString snapshotPath;       // File to chunk
+        std::function<QString()> writeSnapshot; // Writes snapshotPath first, if set
+        bool temporarySnapshot = false;
+        QString title;
+        QDateTime created;
+        QString manifestDir;
+        QDir manifestRoot;
+        int maxBackups = 0;
+    };
+
+    // Stable per-document key used for the manifest directory
+    QString documentKey(const QString& originalPath) const {
+        return QCryptographicHash::hash(originalPath.toUtf8(), QCryptographicHash::Md5).toHex().left(16);
+    }
+
+    QDir manifestRoot() const {
+        return QDir(backupDir.filePath("manifests"));
+    }
+
+    QString manifestDirFor(const QString& originalPath) const {
+        return manifestRoot().filePath(documentKey(originalPath));
+    }
+
+    // Manifests for a document, oldest first
+    QStringList manifestsFor(const QString& originalPath) const {
+        return manifestsIn(manifestDirFor(originalPath));
+    }
 
+    // Pre-deduplication whole-file backups for a document
+    QStringList legacyBackupsFor(const QString& originalPath) const {
         QString escapedOriginalBasename = QFileInfo(originalPath).completeBaseName();
         // Escape characters that might be interpreted by regex in file filters
         escapedOriginalBasename.replace(".", "\\.");
         // Construct a pattern matching our naming scheme: basename_backup_timestamp_hash.ext
         QString pattern = QString("%1_backup_*.*").arg(escapedOriginalBasename);
-
         QStringList backupFiles = backupDir.entryList({pattern}, QDir::Files | QDir::NoDotAndDotDot, QDir::Time);
         // Sort by time descending, so oldest are at the end
         std::reverse(backupFiles.begin(), backupFiles.end());
+        return backupFiles;
+    }
+
+    // Manifests in a directory, oldest first (names are timestamps)
+    static QStringList manifestsIn(const QString& manifestDir) {
+        QDir dir(manifestDir);
+        QStringList result;
+        const QStringList names = dir.entryList(QStringList() << "*.manifest", QDir::Files, QDir::Name);
+        for (const QString& name : names) {
+            result.append(dir.filePath(name));
+        }
+        return result;
+    }
+
+    // Drop manifests beyond the limit, then chunks no manifest uses; caller holds storeMutex
+    void trimManifests(const QString& manifestDir, const QDir& root, int maxBackups) {
+        // Versions beyond the limit lose their manifest; chunks still shared
+        // with newer versions survive garbage collection.
+        const QStringList manifests = manifestsIn(manifestDir);
+        const int manifestsToRemove = manifests.size() - maxBackups;
+        for (int i = 0; i < manifestsToRemove; ++i) {
+            if (QFile::remove(manifests[i])) {
+                LOG_DEBUG("Removed old backup: " << manifests[i]);
+            } else {
+                LOG_WARN("Failed to remove old backup: " << manifests[i]);
+            }
+        }
+        if (manifestsToRemove > 0) {
+            chunkStore.collectGarbage(root);
+        }
+    }
+
+    // Chunk a snapshot into the store; runs on a pool thread. Returns false on
+    // error; manifestPath stays empty if the content matched the previous version.
+    bool runBackupJob(const BackupJob& job, QString& manifestPath, QString& error) {
+        QMutexLocker storeLocker(&storeMutex);
+        const QStringList previous = manifestsIn(job.manifestDir);
+
+        ChunkManifest manifest;
+        manifest.sourcePath = job.originalPath;
+        manifest.title = job.title;
+        manifest.created = job.created;
+        const QString path = QDir(job.manifestDir).filePath(job.created.toString("yyyyMMdd_hhmmsszzz") + ".manifest");
+
+        ChunkStoreStats stats;
+        if (!chunkStore.storeFile(job.snapshotPath, path, manifest, &stats)) {
+            error = chunkStore.lastError();
+            return false;
+        }
+
+        // Nothing changed since the last backup: the chunks were all shared,
+        // so dropping the new manifest leaves the store exactly as it was.
+        ChunkManifest last;
+        if (!previous.isEmpty() && ChunkStore::readManifest(previous.last(), last) && last.sha256 == manifest.sha256) {
+            QFile::remove(path);
+            LOG_DEBUG("Backup of " << job.originalPath << " unchanged since " << previous.last() << ", skipped");
+            return true;
+        }
+
+        LOG_INFO("Backup of " << job.originalPath << ": " << stats.chunkCount << " chunks, "
+                 << stats.newChunks << " new, " << stats.newBytes << " of " << stats.totalBytes
+                 << " bytes new, " << stats.storedBytes << " bytes on disk");
+        manifestPath = path;
+        trimManifests(job.manifestDir, job.manifestRoot, job.maxBackups);
+        return true;
+    }
+
+    // Helper to clean up old backups for a specific document path; caller holds mutex
+    void cleanupOldBackupsForPath(const QString& originalPath) {
+        if (!backupDir.exists()) return;
 
+        {
+            QMutexLocker storeLocker(&storeMutex);
+            trimManifests(manifestDirFor(originalPath), manifestRoot(), maxBackupsPerDoc);
+        }
+
+        QStringList backupFiles = legacyBackupsFor(originalPath);
         int filesToRemove = backupFiles.size() - maxBackupsPerDoc;
         if (filesToRemove <= 0) return; // Within limit
 
@@ -100,6 +273,7 @@ BackupManager::BackupManager(QObject* parent)
 {
     d->backupDir.setPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/backups");
     QDir().mkpath(d->backupDir.absolutePath()); // Ensure directory exists
+    d->chunkStore.setRoot(d->backupDir);
 
     d->autoSaveTimer = new QTimer(this);
     d->autoSaveTimer->setSingleShot(false);
@@ -111,13 +285,16 @@ BackupManager::~BackupManager()
     if (d->autoSaveTimer->isActive()) {
         d->autoSaveTimer->stop();
     }
+    // Jobs reference d; let them finish before it goes away
+    waitForPendingBackups();
     // Clear watched documents list
     d->watchedDocs.clear();
 }
 
 void BackupManager::watchDocument(Document* doc)
 {
-    if (!doc || !doc->filePath().isEmpty()) return;
+    // Only documents with a file on disk can be backed up
+    if (!doc || doc->filePath().isEmpty()) return;
 
     QMutexLocker locker(&d->mutex);
     if (!d->watchedDocs.contains(doc)) {
@@ -140,6 +317,9 @@ void BackupManager::unwatchDocument(Document* doc)
 
     QMutexLocker locker(&d->mutex);
     if (d->watchedDocs.remove(doc)) {
+        d->lastBackedUp.remove(doc);
+        d->lastBackedUpRevision.remove(doc);
+        d->warnedNoCopy.remove(doc);
         LOG_DEBUG("Stopped watching document for backup: " << doc->filePath());
 
         // Stop timer if no documents are watched anymore
@@ -160,31 +340,121 @@ bool BackupManager::saveNow(Document* doc)
         return false;
     }
 
-    // Determine temporary backup path
-    QString backupFileName = d->generateBackupFilename(originalPath, QDateTime::currentDateTime());
-    QString backupPath = d->backupDir.filePath(backupFileName);
+    if (d->inFlight.contains(doc)) {
+        LOG_DEBUG("Backup already pending for: " << originalPath);
+        return true;
+    }
 
-    // Attempt to save document to backup location
-    // This assumes the Document class has a save method that can save to a different path
-    // In a real scenario, you might want to copy the original file directly or implement
-    // a 'saveAs' functionality in the Document class.
-    // For now, let's assume doc->save(backupPath) exists.
-    // If not, you'd need to implement a method to serialize the document's internal state
-    // or copy the original file if it hasn't been modified since last save.
-    // This is a simplification.
-    bool success = doc->save(backupPath);
+    // An unmodified document that has not changed on disk since its last
+    // backup has nothing new to store.
+    const bool modified = doc->isModified();
+    const FileFingerprint fingerprint = fingerprintOf(originalPath);
+    const quint64 revision = doc->revision();
+    if (!modified && d->lastBackedUp.value(doc) == fingerprint) {
+        LOG_DEBUG("Document unchanged since last backup, skipping: " << originalPath);
+        return true;
+    }
+    // Likewise a modified document with no edits since its last backup
+    if (modified && d->lastBackedUpRevision.contains(doc) && d->lastBackedUpRevision.value(doc) == revision) {
+        LOG_DEBUG("No edits since last backup, skipping: " << originalPath);
+        return true;
+    }
 
-    if (success) {
-        LOG_INFO("Backup created: " << backupPath);
-        emit backupCreated(doc, backupPath);
-        // Cleanup old backups for this document path
-        d->cleanupOldBackupsForPath(originalPath);
+    Private::BackupJob job;
+    job.doc = doc;
+    job.originalPath = originalPath;
+    job.title = doc->title();
+    job.created = QDateTime::currentDateTime();
+    job.manifestDir = d->manifestDirFor(originalPath);
+    job.manifestRoot = d->manifestRoot();
+    job.maxBackups = d->maxBackupsPerDoc;
+
+    // Only capture the snapshot here; writing it, chunking, hashing,
+    // compression and pruning run on a pool thread. The original of an
+    // unmodified document is cloned with a reflink where the filesystem
+    // supports it, otherwise read in place. Edits only exist in memory, so a
+    // modified document is written to a scratch file with prepareCopy(),
+    // which leaves its path and modified flag alone.
+    QDir tmpDir(d->backupDir.filePath("tmp"));
+    tmpDir.mkpath(".");
+    const QString scratchPath = tmpDir.filePath(d->generateBackupFilename(originalPath, job.created));
+    if (!modified) {
+        job.temporarySnapshot = reflinkFile(originalPath, scratchPath);
+        job.snapshotPath = job.temporarySnapshot ? scratchPath : originalPath;
     } else {
-        LOG_ERROR("Failed to create backup for: " << originalPath << ", Error: " << doc->lastError());
-        emit backupFailed(doc, doc->lastError());
+        job.writeSnapshot = doc->prepareCopy(scratchPath);
+        if (!job.writeSnapshot) {
+            // Not a failure: the format has no side-effect-free writer, and
+            // saving would change the document's path and modified state.
+            // Skipped until saved, with one warning per document.
+            if (!d->warnedNoCopy.contains(doc)) {
+                d->warnedNoCopy.insert(doc);
+                LOG_WARN("Unsaved changes of this format cannot be backed up, skipping until saved: "
+                         << originalPath);
+            }
+            return true;
+        }
+        job.snapshotPath = scratchPath;
+        job.temporarySnapshot = true;
     }
 
-    return success;
+    d->inFlight.insert(doc);
+    d->pendingJobs++;
+    ThreadPool::instance().submitTask([this, job, modified, fingerprint, revision]() {
+        QString manifestPath;
+        QString error = job.writeSnapshot ? job.writeSnapshot() : QString();
+        const bool success = error.isEmpty() && d->runBackupJob(job, manifestPath, error);
+        if (job.temporarySnapshot) {
+            QFile::remove(job.snapshotPath);
+        }
+
+        {
+            QMutexLocker locker(&d->mutex);
+            d->inFlight.remove(job.doc);
+            if (success && d->watchedDocs.contains(job.doc)) {
+                if (modified) {
+                    d->lastBackedUpRevision.insert(job.doc, revision);
+                } else {
+                    d->lastBackedUp.insert(job.doc, fingerprint);
+                }
+            }
+            d->pendingJobs--;
+            d->jobsDone.wakeAll();
+        }
+
+        // Queued to receivers on the GUI thread
+        if (!success) {
+            LOG_ERROR("Failed to create backup for: " << job.originalPath << ", Error: " << error);
+            emit backupFailed(job.doc, error);
+        } else if (!manifestPath.isEmpty()) {
+            LOG_INFO("Backup created: " << manifestPath);
+            emit backupCreated(job.doc, manifestPath);
+        }
+    }, QString("Backup %1").arg(QFileInfo(originalPath).fileName()), Task::Priority::Low);
+
+    return true;
+}
+
+void BackupManager::waitForPendingBackups()
+{
+    QMutexLocker locker(&d->mutex);
+    while (d->pendingJobs > 0) {
+        d->jobsDone.wait(&d->mutex);
+    }
+}
+
+int BackupManager::compressionLevel() const
+{
+    QMutexLocker locker(&d->mutex);
+    QMutexLocker storeLocker(&d->storeMutex);
+    return d->chunkStore.compressionLevel();
+}
+
+void BackupManager::setCompressionLevel(int level)
+{
+    QMutexLocker locker(&d->mutex);
+    QMutexLocker storeLocker(&d->storeMutex);
+    d->chunkStore.setCompressionLevel(level);
 }
 
 QDir BackupManager::backupDirectory() const
@@ -195,10 +465,13 @@ QDir BackupManager::backupDirectory() const
 
 void BackupManager::setBackupDirectory(const QDir& dir)
 {
+    waitForPendingBackups(); // Queued jobs write to the current directory
     QMutexLocker locker(&d->mutex);
     if (dir != d->backupDir) {
         d->backupDir = dir;
         QDir().mkpath(d->backupDir.absolutePath()); // Ensure new directory exists
+        QMutexLocker storeLocker(&d->storeMutex);
+        d->chunkStore.setRoot(d->backupDir);
         LOG_INFO("Backup directory changed to: " << d->backupDir.absolutePath());
     }
 }
@@ -234,6 +507,7 @@ void BackupManager::setMaxBackupsPerDocument(int count)
     if (count > 0 && d->maxBackupsPerDoc != count) {
         d->maxBackupsPerDoc = count;
         LOG_INFO("Max backups per document changed to " << count << ". Cleaning up now.");
+        locker.unlock();
         cleanupOldBackups(); // Clean up immediately based on new limit
     }
 }
@@ -269,13 +543,22 @@ QList<BackupInfo> BackupManager::getBackupsForDocument(Document* doc) const
     QString originalPath = d->watchedDocs.value(doc);
     if (originalPath.isEmpty()) return backups; // Not watched
 
-    QString escapedOriginalBasename = QFileInfo(originalPath).completeBaseName();
-    escapedOriginalBasename.replace(".", "\\.");
-    QString pattern = QString("%1_backup_*.*").arg(escapedOriginalBasename);
+    // Deduplicated versions, newest first
+    const QStringList manifests = d->manifestsFor(originalPath);
+    for (int i = manifests.size() - 1; i >= 0; --i) {
+        ChunkManifest manifest;
+        if (!ChunkStore::readManifest(manifests[i], manifest)) continue;
+        BackupInfo info;
+        info.filePath = manifests[i];
+        info.timestamp = manifest.created;
+        info.originalSize = manifest.size;
+        info.documentTitle = manifest.title.isEmpty() ? doc->title() : manifest.title;
+        backups.append(info);
+    }
 
-    QStringList backupFiles = d->backupDir.entryList({pattern}, QDir::Files | QDir::NoDotAndDotDot, QDir::Time);
-    // Sort by time descending
-    std::reverse(backupFiles.begin(), backupFiles.end());
+    // Legacy whole-file backups
+    QStringList backupFiles = d->legacyBackupsFor(originalPath);
+    std::reverse(backupFiles.begin(), backupFiles.end()); // Newest first
 
     for (const QString& fileName : backupFiles) {
         QString fullPath = d->backupDir.filePath(fileName);
@@ -287,6 +570,10 @@ QList<BackupInfo> BackupManager::getBackupsForDocument(Document* doc) const
         info.documentTitle = doc->title();
         backups.append(info);
     }
+
+    std::stable_sort(backups.begin(), backups.end(), [](const BackupInfo& a, const BackupInfo& b) {
+        return a.timestamp > b.timestamp;
+    });
     return backups;
 }
 
@@ -299,19 +586,33 @@ bool BackupManager::restoreFromBackup(const QString& backupFilePath, const QStri
         return false;
     }
 
-    // Attempt to copy the backup file to the target path
     QFile targetFile(targetDocumentPath);
     if (targetFile.exists()) {
         // Optionally prompt user or backup the target file first
         LOG_WARN("Target file exists, overwriting: " << targetDocumentPath);
     }
 
-    bool success = backupFile.copy(targetDocumentPath);
+    bool success = false;
+    QString error;
+    if (backupFilePath.endsWith(".manifest")) {
+        // Reassemble from chunks; the target is replaced only if the checksum matches
+        QMutexLocker storeLocker(&d->storeMutex);
+        success = d->chunkStore.restoreFile(backupFilePath, targetDocumentPath);
+        error = d->chunkStore.lastError();
+    } else {
+        // Legacy whole-file backup: copy it over the target
+        if (targetFile.exists()) {
+            targetFile.remove();
+        }
+        success = backupFile.copy(targetDocumentPath);
+        error = backupFile.errorString();
+    }
+
     if (success) {
         LOG_INFO("Document restored from backup: " << backupFilePath << " -> " << targetDocumentPath);
         emit documentRestored(targetDocumentPath, backupFilePath);
     } else {
-        LOG_ERROR("Failed to restore backup: " << backupFilePath << " -> " << targetDocumentPath << ", Error: " << backupFile.errorString());
+        LOG_ERROR("Failed to restore backup: " << backupFilePath << " -> " << targetDocumentPath << ", Error: " << error);
     }
     return success;
 }
@@ -334,11 +635,16 @@ void BackupManager::purgeBackupsForDocument(Document* doc)
     QString originalPath = d->watchedDocs.value(doc);
     if (originalPath.isEmpty()) return; // Not watched
 
-    QString escapedOriginalBasename = QFileInfo(originalPath).completeBaseName();
-    escapedOriginalBasename.replace(".", "\\.");
-    QString pattern = QString("%1_backup_*.*").arg(escapedOriginalBasename);
+    QStringList backupFiles = d->legacyBackupsFor(originalPath);
 
-    QStringList backupFiles = d->backupDir.entryList({pattern}, QDir::Files | QDir::NoDotAndDotDot);
+    // Deduplicated versions: drop the manifests, then unreferenced chunks
+    {
+        QMutexLocker storeLocker(&d->storeMutex);
+        QDir(d->manifestDirFor(originalPath)).removeRecursively();
+        d->chunkStore.collectGarbage(d->manifestRoot());
+    }
+    d->lastBackedUp.remove(doc);
+    d->lastBackedUpRevision.remove(doc);
 
     int purgedCount = 0;
     for (const QString& fileName : backupFiles) {
@@ -358,6 +664,14 @@ void BackupManager::purgeAllBackups()
     QMutexLocker locker(&d->mutex);
     QStringList backupFiles = d->backupDir.entryList(QDir::Files | QDir::NoDotAndDotDot);
 
+    {
+        QMutexLocker storeLocker(&d->storeMutex);
+        d->manifestRoot().removeRecursively();
+        QDir(d->backupDir.filePath("chunks")).removeRecursively();
+    }
+    d->lastBackedUp.clear();
+    d->lastBackedUpRevision.clear();
+
     int purgedCount = 0;
     for (const QString& fileName : backupFiles) {
         QString fullPath = d->backupDir.filePath(fileName);
@@ -373,55 +687,24 @@ void BackupManager::purgeAllBackups()
 
 void BackupManager::onAutoSaveTimer()
 {
-    // Run auto-save for all watched documents
-    QMutexLocker locker(&d->mutex);
-    if (!d->enabled) return;
-
-    for (auto it = d->watchedDocs.constBegin(); it != d->watchedDocs.constEnd(); ++it) {
-        Document* doc = it.key();
-        // Only save if the document is modified (or always, depending on strategy)
-        if (doc && doc->isModified()) {
-             // We cannot call saveNow here directly as it locks again. We unlock first.
-             // A better design might involve queuing these saves on the main thread.
-             // For simplicity in this example, we'll call it, assuming re-entrancy is handled carefully elsewhere.
-             // In practice, consider using QMetaObject::invokeMethod to post the save request.
-             QCoreApplication::postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::User + 1))); // Custom event
-             // Or, for direct call (less safe if saveNow also locks):
-             // locker.unlock(); // Temporarily unlock
-             // saveNow(doc);
-             // locker.relock(); // Re-lock
+    // Collect modified documents, then back them up without holding the lock
+    // (saveNow takes it again). Each call only snapshots and queues the work.
+    QList<Document*> modifiedDocs;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (!d->enabled) return;
+
+        for (auto it = d->watchedDocs.constBegin(); it != d->watchedDocs.constEnd(); ++it) {
+            Document* doc = it.key();
+            if (doc && doc->isModified() && !d->inFlight.contains(doc)) {
+                modifiedDocs.append(doc);
+            }
         }
     }
+
+    for (Document* doc : modifiedDocs) {
+        saveNow(doc);
+    }
 }
 
-// To handle the posted event safely:
-// bool BackupManager::event(QEvent *e) {
-//     if (e->type() == QEvent::User + 1) {
-//         // Re-implement the auto-save loop here with proper locking.
-//         // This avoids recursive locking.
-//         return true;
-//     }
-//     return QObject::event(e);
-// }
-
-// For now, simplify the timer slot to avoid recursive lock issues in this example snippet:
-// Instead of calling saveNow directly, just emit a signal to trigger it on the main thread
-// where the document modification check can happen safely.
-// This requires adding a signal like void requestAutoSave(Document*) and connecting it.
-// For brevity, we'll adjust the timer slot to emit such a signal for each modified doc.
-// void BackupManager::onAutoSaveTimer() {
-//     QMutexLocker locker(&d->mutex);
-//     if (!d->enabled) return;
-//
-//     for (auto it = d->watchedDocs.constBegin(); it != d->watchedDocs.constEnd(); ++it) {
-//         Document* doc = it.key();
-//         if (doc && doc->isModified()) {
-//              emit requestAutoSave(doc);
-//         }
-//     }
-// }
-
-// Assuming the signal requestAutoSave is added to the header and connected appropriately,
-// the actual saveNow call happens on the main thread safely.
-
-} // namespace QuantilyxDoc
\ No newline at end of file
+} // namespace QuantilyxDoc
@@ -22,7 +22,7 @@ namespace QuantilyxDoc {
 class Document;
 
 struct BackupInfo {
-    QString filePath;       // Path to the backup file
+    QString filePath;       // Path to the backup manifest (or legacy whole-file copy)
     QDateTime timestamp;    // When the backup was created
     qint64 originalSize;    // Size of the original document at backup time
     QString documentTitle;  // Title of the document for reference
@@ -33,6 +33,20 @@ struct BackupInfo {
  *
  * Handles periodic auto-saves and maintains backup copies in a designated
  * directory. Can restore documents from backups if the original is lost/corrupted.
+ *
+ * Backups are deduplicated: each version is chunked into a ChunkStore under
+ * "<backupDir>/chunks" and described by a manifest in
+ * "<backupDir>/manifests/<document key>/". Whole-file backups from older
+ * versions are still listed and restorable.
+ *
+ * Backups run in the background: saveNow() only takes a snapshot (a reflink
+ * clone of an unmodified original on btrfs/XFS, or the edits of a modified
+ * document captured with Document::prepareCopy()) and queues writing,
+ * chunking and compression on the ThreadPool at low priority. Documents
+ * without edits since their last backup are skipped, and a version whose
+ * content matches the previous one is not kept. Unsaved edits of formats
+ * that cannot prepareCopy() are skipped with a single warning; their saved
+ * original is still backed up once they are saved.
  */
 class BackupManager : public QObject
 {
@@ -70,11 +84,34 @@ public:
 
     /**
      * @brief Perform an immediate auto-save for a specific document.
+     *
+     * Takes the snapshot synchronously and writes the backup in the
+     * background; backupCreated() or backupFailed() reports the outcome.
      * @param doc The document to save.
-     * @return True if save was successful.
+     * @return True if the backup was queued or nothing changed since the last one.
      */
     bool saveNow(Document* doc);
 
+    /**
+     * @brief Block until all queued backups have been written.
+     */
+    void waitForPendingBackups();
+
+    /**
+     * @brief Get the zlib level used for backup chunks.
+     * @return Level 0-9 (0 = uncompressed).
+     */
+    int compressionLevel() const;
+
+    /**
+     * @brief Set the zlib level used for backup chunks.
+     *
+     * Low levels keep background CPU use small; chunks that do not compress
+     * are stored raw regardless.
+     * @param level Level 0-9 (0 = uncompressed).
+     */
+    void setCompressionLevel(int level);
+
     /**
      * @brief Get the backup directory path.
      * @return Path to the backup directory.
@@ -132,7 +169,10 @@ public:
 
     /**
      * @brief Restore a document from a specific backup file.
-     * @param backupFilePath Path to the backup file.
+     *
+     * Manifests are reassembled from their chunks and verified against the
+     * recorded whole-file checksum; legacy backups are copied.
+     * @param backupFilePath Path to the backup manifest or legacy backup file.
      * @param targetDocumentPath Path where the restored document should be saved.
      * @return True if restoration was successful.
      */
@@ -187,6 +227,7 @@ private slots:
 private:
     class Private;
     std::unique_ptr<Private> d;
+    static BackupManager* s_instance;
 };
 
 } // namespace QuantilyxDoc
@@ -0,0 +1,455 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "BinaryLog.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QJsonArray>
+#include <chrono>
+#include <iostream>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+// Events are buffered and written in blocks of this size
+constexpr int WriteBufferSize = 64 * 1024;
+
+struct FormatDef {
+    quint32 id = 0;
+    quint8 level = 0;
+    quint32 line = 0;
+    QByteArray file;
+    QByteArray function;
+    QByteArray format;
+};
+
+template<typename T>
+void appendPod(QByteArray& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendShortString(QByteArray& out, const QByteArray& str) {
+    quint16 len = static_cast<quint16>(qMin(str.size(), 0xFFFF));
+    appendPod(out, len);
+    out.append(str.constData(), len);
+}
+
+QString levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:    return "TRACE";
+        case LogLevel::Debug:    return "DEBUG";
+        case LogLevel::Info:     return "INFO ";
+        case LogLevel::Warning:  return "WARN ";
+        case LogLevel::Error:    return "ERROR";
+        case LogLevel::Critical: return "CRIT ";
+        default:                 return "?????";
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+class BinaryLog::Private {
+public:
+    Private() : file(nullptr), nextFormatId(1) {}
+
+    ~Private() {
+        delete file;
+    }
+
+    QMutex mutex;
+    QFile* file;
+    QString filePath;
+    QByteArray buffer;
+    QList<FormatDef> formats;
+    quint32 nextFormatId;
+
+    void appendFormatRecord(const FormatDef& def) {
+        appendPod(buffer, static_cast<quint8>(RecordFormat));
+        appendPod(buffer, def.id);
+        appendPod(buffer, def.level);
+        appendPod(buffer, def.line);
+        appendShortString(buffer, def.file);
+        appendShortString(buffer, def.function);
+        appendShortString(buffer, def.format);
+    }
+
+    void flushBuffer() {
+        if (file && file->isOpen() && !buffer.isEmpty()) {
+            file->write(buffer);
+            file->flush();
+        }
+        buffer.clear();
+    }
+};
+
+BinaryLog::BinaryLog()
+    : d(new Private())
+    , m_open(false)
+    , m_threshold(static_cast<int>(LogLevel::Trace))
+{
+}
+
+BinaryLog::~BinaryLog()
+{
+    close();
+}
+
+BinaryLog& BinaryLog::instance()
+{
+    static BinaryLog instance;
+    return instance;
+}
+
+bool BinaryLog::open(const QString& filePath)
+{
+    QMutexLocker locker(&d->mutex);
+
+    m_open.store(false, std::memory_order_relaxed);
+    d->flushBuffer();
+    delete d->file;
+
+    d->filePath = filePath;
+    d->file = new QFile(filePath);
+    if (!d->file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::cerr << "Failed to open binary log file: " << filePath.toStdString() << std::endl;
+        delete d->file;
+        d->file = nullptr;
+        return false;
+    }
+
+    // Header: magic, version, then the wall-clock/monotonic pair used to
+    // convert event timestamps back into dates when decoding.
+    d->buffer.reserve(WriteBufferSize);
+    appendPod(d->buffer, Magic);
+    appendPod(d->buffer, Version);
+    appendPod(d->buffer, static_cast<qint64>(QDateTime::currentMSecsSinceEpoch()));
+    appendPod(d->buffer, timestampNs());
+
+    for (const FormatDef& def : d->formats) {
+        d->appendFormatRecord(def);
+    }
+    d->flushBuffer();
+
+    m_open.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void BinaryLog::close()
+{
+    QMutexLocker locker(&d->mutex);
+    m_open.store(false, std::memory_order_relaxed);
+    d->flushBuffer();
+    if (d->file) {
+        d->file->close();
+        delete d->file;
+        d->file = nullptr;
+    }
+}
+
+QString BinaryLog::filePath() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->filePath;
+}
+
+quint32 BinaryLog::registerFormat(LogLevel level, const char* file, int line,
+                                  const char* function, const char* format)
+{
+    QMutexLocker locker(&d->mutex);
+
+    FormatDef def;
+    def.id = d->nextFormatId++;
+    def.level = static_cast<quint8>(level);
+    def.line = static_cast<quint32>(line);
+    def.file = QFileInfo(QString::fromUtf8(file)).fileName().toUtf8();
+    def.function = QByteArray(function ? function : "");
+    def.format = QByteArray(format ? format : "");
+    d->formats.append(def);
+
+    if (d->file) {
+        d->appendFormatRecord(def);
+    }
+    return def.id;
+}
+
+void BinaryLog::write(quint32 formatId, const BinaryLogArgs& args)
+{
+    const quint64 timestamp = timestampNs();
+    const quint64 threadId = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    const quint16 payloadSize = static_cast<quint16>(args.size());
+
+    QMutexLocker locker(&d->mutex);
+    if (!d->file) {
+        return;
+    }
+
+    appendPod(d->buffer, static_cast<quint8>(RecordEvent));
+    appendPod(d->buffer, formatId);
+    appendPod(d->buffer, timestamp);
+    appendPod(d->buffer, threadId);
+    appendPod(d->buffer, payloadSize);
+    d->buffer.append(args.data(), payloadSize);
+
+    if (d->buffer.size() >= WriteBufferSize) {
+        d->flushBuffer();
+    }
+}
+
+void BinaryLog::flush()
+{
+    QMutexLocker locker(&d->mutex);
+    d->flushBuffer();
+}
+
+quint64 BinaryLog::timestampNs()
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ---------------------------------------------------------------------------
+// Decoding
+// ---------------------------------------------------------------------------
+
+QString BinaryLogEvent::message() const
+{
+    QString result;
+    result.reserve(format.size() + args.size() * 8);
+
+    int argIndex = 0;
+    int pos = 0;
+    while (pos < format.size()) {
+        int placeholder = format.indexOf(QLatin1String("{}"), pos);
+        if (placeholder < 0) {
+            result += format.midRef(pos);
+            break;
+        }
+        result += format.midRef(pos, placeholder - pos);
+        result += (argIndex < args.size()) ? args.at(argIndex++).toString() : QStringLiteral("{}");
+        pos = placeholder + 2;
+    }
+
+    // Extra arguments without a placeholder are appended so nothing is lost
+    for (; argIndex < args.size(); ++argIndex) {
+        result += QLatin1Char(' ') + args.at(argIndex).toString();
+    }
+    return result;
+}
+
+QString BinaryLogEvent::toText() const
+{
+    QString formatted = QDateTime::fromMSecsSinceEpoch(wallTimeMs).toString("[yyyy-MM-dd HH:mm:ss.zzz] ");
+    formatted += QString("[%1] ").arg(levelName(level));
+    formatted += QString("[Thread 0x%1] ").arg(threadId, 0, 16);
+    if (!function.isEmpty()) {
+        formatted += QString("[%1] ").arg(function);
+    }
+    if (!file.isEmpty() && line > 0) {
+        formatted += QString("[%1:%2] ").arg(file).arg(line);
+    }
+    formatted += message();
+    return formatted;
+}
+
+QJsonObject BinaryLogEvent::toJson() const
+{
+    QJsonObject obj;
+    obj["time"] = QDateTime::fromMSecsSinceEpoch(wallTimeMs).toString(Qt::ISODateWithMs);
+    obj["timestampNs"] = QString::number(timestampNs);
+    obj["level"] = levelName(level).trimmed();
+    obj["thread"] = QString::number(threadId, 16);
+    obj["file"] = file;
+    obj["line"] = line;
+    obj["function"] = function;
+    obj["format"] = format;
+    obj["args"] = QJsonArray::fromVariantList(args);
+    obj["message"] = message();
+    return obj;
+}
+
+class BinaryLogReader::Private {
+public:
+    Private() : originWallMs(0), originNs(0) {}
+
+    QFile file;
+    QString error;
+    qint64 originWallMs;
+    quint64 originNs;
+    QHash<quint32, FormatDef> formats;
+
+    template<typename T>
+    bool readPod(T& value) {
+        return file.read(reinterpret_cast<char*>(&value), sizeof(T)) == static_cast<qint64>(sizeof(T));
+    }
+
+    bool readShortString(QByteArray& out) {
+        quint16 len = 0;
+        if (!readPod(len)) return false;
+        out = file.read(len);
+        return out.size() == len;
+    }
+
+    bool readFormat() {
+        FormatDef def;
+        if (!readPod(def.id) || !readPod(def.level) || !readPod(def.line)
+            || !readShortString(def.file) || !readShortString(def.function)
+            || !readShortString(def.format)) {
+            return false;
+        }
+        formats.insert(def.id, def);
+        return true;
+    }
+
+    static bool decodeArgs(const QByteArray& payload, QVariantList& args) {
+        const char* p = payload.constData();
+        const char* end = p + payload.size();
+        while (p < end) {
+            const quint8 tag = static_cast<quint8>(*p++);
+            switch (tag) {
+                case BinaryLogArgs::TagInt: {
+                    qint64 v;
+                    if (end - p < static_cast<ptrdiff_t>(sizeof(v))) return false;
+                    std::memcpy(&v, p, sizeof(v)); p += sizeof(v);
+                    args.append(v);
+                    break;
+                }
+                case BinaryLogArgs::TagUInt: {
+                    quint64 v;
+                    if (end - p < static_cast<ptrdiff_t>(sizeof(v))) return false;
+                    std::memcpy(&v, p, sizeof(v)); p += sizeof(v);
+                    args.append(v);
+                    break;
+                }
+                case BinaryLogArgs::TagDouble: {
+                    double v;
+                    if (end - p < static_cast<ptrdiff_t>(sizeof(v))) return false;
+                    std::memcpy(&v, p, sizeof(v)); p += sizeof(v);
+                    args.append(v);
+                    break;
+                }
+                case BinaryLogArgs::TagBool: {
+                    if (end - p < 1) return false;
+                    args.append(*p++ != 0);
+                    break;
+                }
+                case BinaryLogArgs::TagString: {
+                    quint32 len;
+                    if (end - p < static_cast<ptrdiff_t>(sizeof(len))) return false;
+                    std::memcpy(&len, p, sizeof(len)); p += sizeof(len);
+                    if (end - p < static_cast<ptrdiff_t>(len)) return false;
+                    args.append(QString::fromUtf8(p, static_cast<int>(len)));
+                    p += len;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
+BinaryLogReader::BinaryLogReader()
+    : d(new Private())
+{
+}
+
+BinaryLogReader::~BinaryLogReader() = default;
+
+bool BinaryLogReader::open(const QString& filePath)
+{
+    d->file.close();
+    d->formats.clear();
+    d->file.setFileName(filePath);
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        d->error = QString("Cannot open %1: %2").arg(filePath, d->file.errorString());
+        return false;
+    }
+
+    quint32 magic = 0, version = 0;
+    if (!d->readPod(magic) || magic != BinaryLog::Magic) {
+        d->error = "Not a QuantilyxDoc binary log.";
+        return false;
+    }
+    if (!d->readPod(version) || version != BinaryLog::Version) {
+        d->error = QString("Unsupported binary log version %1.").arg(version);
+        return false;
+    }
+    if (!d->readPod(d->originWallMs) || !d->readPod(d->originNs)) {
+        d->error = "Truncated binary log header.";
+        return false;
+    }
+    return true;
+}
+
+bool BinaryLogReader::next(BinaryLogEvent& event)
+{
+    quint8 type = 0;
+    while (d->readPod(type)) {
+        if (type == BinaryLog::RecordFormat) {
+            if (!d->readFormat()) {
+                d->error = "Truncated format record.";
+                return false;
+            }
+            continue;
+        }
+        if (type != BinaryLog::RecordEvent) {
+            d->error = QString("Unknown record type %1.").arg(type);
+            return false;
+        }
+
+        quint32 formatId = 0;
+        quint16 payloadSize = 0;
+        if (!d->readPod(formatId) || !d->readPod(event.timestampNs)
+            || !d->readPod(event.threadId) || !d->readPod(payloadSize)) {
+            d->error = "Truncated event record.";
+            return false;
+        }
+        const QByteArray payload = d->file.read(payloadSize);
+        if (payload.size() != payloadSize) {
+            d->error = "Truncated event payload.";
+            return false;
+        }
+
+        const FormatDef def = d->formats.value(formatId);
+        event.level = static_cast<LogLevel>(def.level);
+        event.file = QString::fromUtf8(def.file);
+        event.line = static_cast<int>(def.line);
+        event.function = QString::fromUtf8(def.function);
+        event.format = def.id ? QString::fromUtf8(def.format)
+                              : QString("<unknown format %1>").arg(formatId);
+        event.wallTimeMs = d->originWallMs
+            + static_cast<qint64>(event.timestampNs - d->originNs) / 1000000;
+        event.args.clear();
+        if (!Private::decodeArgs(payload, event.args)) {
+            d->error = "Malformed event arguments.";
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+QString BinaryLogReader::errorString() const
+{
+    return d->error;
+}
+
+} // namespace QuantilyxDoc
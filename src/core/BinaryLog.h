@@ -0,0 +1,329 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_BINARYLOG_H
+#define QUANTILYX_BINARYLOG_H
+
+#include "Logger.h"
+#include <QString>
+#include <QByteArray>
+#include <QVariantList>
+#include <QJsonObject>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Fixed-size argument buffer for one binary log event.
+ *
+ * Lives on the caller's stack; arguments are appended as a type tag followed by
+ * their raw bytes. Arguments that do not fit are dropped rather than allocating.
+ */
+class BinaryLogArgs
+{
+public:
+    enum Tag : quint8 {
+        TagInt = 1,
+        TagUInt = 2,
+        TagDouble = 3,
+        TagString = 4,
+        TagBool = 5
+    };
+
+    static constexpr int Capacity = 512;
+
+    BinaryLogArgs() : m_size(0) {}
+
+    template<typename T>
+    void append(const T& value) {
+        if constexpr (std::is_same<T, bool>::value) {
+            quint8 v = value ? 1 : 0;
+            appendRaw(TagBool, &v, sizeof(v));
+        } else if constexpr (std::is_enum<T>::value) {
+            qint64 v = static_cast<qint64>(value);
+            appendRaw(TagInt, &v, sizeof(v));
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            qint64 v = value;
+            appendRaw(TagInt, &v, sizeof(v));
+        } else if constexpr (std::is_integral<T>::value) {
+            quint64 v = value;
+            appendRaw(TagUInt, &v, sizeof(v));
+        } else if constexpr (std::is_floating_point<T>::value) {
+            double v = value;
+            appendRaw(TagDouble, &v, sizeof(v));
+        } else if constexpr (std::is_same<T, QString>::value) {
+            appendString(value.toUtf8());
+        } else if constexpr (std::is_same<T, QByteArray>::value) {
+            appendString(value);
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            appendString(value.data(), static_cast<int>(value.size()));
+        } else if constexpr (std::is_convertible<T, const char*>::value) {
+            const char* str = value;
+            appendString(str, str ? static_cast<int>(std::strlen(str)) : 0);
+        } else {
+            static_assert(std::is_arithmetic<T>::value, "Unsupported binary log argument type");
+        }
+    }
+
+    const char* data() const { return m_data; }
+    int size() const { return m_size; }
+
+private:
+    void appendRaw(quint8 tag, const void* bytes, int length) {
+        if (m_size + 1 + length > Capacity) {
+            return;
+        }
+        m_data[m_size++] = static_cast<char>(tag);
+        std::memcpy(m_data + m_size, bytes, length);
+        m_size += length;
+    }
+
+    void appendString(const QByteArray& utf8) { appendString(utf8.constData(), utf8.size()); }
+
+    void appendString(const char* str, int length) {
+        const int room = Capacity - m_size - 1 - static_cast<int>(sizeof(quint32));
+        if (room < 0) {
+            return;
+        }
+        quint32 len = static_cast<quint32>(qMin(length, room));
+        m_data[m_size++] = static_cast<char>(TagString);
+        std::memcpy(m_data + m_size, &len, sizeof(len));
+        m_size += sizeof(len);
+        if (len > 0) {
+            std::memcpy(m_data + m_size, str, len);
+            m_size += static_cast<int>(len);
+        }
+    }
+
+    char m_data[Capacity];
+    int m_size;
+};
+
+/**
+ * @brief Binary structured log writer - Singleton pattern
+ *
+ * Format strings are registered once per call site and referenced by id;
+ * each event stores only the id, a monotonic nanosecond timestamp, the thread
+ * id and the raw argument bytes. No text formatting happens at log time, so
+ * debug tracing can stay on in production. Use the quantilyxdoc-logdecode tool
+ * (or BinaryLogReader) to turn a log into text or JSON.
+ *
+ * File layout: "QDBL" magic, version, wall-clock and monotonic origin, then a
+ * sequence of format-definition and event records.
+ */
+class BinaryLog
+{
+public:
+    static constexpr quint32 Magic = 0x4c424451; // "QDBL"
+    static constexpr quint32 Version = 1;
+
+    enum RecordType : quint8 {
+        RecordFormat = 1,
+        RecordEvent = 2
+    };
+
+    /**
+     * @brief Get singleton instance
+     * @return Reference to BinaryLog
+     */
+    static BinaryLog& instance();
+
+    ~BinaryLog();
+
+    /**
+     * @brief Open (or reopen) the binary log file
+     *
+     * Already registered formats are re-emitted so the file is self-contained.
+     * @param filePath Output path
+     * @return true on success
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Flush and close the log file
+     */
+    void close();
+
+    /**
+     * @brief Check if events are currently being recorded
+     */
+    bool isOpen() const { return m_open.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the lowest level recorded (default Trace)
+     *
+     * Independent of the text logger's level and of QUANTILYX_LOG_MIN_LEVEL,
+     * so release builds can keep tracing into the binary log.
+     * @param level Minimum level
+     */
+    void setLevel(LogLevel level) { m_threshold.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the lowest level recorded
+     */
+    LogLevel level() const { return static_cast<LogLevel>(m_threshold.load(std::memory_order_relaxed)); }
+
+    /**
+     * @brief Check if events of a level are recorded (the log is open and the level passes)
+     */
+    bool isEnabled(LogLevel level) const {
+        return isOpen() && static_cast<int>(level) >= m_threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get current file path
+     */
+    QString filePath() const;
+
+    /**
+     * @brief Register a static format string
+     *
+     * Called once per call site by the LOG_B* macros. Placeholders are "{}".
+     * @return Format id used by subsequent events
+     */
+    quint32 registerFormat(LogLevel level, const char* file, int line,
+                           const char* function, const char* format);
+
+    /**
+     * @brief Append an event
+     * @param formatId Id returned by registerFormat()
+     * @param args Encoded arguments
+     */
+    void write(quint32 formatId, const BinaryLogArgs& args);
+
+    /**
+     * @brief Flush buffered events to disk
+     */
+    void flush();
+
+    /**
+     * @brief Monotonic timestamp in nanoseconds
+     */
+    static quint64 timestampNs();
+
+private:
+    BinaryLog();
+    BinaryLog(const BinaryLog&) = delete;
+    BinaryLog& operator=(const BinaryLog&) = delete;
+
+    class Private;
+    std::unique_ptr<Private> d;
+    std::atomic<bool> m_open;
+    std::atomic<int> m_threshold;
+};
+
+/**
+ * @brief One decoded event from a binary log
+ */
+struct BinaryLogEvent
+{
+    LogLevel level = LogLevel::Info;
+    quint64 timestampNs = 0;     ///< Monotonic timestamp as recorded
+    qint64 wallTimeMs = 0;       ///< Wall-clock time reconstructed from the file origin
+    quint64 threadId = 0;
+    QString file;
+    int line = 0;
+    QString function;
+    QString format;
+    QVariantList args;
+
+    /**
+     * @brief Substitute arguments into the format string
+     */
+    QString message() const;
+
+    /**
+     * @brief Render as a single text line (same layout as the text logger)
+     */
+    QString toText() const;
+
+    /**
+     * @brief Render as a JSON object
+     */
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief Offline reader for binary log files
+ */
+class BinaryLogReader
+{
+public:
+    BinaryLogReader();
+    ~BinaryLogReader();
+
+    /**
+     * @brief Open a binary log file
+     * @return true if the header is valid
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Read the next event, consuming format records on the way
+     * @param event Receives the decoded event
+     * @return false at end of file or on a truncated record
+     */
+    bool next(BinaryLogEvent& event);
+
+    /**
+     * @brief Last error message
+     */
+    QString errorString() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+namespace BinaryLogDetail {
+
+inline void appendAll(BinaryLogArgs&) {}
+
+template<typename T, typename... Rest>
+inline void appendAll(BinaryLogArgs& args, const T& first, const Rest&... rest) {
+    args.append(first);
+    appendAll(args, rest...);
+}
+
+template<typename... Args>
+inline void writeEvent(quint32 formatId, const char* /*format*/, const Args&... args) {
+    BinaryLogArgs encoded;
+    appendAll(encoded, args...);
+    BinaryLog::instance().write(formatId, encoded);
+}
+
+} // namespace BinaryLogDetail
+
+} // namespace QuantilyxDoc
+
+#define QUANTILYX_BLOG_FORMAT(format, ...) format
+
+// Binary structured logging: LOG_BDEBUG("Rendered page {} in {} ms", index, ms)
+// Arguments are only evaluated when the binary log is open and records the
+// level. Neither QUANTILYX_LOG_MIN_LEVEL nor the text logger's level applies.
+#define QUANTILYX_BLOG(level, ...) \
+    do { \
+        if (QuantilyxDoc::BinaryLog::instance().isEnabled(level)) { \
+            static const quint32 quantilyxFormatId = QuantilyxDoc::BinaryLog::instance().registerFormat( \
+                level, __FILE__, __LINE__, __FUNCTION__, QUANTILYX_BLOG_FORMAT(__VA_ARGS__, 0)); \
+            QuantilyxDoc::BinaryLogDetail::writeEvent(quantilyxFormatId, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_BTRACE(...) QUANTILYX_BLOG(QuantilyxDoc::LogLevel::Trace, __VA_ARGS__)
+#define LOG_BDEBUG(...) QUANTILYX_BLOG(QuantilyxDoc::LogLevel::Debug, __VA_ARGS__)
+#define LOG_BINFO(...)  QUANTILYX_BLOG(QuantilyxDoc::LogLevel::Info, __VA_ARGS__)
+#define LOG_BWARN(...)  QUANTILYX_BLOG(QuantilyxDoc::LogLevel::Warning, __VA_ARGS__)
+#define LOG_BERROR(...) QUANTILYX_BLOG(QuantilyxDoc::LogLevel::Error, __VA_ARGS__)
+
+#endif // QUANTILYX_BINARYLOG_H
@@ -0,0 +1,391 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "ChunkStore.h"
+#include "Logger.h"
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+// FastCDC parameters: 4 KiB min, 16 KiB average, 64 KiB max
+constexpr qint64 MinChunkSize = 4 * 1024;
+constexpr qint64 AvgChunkSize = 16 * 1024;
+constexpr qint64 MaxChunkSize = 64 * 1024;
+
+// Normalized chunking: a harder mask below the average size, an easier one
+// above it. Top bits are used because after "hash << 1" they depend on the
+// last 64 bytes rather than only the most recent few.
+constexpr quint64 MaskHard = ~0ULL << (64 - 16);
+constexpr quint64 MaskEasy = ~0ULL << (64 - 12);
+
+constexpr qint64 ReadBlockSize = 1024 * 1024;
+
+// Compressed chunks carry this suffix; keep them compressed only if it saves at least 1/8
+const char* const CompressedSuffix = ".z";
+constexpr int MinCompressionGainDivisor = 8;
+
+const char* const ManifestHeader = "# QuantilyxDoc backup manifest v1";
+
+// Gear table; fixed seed so chunk boundaries are stable across runs and versions
+const quint64* gearTable()
+{
+    static quint64 table[256];
+    static bool initialized = [] {
+        quint64 state = 0x5175616e74696c79ULL; // "Quantily"
+        for (int i = 0; i < 256; ++i) {
+            // splitmix64
+            state += 0x9e3779b97f4a7c15ULL;
+            quint64 z = state;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            table[i] = z ^ (z >> 31);
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized);
+    return table;
+}
+
+// Length of the next chunk in data[0, length)
+qint64 cutPoint(const uchar* data, qint64 length)
+{
+    if (length <= MinChunkSize) return length;
+
+    const quint64* gear = gearTable();
+    const qint64 normal = qMin(AvgChunkSize, length);
+    quint64 hash = 0;
+    qint64 i = MinChunkSize;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & MaskHard)) return i + 1;
+    }
+    for (; i < length; ++i) {
+        hash = (hash << 1) + gear[data[i]];
+        if (!(hash & MaskEasy)) return i + 1;
+    }
+    return length;
+}
+
+} // namespace
+
+class ChunkStore::Private {
+public:
+    QDir root;
+    QString lastError;
+    int compressionLevel = 3;
+
+    QString chunkPath(const QByteArray& hash) const {
+        const QString hex = QString::fromLatin1(hash);
+        return root.filePath("chunks/" + hex.left(2) + "/" + hex);
+    }
+
+    // Store one chunk unless it already exists; returns false on I/O error
+    bool putChunk(const QByteArray& hash, const char* data, qint64 length, bool& isNew, qint64& storedBytes) {
+        const QString path = chunkPath(hash);
+        isNew = false;
+        storedBytes = 0;
+        if (QFile::exists(path) || QFile::exists(path + CompressedSuffix)) return true;
+
+        // Already-compressed content (most PDF streams, images) does not
+        // shrink; store it raw rather than pay for inflate on restore.
+        QByteArray compressed;
+        if (compressionLevel > 0) {
+            compressed = qCompress(reinterpret_cast<const uchar*>(data), static_cast<int>(length), compressionLevel);
+            if (compressed.size() > length - length / MinCompressionGainDivisor) {
+                compressed.clear();
+            }
+        }
+        const bool useCompressed = !compressed.isEmpty();
+        const QString targetPath = useCompressed ? path + CompressedSuffix : path;
+        const char* bytes = useCompressed ? compressed.constData() : data;
+        const qint64 byteCount = useCompressed ? compressed.size() : length;
+
+        QDir().mkpath(QFileInfo(targetPath).absolutePath());
+        QSaveFile file(targetPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            lastError = QString("Cannot write chunk %1: %2").arg(targetPath, file.errorString());
+            return false;
+        }
+        if (file.write(bytes, byteCount) != byteCount || !file.commit()) {
+            lastError = QString("Cannot write chunk %1: %2").arg(targetPath, file.errorString());
+            return false;
+        }
+        isNew = true;
+        storedBytes = byteCount;
+        return true;
+    }
+
+    bool readChunk(const ChunkRef& ref, QByteArray& out) {
+        const QString path = chunkPath(ref.hash);
+        QFile compressedFile(path + CompressedSuffix);
+        if (compressedFile.open(QIODevice::ReadOnly)) {
+            out = qUncompress(compressedFile.readAll());
+        } else {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                lastError = QString("Missing chunk %1").arg(QString::fromLatin1(ref.hash));
+                return false;
+            }
+            out = file.readAll();
+        }
+        if (out.size() != ref.length) {
+            lastError = QString("Chunk %1 has wrong length").arg(QString::fromLatin1(ref.hash));
+            return false;
+        }
+        return true;
+    }
+};
+
+ChunkStore::ChunkStore(const QDir& root)
+    : d(new Private())
+{
+    d->root = root;
+}
+
+ChunkStore::~ChunkStore() = default;
+
+QDir ChunkStore::root() const
+{
+    return d->root;
+}
+
+void ChunkStore::setRoot(const QDir& root)
+{
+    d->root = root;
+}
+
+int ChunkStore::compressionLevel() const
+{
+    return d->compressionLevel;
+}
+
+void ChunkStore::setCompressionLevel(int level)
+{
+    d->compressionLevel = qBound(0, level, 9);
+}
+
+bool ChunkStore::storeFile(const QString& sourcePath, const QString& manifestPath,
+                           ChunkManifest& manifest, ChunkStoreStats* stats)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        d->lastError = QString("Cannot open %1: %2").arg(sourcePath, source.errorString());
+        LOG_ERROR(d->lastError);
+        return false;
+    }
+
+    ChunkStoreStats localStats;
+    QCryptographicHash fileHash(QCryptographicHash::Sha256);
+    manifest.chunks.clear();
+
+    // Sliding buffer: always hold at least MaxChunkSize bytes past pos unless at EOF
+    QByteArray buffer;
+    qint64 pos = 0;
+    bool eof = false;
+    while (true) {
+        if (!eof && buffer.size() - pos < MaxChunkSize) {
+            if (pos > 0) {
+                buffer.remove(0, static_cast<int>(pos));
+                pos = 0;
+            }
+            const QByteArray block = source.read(ReadBlockSize);
+            if (block.isEmpty()) {
+                eof = true;
+            } else {
+                fileHash.addData(block);
+                buffer.append(block);
+                continue;
+            }
+        }
+
+        const qint64 available = buffer.size() - pos;
+        if (available <= 0) break;
+
+        const uchar* data = reinterpret_cast<const uchar*>(buffer.constData()) + pos;
+        const qint64 length = cutPoint(data, qMin(available, MaxChunkSize));
+        const char* chunk = buffer.constData() + pos;
+
+        const QByteArray hash = QCryptographicHash::hash(QByteArray::fromRawData(chunk, static_cast<int>(length)),
+                                                         QCryptographicHash::Sha256).toHex();
+        bool isNew = false;
+        qint64 storedBytes = 0;
+        if (!d->putChunk(hash, chunk, length, isNew, storedBytes)) {
+            LOG_ERROR(d->lastError);
+            return false;
+        }
+
+        manifest.chunks.append(ChunkRef{hash, length});
+        localStats.totalBytes += length;
+        localStats.chunkCount++;
+        if (isNew) {
+            localStats.newBytes += length;
+            localStats.storedBytes += storedBytes;
+            localStats.newChunks++;
+        }
+        pos += length;
+    }
+
+    manifest.size = localStats.totalBytes;
+    manifest.sha256 = fileHash.result().toHex();
+    if (!writeManifest(manifestPath, manifest)) {
+        d->lastError = QString("Cannot write manifest %1").arg(manifestPath);
+        LOG_ERROR(d->lastError);
+        return false;
+    }
+
+    LOG_DEBUG("Stored " << sourcePath << " as " << localStats.chunkCount << " chunks, "
+              << localStats.newChunks << " new (" << localStats.newBytes << " of "
+              << localStats.totalBytes << " bytes new, " << localStats.storedBytes << " on disk)");
+    if (stats) *stats = localStats;
+    return true;
+}
+
+bool ChunkStore::restoreFile(const QString& manifestPath, const QString& targetPath)
+{
+    ChunkManifest manifest;
+    if (!readManifest(manifestPath, manifest)) {
+        d->lastError = QString("Invalid backup manifest: %1").arg(manifestPath);
+        LOG_ERROR(d->lastError);
+        return false;
+    }
+
+    QSaveFile target(targetPath);
+    if (!target.open(QIODevice::WriteOnly)) {
+        d->lastError = QString("Cannot write %1: %2").arg(targetPath, target.errorString());
+        LOG_ERROR(d->lastError);
+        return false;
+    }
+
+    QCryptographicHash fileHash(QCryptographicHash::Sha256);
+    QByteArray chunk;
+    for (const ChunkRef& ref : manifest.chunks) {
+        if (!d->readChunk(ref, chunk) || target.write(chunk) != chunk.size()) {
+            if (d->lastError.isEmpty()) d->lastError = target.errorString();
+            LOG_ERROR("Failed to restore " << manifestPath << ": " << d->lastError);
+            target.cancelWriting();
+            return false;
+        }
+        fileHash.addData(chunk);
+    }
+
+    if (fileHash.result().toHex() != manifest.sha256) {
+        d->lastError = QString("Checksum mismatch restoring %1").arg(manifestPath);
+        LOG_ERROR(d->lastError);
+        target.cancelWriting();
+        return false;
+    }
+    if (!target.commit()) {
+        d->lastError = QString("Cannot write %1: %2").arg(targetPath, target.errorString());
+        LOG_ERROR(d->lastError);
+        return false;
+    }
+    return true;
+}
+
+int ChunkStore::collectGarbage(const QDir& manifestRoot)
+{
+    QSet<QString> referenced;
+    QDirIterator manifests(manifestRoot.absolutePath(), QStringList() << "*.manifest",
+                           QDir::Files, QDirIterator::Subdirectories);
+    while (manifests.hasNext()) {
+        ChunkManifest manifest;
+        if (!readManifest(manifests.next(), manifest)) {
+            // Keep everything if a manifest cannot be read; better than losing data
+            LOG_WARN("Skipping chunk garbage collection: unreadable manifest " << manifests.filePath());
+            return 0;
+        }
+        for (const ChunkRef& ref : manifest.chunks) {
+            referenced.insert(QString::fromLatin1(ref.hash));
+        }
+    }
+
+    int removed = 0;
+    QDirIterator chunks(d->root.filePath("chunks"), QDir::Files, QDirIterator::Subdirectories);
+    while (chunks.hasNext()) {
+        const QString path = chunks.next();
+        // Chunk files are named "<hash>" or "<hash>.z"
+        if (!referenced.contains(chunks.fileInfo().baseName()) && QFile::remove(path)) {
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        LOG_DEBUG("Removed " << removed << " unreferenced backup chunks");
+    }
+    return removed;
+}
+
+bool ChunkStore::readManifest(const QString& manifestPath, ChunkManifest& manifest)
+{
+    QFile file(manifestPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    if (stream.readLine() != QLatin1String(ManifestHeader)) return false;
+
+    manifest = ChunkManifest();
+    qint64 chunkTotal = 0;
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine();
+        if (line.startsWith("C ")) {
+            const QStringList parts = line.split(' ');
+            if (parts.size() != 3) return false;
+            ChunkRef ref{parts[1].toLatin1(), parts[2].toLongLong()};
+            chunkTotal += ref.length;
+            manifest.chunks.append(ref);
+            continue;
+        }
+        const int eq = line.indexOf('=');
+        if (eq <= 0) continue;
+        const QString key = line.left(eq);
+        const QString value = line.mid(eq + 1);
+        if (key == "source") manifest.sourcePath = value;
+        else if (key == "title") manifest.title = value;
+        else if (key == "created") manifest.created = QDateTime::fromString(value, Qt::ISODateWithMs);
+        else if (key == "size") manifest.size = value.toLongLong();
+        else if (key == "sha256") manifest.sha256 = value.toLatin1();
+    }
+    return chunkTotal == manifest.size && !manifest.sha256.isEmpty();
+}
+
+bool ChunkStore::writeManifest(const QString& manifestPath, const ChunkManifest& manifest)
+{
+    QDir().mkpath(QFileInfo(manifestPath).absolutePath());
+    QSaveFile file(manifestPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << ManifestHeader << "\n";
+    stream << "source=" << manifest.sourcePath << "\n";
+    stream << "title=" << QString(manifest.title).replace('\n', ' ') << "\n";
+    stream << "created=" << manifest.created.toString(Qt::ISODateWithMs) << "\n";
+    stream << "size=" << manifest.size << "\n";
+    stream << "sha256=" << manifest.sha256 << "\n";
+    for (const ChunkRef& ref : manifest.chunks) {
+        stream << "C " << ref.hash << " " << ref.length << "\n";
+    }
+    stream.flush();
+    return file.commit();
+}
+
+QString ChunkStore::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace QuantilyxDoc
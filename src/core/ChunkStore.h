@@ -0,0 +1,149 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_CHUNKSTORE_H
+#define QUANTILYX_CHUNKSTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QList>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief One chunk reference inside a backup manifest.
+ */
+struct ChunkRef {
+    QByteArray hash;    // Hex SHA-256 of the chunk contents
+    qint64 length;      // Uncompressed length in bytes
+};
+
+/**
+ * @brief Describes one backup version: metadata plus the ordered chunk list.
+ */
+struct ChunkManifest {
+    QString sourcePath;     // Original document path
+    QString title;          // Document title at backup time
+    QDateTime created;      // When the backup was taken
+    qint64 size = 0;        // Size of the reassembled file
+    QByteArray sha256;      // Hex SHA-256 of the whole file
+    QList<ChunkRef> chunks;
+};
+
+/**
+ * @brief Statistics for one storeFile() call.
+ */
+struct ChunkStoreStats {
+    qint64 totalBytes = 0;  // Bytes in the source file
+    qint64 newBytes = 0;    // Bytes that were not already in the store
+    qint64 storedBytes = 0; // Bytes written to disk for new chunks (after compression)
+    int chunkCount = 0;
+    int newChunks = 0;
+};
+
+/**
+ * @brief Content-addressed, deduplicating chunk store for backups.
+ *
+ * Files are split with FastCDC (gear rolling hash, normalized chunking,
+ * 4/16/64 KiB min/avg/max), so an edit only changes the chunks around it.
+ * Chunks are stored once under their SHA-256 in "<root>/chunks/xx/<hash>";
+ * each backup version is a small manifest listing its chunks. Versions that
+ * differ by one annotation share nearly all chunks.
+ *
+ * New chunks are zlib-compressed ("<hash>.z") when that saves at least an
+ * eighth of their size; incompressible chunks are stored raw.
+ *
+ * Not thread-safe; callers serialize access.
+ */
+class ChunkStore
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param root Directory holding the "chunks" subdirectory.
+     */
+    explicit ChunkStore(const QDir& root = QDir());
+    ~ChunkStore();
+
+    /**
+     * @brief Get the store root.
+     */
+    QDir root() const;
+
+    /**
+     * @brief Set the store root.
+     */
+    void setRoot(const QDir& root);
+
+    /**
+     * @brief Get the zlib level used for new chunks (0 = store raw).
+     */
+    int compressionLevel() const;
+
+    /**
+     * @brief Set the zlib level used for new chunks (0-9, default 3).
+     */
+    void setCompressionLevel(int level);
+
+    /**
+     * @brief Chunk a file into the store and write its manifest.
+     * @param sourcePath File to back up.
+     * @param manifestPath Where to write the manifest.
+     * @param manifest Metadata (sourcePath, title, created); chunk list and hashes are filled in.
+     * @param stats Optional statistics output.
+     * @return True on success.
+     */
+    bool storeFile(const QString& sourcePath, const QString& manifestPath,
+                   ChunkManifest& manifest, ChunkStoreStats* stats = nullptr);
+
+    /**
+     * @brief Reassemble a backup version into a file.
+     *
+     * The target is replaced atomically and only if the reassembled contents
+     * match the manifest's whole-file hash.
+     * @param manifestPath Manifest of the version to restore.
+     * @param targetPath Output file.
+     * @return True on success.
+     */
+    bool restoreFile(const QString& manifestPath, const QString& targetPath);
+
+    /**
+     * @brief Remove chunks not referenced by any manifest under the given directory.
+     * @param manifestRoot Directory searched recursively for "*.manifest" files.
+     * @return Number of chunk files removed.
+     */
+    int collectGarbage(const QDir& manifestRoot);
+
+    /**
+     * @brief Read a manifest file.
+     * @return True if the manifest is well-formed.
+     */
+    static bool readManifest(const QString& manifestPath, ChunkManifest& manifest);
+
+    /**
+     * @brief Write a manifest file atomically.
+     */
+    static bool writeManifest(const QString& manifestPath, const ChunkManifest& manifest);
+
+    /**
+     * @brief Get the last error message.
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_CHUNKSTORE_H
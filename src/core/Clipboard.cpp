@@ -9,106 +9,295 @@
  */
 #include "Clipboard.h"
 #include "Logger.h"
+#include "SelectionMimeData.h"
 #include <QApplication>
 #include <QClipboard>
 #include <QMimeData>
 #include <QImage>
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QUrl>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QRegularExpression>
 #include <QDebug>
+#include <cstring>
 
 namespace QuantilyxDoc {
 
+namespace {
+
+// Formats whose bytes are already compressed; storing them through zlib again only costs time
+bool isCompressedFormat(const QString& mimeType)
+{
+    return mimeType == QLatin1String("image/png") || mimeType == QLatin1String("image/jpeg")
+        || mimeType == QLatin1String("image/gif") || mimeType == QLatin1String("image/webp");
+}
+
+const QString RawImageFormat = QStringLiteral("application/x-qt-image");
+constexpr int MinCompressSize = 4096;
+
+} // namespace
+
 class Clipboard::Private {
 public:
     Private(Clipboard* q_ptr)
         : q(q_ptr),
           historyEnabled(true),
-          maxHistorySizeVal(20) {}
+          maxHistorySizeVal(20),
+          spillThreshold(1024 * 1024),
+          memoryUsage(0) {}
+
+    // One clipboard format as captured for the history
+    struct Format {
+        QString mimeType;
+        QByteArray bytes;
+        bool compressed;
+    };
+
+    // History payload, keyed by HistoryEntry::hash
+    struct Payload {
+        QByteArray blob;                               // Encoded formats, empty when spilled
+        QString spillPath;                             // File holding the blob, if spilled
+        std::shared_ptr<SelectionTextSource> lazySource; // Delayed-rendering selection text
+    };
 
     Clipboard* q;
-    mutable QMutex mutex; // Protect access to history list and system clipboard connection
+    mutable QMutex mutex; // Protects the history; never held across QClipboard calls, which may emit dataChanged
     QList<HistoryEntry> history;
+    QHash<QByteArray, Payload> payloads;
     bool historyEnabled;
     int maxHistorySizeVal;
+    qint64 spillThreshold;
+    qint64 memoryUsage;
 
     // Helper to get system clipboard
     QClipboard* getSystemClipboard() const {
         return QApplication::clipboard();
     }
 
-    // Helper to add current system clipboard content to history
-    void addToHistoryIfNeeded() {
-        if (!historyEnabled) return;
-
-        const QMimeData* sysData = getSystemClipboard()->mimeData();
-        if (!sysData) return;
+    QString spillDirectory() const {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/clipboard";
+    }
 
-        // Check if this exact data is already the most recent in history
-        if (!history.isEmpty() && dataEquals(history.last().data, sysData)) {
-             LOG_DEBUG("Current clipboard data matches last history entry. Skipping.");
-             return;
+    // Add clipboard content to the history. Reading the clipboard data runs
+    // before the lock is taken; only the history update runs under it. The
+    // signals are emitted by the caller once the lock is released.
+    enum class HistoryUpdate { None, Moved, Added };
+    HistoryUpdate addToHistory(const QMimeData* sysData, HistoryEntry& entry) {
+        {
+            QMutexLocker locker(&mutex);
+            if (!historyEnabled) return HistoryUpdate::None;
+        }
+        if (!sysData) return HistoryUpdate::None;
+
+        Payload payload;
+        QList<Format> formats;
+        if (const SelectionMimeData* lazy = qobject_cast<const SelectionMimeData*>(sysData)) {
+            // Keep the selection snapshot; its text is not materialized for the history
+            payload.lazySource = lazy->source();
+            entry.hash = "selection:" + QByteArray::number(quintptr(payload.lazySource.get()), 16);
+            entry.dataSize = payload.lazySource->approximateSize();
+        } else {
+            formats = captureFormats(sysData, entry.hash, entry.dataSize);
         }
-
-        HistoryEntry entry;
-        entry.data = cloneMimeData(sysData);
-        entry.timestamp = QDateTime::currentDateTime();
         entry.dataType = sysData->formats().isEmpty() ? "unknown" : sysData->formats().first();
         entry.previewText = generatePreviewText(sysData);
-        entry.dataSize = approximateDataSize(sysData);
 
+        QMutexLocker locker(&mutex);
+        // The same content copied again moves its entry to the end instead of adding one
+        for (int i = 0; i < history.size(); ++i) {
+            if (history.at(i).hash == entry.hash) {
+                HistoryEntry existing = history.takeAt(i);
+                existing.timestamp = QDateTime::currentDateTime();
+                history.append(existing);
+                LOG_DEBUG("Clipboard content already in history; moved entry " << i << " to the end.");
+                return HistoryUpdate::Moved;
+            }
+        }
+
+        entry.timestamp = QDateTime::currentDateTime();
+        if (!payload.lazySource) {
+            storePayload(entry, payload, formats);
+        }
+        payloads.insert(entry.hash, payload);
         history.append(entry);
-        LOG_DEBUG("Added clipboard content to history. Type: " << entry.dataType << ", Size: " << entry.dataSize << " bytes.");
+        LOG_DEBUG("Added clipboard content to history. Type: " << entry.dataType << ", Size: " << entry.dataSize
+                  << " bytes, stored: " << entry.storedSize << (entry.onDisk ? " bytes on disk." : " bytes."));
 
         // Maintain max size
-        while (history.size() > maxHistorySizeVal) {
-            HistoryEntry oldEntry = history.takeFirst(); // Remove oldest
-            LOG_DEBUG("Evicted old clipboard history entry.");
-        }
+        trimHistory();
+        return HistoryUpdate::Added;
+    }
 
-        emit q->historyChanged();
-        emit q->historyItemAdded(entry);
+    // Read the formats worth keeping and hash them. An image is kept once, as
+    // raw pixels, instead of once per platform image format.
+    QList<Format> captureFormats(const QMimeData* data, QByteArray& hash, qint64& size) const {
+        QList<Format> formats;
+        QCryptographicHash hasher(QCryptographicHash::Sha256);
+        size = 0;
+
+        auto add = [&](const QString& mimeType, const QByteArray& bytes) {
+            hasher.addData(mimeType.toUtf8());
+            hasher.addData(QByteArray::number(bytes.size()));
+            hasher.addData(bytes);
+            size += bytes.size();
+            formats.append(Format{mimeType, bytes, false});
+        };
+
+        const bool hasImage = data->hasImage();
+        if (hasImage) {
+            add(RawImageFormat, encodeImage(qvariant_cast<QImage>(data->imageData())));
+        }
+        for (const QString& format : data->formats()) {
+            if (format == RawImageFormat) continue;
+            if (hasImage && format.startsWith(QLatin1String("image/"))) continue;
+            add(format, data->data(format));
+        }
+        hash = hasher.result().toHex();
+        return formats;
     }
 
-    // Helper to check if two QMimeData objects are equivalent
-    bool dataEquals(const QMimeData* a, const QMimeData* b) const {
-        if (!a && !b) return true;
-        if (!a || !b) return false;
-        // Compare formats and primary content (simplified check)
-        return a->formats() == b->formats() &&
-               a->text() == b->text() &&
-               a->html() == b->html() &&
-               a->hasImage() == b->hasImage(); // Could be more thorough
+    // Compress the formats and keep the blob in memory or spill it to disk
+    void storePayload(HistoryEntry& entry, Payload& payload, QList<Format>& formats) {
+        for (Format& format : formats) {
+            if (format.bytes.size() >= MinCompressSize && !isCompressedFormat(format.mimeType)) {
+                QByteArray packed = qCompress(format.bytes, 1);
+                if (packed.size() < format.bytes.size()) {
+                    format.bytes = packed;
+                    format.compressed = true;
+                }
+            }
+        }
+
+        QByteArray blob;
+        {
+            QDataStream stream(&blob, QIODevice::WriteOnly);
+            stream << qint32(formats.size());
+            for (const Format& format : formats) {
+                stream << format.mimeType << format.compressed << format.bytes;
+            }
+        }
+        formats.clear();
+        entry.storedSize = blob.size();
+
+        if (spillThreshold > 0 && blob.size() > spillThreshold && QDir().mkpath(spillDirectory())) {
+            const QString path = spillDirectory() + "/" + QString::fromLatin1(entry.hash) + ".bin";
+            QSaveFile file(path);
+            if (file.open(QIODevice::WriteOnly) && file.write(blob) == blob.size() && file.commit()) {
+                payload.spillPath = path;
+                entry.onDisk = true;
+                return;
+            }
+            LOG_WARN("Failed to spill clipboard history entry to " << path << "; keeping it in memory.");
+        }
+        payload.blob = blob;
+        memoryUsage += blob.size();
     }
 
-    // Helper to deep clone QMimeData
-    QMimeData* cloneMimeData(const QMimeData* original) const {
-        if (!original) return nullptr;
-
-        QMimeData* clone = new QMimeData();
-        // Copy standard formats
-        if (original->hasText()) clone->setText(original->text());
-        if (original->hasHtml()) clone->setHtml(original->html());
-        if (original->hasImage()) clone->setImageData(original->imageData());
-        if (original->hasUrls()) clone->setUrls(original->urls());
-        if (original->hasColor()) clone->setColorData(original->colorData());
-
-        // Copy custom formats
-        for (const QString& format : original->formats()) {
-            if (!clone->hasFormat(format)) { // Avoid overwriting standard ones set above
-                clone->setData(format, original->data(format));
+    // Decode a payload into new MIME data
+    QMimeData* decodePayload(const Payload& payload) const {
+        if (payload.lazySource) {
+            return new SelectionMimeData(payload.lazySource);
+        }
+
+        QByteArray blob = payload.blob;
+        if (!payload.spillPath.isEmpty()) {
+            QFile file(payload.spillPath);
+            if (!file.open(QIODevice::ReadOnly)) {
+                LOG_WARN("Cannot read clipboard history entry: " << payload.spillPath);
+                return nullptr;
             }
+            blob = file.readAll();
+        }
+
+        QDataStream stream(blob);
+        qint32 count = 0;
+        stream >> count;
+        QMimeData* data = new QMimeData();
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            QString mimeType;
+            bool compressed = false;
+            QByteArray bytes;
+            stream >> mimeType >> compressed >> bytes;
+            if (compressed) bytes = qUncompress(bytes);
+            if (mimeType == RawImageFormat) {
+                data->setImageData(decodeImage(bytes));
+            } else {
+                data->setData(mimeType, bytes);
+            }
+        }
+        if (stream.status() != QDataStream::Ok) {
+            LOG_WARN("Clipboard history entry is corrupt.");
+            delete data;
+            return nullptr;
+        }
+        return data;
+    }
+
+    static QByteArray encodeImage(const QImage& image) {
+        QByteArray bytes;
+        if (image.isNull()) return bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream << qint32(image.format()) << qint32(image.width()) << qint32(image.height())
+               << qint32(image.bytesPerLine());
+        stream.writeRawData(reinterpret_cast<const char*>(image.constBits()), int(image.sizeInBytes()));
+        return bytes;
+    }
+
+    static QImage decodeImage(const QByteArray& bytes) {
+        QDataStream stream(bytes);
+        qint32 format = 0, width = 0, height = 0, bytesPerLine = 0;
+        stream >> format >> width >> height >> bytesPerLine;
+        if (stream.status() != QDataStream::Ok || width <= 0 || height <= 0) return QImage();
+        QImage image(width, height, QImage::Format(format));
+        const qint64 offset = stream.device()->pos();
+        if (image.isNull() || offset + qint64(bytesPerLine) * height > bytes.size()) return QImage();
+        const char* src = bytes.constData() + offset;
+        const int rowBytes = qMin(bytesPerLine, int(image.bytesPerLine()));
+        for (int y = 0; y < height; ++y) {
+            memcpy(image.scanLine(y), src + qint64(y) * bytesPerLine, rowBytes);
+        }
+        return image;
+    }
+
+    void dropPayload(const QByteArray& hash) {
+        const Payload payload = payloads.take(hash);
+        memoryUsage -= payload.blob.size();
+        if (!payload.spillPath.isEmpty()) {
+            QFile::remove(payload.spillPath);
+        }
+    }
+
+    void trimHistory() {
+        while (history.size() > maxHistorySizeVal) {
+            dropPayload(history.takeFirst().hash); // Remove oldest
+            LOG_DEBUG("Evicted old clipboard history entry.");
+        }
+    }
+
+    void clearHistoryLocked() {
+        for (const HistoryEntry& entry : history) {
+            dropPayload(entry.hash);
         }
-        return clone;
+        history.clear();
     }
 
     // Helper to generate a short preview text
     QString generatePreviewText(const QMimeData* data) const {
         if (!data) return QString();
 
+        if (const SelectionMimeData* lazy = qobject_cast<const SelectionMimeData*>(data)) {
+            QString text = lazy->source()->preview(51);
+            if (text.length() > 50) text = text.left(50) + "...";
+            return text;
+        }
         if (data->hasText()) {
             QString text = data->text();
             if (text.length() > 50) text = text.left(50) + "...";
@@ -135,21 +324,6 @@ public:
         return formats.isEmpty() ? "[Unknown Data]" : "[" + formats.first() + "]";
     }
 
-    // Helper to estimate data size (very rough approximation)
-    qint64 approximateDataSize(const QMimeData* data) const {
-        if (!data) return 0;
-        qint64 size = 0;
-        if (data->hasText()) size += data->text().length() * sizeof(QChar);
-        if (data->hasHtml()) size += data->html().length() * sizeof(QChar);
-        if (data->hasImage()) {
-            QImage img = qvariant_cast<QImage>(data->imageData());
-            if (!img.isNull()) size += img.sizeInBytes();
-        }
-        size += data->urls().size() * 100; // Rough estimate per URL
-        // Add sizes for other formats if needed
-        return size;
-    }
-
     // Helper to sanitize HTML content
     QString sanitizeHtml(const QString& html) const {
         QString sanitized = html;
@@ -186,23 +360,21 @@ Clipboard::Clipboard(QObject* parent)
 
 Clipboard::~Clipboard()
 {
-    // Clear history to delete contained QMimeData objects
-    d->history.clear();
+    // History is per session: drop payloads and spill files
+    d->clearHistoryLocked();
 }
 
 void Clipboard::setText(const QString& text)
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (sysClipboard) {
         sysClipboard->setText(text);
-        // Signal 'changed' is emitted by system clipboard, triggering onSystemClipboardChanged
+        // The system clipboard emits dataChanged, triggering onSystemClipboardChanged
     }
 }
 
 void Clipboard::setHtml(const QString& html)
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (sysClipboard) {
         QString sanitizedHtml = d->sanitizeHtml(html); // Sanitize before setting
@@ -212,7 +384,6 @@ void Clipboard::setHtml(const QString& html)
 
 void Clipboard::setImage(const QImage& image)
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (sysClipboard) {
         sysClipboard->setImage(image);
@@ -223,79 +394,72 @@ void Clipboard::setData(QMimeData* data)
 {
     if (!data) return;
 
-    QMutexLocker locker(&d->mutex);
+    // Not under the lock: setMimeData() emits dataChanged synchronously and
+    // onSystemClipboardChanged() takes the lock to update the history
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (sysClipboard) {
         sysClipboard->setMimeData(data); // Clipboard takes ownership
+    } else {
+        delete data;
     }
 }
 
 QString Clipboard::text() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->text() : QString();
 }
 
 QString Clipboard::html() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->html() : QString();
 }
 
 QImage Clipboard::image() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->image() : QImage();
 }
 
 const QMimeData* Clipboard::data() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->mimeData() : nullptr;
 }
 
 bool Clipboard::hasText() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->hasText() : false;
 }
 
 bool Clipboard::hasHtml() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->hasHtml() : false;
 }
 
 bool Clipboard::hasImage() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->hasImage() : false;
 }
 
 bool Clipboard::hasUrls() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->hasUrls() : false;
 }
 
 QList<QUrl> Clipboard::urls() const
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     return sysClipboard ? sysClipboard->urls() : QList<QUrl>();
 }
 
 void Clipboard::clear()
 {
-    QMutexLocker locker(&d->mutex);
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (sysClipboard) {
         sysClipboard->clear();
@@ -305,8 +469,10 @@ void Clipboard::clear()
 
 void Clipboard::setHistoryEnabled(bool enabled)
 {
-    QMutexLocker locker(&d->mutex);
-    d->historyEnabled = enabled;
+    {
+        QMutexLocker locker(&d->mutex);
+        d->historyEnabled = enabled;
+    }
     if (!enabled) {
         clearHistory(); // Optionally clear history when disabling
     }
@@ -343,65 +509,84 @@ void Clipboard::setMaxHistorySize(int size)
     if (d->maxHistorySizeVal != size) {
         d->maxHistorySizeVal = size;
         // Trim history if new size is smaller
-        while (d->history.size() > d->maxHistorySizeVal) {
-            d->history.removeFirst();
-        }
+        d->trimHistory();
         LOG_DEBUG("Set clipboard history max size to " << size);
     }
 }
 
 bool Clipboard::restoreFromHistory(int index)
 {
-    QMutexLocker locker(&d->mutex);
-    if (index < 0 || index >= d->history.size()) {
-        LOG_WARN("Cannot restore from clipboard history: invalid index " << index);
-        return false;
-    }
-
     QClipboard* sysClipboard = d->getSystemClipboard();
     if (!sysClipboard) return false;
 
-    const HistoryEntry& entry = d->history.at(index);
-    if (!entry.data) {
-        LOG_WARN("Cannot restore from clipboard history: null data at index " << index);
-        return false;
-    }
-
-    // Clone the data from history to set on the system clipboard
-    QMimeData* clonedData = d->cloneMimeData(entry.data);
-    if (clonedData) {
-        sysClipboard->setMimeData(clonedData); // System clipboard takes ownership
+    // Decoded under the lock, handed to the system clipboard outside it:
+    // setMimeData() may report the change synchronously
+    QMimeData* data = historyData(index);
+    if (data) {
+        sysClipboard->setMimeData(data); // System clipboard takes ownership
         LOG_DEBUG("Restored clipboard content from history index " << index);
         return true;
     }
     return false;
 }
 
-void Clipboard::clearHistory()
+QMimeData* Clipboard::historyData(int index) const
 {
     QMutexLocker locker(&d->mutex);
-    d->history.clear();
+    if (index < 0 || index >= d->history.size()) {
+        LOG_WARN("Cannot restore from clipboard history: invalid index " << index);
+        return nullptr;
+    }
+    auto it = d->payloads.constFind(d->history.at(index).hash);
+    if (it == d->payloads.constEnd()) {
+        LOG_WARN("Cannot restore from clipboard history: no data at index " << index);
+        return nullptr;
+    }
+    return d->decodePayload(it.value());
+}
+
+void Clipboard::clearHistory()
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->clearHistoryLocked();
+    }
     emit historyChanged();
     LOG_DEBUG("Cleared clipboard history.");
 }
 
-QStringList Clipboard::formats() const
+qint64 Clipboard::historySpillThreshold() const
 {
     QMutexLocker locker(&d->mutex);
+    return d->spillThreshold;
+}
+
+void Clipboard::setHistorySpillThreshold(qint64 bytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->spillThreshold = qMax<qint64>(0, bytes);
+}
+
+qint64 Clipboard::historyMemoryUsage() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->memoryUsage;
+}
+
+QStringList Clipboard::formats() const
+{
     const QMimeData* data = this->data();
     return data ? data->formats() : QStringList();
 }
 
 bool Clipboard::hasFormat(const QString& mimeType) const
 {
-    QMutexLocker locker(&d->mutex);
     const QMimeData* data = this->data();
     return data ? data->hasFormat(mimeType) : false;
 }
 
 QByteArray Clipboard::rawData(const QString& mimeType) const
 {
-    QMutexLocker locker(&d->mutex);
     const QMimeData* data = this->data();
     return data ? data->data(mimeType) : QByteArray();
 }
@@ -430,9 +615,16 @@ QMimeData* Clipboard::sanitizeData(QMimeData* data) const
 void Clipboard::onSystemClipboardChanged()
 {
     // This slot runs on the main thread where QApplication lives
-    QMutexLocker locker(&d->mutex);
-    d->addToHistoryIfNeeded();
+    QClipboard* sysClipboard = d->getSystemClipboard();
+    HistoryEntry entry;
+    const Private::HistoryUpdate update = d->addToHistory(sysClipboard ? sysClipboard->mimeData() : nullptr, entry);
+    if (update != Private::HistoryUpdate::None) {
+        emit historyChanged();
+    }
+    if (update == Private::HistoryUpdate::Added) {
+        emit historyItemAdded(entry);
+    }
     emit changed(); // Propagate the system change signal
 }
 
-} // namespace QuantilyxDoc
\ No newline at end of file
+} // namespace QuantilyxDoc
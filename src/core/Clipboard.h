@@ -15,6 +15,7 @@
 #include <QImage>
 #include <QByteArray>
 #include <QUrl>
+#include <QDateTime>
 #include <memory>
 
 namespace QuantilyxDoc {
@@ -33,16 +34,21 @@ class Clipboard : public QObject
 public:
     /**
      * @brief Represents an entry in the clipboard history.
+     *
+     * Only metadata is kept here; the payload is stored (compressed, and on
+     * disk when large) by the Clipboard and decoded by historyData() or
+     * restoreFromHistory().
      */
     struct HistoryEntry {
-        QMimeData* data;                  // The clipboard data
-        QDateTime timestamp;              // When it was added
+        QByteArray hash;                  // Content hash (hex SHA-256); copies of the same content share one entry
+        QDateTime timestamp;              // When it was last copied
         QString previewText;              // Short preview string
         QString dataType;                 // Primary data type (e.g., "text/plain", "image/png", "application/pdf")
-        qint64 dataSize;                  // Approximate size in bytes
+        qint64 dataSize;                  // Uncompressed size in bytes
+        qint64 storedSize;                // Bytes held in memory or on disk
+        bool onDisk;                      // Payload spilled to the cache directory
 
-        HistoryEntry() : data(nullptr), dataSize(0) {}
-        ~HistoryEntry() { delete data; } // Ensure data is cleaned up
+        HistoryEntry() : dataSize(0), storedSize(0), onDisk(false) {}
     };
 
     /**
@@ -188,11 +194,36 @@ public:
      */
     bool restoreFromHistory(int index);
 
+    /**
+     * @brief Decode a history entry.
+     * @param index Index of the item in the history list.
+     * @return New MIME data owned by the caller, or nullptr.
+     */
+    QMimeData* historyData(int index) const;
+
     /**
      * @brief Clear the clipboard history.
      */
     void clearHistory();
 
+    /**
+     * @brief Get the payload size above which history entries are written to disk.
+     * @return Threshold in bytes (after compression).
+     */
+    qint64 historySpillThreshold() const;
+
+    /**
+     * @brief Set the payload size above which history entries are written to disk.
+     * @param bytes Threshold in bytes (after compression); 0 keeps everything in memory.
+     */
+    void setHistorySpillThreshold(qint64 bytes);
+
+    /**
+     * @brief Get the memory held by history payloads.
+     * @return Bytes in memory (spilled payloads are not counted).
+     */
+    qint64 historyMemoryUsage() const;
+
     /**
      * @brief Get the MIME types currently available on the clipboard.
      * @return List of MIME type strings.
@@ -249,6 +280,8 @@ private slots:
 private:
     class Private;
     std::unique_ptr<Private> d;
+
+    static Clipboard* s_instance;
 };
 
 } // namespace QuantilyxDoc
@@ -22,6 +22,7 @@ public:
     Private() 
         : state(Unloaded)
         , modified(false)
+        , revision(0)
         , currentPageIndex(0)
     {}
     QString filePath;
@@ -35,6 +36,7 @@ public:
     QString lastError;
     qint64 fileSize;
     bool modified;
+    quint64 revision;
     int currentPageIndex;
     QString formatVersion;
     bool locked;
@@ -56,6 +58,22 @@ Document::~Document()
 {
 }
 
+std::function<QString()> Document::prepareCopy(const QString& filePath) const
+{
+    if (d->modified || d->filePath.isEmpty()) {
+        return nullptr;
+    }
+    const QString sourcePath = d->filePath;
+    return [sourcePath, filePath]() -> QString {
+        QFile::remove(filePath);
+        QFile source(sourcePath);
+        if (!source.copy(filePath)) {
+            return Document::tr("Failed to copy '%1': %2").arg(sourcePath, source.errorString());
+        }
+        return QString();
+    };
+}
+
 void Document::close()
 {
     setState(Unloaded);
@@ -118,6 +136,9 @@ bool Document::isModified() const
 
 void Document::setModified(bool modified)
 {
+    if (modified) {
+        ++d->revision;
+    }
     if (d->modified != modified) {
         d->modified = modified;
         if (modified) {
@@ -126,6 +147,11 @@ void Document::setModified(bool modified)
     }
 }
 
+quint64 Document::revision() const
+{
+    return d->revision;
+}
+
 bool Document::isLocked() const
 {
     return d->locked;
@@ -16,6 +16,7 @@
 #include <QSize>
 #include <QImage>
 #include <QList>
+#include <functional>
 #include <memory>
 
 namespace QuantilyxDoc {
@@ -88,6 +89,19 @@ public:
      */
     virtual bool save(const QString& filePath = QString()) = 0;
 
+    /**
+     * @brief Prepare writing the current state to a file, leaving the document as it is
+     *
+     * Unlike save(), filePath() and isModified() do not change. The edits are
+     * captured here, on the document's thread; the returned function does
+     * the writing and may run on any thread, even after further edits.
+     * The default copies the file of an unmodified document.
+     * @param filePath Path to write the copy to
+     * @return Writer returning an error message, empty on success; a null
+     *         function if this format cannot write copies of unsaved edits
+     */
+    virtual std::function<QString()> prepareCopy(const QString& filePath) const;
+
     /**
      * @brief Close document
      */
@@ -178,6 +192,13 @@ public:
      */
     void setModified(bool modified);
 
+    /**
+     * @brief Get the edit revision
+     * @return Counter advanced by every setModified(true), so it tells edits
+     *         apart even while the document stays modified
+     */
+    quint64 revision() const;
+
     /**
      * @brief Check if document is locked (read-only)
      * @return true if locked
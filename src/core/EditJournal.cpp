@@ -0,0 +1,327 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "EditJournal.h"
+#include "Logger.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <zlib.h>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace QuantilyxDoc {
+
+namespace {
+
+const char Magic[4] = {'Q', 'D', 'E', 'J'};
+constexpr quint32 Version = 1;
+constexpr qint64 HeaderSize = 4 + 4 + 8 + 8;    // magic, version, base size, base mtime
+constexpr qint64 FrameSize = 4 + 4;             // length, CRC-32
+constexpr quint32 MaxRecordSize = 64 * 1024 * 1024;
+
+quint32 checksum(const QByteArray& data)
+{
+    return static_cast<quint32>(::crc32(0L, reinterpret_cast<const Bytef*>(data.constData()),
+                                        static_cast<uInt>(data.size())));
+}
+
+QByteArray encodeRecord(const EditJournalRecord& record)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << static_cast<quint8>(record.op) << record.timeMs << record.type << record.payload
+        << static_cast<qint32>(record.argument);
+    return body;
+}
+
+bool decodeRecord(const QByteArray& body, EditJournalRecord& record)
+{
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint8 op = 0;
+    qint32 argument = 0;
+    in >> op >> record.timeMs >> record.type >> record.payload >> argument;
+    if (in.status() != QDataStream::Ok || op < 1 || op > static_cast<quint8>(EditJournalRecord::Op::Clear)) {
+        return false;
+    }
+    record.op = static_cast<EditJournalRecord::Op>(op);
+    record.argument = argument;
+    return true;
+}
+
+bool syncFile(QFile& file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_UNIX
+    return ::fdatasync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+} // namespace
+
+class EditJournal::Private {
+public:
+    QString documentPath;
+    QFile file;
+    qint64 baseSize = -1;
+    qint64 baseMtimeMs = 0;
+    QList<EditJournalRecord> pending;
+    bool writable = false;      // Header matches the document; appends allowed
+    bool dirty = false;
+
+    void fingerprintDocument(qint64& size, qint64& mtimeMs) const {
+        EditJournal::fingerprint(documentPath, size, mtimeMs);
+    }
+
+    // Read header and records; returns false if the header is missing or stale
+    bool readExisting() {
+        pending.clear();
+        if (file.size() < HeaderSize || !file.seek(0)) return false;
+
+        QDataStream in(&file);
+        in.setVersion(QDataStream::Qt_5_12);
+        char magic[4];
+        quint32 version = 0;
+        qint64 size = 0;
+        qint64 mtimeMs = 0;
+        if (in.readRawData(magic, 4) != 4 || std::memcmp(magic, Magic, 4) != 0) return false;
+        in >> version >> size >> mtimeMs;
+        if (in.status() != QDataStream::Ok || version != Version) return false;
+
+        qint64 currentSize = 0;
+        qint64 currentMtime = 0;
+        fingerprintDocument(currentSize, currentMtime);
+        if (size != currentSize || mtimeMs != currentMtime) {
+            LOG_WARN("Edit journal " << file.fileName() << " belongs to a different version of "
+                     << documentPath << "; ignoring it");
+            return false;
+        }
+
+        qint64 offset = HeaderSize;
+        while (true) {
+            quint32 length = 0;
+            quint32 crc = 0;
+            in >> length >> crc;
+            if (in.status() != QDataStream::Ok || length > MaxRecordSize) break;
+            QByteArray body(static_cast<int>(length), Qt::Uninitialized);
+            if (in.readRawData(body.data(), static_cast<int>(length)) != static_cast<int>(length)) break;
+
+            EditJournalRecord record;
+            if (checksum(body) != crc || !decodeRecord(body, record)) {
+                LOG_WARN("Edit journal " << file.fileName() << " has a corrupt record at offset " << offset
+                         << "; later records are ignored");
+                break;
+            }
+            offset += FrameSize + length;
+            record.endOffset = offset;
+            pending.append(record);
+        }
+        return true;
+    }
+
+    bool writeHeader() {
+        fingerprintDocument(baseSize, baseMtimeMs);
+        if (!file.resize(0) || !file.seek(0)) return false;
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_5_12);
+        out.writeRawData(Magic, 4);
+        out << Version << baseSize << baseMtimeMs;
+        return out.status() == QDataStream::Ok && syncFile(file);
+    }
+};
+
+EditJournal::EditJournal()
+    : d(new Private())
+{
+}
+
+EditJournal::~EditJournal()
+{
+    close();
+}
+
+QString EditJournal::journalPathFor(const QString& documentPath)
+{
+    const QFileInfo info(documentPath);
+    const QFileInfo dirInfo(info.absolutePath());
+    if (dirInfo.isDir() && dirInfo.isWritable()) {
+        return QDir(info.absolutePath()).filePath("." + info.fileName() + ".qdjournal");
+    }
+
+    // Read-only location: keep the journal with the application data instead
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journals";
+    QDir().mkpath(dir);
+    const QByteArray key = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex();
+    return QDir(dir).filePath(QString::fromLatin1(key) + ".qdjournal");
+}
+
+void EditJournal::fingerprint(const QString& documentPath, qint64& size, qint64& mtimeMs)
+{
+    const QFileInfo info(documentPath);
+    size = info.exists() ? info.size() : -1;
+    mtimeMs = info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+bool EditJournal::rebase(const QString& documentPath, qint64 previousSize, qint64 previousMtimeMs)
+{
+    QFile file(journalPathFor(documentPath));
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadWrite)) {
+        LOG_ERROR("Cannot open edit journal " << file.fileName() << ": " << file.errorString());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    char magic[4];
+    quint32 version = 0;
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+    if (stream.readRawData(magic, 4) != 4 || std::memcmp(magic, Magic, 4) != 0) return true;
+    stream >> version >> size >> mtimeMs;
+    if (stream.status() != QDataStream::Ok || version != Version) return true;
+    if (size != previousSize || mtimeMs != previousMtimeMs) return true; // Keyed to another version
+
+    fingerprint(documentPath, size, mtimeMs);
+    if (!file.seek(HeaderSize - 8 - 8)) return false;
+    stream << size << mtimeMs;
+    if (stream.status() != QDataStream::Ok || !syncFile(file)) {
+        LOG_ERROR("Cannot re-key edit journal " << file.fileName() << ": " << file.errorString());
+        return false;
+    }
+    LOG_DEBUG("Re-keyed edit journal " << file.fileName() << " to the updated " << documentPath);
+    return true;
+}
+
+bool EditJournal::open(const QString& documentPath)
+{
+    close();
+    d->documentPath = documentPath;
+    d->file.setFileName(journalPathFor(documentPath));
+    if (!d->file.open(QIODevice::ReadWrite)) {
+        LOG_ERROR("Cannot open edit journal " << d->file.fileName() << ": " << d->file.errorString());
+        return false;
+    }
+    d->readExisting();
+    if (!d->pending.isEmpty()) {
+        LOG_INFO("Edit journal " << d->file.fileName() << " holds " << d->pending.size()
+                 << " records from a previous session");
+    }
+    return true;
+}
+
+void EditJournal::close()
+{
+    if (d->file.isOpen()) {
+        if (d->dirty) {
+            syncFile(d->file);
+        }
+        d->file.close();
+    }
+    d->pending.clear();
+    d->writable = false;
+    d->dirty = false;
+}
+
+void EditJournal::remove()
+{
+    const QString journalPath = d->file.fileName();
+    close();
+    if (!journalPath.isEmpty()) {
+        QFile::remove(journalPath);
+    }
+}
+
+bool EditJournal::isOpen() const
+{
+    return d->file.isOpen();
+}
+
+QList<EditJournalRecord> EditJournal::pendingRecords() const
+{
+    return d->pending;
+}
+
+bool EditJournal::keepPending(qint64 endOffset)
+{
+    if (!d->file.isOpen()) return false;
+    // Cut off the torn tail (or records that could not be replayed)
+    if (!d->file.resize(qMax(HeaderSize, endOffset)) || !d->file.seek(d->file.size())) {
+        LOG_ERROR("Cannot truncate edit journal " << d->file.fileName() << ": " << d->file.errorString());
+        return false;
+    }
+    d->pending.clear();
+    d->writable = true;
+    return syncFile(d->file);
+}
+
+bool EditJournal::reset()
+{
+    if (!d->file.isOpen()) return false;
+    d->pending.clear();
+    d->dirty = false;
+    d->writable = d->writeHeader();
+    if (!d->writable) {
+        LOG_ERROR("Cannot write edit journal " << d->file.fileName() << ": " << d->file.errorString());
+    }
+    return d->writable;
+}
+
+bool EditJournal::append(const EditJournalRecord& record)
+{
+    if (!d->writable) return false;
+
+    const QByteArray body = encodeRecord(record);
+    QByteArray frame;
+    frame.reserve(FrameSize + body.size());
+    {
+        QDataStream out(&frame, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << static_cast<quint32>(body.size()) << checksum(body);
+    }
+    frame.append(body);
+
+    // One write per record, handed to the OS right away; durability comes from sync()
+    if (d->file.write(frame) != frame.size() || !d->file.flush()) {
+        LOG_ERROR("Cannot append to edit journal " << d->file.fileName() << ": " << d->file.errorString());
+        return false;
+    }
+    d->dirty = true;
+    return true;
+}
+
+bool EditJournal::sync()
+{
+    if (!d->dirty) return true;
+    d->dirty = false;
+    return syncFile(d->file);
+}
+
+bool EditJournal::needsSync() const
+{
+    return d->dirty;
+}
+
+QString EditJournal::path() const
+{
+    return d->file.fileName();
+}
+
+} // namespace QuantilyxDoc
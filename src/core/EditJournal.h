@@ -0,0 +1,165 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_EDITJOURNAL_H
+#define QUANTILYX_EDITJOURNAL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief One record of the edit journal.
+ */
+struct EditJournalRecord {
+    enum class Op : quint8 {
+        Push = 1,       // Command pushed (type + payload)
+        Undo = 2,
+        Redo = 3,
+        SetIndex = 4,   // Jump to index (argument)
+        CloseMerge = 5, // End of a continuous edit
+        BeginMacro = 6, // Macro started (text)
+        EndMacro = 7,
+        Barrier = 8,    // A command that cannot be journaled was pushed
+        Clear = 9       // History cleared (edits stay applied)
+    };
+
+    Op op = Op::Push;
+    qint64 timeMs = 0;      // Wall-clock time of the edit
+    QString type;           // Push: command journal type; BeginMacro: macro text
+    QByteArray payload;     // Push: serialized command
+    int argument = 0;       // SetIndex: target index
+    qint64 endOffset = 0;   // File offset just past this record (set when reading)
+};
+
+/**
+ * @brief Append-only, checksummed journal of the edits made to a document.
+ *
+ * Lives next to the document as ".<file name>.qdjournal" (or in the
+ * application data directory if that is not writable). The header records
+ * the size and modification time of the saved file the edits apply to, so
+ * a journal left over from a crash is only replayed over that same file.
+ *
+ * Each record is framed as [length][CRC-32][body]; appends are sequential
+ * writes handed to the OS immediately, and sync() makes them durable with
+ * one fdatasync, so callers can sync periodically rather than per edit.
+ * On reading, the first truncated or corrupt record ends the journal (a torn
+ * tail from a crash) and is cut off before further appends.
+ *
+ * Not thread-safe; UndoStack drives it from the GUI thread.
+ */
+class EditJournal
+{
+public:
+    EditJournal();
+    ~EditJournal();
+
+    /**
+     * @brief Get the journal path for a document.
+     */
+    static QString journalPathFor(const QString& documentPath);
+
+    /**
+     * @brief Get the fingerprint a journal header records for a document file.
+     * @param documentPath Document file.
+     * @param size Receives the file size, or -1 if it does not exist.
+     * @param mtimeMs Receives the modification time in ms since the epoch.
+     */
+    static void fingerprint(const QString& documentPath, qint64& size, qint64& mtimeMs);
+
+    /**
+     * @brief Re-key a document's journal to its current file.
+     *
+     * For in-place updates that leave the journaled edits valid, such as an
+     * appended OCR text layer: the header is rewritten only if it still
+     * matches the previous version of the file, so a journal of another
+     * version is never adopted. Works on the file directly, whether or not
+     * an EditJournal (in any process) has it open.
+     * @param documentPath Document file, already updated.
+     * @param previousSize File size before the update.
+     * @param previousMtimeMs Modification time before the update.
+     * @return True if there was no journal or it was re-keyed.
+     */
+    static bool rebase(const QString& documentPath, qint64 previousSize, qint64 previousMtimeMs);
+
+    /**
+     * @brief Open the journal for a document without modifying it.
+     * Existing valid records become pendingRecords() if they apply to the
+     * document's current file.
+     * @param documentPath Path of the saved document.
+     * @return True if the journal could be opened or created.
+     */
+    bool open(const QString& documentPath);
+
+    /**
+     * @brief Close the journal file, keeping it on disk.
+     */
+    void close();
+
+    /**
+     * @brief Close and delete the journal (clean shutdown of the document).
+     */
+    void remove();
+
+    /**
+     * @brief Check if the journal is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the records left by a previous session that can be replayed.
+     */
+    QList<EditJournalRecord> pendingRecords() const;
+
+    /**
+     * @brief Keep the pending records up to (and including) the one ending at offset
+     * and continue appending after them.
+     * @param endOffset endOffset of the last record to keep.
+     */
+    bool keepPending(qint64 endOffset);
+
+    /**
+     * @brief Discard all records and start a new journal for the document's current file.
+     * Call after opening without recovering, and after each save.
+     */
+    bool reset();
+
+    /**
+     * @brief Append a record (written to the OS, not yet fsynced).
+     * @return True on success.
+     */
+    bool append(const EditJournalRecord& record);
+
+    /**
+     * @brief Make appended records durable.
+     * @return True on success.
+     */
+    bool sync();
+
+    /**
+     * @brief Check if records were appended since the last sync().
+     */
+    bool needsSync() const;
+
+    /**
+     * @brief Get the journal file path.
+     */
+    QString path() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_EDITJOURNAL_H
@@ -9,6 +9,7 @@
  */
 #include "IntelligentCache.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QDateTime>
@@ -93,11 +94,11 @@ public:
             if (!keyToEvict.isEmpty()) {
                 CachedItem item = cacheData.take(keyToEvict);
                 currentSizeBytes -= item.sizeBytes;
-                LOG_DEBUG("Evicted item from cache: " << keyToEvict << ", Size: " << item.sizeBytes);
+                LOG_BTRACE("Evicted item from cache: {}, Size: {}", keyToEvict, item.sizeBytes);
                 emit q->itemRemoved(keyToEvict, item.sizeBytes);
             } else {
                 // Should not happen if cacheData is not empty
-                LOG_WARN("Cache size exceeded limit but no item found for eviction!");
+                LOG_CWARN(lcCache, "Cache size exceeded limit but no item found for eviction!");
                 break; // Avoid infinite loop
             }
         }
@@ -158,7 +159,7 @@ bool IntelligentCache::put(const QString& key, const QVariant& data, qint64 size
     if (existingIt != d->cacheData.end()) {
         d->currentSizeBytes -= existingIt->sizeBytes;
         d->cacheData.erase(existingIt);
-        LOG_DEBUG("Replacing existing item in cache: " << key);
+        LOG_BTRACE("Replacing existing item in cache: {}", key);
     }
 
     CachedItem item;
@@ -193,9 +194,11 @@ QVariant IntelligentCache::get(const QString& key)
         // Optionally bump priority based on access or prediction model
         it->priority += 0.1; // Simple bump
 
+        LOG_BTRACE("Cache hit: {}", key);
         emit q->statisticsChanged(); // Access stats changed
         return it->data;
     }
+    LOG_BTRACE("Cache miss: {}", key);
     return QVariant(); // Not found
 }
 
@@ -227,7 +230,7 @@ void IntelligentCache::clear()
     int oldCount = d->cacheData.size();
     d->cacheData.clear();
     d->currentSizeBytes = 0;
-    LOG_DEBUG("Cleared entire cache. Removed " << oldCount << " items, freed " << oldSize << " bytes.");
+    LOG_CDEBUG(lcCache, "Cleared entire cache. Removed " << oldCount << " items, freed " << oldSize << " bytes.");
     emit cacheSizeChanged(0, 0);
 }
 
@@ -243,7 +246,7 @@ void IntelligentCache::setMaxSizeBytes(qint64 size)
     QWriteLocker locker(&d->dataLock);
     if (d->maxSizeBytes != size) {
         d->maxSizeBytes = size;
-        LOG_INFO("Cache max size changed to " << size << " bytes. Triggering eviction if necessary.");
+        LOG_CINFO(lcCache, "Cache max size changed to " << size << " bytes. Triggering eviction if necessary.");
         d->evictIfNeeded(); // Enforce new limit
     }
 }
@@ -271,7 +274,7 @@ void IntelligentCache::setEvictionPolicy(EvictionPolicy policy)
     QWriteLocker locker(&d->dataLock);
     if (d->evictionPolicy != policy) {
         d->evictionPolicy = policy;
-        LOG_INFO("Cache eviction policy changed to " << static_cast<int>(policy));
+        LOG_CINFO(lcCache, "Cache eviction policy changed to " << static_cast<int>(policy));
         // Consider re-sorting/triggering eviction based on new policy immediately?
         // This could be expensive. Maybe just apply the new policy on next put/evict.
     }
@@ -296,10 +299,10 @@ void IntelligentCache::hintAccess(const QString& key)
         // Bump priority or move to front based on policy
         it->priority += 0.5; // Significant bump for a hint
         it->lastAccessTime = QDateTime::currentDateTime(); // Update time
-        LOG_DEBUG("Hinted access for item: " << key);
+        LOG_BTRACE("Hinted access for item: {}", key);
     } else {
         // Item not in cache, could trigger a pre-load based on prediction
-        LOG_DEBUG("Hinted access for non-existent item: " << key << ". Could trigger pre-load.");
+        LOG_CDEBUG(lcCache, "Hinted access for non-existent item: " << key << ". Could trigger pre-load.");
     }
 }
 
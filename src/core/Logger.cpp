@@ -9,6 +9,7 @@
  */
 
 #include "Logger.h"
+#include "BinaryLog.h"
 
 #include <QFile>
 #include <QTextStream>
@@ -17,17 +18,21 @@
 #include <QDir>
 #include <QStandardPaths>
 #include <QFileInfo>
+#include <QHash>
+#include <QList>
 #include <iostream>
 
 namespace QuantilyxDoc {
 
+QUANTILYX_LOG_CATEGORY(lcRender, "render")
+QUANTILYX_LOG_CATEGORY(lcCache, "cache")
+
 // Private implementation
 class Logger::Private
 {
 public:
     Private() 
-        : level(LogLevel::Info)
-        , consoleOutput(false)
+        : consoleOutput(false)
         , fileOutput(true)
         , timestamps(true)
         , threadIds(false)
@@ -44,7 +49,6 @@ public:
         }
     }
 
-    LogLevel level;
     bool consoleOutput;
     bool fileOutput;
     bool timestamps;
@@ -54,11 +58,20 @@ public:
     int maxFiles;
     QString logFilePath;
     QFile* logFile;
+
+    // Category overrides by name, and every category seen so far
+    QHash<QString, int> categoryLevels;
+    QList<LogCategory*> categories;
+
+    void applyCategoryLevel(LogCategory* category) const {
+        category->setThreshold(categoryLevels.value(QString::fromLatin1(category->name()), -1));
+    }
 };
 
 Logger::Logger()
     : QObject(nullptr)
     , d(new Private())
+    , m_threshold(static_cast<int>(LogLevel::Info))
 {
 }
 
@@ -77,7 +90,7 @@ void Logger::initialize(LogLevel level, const QString& logFile)
 {
     QMutexLocker locker(&mutex);
     
-    d->level = level;
+    m_threshold.store(static_cast<int>(level), std::memory_order_relaxed);
     
     // Determine log file path
     if (logFile.isEmpty()) {
@@ -104,19 +117,76 @@ void Logger::initialize(LogLevel level, const QString& logFile)
     // Log initialization
     log(LogLevel::Info, "=== Logger initialized ===");
     log(LogLevel::Info, QString("Log file: %1").arg(d->logFilePath));
-    log(LogLevel::Info, QString("Log level: %1").arg(levelString(d->level)));
+    log(LogLevel::Info, QString("Log level: %1").arg(levelString(level)));
 }
 
 void Logger::setLogLevel(LogLevel level)
 {
-    QMutexLocker locker(&mutex);
-    d->level = level;
+    m_threshold.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 LogLevel Logger::logLevel() const
 {
-    QMutexLocker locker(&const_cast<QMutex&>(mutex));
-    return d->level;
+    return static_cast<LogLevel>(m_threshold.load(std::memory_order_relaxed));
+}
+
+void Logger::setCategoryLevel(const QString& category, LogLevel level)
+{
+    QMutexLocker locker(&mutex);
+    d->categoryLevels.insert(category, static_cast<int>(level));
+    for (LogCategory* registered : d->categories) {
+        if (category == QLatin1String(registered->name())) {
+            registered->setThreshold(static_cast<int>(level));
+        }
+    }
+}
+
+void Logger::resetCategoryLevel(const QString& category)
+{
+    QMutexLocker locker(&mutex);
+    d->categoryLevels.remove(category);
+    for (LogCategory* registered : d->categories) {
+        if (category == QLatin1String(registered->name())) {
+            registered->setThreshold(-1);
+        }
+    }
+}
+
+void Logger::setCategoryRules(const QString& rules)
+{
+    const QStringList entries = rules.split(',', Qt::SkipEmptyParts);
+    for (const QString& entry : entries) {
+        const int eq = entry.indexOf('=');
+        if (eq <= 0) {
+            continue;
+        }
+        bool ok = false;
+        LogLevel level = levelFromString(entry.mid(eq + 1).trimmed(), &ok);
+        if (ok) {
+            setCategoryLevel(entry.left(eq).trimmed(), level);
+        }
+    }
+}
+
+void Logger::registerCategory(LogCategory* category)
+{
+    QMutexLocker locker(&mutex);
+    d->categories.append(category);
+    d->applyCategoryLevel(category);
+}
+
+LogLevel Logger::levelFromString(const QString& name, bool* ok)
+{
+    const QString lower = name.toLower();
+    if (ok) *ok = true;
+    if (lower == "trace") return LogLevel::Trace;
+    if (lower == "debug") return LogLevel::Debug;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "warning" || lower == "warn") return LogLevel::Warning;
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "critical") return LogLevel::Critical;
+    if (ok) *ok = false;
+    return LogLevel::Info;
 }
 
 void Logger::setConsoleOutput(bool enable)
@@ -131,6 +201,26 @@ void Logger::setFileOutput(bool enable)
     d->fileOutput = enable;
 }
 
+void Logger::setBinaryOutput(bool enable)
+{
+    if (!enable) {
+        BinaryLog::instance().close();
+        return;
+    }
+
+    QString path;
+    {
+        QMutexLocker locker(&mutex);
+        path = d->logFilePath;
+    }
+    if (path.isEmpty()) {
+        path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+               "/quantilyxdoc/logs/quantilyxdoc.log";
+        QDir().mkpath(QFileInfo(path).absolutePath());
+    }
+    BinaryLog::instance().open(path + ".qlb");
+}
+
 void Logger::setLogFilePath(const QString& filePath)
 {
     QMutexLocker locker(&mutex);
@@ -187,17 +277,18 @@ void Logger::setMaxFiles(int count)
 }
 
 void Logger::log(LogLevel level, const QString& message, 
-                const char* file, int line, const char* function)
+                const char* file, int line, const char* function,
+                const LogCategory* category)
 {
-    QMutexLocker locker(&mutex);
-    
     // Check if message should be logged
-    if (level < d->level) {
+    if (category ? !category->isEnabled(level) : !isEnabled(level)) {
         return;
     }
     
+    QMutexLocker locker(&mutex);
+    
     // Format message
-    QString formattedMessage = formatMessage(level, message, file, line, function);
+    QString formattedMessage = formatMessage(level, message, file, line, function, category);
     
     // Output to console
     if (d->consoleOutput) {
@@ -225,6 +316,7 @@ void Logger::flush()
     if (d->logFile) {
         d->logFile->flush();
     }
+    BinaryLog::instance().flush();
 }
 
 void Logger::clear()
@@ -275,7 +367,8 @@ void Logger::rotate()
 }
 
 QString Logger::formatMessage(LogLevel level, const QString& message,
-                              const char* file, int line, const char* function) const
+                              const char* file, int line, const char* function,
+                              const LogCategory* category) const
 {
     QString formatted;
     
@@ -287,6 +380,11 @@ QString Logger::formatMessage(LogLevel level, const QString& message,
     // Level
     formatted += QString("[%1] ").arg(levelString(level));
     
+    // Category
+    if (category) {
+        formatted += QString("[%1] ").arg(QLatin1String(category->name()));
+    }
+    
     // Thread ID
     if (d->threadIds) {
         formatted += QString("[Thread 0x%1] ")
@@ -313,6 +411,7 @@ QString Logger::formatMessage(LogLevel level, const QString& message,
 QString Logger::levelString(LogLevel level) const
 {
     switch (level) {
+        case LogLevel::Trace:    return "TRACE";
         case LogLevel::Debug:    return "DEBUG";
         case LogLevel::Info:     return "INFO ";
         case LogLevel::Warning:  return "WARN ";
@@ -14,9 +14,21 @@
 #include <QString>
 #include <QObject>
 #include <QMutex>
+#include <atomic>
 #include <memory>
 #include <sstream>
 
+/**
+ * @brief Minimum log level compiled into the binary
+ *
+ * Statements below this level are removed by the compiler. The value maps onto
+ * LogLevel (0 = Trace ... 5 = Critical) and is normally set by the
+ * LOG_MIN_LEVEL CMake option.
+ */
+#ifndef QUANTILYX_LOG_MIN_LEVEL
+#define QUANTILYX_LOG_MIN_LEVEL 0
+#endif
+
 namespace QuantilyxDoc {
 
 /**
@@ -24,6 +36,7 @@ namespace QuantilyxDoc {
  */
 enum class LogLevel
 {
+    Trace,      ///< Fine-grained tracing (hot paths)
     Debug,      ///< Debug messages
     Info,       ///< Informational messages
     Warning,    ///< Warning messages
@@ -31,6 +44,8 @@ enum class LogLevel
     Critical    ///< Critical error messages
 };
 
+class LogCategory;
+
 /**
  * @brief Logger class - Singleton pattern
  * 
@@ -71,6 +86,46 @@ public:
      */
     LogLevel logLevel() const;
 
+    /**
+     * @brief Check whether a message at the given level would be logged
+     *
+     * Lock-free; used by the logging macros before any argument is evaluated.
+     * @param level Log level
+     * @return true if the level passes the runtime threshold
+     */
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= m_threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set runtime level for a category
+     *
+     * Applies to categories already registered and to those registered later.
+     * @param category Category name (e.g. "render")
+     * @param level Minimum log level for that category
+     */
+    void setCategoryLevel(const QString& category, LogLevel level);
+
+    /**
+     * @brief Remove a category override so it follows the global level again
+     * @param category Category name
+     */
+    void resetCategoryLevel(const QString& category);
+
+    /**
+     * @brief Configure category levels from a rule string
+     *
+     * Format: "render=trace,cache=warning". Unknown level names are ignored.
+     * @param rules Comma-separated category=level pairs
+     */
+    void setCategoryRules(const QString& rules);
+
+    /**
+     * @brief Register a category (called by LogCategory)
+     * @param category Category to register
+     */
+    void registerCategory(LogCategory* category);
+
     /**
      * @brief Enable/disable console output
      * @param enable true to enable console output
@@ -83,6 +138,15 @@ public:
      */
     void setFileOutput(bool enable);
 
+    /**
+     * @brief Enable/disable the binary structured log
+     *
+     * Opens BinaryLog next to the text log ("<logfile>.qlb") so LOG_B* events
+     * are recorded. Decode with quantilyxdoc-logdecode.
+     * @param enable true to enable binary output
+     */
+    void setBinaryOutput(bool enable);
+
     /**
      * @brief Set log file path
      * @param filePath Path to log file
@@ -132,9 +196,11 @@ public:
      * @param file Source file name
      * @param line Line number
      * @param function Function name
+     * @param category Category the message belongs to (nullptr for none)
      */
     void log(LogLevel level, const QString& message, 
-            const char* file = nullptr, int line = 0, const char* function = nullptr);
+            const char* file = nullptr, int line = 0, const char* function = nullptr,
+            const LogCategory* category = nullptr);
 
     /**
      * @brief Flush log buffers
@@ -151,6 +217,14 @@ public:
      */
     void rotate();
 
+    /**
+     * @brief Parse a level name ("trace", "debug", ...)
+     * @param name Level name
+     * @param ok Set to false if the name is unknown
+     * @return Parsed level
+     */
+    static LogLevel levelFromString(const QString& name, bool* ok = nullptr);
+
 signals:
     /**
      * @brief Emitted when a message is logged
@@ -182,10 +256,12 @@ private:
      * @param file Source file
      * @param line Line number
      * @param function Function name
+     * @param category Category (may be nullptr)
      * @return Formatted message
      */
     QString formatMessage(LogLevel level, const QString& message,
-                         const char* file, int line, const char* function) const;
+                         const char* file, int line, const char* function,
+                         const LogCategory* category) const;
 
     /**
      * @brief Get level string
@@ -209,6 +285,44 @@ private:
     class Private;
     std::unique_ptr<Private> d;
     QMutex mutex;
+    std::atomic<int> m_threshold;
+};
+
+/**
+ * @brief Named log category with its own runtime level
+ *
+ * Categories are declared with QUANTILYX_LOG_CATEGORY and default to the
+ * global level until Logger::setCategoryLevel() overrides them.
+ */
+class LogCategory
+{
+public:
+    explicit LogCategory(const char* name)
+        : m_name(name), m_level(-1) {
+        Logger::instance().registerCategory(this);
+    }
+
+    const char* name() const { return m_name; }
+
+    bool isEnabled(LogLevel level) const {
+        int threshold = m_level.load(std::memory_order_relaxed);
+        if (threshold < 0) {
+            return Logger::instance().isEnabled(level);
+        }
+        return static_cast<int>(level) >= threshold;
+    }
+
+    /**
+     * @brief Set category level; -1 follows the global level
+     */
+    void setThreshold(int threshold) { m_level.store(threshold, std::memory_order_relaxed); }
+
+private:
+    LogCategory(const LogCategory&) = delete;
+    LogCategory& operator=(const LogCategory&) = delete;
+
+    const char* m_name;
+    std::atomic<int> m_level;
 };
 
 /**
@@ -217,12 +331,13 @@ private:
 class LogStream
 {
 public:
-    LogStream(LogLevel level, const char* file, int line, const char* function)
-        : m_level(level), m_file(file), m_line(line), m_function(function) {}
+    LogStream(LogLevel level, const char* file, int line, const char* function,
+              const LogCategory* category = nullptr)
+        : m_level(level), m_file(file), m_line(line), m_function(function), m_category(category) {}
     
     ~LogStream() {
         Logger::instance().log(m_level, QString::fromStdString(m_stream.str()), 
-                              m_file, m_line, m_function);
+                              m_file, m_line, m_function, m_category);
     }
     
     template<typename T>
@@ -246,16 +361,60 @@ private:
     const char* m_file;
     int m_line;
     const char* m_function;
+    const LogCategory* m_category;
     std::ostringstream m_stream;
 };
 
 } // namespace QuantilyxDoc
 
+// Declare/define a log category accessor, e.g. QUANTILYX_LOG_CATEGORY(lcRender, "render")
+#define QUANTILYX_DECLARE_LOG_CATEGORY(accessor) \
+    QuantilyxDoc::LogCategory& accessor();
+#define QUANTILYX_LOG_CATEGORY(accessor, name) \
+    QuantilyxDoc::LogCategory& accessor() { \
+        static QuantilyxDoc::LogCategory category(name); \
+        return category; \
+    }
+
+namespace QuantilyxDoc {
+// Shared categories for hot paths (defined in Logger.cpp)
+QUANTILYX_DECLARE_LOG_CATEGORY(lcRender)
+QUANTILYX_DECLARE_LOG_CATEGORY(lcCache)
+} // namespace QuantilyxDoc
+
+// Level checks happen before the message expression is evaluated; levels below
+// QUANTILYX_LOG_MIN_LEVEL are folded away at compile time.
+#define QUANTILYX_LOG_COMPILED(level) \
+    (static_cast<int>(level) >= QUANTILYX_LOG_MIN_LEVEL)
+
+#define QUANTILYX_LOG(level, msg) \
+    do { \
+        if (QUANTILYX_LOG_COMPILED(level) && QuantilyxDoc::Logger::instance().isEnabled(level)) { \
+            QuantilyxDoc::LogStream(level, __FILE__, __LINE__, __FUNCTION__) << msg; \
+        } \
+    } while (0)
+
+#define QUANTILYX_CLOG(category, level, msg) \
+    do { \
+        if (QUANTILYX_LOG_COMPILED(level) && (category)().isEnabled(level)) { \
+            QuantilyxDoc::LogStream(level, __FILE__, __LINE__, __FUNCTION__, &(category)()) << msg; \
+        } \
+    } while (0)
+
 // Convenient logging macros
-#define LOG_DEBUG   QuantilyxDoc::LogStream(QuantilyxDoc::LogLevel::Debug, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_INFO    QuantilyxDoc::LogStream(QuantilyxDoc::LogLevel::Info, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_WARNING QuantilyxDoc::LogStream(QuantilyxDoc::LogLevel::Warning, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_ERROR   QuantilyxDoc::LogStream(QuantilyxDoc::LogLevel::Error, __FILE__, __LINE__, __FUNCTION__)
-#define LOG_CRITICAL QuantilyxDoc::LogStream(QuantilyxDoc::LogLevel::Critical, __FILE__, __LINE__, __FUNCTION__)
+#define LOG_TRACE(msg)    QUANTILYX_LOG(QuantilyxDoc::LogLevel::Trace, msg)
+#define LOG_DEBUG(msg)    QUANTILYX_LOG(QuantilyxDoc::LogLevel::Debug, msg)
+#define LOG_INFO(msg)     QUANTILYX_LOG(QuantilyxDoc::LogLevel::Info, msg)
+#define LOG_WARN(msg)     QUANTILYX_LOG(QuantilyxDoc::LogLevel::Warning, msg)
+#define LOG_WARNING(msg)  QUANTILYX_LOG(QuantilyxDoc::LogLevel::Warning, msg)
+#define LOG_ERROR(msg)    QUANTILYX_LOG(QuantilyxDoc::LogLevel::Error, msg)
+#define LOG_CRITICAL(msg) QUANTILYX_LOG(QuantilyxDoc::LogLevel::Critical, msg)
+
+// Category logging macros
+#define LOG_CTRACE(category, msg) QUANTILYX_CLOG(category, QuantilyxDoc::LogLevel::Trace, msg)
+#define LOG_CDEBUG(category, msg) QUANTILYX_CLOG(category, QuantilyxDoc::LogLevel::Debug, msg)
+#define LOG_CINFO(category, msg)  QUANTILYX_CLOG(category, QuantilyxDoc::LogLevel::Info, msg)
+#define LOG_CWARN(category, msg)  QUANTILYX_CLOG(category, QuantilyxDoc::LogLevel::Warning, msg)
+#define LOG_CERROR(category, msg) QUANTILYX_CLOG(category, QuantilyxDoc::LogLevel::Error, msg)
 
 #endif // QUANTILYX_LOGGER_H
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include <QRectF>
 #include <QPointF>
 #include <QVariantMap>
+#include <QMutex>
+#include <QMutexLocker>
 
 namespace QuantilyxDoc {
 
@@ -35,6 +37,7 @@ public:
     QList<Annotation*> annotations;
     PageContent* content;
     PageRenderer* renderer;
+    std::shared_ptr<PageTextLayer> textLayer; // Shared with background readers
 };
 
 Page::Page(Document* document, QObject* parent)
@@ -44,10 +47,13 @@ Page::Page(Document* document, QObject* parent)
 {
     d->content = nullptr;
     d->renderer = nullptr;
+    d->textLayer.reset(new PageTextLayer(this));
+    connect(this, &Page::contentChanged, this, &Page::invalidateText);
 }
 
 Page::~Page()
 {
+    detachTextLayer();
     qDeleteAll(d->annotations);
 }
 
@@ -127,11 +133,64 @@ PageRenderer* Page::renderer() const
     return d->renderer;
 }
 
+QImage Page::renderForDisplay(int width, int height, int dpi)
+{
+    return render(width, height, dpi);
+}
+
 QString Page::text() const
 {
     return QString();
 }
 
+QString Page::cachedText() const
+{
+    return d->textLayer->text();
+}
+
+std::shared_ptr<PageTextLayer> Page::textLayer() const
+{
+    return d->textLayer;
+}
+
+void Page::invalidateText()
+{
+    QMutexLocker locker(&d->textLayer->m_mutex);
+    d->textLayer->m_text.clear();
+    d->textLayer->m_valid = false;
+}
+
+void Page::detachTextLayer()
+{
+    // Extraction holds the lock while it calls text(), so this waits for it
+    QMutexLocker locker(&d->textLayer->m_mutex);
+    d->textLayer->m_page = nullptr;
+}
+
+// --- PageTextLayer ---
+
+PageTextLayer::PageTextLayer(const Page* page)
+    : m_page(page)
+    , m_valid(false)
+{
+}
+
+QString PageTextLayer::text()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_valid && m_page) {
+        m_text = m_page->text();
+        m_valid = true;
+    }
+    return m_text;
+}
+
+bool PageTextLayer::isExtracted() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_valid;
+}
+
 QList<QRectF> Page::searchText(const QString& text, bool caseSensitive, bool wholeWords) const
 {
     Q_UNUSED(text);
@@ -169,7 +228,10 @@ void Page::setSize(const QSizeF& size)
 
 void Page::setRotation(PageRotation rotation)
 {
-    d->rotation = rotation;
+    if (d->rotation != rotation) {
+        d->rotation = rotation;
+        emit contentChanged();
+    }
 }
 
 void Page::setLabel(const QString& label)
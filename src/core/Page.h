@@ -15,6 +15,8 @@
 #include <QRectF>
 #include <QImage>
 #include <QList>
+#include <QMutex>
+#include <QString>
 #include <memory>
 
 namespace QuantilyxDoc {
@@ -45,11 +47,49 @@ enum class PageLayout
     BookView        ///< Book view with facing pages and odd pages on right
 };
 
+/**
+ * @brief Text layer of a page, shared with readers on other threads
+ *
+ * Extracts the page text on first use, on whichever thread asks first, and
+ * keeps it until the page content changes. Holders may outlive the page:
+ * after the page is destroyed text() returns what was extracted, or an
+ * empty string. Thread-safe.
+ */
+class PageTextLayer
+{
+public:
+    /**
+     * @brief Get the page text, extracting it if needed
+     * @return Text content
+     */
+    QString text();
+
+    /**
+     * @brief Check if the text has been extracted
+     */
+    bool isExtracted() const;
+
+private:
+    friend class Page;
+    explicit PageTextLayer(const Page* page);
+
+    mutable QMutex m_mutex;
+    const Page* m_page;     // Null once the page is destroyed
+    QString m_text;
+    bool m_valid;
+};
+
 /**
  * @brief Base page class
  * 
  * Abstract base class for all document pages. Provides common interface
  * for page operations like rendering, hit testing, and content access.
+ *
+ * Threading: pages belong to the GUI thread, but render() and text() may
+ * be called from worker threads as long as the caller guarantees that the
+ * document outlives the call (the OCR pipeline renders this way). Work that
+ * cannot guarantee it, such as a selection copy outliving its document,
+ * holds textLayer() instead of the page.
  */
 class Page : public QObject
 {
@@ -84,6 +124,13 @@ public:
      */
     PageRotation rotation() const;
     
+    /**
+     * @brief Set page rotation
+     * Public so edits can rotate pages (see RotatePageCommand).
+     * @param rotation Page rotation
+     */
+    void setRotation(PageRotation rotation);
+    
     /**
      * @brief Get page label (custom page number)
      * @return Page label or empty string if none
@@ -146,6 +193,18 @@ public:
      * @return Rendered image
      */
     virtual QImage render(int width, int height, int dpi = 72) = 0;
+
+    /**
+     * @brief Render page to image for on-screen display
+     *
+     * Formats whose annotations DocumentView draws as an overlay leave them
+     * out here; printing, export and OCR use render(). Defaults to render().
+     * @param width Target width in pixels
+     * @param height Target height in pixels
+     * @param dpi DPI for rendering
+     * @return Rendered image
+     */
+    virtual QImage renderForDisplay(int width, int height, int dpi = 72);
     
     /**
      * @brief Get text content of page
@@ -153,6 +212,29 @@ public:
      */
     virtual QString text() const;
     
+    /**
+     * @brief Get the page text, extracting it on first use
+     * The text is kept until the page content changes. Thread-safe, but
+     * extraction can be slow: the GUI thread should read textLayer() from
+     * a background task instead.
+     * @return Text content
+     */
+    QString cachedText() const;
+
+    /**
+     * @brief Get the shared text layer of this page
+     * Background tasks hold it instead of the page, so closing the document
+     * never leaves them with a dangling page.
+     * @return Text layer, never null
+     */
+    std::shared_ptr<PageTextLayer> textLayer() const;
+
+    /**
+     * @brief Drop the extracted text; it is extracted again on next use
+     * Called when the content changes.
+     */
+    void invalidateText();
+    
     /**
      * @brief Search for text on page
      * @param text Text to search
@@ -219,12 +301,6 @@ protected:
      */
     void setSize(const QSizeF& size);
     
-    /**
-     * @brief Set page rotation
-     * @param rotation Page rotation
-     */
-    void setRotation(PageRotation rotation);
-    
     /**
      * @brief Set page label
      * @param label Page label
@@ -249,6 +325,14 @@ protected:
      */
     void setContentBox(const QRectF& box);
 
+    /**
+     * @brief Detach the text layer from this page
+     * Waits for an extraction in progress. Subclasses whose text() uses their
+     * own state call it first in their destructor; the base destructor calls
+     * it too.
+     */
+    void detachTextLayer();
+
 private:
     class Private;
     std::unique_ptr<Private> d;
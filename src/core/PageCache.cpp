@@ -10,6 +10,7 @@
 #include "PageCache.h"
 #include "Page.h"
 #include "Document.h"
+#include "BinaryLog.h"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QImage>
@@ -94,8 +95,10 @@ QImage PageCache::get(const CacheKey& key)
         // Move key to end of LRU queue (most recently used)
         d->lruQueue.removeAll(key);
         d->lruQueue.enqueue(key);
+        LOG_BTRACE("Page cache hit: page {} at {}x{}", key.pageIndex, key.targetSize.width(), key.targetSize.height());
         return it->image;
     }
+    LOG_BTRACE("Page cache miss: page {} at {}x{}", key.pageIndex, key.targetSize.width(), key.targetSize.height());
     return QImage(); // Return null image if not found
 }
 
@@ -200,6 +203,7 @@ void PageCache::evictIfNecessary()
         // The key might have been removed already by clearForDocument or put
         if (d->cacheMap.contains(lruKey)) {
             d->removeItem(lruKey);
+            LOG_BTRACE("Page cache evicted page {}, {} bytes in use", lruKey.pageIndex, d->currentSizeBytes);
         }
     }
 }
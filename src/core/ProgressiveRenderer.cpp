@@ -11,6 +11,7 @@
 #include "Page.h"
 #include "Document.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include "ThreadPool.h" // Use our custom ThreadPool for passes
 #include "Task.h"       // Use our custom Task
 #include <QMutex>
@@ -158,7 +159,7 @@ quintptr ProgressiveRenderer::requestRender(Page* page, const QSize& initialSize
     d->requestMap.insert(requestId, request);
     d->requestQueue.enqueue(requestId);
 
-    LOG_DEBUG("Queued progressive render request: " << requestId << " for page " << page->pageIndex());
+    LOG_CDEBUG(lcRender, "Queued progressive render request: " << requestId << " for page " << page->pageIndex());
 
     emit queueStatusChanged(d->requestQueue.size(), d->activeCount);
 
@@ -177,16 +178,16 @@ void ProgressiveRenderer::cancelRequest(quintptr requestId)
         // If it's active, the running task should check this flag.
         // If it's queued, it will be skipped during processing.
         if (d->activeRequestIds.contains(requestId)) {
-            LOG_DEBUG("Marked active request for cancellation: " << requestId);
+            LOG_CDEBUG(lcRender, "Marked active request for cancellation: " << requestId);
         } else {
             // Remove from queue if it's still there
             d->requestQueue.removeAll(requestId);
-            LOG_DEBUG("Removed queued request for cancellation: " << requestId);
+            LOG_CDEBUG(lcRender, "Removed queued request for cancellation: " << requestId);
         }
         emit renderCanceled(requestId);
         emit queueStatusChanged(d->requestQueue.size(), d->activeCount);
     } else {
-        LOG_DEBUG("Request to cancel not found: " << requestId);
+        LOG_CDEBUG(lcRender, "Request to cancel not found: " << requestId);
     }
 }
 
@@ -198,7 +199,7 @@ void ProgressiveRenderer::cancelAllRequests()
         request.canceled = true;
     }
     d->requestQueue.clear();
-    LOG_DEBUG("Marked all " << count << " requests for cancellation.");
+    LOG_CDEBUG(lcRender, "Marked all " << count << " requests for cancellation.");
     emit queueStatusChanged(0, d->activeCount);
 }
 
@@ -298,7 +299,7 @@ void ProgressiveRenderer::processNextRequest()
     auto requestIt = d->requestMap.find(requestId);
     if (requestIt == d->requestMap.end()) {
         // Should not happen if getNextRequestIdToProcess is correct
-        LOG_WARN("processNextRequest: Request ID " << requestId << " not found in map!");
+        LOG_CWARN(lcRender, "processNextRequest: Request ID " << requestId << " not found in map!");
         emit queueStatusChanged(d->requestQueue.size(), d->activeCount);
         return;
     }
@@ -307,14 +308,14 @@ void ProgressiveRenderer::processNextRequest()
     d->activeRequestIds.insert(requestId);
     d->activeCount++;
 
-    LOG_DEBUG("Starting progressive render request: " << requestId << " with " << request.passes.size() << " passes.");
+    LOG_CDEBUG(lcRender, "Starting progressive render request: " << requestId << " with " << request.passes.size() << " passes.");
 
     // Create a Task that will handle all passes for this request sequentially
     Task* renderTask = new Task([this, requestId, request]() {
         // Capture request by value to avoid lifetime issues with the main thread's map
         // In a real implementation, you'd need a more robust way to ensure the Page object is valid.
         if (!request.page || request.canceled) {
-             LOG_DEBUG("Render task started but request was canceled or page invalid: " << requestId);
+             LOG_CDEBUG(lcRender, "Render task started but request was canceled or page invalid: " << requestId);
              // Report cancellation/failure on main thread
              QMetaObject::invokeMethod(this, [this, requestId]() {
                  QMutexLocker resLocker(&d->mutex); // Lock to update active count
@@ -338,7 +339,7 @@ void ProgressiveRenderer::processNextRequest()
 
         for (const auto& pass : request.passes) {
             if (request.canceled) {
-                LOG_DEBUG("Render request " << requestId << " was canceled during pass " << pass.passNumber);
+                LOG_CDEBUG(lcRender, "Render request " << requestId << " was canceled during pass " << pass.passNumber);
                 overallSuccess = false;
                 overallError = "Request canceled";
                 break;
@@ -354,7 +355,7 @@ void ProgressiveRenderer::processNextRequest()
             if (image.isNull()) {
                 overallSuccess = false;
                 overallError = "Failed to create image buffer for pass " + QString::number(pass.passNumber);
-                LOG_ERROR(overallError);
+                LOG_CERROR(lcRender, overallError);
                 break;
             }
             image.fill(Qt::lightGray); // Placeholder background
@@ -362,7 +363,7 @@ void ProgressiveRenderer::processNextRequest()
             if (!painter.isActive()) {
                  overallSuccess = false;
                  overallError = "Failed to initialize painter for pass " + QString::number(pass.passNumber);
-                 LOG_ERROR(overallError);
+                 LOG_CERROR(lcRender, overallError);
                  break;
             }
             // Draw a simple representation of the page content
@@ -383,11 +384,11 @@ void ProgressiveRenderer::processNextRequest()
 
             if (result.success) {
                 finalImage = result.image; // Update final image if this was the last pass
-                LOG_DEBUG("Completed render pass " << pass.passNumber << " for request " << requestId);
+                LOG_BDEBUG("Completed render pass {} for request {}", pass.passNumber, requestId);
             } else {
                 overallSuccess = false;
                 overallError = result.errorMessage;
-                LOG_ERROR("Render pass " << pass.passNumber << " failed for request " << requestId << ": " << result.errorMessage);
+                LOG_CERROR(lcRender, "Render pass " << pass.passNumber << " failed for request " << requestId << ": " << result.errorMessage);
                 break; // Stop further passes on failure
             }
 
@@ -411,10 +412,10 @@ void ProgressiveRenderer::processNextRequest()
 
              if (overallSuccess) {
                  emit renderCompleted(requestId, finalImage);
-                 LOG_DEBUG("Successfully completed progressive render request: " << requestId);
+                 LOG_CDEBUG(lcRender, "Successfully completed progressive render request: " << requestId);
              } else {
                  emit renderFailed(requestId, overallError);
-                 LOG_WARN("Progressive render request failed: " << requestId << ", Error: " << overallError);
+                 LOG_CWARN(lcRender, "Progressive render request failed: " << requestId << ", Error: " << overallError);
              }
 
              // Process the next request in the queue
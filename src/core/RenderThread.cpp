@@ -11,6 +11,7 @@
 #include "Page.h"
 #include "Document.h"
 #include "Logger.h"
+#include "BinaryLog.h"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QWaitCondition>
@@ -42,13 +43,13 @@ public:
 
         if (req.canceled) {
             result.errorMessage = "Request was canceled.";
-            LOG_DEBUG("Render request " << req.requestId << " was canceled before processing.");
+            LOG_CDEBUG(lcRender, "Render request " << req.requestId << " was canceled before processing.");
             return result;
         }
 
         if (!req.page) {
             result.errorMessage = "Invalid page pointer.";
-            LOG_ERROR("Render request " << req.requestId << " has null page pointer.");
+            LOG_CERROR(lcRender, "Render request " << req.requestId << " has null page pointer.");
             return result;
         }
 
@@ -58,7 +59,7 @@ public:
         QSizeF pageSize = req.page->size(); // Size in points
         if (pageSize.isEmpty()) {
             result.errorMessage = "Page has invalid size.";
-            LOG_ERROR("Page " << req.page->pageIndex() << " has invalid size for render request " << req.requestId);
+            LOG_CERROR(lcRender, "Page " << req.page->pageIndex() << " has invalid size for render request " << req.requestId);
             return result;
         }
 
@@ -75,7 +76,7 @@ public:
         QImage image(renderSize, QImage::Format_ARGB32_Premultiplied);
         if (image.isNull()) {
             result.errorMessage = "Failed to create image buffer.";
-            LOG_ERROR("Failed to create image buffer for render request " << req.requestId);
+            LOG_CERROR(lcRender, "Failed to create image buffer for render request " << req.requestId);
             return result;
         }
         image.fill(Qt::lightGray); // Placeholder background
@@ -83,7 +84,7 @@ public:
         QPainter painter(&image);
         if (!painter.isActive()) {
             result.errorMessage = "Failed to initialize painter.";
-            LOG_ERROR("Failed to initialize painter for render request " << req.requestId);
+            LOG_CERROR(lcRender, "Failed to initialize painter for render request " << req.requestId);
             return result;
         }
 
@@ -105,16 +106,23 @@ public:
                 break; // No rotation
         }
 
-        // Simulate drawing page content (placeholder)
-        painter.fillRect(0, 0, pageSize.width() * scale, pageSize.height() * scale, QColor(200, 220, 255)); // Light blue page
-        painter.setPen(Qt::black);
-        painter.drawText(QRectF(10, 10, pageSize.width() * scale - 20, 20), Qt::AlignLeft, QString("Page %1").arg(req.page->pageIndex()));
+        // On-screen render: annotations are composited by the view, not baked in
+        const QRectF pageRect(0, 0, pageSize.width() * scale, pageSize.height() * scale);
+        const QImage pageImage = req.page->renderForDisplay(renderSize.width(), renderSize.height());
+        if (!pageImage.isNull()) {
+            painter.drawImage(pageRect, pageImage);
+        } else {
+            // Simulate drawing page content (placeholder)
+            painter.fillRect(pageRect, QColor(200, 220, 255)); // Light blue page
+            painter.setPen(Qt::black);
+            painter.drawText(QRectF(10, 10, pageRect.width() - 20, 20), Qt::AlignLeft, QString("Page %1").arg(req.page->pageIndex()));
+        }
 
         painter.end();
 
         result.image = image;
         result.success = true;
-        LOG_DEBUG("Successfully rendered page " << req.page->pageIndex() << " for request " << req.requestId);
+        LOG_BDEBUG("Successfully rendered page {} for request {}", req.page->pageIndex(), req.requestId);
 
         return result;
     }
@@ -138,7 +146,7 @@ RenderThread::~RenderThread()
     // Clear any remaining requests
     while (!d->requestQueue.isEmpty()) {
         auto req = d->requestQueue.dequeue();
-        LOG_WARN("Discarding render request " << req.requestId << " during shutdown.");
+        LOG_CWARN(lcRender, "Discarding render request " << req.requestId << " during shutdown.");
     }
 }
 
@@ -158,7 +166,7 @@ void RenderThread::cancelRequest(quintptr requestId)
                            [requestId](const RenderRequest& r) { return r.requestId == requestId; });
     if (it != d->requestQueue.end()) {
         it->canceled = true;
-        LOG_DEBUG("Marked render request " << requestId << " as canceled (queued).");
+        LOG_CDEBUG(lcRender, "Marked render request " << requestId << " as canceled (queued).");
     }
     // If the request is already active, the processing logic in run() will check the flag.
     // Adding the ID to a separate 'cancelledActive' set could make this more efficient if needed.
@@ -174,7 +182,7 @@ void RenderThread::cancelRequestsForPage(Page* page)
     for (auto& req : d->requestQueue) {
         if (req.page == page) {
             req.canceled = true;
-            LOG_DEBUG("Marked render request " << req.requestId << " for page " << page->pageIndex() << " as canceled (queued).");
+            LOG_CDEBUG(lcRender, "Marked render request " << req.requestId << " for page " << page->pageIndex() << " as canceled (queued).");
         }
     }
     // Active requests for this page will be checked similarly during processing.
@@ -187,7 +195,7 @@ void RenderThread::cancelAllRequests()
     for (auto& req : d->requestQueue) {
         req.canceled = true;
     }
-    LOG_DEBUG("Marked all " << d->requestQueue.size() << " queued render requests as canceled.");
+    LOG_CDEBUG(lcRender, "Marked all " << d->requestQueue.size() << " queued render requests as canceled.");
     // Active requests will also be checked.
 }
 
@@ -250,7 +258,7 @@ void RenderThread::run()
         emit renderCompleted(result);
 
     } // forever
-    LOG_DEBUG("RenderThread " << QThread::currentThreadId() << " exiting run loop.");
+    LOG_CDEBUG(lcRender, "RenderThread " << QThread::currentThreadId() << " exiting run loop.");
 }
 
 } // namespace QuantilyxDoc
\ No newline at end of file
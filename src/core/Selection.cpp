@@ -11,24 +11,72 @@
 #include "Document.h"
 #include "Page.h"
 #include "Clipboard.h" // Assuming a core Clipboard manager exists
+#include "SelectionMimeData.h"
+#include "ThreadPool.h"
+#include "Logger.h"
 #include <QRectF>
 #include <QPointF>
 #include <QApplication> // For clipboard access if needed
 #include <QClipboard>
 #include <QMimeData>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
 #include <QDebug>
 #include <algorithm> // For std::find_if, std::sort, std::unique
 
 namespace QuantilyxDoc {
 
+namespace {
+const QString TextSeparator = QStringLiteral("\n---\n"); // Between text segments
+}
+
 class Selection::Private {
 public:
-    Private() : document(nullptr) {}
+    Private() : document(nullptr), extraction(std::make_shared<ExtractionState>()) {}
     QList<Segment> segments;
     QPointer<Document> document; // Use QPointer for safety
 
+    // Shared with extraction tasks; owner is cleared under the mutex when the
+    // Selection is destroyed, and bumping generation abandons running tasks.
+    struct ExtractionState {
+        QMutex mutex;
+        Selection* owner = nullptr;
+        quint64 generation = 0;
+    };
+    std::shared_ptr<ExtractionState> extraction;
+
+    void cancelExtraction() {
+        QMutexLocker locker(&extraction->mutex);
+        ++extraction->generation;
+    }
+
+    // Snapshot of the text segments, taken on the GUI thread. It holds the
+    // pages' text layers, not their text: extraction, slicing and joining
+    // wait until materialized, normally in extractTextAsync()'s task.
+    std::shared_ptr<SelectionTextSource> textSource() const {
+        QVector<SelectionTextSource::Piece> pieces;
+        pieces.reserve(segments.size());
+        for (const auto& seg : segments) {
+            if (seg.type != Text && seg.type != Mixed) continue;
+            SelectionTextSource::Piece piece;
+            if (seg.page && seg.startIndex >= 0 && seg.endIndex >= seg.startIndex) {
+                piece.textLayer = seg.page->textLayer();
+                piece.startIndex = seg.startIndex;
+                piece.endIndex = seg.endIndex;
+            } else {
+                piece.startIndex = -1;
+                piece.endIndex = -1;
+                piece.text = seg.content.toString(); // Assumes content is stored as QString for Text type
+            }
+            pieces.append(piece);
+        }
+        return std::make_shared<SelectionTextSource>(pieces, TextSeparator);
+    }
+
     // Helper to update internal state based on segments
     void updateState() {
+        cancelExtraction();
         bool wasEmpty = segments.isEmpty();
         bool wasMultiPage = isMultiPageInternal();
         ContentType oldType = contentTypeInternal();
@@ -113,11 +161,14 @@ Selection::Selection(QObject* parent)
     , d(new Private())
 {
     d->q = this; // Set back-pointer for signal emission in private helpers
+    d->extraction->owner = this;
 }
 
 Selection::~Selection()
 {
     clear(); // Ensure segments are cleared properly
+    QMutexLocker locker(&d->extraction->mutex);
+    d->extraction->owner = nullptr;
 }
 
 void Selection::clear()
@@ -186,13 +237,51 @@ QString Selection::selectedText() const
     if (contentType() != Text && contentType() != Mixed) {
         return QString(); // Only return text if primarily text content
     }
-    QStringList texts;
-    for (const auto& seg : d->segments) {
-        if (seg.type == Text || seg.type == Mixed) {
-            texts << seg.content.toString(); // Assumes content is stored as QString for Text type
-        }
+    return d->textSource()->text();
+}
+
+void Selection::extractTextAsync()
+{
+    std::shared_ptr<SelectionTextSource> source = d->textSource();
+    std::shared_ptr<Private::ExtractionState> state = d->extraction;
+    quint64 generation;
+    {
+        QMutexLocker locker(&state->mutex);
+        generation = ++state->generation;
     }
-    return texts.join("\n---\n"); // Join multi-segment text with a separator
+
+    ThreadPool::instance().submitTask([source, state, generation]() {
+        // Queue a call on the GUI thread unless the extraction was abandoned;
+        // the generation is checked again on delivery.
+        auto post = [&state, generation](std::function<void(Selection*)> fn) {
+            QMutexLocker locker(&state->mutex);
+            if (!state->owner || state->generation != generation) return false;
+            QMetaObject::invokeMethod(state->owner, [state, generation, fn]() {
+                Selection* owner;
+                {
+                    QMutexLocker locker(&state->mutex);
+                    if (state->generation != generation) return;
+                    owner = state->owner;
+                }
+                fn(owner);
+            }, Qt::QueuedConnection);
+            return true;
+        };
+
+        bool abandoned = false;
+        const QString text = source->text([&post, &abandoned](int done, int total) {
+            abandoned = !post([done, total](Selection* owner) { emit owner->textExtractionProgress(done, total); });
+            return !abandoned;
+        });
+        if (!abandoned) {
+            post([text](Selection* owner) { emit owner->textExtracted(text); });
+        }
+    }, QStringLiteral("Selection text extraction"), Task::Priority::Normal);
+}
+
+void Selection::cancelTextExtraction()
+{
+    d->cancelExtraction();
 }
 
 bool Selection::selectRegion(Page* page, const QRectF& region, ContentType typeHint)
@@ -269,19 +358,14 @@ bool Selection::copyToClipboard() const
 {
     if (isEmpty() || !canCopy()) return false;
 
-    QClipboard* clipboard = QApplication::clipboard();
-    if (!clipboard) return false;
-
-    QMimeData* mimeData = new QMimeData();
-
     ContentType type = contentType();
-    if (type == Text || type == Mixed) {
-        mimeData->setText(selectedText());
-        mimeData->setHtml(selectedText()); // Basic HTML representation
+    if (type != Text && type != Mixed) {
+        // Add other formats based on content type (images, etc.)
+        return false;
     }
-    // Add other formats based on content type (images, etc.)
 
-    clipboard->setMimeData(mimeData);
+    // Delayed rendering: the text is built when another application pastes it
+    Clipboard::instance().setData(new SelectionMimeData(d->textSource()));
     LOG_INFO("Copied selection to clipboard.");
     return true;
 }
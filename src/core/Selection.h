@@ -139,6 +139,20 @@ public:
      */
     QString selectedText() const;
 
+    /**
+     * @brief Extract the selected text on a pool thread.
+     * The pages' text is extracted on that thread, one page at a time;
+     * textExtractionProgress() is emitted after each page and
+     * textExtracted() with the result. Starting a new extraction, or changing
+     * the selection, abandons the previous one.
+     */
+    void extractTextAsync();
+
+    /**
+     * @brief Abandon a running extractTextAsync().
+     */
+    void cancelTextExtraction();
+
     /**
      * @brief Select content based on a region on a page.
      * @param page The page to select on.
@@ -179,6 +193,8 @@ public:
 
     /**
      * @brief Copy the selected content to the clipboard.
+     * Text is put on the clipboard with delayed rendering (SelectionMimeData):
+     * it is only materialized when another application pastes it.
      * @return True if the copy operation was successful.
      */
     bool copyToClipboard() const;
@@ -242,6 +258,19 @@ signals:
     void canCutChanged();
     void canDeleteChanged();
 
+    /**
+     * @brief Emitted as extractTextAsync() progresses.
+     * @param done Pages extracted so far.
+     * @param total Number of pages in the selection.
+     */
+    void textExtractionProgress(int done, int total);
+
+    /**
+     * @brief Emitted when extractTextAsync() has finished.
+     * @param text The selected text.
+     */
+    void textExtracted(const QString& text);
+
 private:
     class Private;
     std::unique_ptr<Private> d;
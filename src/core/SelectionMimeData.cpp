@@ -0,0 +1,179 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "SelectionMimeData.h"
+#include "Page.h"
+#include <QMutexLocker>
+#include <QSet>
+
+namespace QuantilyxDoc {
+
+namespace {
+const QString MimeText = QStringLiteral("text/plain");
+const QString MimeHtml = QStringLiteral("text/html");
+}
+
+SelectionTextSource::SelectionTextSource(const QVector<Piece>& pieces, const QString& separator)
+    : m_pieces(pieces)
+    , m_separator(separator)
+    , m_ready(pieces.size(), false)
+    , m_materialized(false)
+{
+    QSet<PageTextLayer*> layers;
+    m_texts.reserve(pieces.size());
+    for (const Piece& piece : pieces) {
+        m_texts.append(QString());
+        if (piece.textLayer) layers.insert(piece.textLayer.get());
+    }
+    m_pageCount = layers.size();
+}
+
+int SelectionTextSource::pieceCount() const
+{
+    return m_pieces.size();
+}
+
+int SelectionTextSource::pageCount() const
+{
+    return m_pageCount;
+}
+
+bool SelectionTextSource::isMaterialized() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_materialized;
+}
+
+QString SelectionTextSource::text(const ProgressCallback& progress)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_materialized) return m_joined;
+    }
+
+    // Extraction is the slow part and happens once per page, so progress
+    // counts pages; literal pieces and further ranges of a page are cheap
+    QSet<PageTextLayer*> extracted;
+    for (int i = 0; i < m_pieces.size(); ++i) {
+        pieceText(i);
+        PageTextLayer* layer = m_pieces.at(i).textLayer.get();
+        if (!layer || extracted.contains(layer)) continue;
+        extracted.insert(layer);
+        if (progress && !progress(extracted.size(), m_pageCount)) {
+            return QString();
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_materialized) {
+        m_joined = m_texts.join(m_separator);
+        m_materialized = true;
+        // The pieces are no longer needed once joined
+        m_texts = QStringList();
+    }
+    return m_joined;
+}
+
+QString SelectionTextSource::preview(int maxLength)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_materialized) return m_joined.left(maxLength);
+    }
+    QString result;
+    for (int i = 0; i < m_pieces.size() && result.length() < maxLength; ++i) {
+        if (i > 0) result += m_separator;
+        result += pieceText(i);
+    }
+    return result.left(maxLength);
+}
+
+qint64 SelectionTextSource::approximateSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_materialized) return m_joined.size() * qint64(sizeof(QChar));
+    qint64 size = 0;
+    for (int i = 0; i < m_pieces.size(); ++i) {
+        const Piece& piece = m_pieces.at(i);
+        if (m_ready.at(i)) {
+            size += m_texts.at(i).size();
+        } else if (piece.startIndex >= 0) {
+            size += piece.endIndex - piece.startIndex;
+        } else {
+            size += piece.text.size();
+        }
+    }
+    return size * qint64(sizeof(QChar));
+}
+
+QString SelectionTextSource::pieceText(int index)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_materialized) return QString();
+        if (m_ready.at(index)) return m_texts.at(index);
+    }
+
+    // Extract outside the lock; if two threads race on a piece the first one wins
+    const Piece& piece = m_pieces.at(index);
+    QString text;
+    if (piece.startIndex < 0) {
+        text = piece.text;
+    } else {
+        // Extracts the page text if no piece of this page has yet
+        const QString pageText = piece.textLayer ? piece.textLayer->text() : QString();
+        text = pageText.mid(piece.startIndex, piece.endIndex - piece.startIndex);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_materialized && !m_ready.at(index)) {
+        m_texts[index] = text;
+        m_ready[index] = true;
+    }
+    return text;
+}
+
+SelectionMimeData::SelectionMimeData(std::shared_ptr<SelectionTextSource> source)
+    : m_source(std::move(source))
+{
+}
+
+std::shared_ptr<SelectionTextSource> SelectionMimeData::source() const
+{
+    return m_source;
+}
+
+SelectionMimeData* SelectionMimeData::clone() const
+{
+    return new SelectionMimeData(m_source);
+}
+
+QStringList SelectionMimeData::formats() const
+{
+    return QStringList() << MimeText << MimeHtml;
+}
+
+bool SelectionMimeData::hasFormat(const QString& mimeType) const
+{
+    return mimeType == MimeText || mimeType == MimeHtml;
+}
+
+QVariant SelectionMimeData::retrieveData(const QString& mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+    if (!m_source || !hasFormat(mimeType)) return QVariant();
+
+    const QString text = m_source->text();
+    if (mimeType == MimeHtml) {
+        return QStringLiteral("<pre>%1</pre>").arg(text.toHtmlEscaped());
+    }
+    return text;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,147 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_SELECTIONMIMEDATA_H
+#define QUANTILYX_SELECTIONMIMEDATA_H
+
+#include <QMimeData>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+class PageTextLayer;
+
+/**
+ * @brief Snapshot of the text pieces of a selection, materialized on demand.
+ *
+ * Each piece is a character range of one page's text layer (or a literal
+ * string when the range is unknown). Pieces hold the shared PageTextLayer,
+ * not the Page, so the text is extracted by whichever thread materializes
+ * the piece first and closing the document meanwhile is safe. Pieces are
+ * produced one at a time, so a background extraction and a paste on the GUI
+ * thread can both make progress without one blocking on the other; the
+ * joined text is built once and kept.
+ */
+class SelectionTextSource
+{
+public:
+    /**
+     * @brief One piece of selected text.
+     */
+    struct Piece {
+        std::shared_ptr<PageTextLayer> textLayer; // Text layer of the page holding the range
+        int startIndex;       // First character, or -1 to use text
+        int endIndex;         // One past the last character
+        QString text;         // Literal text when there is no range
+    };
+
+    /**
+     * @brief Called after each page's text is extracted; return false to stop.
+     */
+    using ProgressCallback = std::function<bool(int done, int total)>;
+
+    /**
+     * @brief Constructor.
+     * @param pieces Selected pieces, in document order.
+     * @param separator String placed between pieces.
+     */
+    SelectionTextSource(const QVector<Piece>& pieces, const QString& separator);
+
+    /**
+     * @brief Get the number of pieces.
+     */
+    int pieceCount() const;
+
+    /**
+     * @brief Get the number of pages the pieces come from.
+     */
+    int pageCount() const;
+
+    /**
+     * @brief Check if the full text has been built.
+     */
+    bool isMaterialized() const;
+
+    /**
+     * @brief Build (or return) the full text.
+     * @param progress Optional progress callback.
+     * @return The text, or a null string if the callback stopped it.
+     */
+    QString text(const ProgressCallback& progress = ProgressCallback());
+
+    /**
+     * @brief Get the beginning of the text without materializing the rest.
+     * @param maxLength Maximum length.
+     */
+    QString preview(int maxLength);
+
+    /**
+     * @brief Get the size of the text in bytes, as far as it is known.
+     */
+    qint64 approximateSize() const;
+
+private:
+    QString pieceText(int index);
+
+    const QVector<Piece> m_pieces;
+    const QString m_separator;
+    int m_pageCount;              // Distinct text layers among the pieces
+    mutable QMutex m_mutex;
+    QStringList m_texts;          // Extracted pieces
+    QVector<bool> m_ready;
+    QString m_joined;
+    bool m_materialized;
+};
+
+/**
+ * @brief Clipboard data for a selection whose text is rendered only when asked for.
+ *
+ * Advertises text/plain and text/html but keeps only a SelectionTextSource;
+ * the text is materialized in retrieveData(), i.e. when another application
+ * actually pastes. Copies share the source.
+ */
+class SelectionMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor.
+     * @param source Text source of the selection.
+     */
+    explicit SelectionMimeData(std::shared_ptr<SelectionTextSource> source);
+
+    /**
+     * @brief Get the text source.
+     */
+    std::shared_ptr<SelectionTextSource> source() const;
+
+    /**
+     * @brief Create a copy sharing the same source.
+     */
+    SelectionMimeData* clone() const;
+
+    QStringList formats() const override;
+    bool hasFormat(const QString& mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString& mimeType, QVariant::Type type) const override;
+
+private:
+    std::shared_ptr<SelectionTextSource> m_source;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_SELECTIONMIMEDATA_H
@@ -0,0 +1,232 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "UndoCommand.h"
+#include "UndoStack.h"
+#include "Logger.h"
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+QHash<QString, UndoCommand::JournalFactory>& journalFactories()
+{
+    static QHash<QString, UndoCommand::JournalFactory> factories;
+    return factories;
+}
+
+QMutex& journalFactoriesMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+} // namespace
+
+UndoCommand::UndoCommand(const QString& text, QUndoCommand* parent)
+    : QUndoCommand(text, parent)
+    , m_stack(nullptr)
+    , m_cost(0)
+    , m_spilled(false)
+    , m_journalOffset(-1)
+    , m_journalLength(0)
+    , m_mergeId(static_cast<int>(UndoMergeId::None))
+    , m_mergeTarget(0)
+    , m_lastEditMs(QDateTime::currentMSecsSinceEpoch())
+    , m_mergeCount(0)
+    , m_mergeClosed(false)
+{
+}
+
+UndoCommand::~UndoCommand()
+{
+    if (m_stack) {
+        m_stack->accountCommand(m_spilled ? 0 : -m_cost, m_spilled ? -m_journalLength : 0);
+    }
+}
+
+void UndoCommand::undo()
+{
+    if (ensureResident()) {
+        doUndo();
+    }
+}
+
+void UndoCommand::redo()
+{
+    if (ensureResident()) {
+        doRedo();
+    }
+}
+
+qint64 UndoCommand::cost() const
+{
+    return m_cost;
+}
+
+bool UndoCommand::isSpilled() const
+{
+    return m_spilled;
+}
+
+int UndoCommand::id() const
+{
+    return m_mergeId;
+}
+
+bool UndoCommand::mergeWith(const QUndoCommand* other)
+{
+    const UndoCommand* next = dynamic_cast<const UndoCommand*>(other);
+    if (!next || m_mergeClosed || m_mergeId < 0) return false;
+    if (next->m_mergeId != m_mergeId || next->m_mergeTarget != m_mergeTarget) return false;
+
+    // A pause longer than the window starts a new undo step
+    const qint64 window = m_stack ? m_stack->mergeWindow() : 0;
+    if (window > 0 && next->m_lastEditMs - m_lastEditMs > window) return false;
+
+    if (!ensureResident() || !mergeFrom(next)) return false;
+
+    m_lastEditMs = next->m_lastEditMs;
+    m_mergeCount += next->m_mergeCount + 1;
+    return true;
+}
+
+int UndoCommand::mergeCount() const
+{
+    return m_mergeCount;
+}
+
+qint64 UndoCommand::lastEditTime() const
+{
+    return m_lastEditMs;
+}
+
+void UndoCommand::registerJournalType(const QString& type, JournalFactory factory)
+{
+    QMutexLocker locker(&journalFactoriesMutex());
+    journalFactories().insert(type, std::move(factory));
+}
+
+UndoCommand* UndoCommand::fromJournal(const QString& type, Document* document, const QByteArray& payload)
+{
+    JournalFactory factory;
+    {
+        QMutexLocker locker(&journalFactoriesMutex());
+        factory = journalFactories().value(type);
+    }
+    return factory ? factory(document, payload) : nullptr;
+}
+
+bool UndoCommand::isJournalTypeRegistered(const QString& type)
+{
+    QMutexLocker locker(&journalFactoriesMutex());
+    return journalFactories().contains(type);
+}
+
+QString UndoCommand::journalType() const
+{
+    return QString();
+}
+
+QByteArray UndoCommand::journalPayload() const
+{
+    return QByteArray();
+}
+
+void UndoCommand::setMergeId(UndoMergeId mergeId, quintptr target)
+{
+    m_mergeId = static_cast<int>(mergeId);
+    m_mergeTarget = target;
+}
+
+bool UndoCommand::mergeFrom(const UndoCommand* other)
+{
+    Q_UNUSED(other);
+    return false;
+}
+
+void UndoCommand::doUndo()
+{
+    QUndoCommand::undo();
+}
+
+void UndoCommand::doRedo()
+{
+    QUndoCommand::redo();
+}
+
+void UndoCommand::setCost(qint64 bytes)
+{
+    const qint64 delta = bytes - m_cost;
+    m_cost = bytes;
+    if (m_stack && !m_spilled) {
+        m_stack->accountCommand(delta, 0);
+    }
+}
+
+bool UndoCommand::supportsSpill() const
+{
+    return false;
+}
+
+QByteArray UndoCommand::saveState() const
+{
+    return QByteArray();
+}
+
+bool UndoCommand::loadState(const QByteArray& state)
+{
+    Q_UNUSED(state);
+    return false;
+}
+
+void UndoCommand::releaseState()
+{
+}
+
+bool UndoCommand::spill()
+{
+    if (m_spilled || !m_stack || !supportsSpill()) return false;
+
+    const QByteArray state = saveState();
+    if (state.isEmpty()) return false;
+
+    const qint64 offset = m_stack->writeJournal(state);
+    if (offset < 0) return false;
+
+    releaseState();
+    m_spilled = true;
+    m_journalOffset = offset;
+    m_journalLength = state.size();
+    m_stack->accountCommand(-m_cost, m_journalLength);
+    return true;
+}
+
+bool UndoCommand::ensureResident()
+{
+    if (!m_spilled) return true;
+
+    const QByteArray state = m_stack ? m_stack->readJournal(m_journalOffset, m_journalLength) : QByteArray();
+    if (state.size() != m_journalLength || !loadState(state)) {
+        LOG_ERROR("Failed to reload undo state for '" << text() << "' from the undo journal");
+        return false;
+    }
+
+    m_spilled = false;
+    m_stack->accountCommand(m_cost, -m_journalLength);
+    m_journalOffset = -1;
+    m_journalLength = 0;
+    return true;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,238 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_UNDOCOMMAND_H
+#define QUANTILYX_UNDOCOMMAND_H
+
+#include <QUndoCommand>
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+namespace QuantilyxDoc {
+
+class UndoStack;
+class Document;
+
+/**
+ * @brief Merge ids for edit kinds that arrive at high frequency.
+ *
+ * Consecutive commands with the same id and merge target are coalesced
+ * into one while they arrive within the stack's merge window.
+ */
+enum class UndoMergeId : int {
+    None = -1,              // Never merge
+    AnnotationMove = 1,     // Dragging an annotation
+    AnnotationResize,       // Dragging a resize handle
+    AnnotationProperties,   // Slider/spin box changes (color, opacity, width)
+    InkStroke,              // Points appended to an ink stroke
+    TextTyping,             // Characters typed into a text/free-text annotation
+    FormFieldEdit           // Characters typed into a form field
+};
+
+/**
+ * @brief Base class for commands pushed onto UndoStack.
+ *
+ * Adds byte-cost accounting on top of QUndoCommand so the stack can keep
+ * its memory within a budget. Commands holding large state (page images,
+ * annotation snapshots) report it with setCost() and implement saveState(),
+ * loadState() and releaseState(); the stack may then move that state to its
+ * on-disk journal while the command is far from the current index. It is
+ * reloaded transparently before undo() or redo() runs.
+ *
+ * Commands that arrive at high frequency (drag steps, ink points, typing)
+ * set a merge id and target and implement mergeFrom(); the stack then folds
+ * each new command into the previous one while they arrive within the merge
+ * window, until UndoStack::closeMergeWindow() ends the gesture.
+ *
+ * Commands that implement journalType()/journalPayload() and register a
+ * factory with registerJournalType() are also written to the document's
+ * crash-recovery EditJournal, and are recreated from it after a crash.
+ *
+ * Subclasses implement doUndo()/doRedo() instead of undo()/redo().
+ */
+class UndoCommand : public QUndoCommand
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param text Command description.
+     * @param parent Parent command (for composite commands).
+     */
+    explicit UndoCommand(const QString& text = QString(), QUndoCommand* parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~UndoCommand() override;
+
+    /**
+     * @brief Reload spilled state if needed, then call doUndo().
+     */
+    void undo() final;
+
+    /**
+     * @brief Reload spilled state if needed, then call doRedo().
+     */
+    void redo() final;
+
+    /**
+     * @brief Get the memory held by this command's state.
+     * @return Cost in bytes (counted against the budget only while resident).
+     */
+    qint64 cost() const;
+
+    /**
+     * @brief Check if the command's state currently lives in the journal.
+     * @return True if spilled to disk.
+     */
+    bool isSpilled() const;
+
+    /**
+     * @brief Get the merge id (QUndoStack calls this to find merge candidates).
+     * @return Merge id, or -1 if the command never merges.
+     */
+    int id() const final;
+
+    /**
+     * @brief Fold a following command into this one if the merge rules allow.
+     * Checks id, target, the time window and whether the window was closed,
+     * then delegates to mergeFrom().
+     */
+    bool mergeWith(const QUndoCommand* other) final;
+
+    /**
+     * @brief Get the number of commands folded into this one.
+     * @return Merge count (0 if never merged).
+     */
+    int mergeCount() const;
+
+    /**
+     * @brief Get when the latest edit in this command happened.
+     * @return Milliseconds since the epoch.
+     */
+    qint64 lastEditTime() const;
+
+    /**
+     * @brief Factory recreating a command from its journal payload.
+     */
+    using JournalFactory = std::function<UndoCommand*(Document* document, const QByteArray& payload)>;
+
+    /**
+     * @brief Register the factory for a journal type (once per command class).
+     * @param type Stable type name written to the journal.
+     * @param factory Creates the command from journalPayload() output.
+     */
+    static void registerJournalType(const QString& type, JournalFactory factory);
+
+    /**
+     * @brief Recreate a journaled command.
+     * @return New command, or nullptr if the type is unknown or the payload invalid.
+     */
+    static UndoCommand* fromJournal(const QString& type, Document* document, const QByteArray& payload);
+
+    /**
+     * @brief Check if a factory is registered for a journal type.
+     */
+    static bool isJournalTypeRegistered(const QString& type);
+
+    /**
+     * @brief Get the type name used in the edit journal.
+     * @return Type name, or an empty string if the command cannot be journaled (default).
+     */
+    virtual QString journalType() const;
+
+    /**
+     * @brief Serialize what the factory needs to recreate this command.
+     * Called just before the command is pushed (and first executed).
+     */
+    virtual QByteArray journalPayload() const;
+
+protected:
+    /**
+     * @brief Set the edit kind used for merging.
+     * @param mergeId Merge id (UndoMergeId::None disables merging).
+     * @param target Identity of the edited object (e.g. annotation pointer);
+     *        only commands on the same target merge.
+     */
+    void setMergeId(UndoMergeId mergeId, quintptr target = 0);
+
+    /**
+     * @brief Absorb a following command of the same kind and target.
+     * The following command has already been executed; update this
+     * command's state so that undo() reverts both. Call setCost() if the
+     * state size changes.
+     * @param other The command being merged in (deleted afterwards).
+     * @return True if merged. Default returns false.
+     */
+    virtual bool mergeFrom(const UndoCommand* other);
+
+    /**
+     * @brief Undo the command. Default undoes the child commands.
+     */
+    virtual void doUndo();
+
+    /**
+     * @brief Redo the command. Default redoes the child commands.
+     */
+    virtual void doRedo();
+
+    /**
+     * @brief Report the memory held by this command's state.
+     * Call again whenever the state grows or shrinks (e.g. after a merge).
+     * @param bytes Approximate size in bytes.
+     */
+    void setCost(qint64 bytes);
+
+    /**
+     * @brief Check if the command's state can be spilled to disk.
+     * @return True if saveState()/loadState()/releaseState() are implemented.
+     */
+    virtual bool supportsSpill() const;
+
+    /**
+     * @brief Serialize the state that releaseState() will free.
+     * @return Serialized state, or an empty array if it cannot be saved now.
+     */
+    virtual QByteArray saveState() const;
+
+    /**
+     * @brief Restore state previously returned by saveState().
+     * @param state Serialized state.
+     * @return True on success.
+     */
+    virtual bool loadState(const QByteArray& state);
+
+    /**
+     * @brief Free the state after it has been written to the journal.
+     */
+    virtual void releaseState();
+
+private:
+    friend class UndoStack;
+
+    bool spill();
+    bool ensureResident();
+
+    UndoStack* m_stack;
+    qint64 m_cost;
+    bool m_spilled;
+    qint64 m_journalOffset;
+    qint64 m_journalLength;
+
+    int m_mergeId;
+    quintptr m_mergeTarget;
+    qint64 m_lastEditMs;    // Time of the latest edit folded into this command
+    int m_mergeCount;
+    bool m_mergeClosed;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_UNDOCOMMAND_H
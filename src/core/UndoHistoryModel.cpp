@@ -0,0 +1,159 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "UndoHistoryModel.h"
+#include "UndoStack.h"
+#include "UndoCommand.h"
+#include <QDateTime>
+#include <QFont>
+
+namespace QuantilyxDoc {
+
+UndoHistoryModel::UndoHistoryModel(UndoStack* stack, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_stack(stack)
+    , m_rows(stack ? stack->count() + 1 : 1)
+    , m_currentRow(stack ? stack->index() : 0)
+    , m_cleanRow(stack ? stack->cleanIndex() : -1)
+    , m_truncatedFrom(-1)
+    , m_firstCommand(stack ? stack->command(0) : nullptr)
+{
+    if (m_stack) {
+        connect(m_stack, &UndoStack::historyTruncated, this, &UndoHistoryModel::onHistoryTruncated);
+        connect(m_stack, &UndoStack::historyChanged, this, &UndoHistoryModel::sync);
+        connect(m_stack, &UndoStack::cleanChanged, this, &UndoHistoryModel::sync);
+    }
+}
+
+UndoHistoryModel::~UndoHistoryModel() = default;
+
+int UndoHistoryModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant UndoHistoryModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows || !m_stack) return QVariant();
+
+    const int row = index.row();
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return row == 0 ? tr("Initial State") : m_stack->text(row - 1);
+        case Qt::FontRole:
+            if (row == m_currentRow) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            return QVariant();
+        case IsCurrentRole:
+            return row == m_currentRow;
+        case IsCleanRole:
+            return row == m_cleanRow;
+        case TimestampRole: {
+            const UndoCommand* cmd = row > 0 ? dynamic_cast<const UndoCommand*>(m_stack->command(row - 1)) : nullptr;
+            return cmd ? QDateTime::fromMSecsSinceEpoch(cmd->lastEditTime()) : QVariant();
+        }
+        case AnnotationRole:
+            return m_annotationProvider ? m_annotationProvider(static_cast<quintptr>(row) + 1) : QVariant();
+        case StateIdRole:
+            return QVariant::fromValue(static_cast<quintptr>(row) + 1);
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> UndoHistoryModel::roleNames() const
+{
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names.insert(IsCurrentRole, "isCurrent");
+    names.insert(IsCleanRole, "isClean");
+    names.insert(TimestampRole, "timestamp");
+    names.insert(AnnotationRole, "annotation");
+    names.insert(StateIdRole, "stateId");
+    return names;
+}
+
+int UndoHistoryModel::currentRow() const
+{
+    return m_currentRow;
+}
+
+void UndoHistoryModel::setAnnotationProvider(std::function<QString(quintptr)> provider)
+{
+    m_annotationProvider = std::move(provider);
+}
+
+void UndoHistoryModel::annotationChanged(quintptr stateId)
+{
+    const int row = static_cast<int>(stateId) - 1;
+    if (row >= 0 && row < m_rows) {
+        emit dataChanged(index(row), index(row), {AnnotationRole});
+    }
+}
+
+void UndoHistoryModel::onHistoryTruncated(int index)
+{
+    m_truncatedFrom = m_truncatedFrom < 0 ? index : qMin(m_truncatedFrom, index);
+}
+
+void UndoHistoryModel::sync()
+{
+    if (!m_stack) return;
+
+    const int newRows = m_stack->count() + 1;
+    const int newCurrent = m_stack->index();
+    const int newClean = m_stack->cleanIndex();
+    const QUndoCommand* first = m_stack->command(0);
+
+    // The undo limit dropped commands at the front: every row shifted.
+    // Bounded by the limit, so a reset is cheap.
+    if (first != m_firstCommand && m_truncatedFrom != 0 && m_rows > 1 && newRows > 1) {
+        beginResetModel();
+        m_rows = newRows;
+        m_currentRow = newCurrent;
+        m_cleanRow = newClean;
+        m_truncatedFrom = -1;
+        m_firstCommand = first;
+        endResetModel();
+        return;
+    }
+    m_firstCommand = first;
+
+    if (newRows < m_rows) {
+        beginRemoveRows(QModelIndex(), newRows, m_rows - 1);
+        m_rows = newRows;
+        endRemoveRows();
+    }
+    // Rows after the truncation point now show the replacement commands
+    if (m_truncatedFrom >= 0 && m_truncatedFrom + 1 < m_rows) {
+        emit dataChanged(index(m_truncatedFrom + 1), index(m_rows - 1));
+    }
+    m_truncatedFrom = -1;
+    if (newRows > m_rows) {
+        beginInsertRows(QModelIndex(), m_rows, newRows - 1);
+        m_rows = newRows;
+        endInsertRows();
+    }
+
+    const int oldCurrent = m_currentRow;
+    const int oldClean = m_cleanRow;
+    m_currentRow = newCurrent;
+    m_cleanRow = newClean;
+    for (int row : {oldCurrent, newCurrent, oldClean, newClean}) {
+        // The current row is refreshed even if unchanged: a merge updates its command
+        if (row >= 0 && row < m_rows) {
+            emit dataChanged(index(row), index(row));
+        }
+    }
+}
+
+} // namespace QuantilyxDoc
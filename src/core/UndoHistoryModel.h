@@ -0,0 +1,95 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_UNDOHISTORYMODEL_H
+#define QUANTILYX_UNDOHISTORYMODEL_H
+
+#include <QAbstractListModel>
+#include <functional>
+
+class QUndoCommand;
+
+namespace QuantilyxDoc {
+
+class UndoStack;
+
+/**
+ * @brief List model over the undo history, one row per state.
+ *
+ * Row 0 is the initial state and row k the state after k commands. Rows
+ * are not stored: data() reads the command text from the UndoStack on
+ * demand, so a view with uniform item sizes (QListView::setUniformItemSizes)
+ * only touches the rows on screen, whatever the history length.
+ *
+ * The model follows UndoStack::historyChanged() incrementally: pushes
+ * insert rows at the end, a push after undo refreshes only the replaced
+ * rows, and moving the current index updates exactly two rows.
+ */
+class UndoHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IsCurrentRole = Qt::UserRole + 1,   // bool: the document is at this state
+        IsCleanRole,                        // bool: the state that was last saved
+        TimestampRole,                      // QDateTime of the command's latest edit
+        AnnotationRole,                     // QString user note (see setAnnotationProvider)
+        StateIdRole                         // quintptr UndoVisualization node id
+    };
+
+    /**
+     * @brief Constructor.
+     * @param stack The stack to present.
+     * @param parent Parent object.
+     */
+    explicit UndoHistoryModel(UndoStack* stack, QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~UndoHistoryModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Get the row of the current state.
+     */
+    int currentRow() const;
+
+    /**
+     * @brief Set a lookup for the AnnotationRole, keyed by state id.
+     */
+    void setAnnotationProvider(std::function<QString(quintptr)> provider);
+
+    /**
+     * @brief Notify the model that the annotation of a state changed.
+     * @param stateId Node id of the state.
+     */
+    void annotationChanged(quintptr stateId);
+
+private slots:
+    void onHistoryTruncated(int index);
+    void sync();
+
+private:
+    UndoStack* m_stack;
+    int m_rows;                         // Rows the view knows about
+    int m_currentRow;
+    int m_cleanRow;
+    int m_truncatedFrom;                // Earliest discarded command index since the last sync, or -1
+    const QUndoCommand* m_firstCommand; // Detects commands dropped at the front by the undo limit
+    std::function<QString(quintptr)> m_annotationProvider;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_UNDOHISTORYMODEL_H
@@ -8,20 +8,167 @@
  * (at your option) any later version.
  */
 #include "UndoStack.h"
+#include "UndoCommand.h"
+#include "EditJournal.h"
 #include "Document.h"
+#include "Logger.h"
 #include <QUndoStack>
 #include <QUndoCommand>
 #include <QPointer>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <QDir>
+#include <QDateTime>
 #include <QDebug>
 
 namespace QuantilyxDoc {
 
 class UndoStack::Private {
 public:
-    Private() : q(nullptr), qtUndoStack(nullptr), document(nullptr) {}
+    Private() : q(nullptr), qtUndoStack(nullptr), document(nullptr)
+        , memoryBudget(256LL * 1024 * 1024), residentBytes(0), spilledBytes(0)
+        , mergeWindowMs(1000), notifyTimer(nullptr)
+        , journalSyncTimer(nullptr), replaying(false), recoveryPending(false) {}
     UndoStack* q;
     QUndoStack* qtUndoStack;
     QPointer<Document> document; // Use QPointer to handle potential Document destruction
+
+    qint64 memoryBudget;
+    qint64 residentBytes;
+    qint64 spilledBytes;
+    std::unique_ptr<QTemporaryFile> journal; // Created on first spill
+
+    int mergeWindowMs;
+    QTimer* notifyTimer; // Coalesces historyChanged()
+
+    EditJournal editJournal;          // Crash-recovery journal of the current document
+    QTimer* journalSyncTimer;         // Bounds how long an edit stays unsynced
+    bool replaying;                   // Recovering; don't journal the replayed edits
+    bool recoveryPending;             // Journal holds records not yet replayed or discarded
+    QList<QMetaObject::Connection> documentConnections;
+
+    // Append one record to the edit journal
+    void appendJournal(EditJournalRecord::Op op, const QString& type = QString(),
+                       const QByteArray& payload = QByteArray(), int argument = 0,
+                       qint64 timeMs = 0) {
+        if (replaying || !editJournal.isOpen()) return;
+        if (recoveryPending) {
+            // Editing without recovering means the old records are abandoned
+            LOG_WARN("Discarding unrecovered edit journal " << editJournal.path());
+            recoveryPending = false;
+            editJournal.reset();
+        }
+
+        EditJournalRecord record;
+        record.op = op;
+        record.timeMs = timeMs ? timeMs : QDateTime::currentMSecsSinceEpoch();
+        record.type = type;
+        record.payload = payload;
+        record.argument = argument;
+        editJournal.append(record);
+
+        if (journalSyncTimer->interval() == 0) {
+            editJournal.sync();
+        } else if (!journalSyncTimer->isActive()) {
+            journalSyncTimer->start();
+        }
+    }
+
+    // Open the journal next to the document; an existing one is kept for recovery
+    void openJournal(Document* doc) {
+        editJournal.close();
+        recoveryPending = false;
+        if (!doc || doc->filePath().isEmpty()) return;
+        if (!editJournal.open(doc->filePath())) return;
+        // Records recovery could not replay are not worth offering
+        recoveryPending = replayableCount(editJournal.pendingRecords()) > 0;
+        if (!recoveryPending) {
+            editJournal.reset();
+        }
+    }
+
+    // Records replay gets through: it stops at an edit that was not
+    // journaled or whose command type cannot be recreated
+    static int replayableCount(const QList<EditJournalRecord>& records) {
+        int count = 0;
+        for (const EditJournalRecord& record : records) {
+            if (record.op == EditJournalRecord::Op::Barrier) break;
+            if (record.op == EditJournalRecord::Op::Push && !UndoCommand::isJournalTypeRegistered(record.type)) break;
+            ++count;
+        }
+        return count;
+    }
+
+    // Start the notification timer unless it is already pending; not
+    // restarting it keeps notifications flowing during a long drag
+    void scheduleNotify() {
+        if (!notifyTimer->isActive()) {
+            notifyTimer->start();
+        }
+    }
+
+    // Stop the command before the index from absorbing later commands
+    void closeMergeWindow() {
+        if (!qtUndoStack || qtUndoStack->index() == 0) return;
+        const QUndoCommand* top = qtUndoStack->command(qtUndoStack->index() - 1);
+        if (UndoCommand* undoCmd = const_cast<UndoCommand*>(dynamic_cast<const UndoCommand*>(top))) {
+            undoCmd->m_mergeClosed = true;
+        }
+    }
+
+    // Attach a command tree to this stack's accounting
+    void registerCommand(QUndoCommand* cmd) {
+        if (UndoCommand* undoCmd = dynamic_cast<UndoCommand*>(cmd)) {
+            if (!undoCmd->m_stack) {
+                undoCmd->m_stack = q;
+                residentBytes += undoCmd->m_cost;
+            }
+        }
+        for (int i = 0; i < cmd->childCount(); ++i) {
+            registerCommand(const_cast<QUndoCommand*>(cmd->child(i)));
+        }
+    }
+
+    // Spill every spillable command in a tree; stops once within budget
+    void spillTree(QUndoCommand* cmd) {
+        if (UndoCommand* undoCmd = dynamic_cast<UndoCommand*>(cmd)) {
+            if (undoCmd->m_cost > 0) {
+                undoCmd->spill();
+            }
+        }
+        for (int i = 0; i < cmd->childCount() && residentBytes > memoryBudget; ++i) {
+            spillTree(const_cast<QUndoCommand*>(cmd->child(i)));
+        }
+    }
+
+    // Spill commands farthest from the current index until within budget.
+    // The commands on either side of the index stay resident, since the
+    // next undo or redo will need them.
+    void enforceBudget() {
+        if (memoryBudget <= 0 || residentBytes <= memoryBudget || !qtUndoStack) return;
+
+        const int index = qtUndoStack->index();
+        int low = 0;
+        int high = qtUndoStack->count() - 1;
+        while (residentBytes > memoryBudget && low <= high) {
+            const int undoDistance = index - 1 - low;
+            const int redoDistance = high - index;
+            int pick;
+            if (undoDistance >= redoDistance) {
+                if (undoDistance <= 0) break;
+                pick = low++;
+            } else {
+                if (redoDistance <= 0) break;
+                pick = high--;
+            }
+            spillTree(const_cast<QUndoCommand*>(qtUndoStack->command(pick)));
+        }
+
+        if (residentBytes > memoryBudget) {
+            LOG_DEBUG("Undo stack holds " << residentBytes << " bytes, over its budget of "
+                      << memoryBudget << " after spilling");
+        }
+    }
 };
 
 // Static instance pointer
@@ -53,37 +200,84 @@ UndoStack::UndoStack(QObject* parent)
             this, &UndoStack::redoTextChanged);
     connect(d->qtUndoStack, &QUndoStack::cleanChanged,
             this, &UndoStack::cleanChanged);
+
+    d->notifyTimer = new QTimer(this);
+    d->notifyTimer->setSingleShot(true);
+    d->notifyTimer->setInterval(100);
+    connect(d->notifyTimer, &QTimer::timeout, this, &UndoStack::historyChanged);
+    // indexChanged also fires when a push was merged into the top command
+    connect(d->qtUndoStack, &QUndoStack::indexChanged, this, [this]() { d->scheduleNotify(); });
+
+    d->journalSyncTimer = new QTimer(this);
+    d->journalSyncTimer->setSingleShot(true);
+    d->journalSyncTimer->setInterval(1000);
+    connect(d->journalSyncTimer, &QTimer::timeout, this, [this]() { d->editJournal.sync(); });
 }
 
 UndoStack::~UndoStack()
 {
-    // d->qtUndoStack is automatically deleted by QObject parent-child mechanism
+    // Delete the commands while d (which they report to) is still alive,
+    // rather than leaving it to the QObject parent-child mechanism
+    delete d->qtUndoStack;
+    d->qtUndoStack = nullptr;
+    // Keep unsaved edits on disk for the next start; otherwise nothing to recover
+    if (d->document && !d->document->isModified()) {
+        d->editJournal.remove();
+    } else {
+        d->editJournal.close();
+    }
 }
 
 void UndoStack::push(QUndoCommand* cmd)
 {
-    if (d->qtUndoStack) {
+    if (d->qtUndoStack && cmd) {
+        // Serialize before pushing: a merged command is deleted inside push()
+        UndoCommand* undoCmd = dynamic_cast<UndoCommand*>(cmd);
+        const QString journalType = undoCmd ? undoCmd->journalType() : QString();
+        if (journalType.isEmpty()) {
+            d->appendJournal(EditJournalRecord::Op::Barrier);
+        } else {
+            d->appendJournal(EditJournalRecord::Op::Push, journalType, undoCmd->journalPayload(), 0,
+                       undoCmd->m_lastEditMs);
+        }
+
+        // Pushing after undo drops the redo branch
+        if (d->qtUndoStack->index() < d->qtUndoStack->count()) {
+            emit historyTruncated(d->qtUndoStack->index());
+        }
+
+        // Register before pushing for the same reason
+        d->registerCommand(cmd);
         d->qtUndoStack->push(cmd);
+        d->enforceBudget();
     }
 }
 
 void UndoStack::undo()
 {
     if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::Undo);
         d->qtUndoStack->undo();
+        d->closeMergeWindow(); // Don't merge new edits into an older step
+        d->enforceBudget(); // The undone command may have been reloaded
     }
 }
 
 void UndoStack::redo()
 {
     if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::Redo);
         d->qtUndoStack->redo();
+        d->closeMergeWindow();
+        d->enforceBudget();
     }
 }
 
 void UndoStack::clear()
 {
     if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::Clear);
+        emit historyTruncated(0);
         d->qtUndoStack->clear();
     }
 }
@@ -110,12 +304,13 @@ QString UndoStack::redoText() const
 
 int UndoStack::undoStackSize() const
 {
-    return d->qtUndoStack ? d->qtUndoStack->count() - d->qtUndoStack->index() : 0;
+    // Commands below the index have been applied and can be undone
+    return d->qtUndoStack ? d->qtUndoStack->index() : 0;
 }
 
 int UndoStack::redoStackSize() const
 {
-    return d->qtUndoStack ? d->qtUndoStack->index() : 0;
+    return d->qtUndoStack ? d->qtUndoStack->count() - d->qtUndoStack->index() : 0;
 }
 
 void UndoStack::setUndoLimit(int limit)
@@ -130,9 +325,95 @@ int UndoStack::undoLimit() const
     return d->qtUndoStack ? d->qtUndoStack->undoLimit() : 0;
 }
 
+void UndoStack::setMemoryBudget(qint64 bytes)
+{
+    d->memoryBudget = qMax<qint64>(0, bytes);
+    d->enforceBudget();
+}
+
+qint64 UndoStack::memoryBudget() const
+{
+    return d->memoryBudget;
+}
+
+qint64 UndoStack::residentBytes() const
+{
+    return d->residentBytes;
+}
+
+qint64 UndoStack::spilledBytes() const
+{
+    return d->spilledBytes;
+}
+
+void UndoStack::setMergeWindow(int msecs)
+{
+    d->mergeWindowMs = qMax(0, msecs);
+}
+
+int UndoStack::mergeWindow() const
+{
+    return d->mergeWindowMs;
+}
+
+void UndoStack::closeMergeWindow()
+{
+    d->appendJournal(EditJournalRecord::Op::CloseMerge);
+    d->closeMergeWindow();
+}
+
+void UndoStack::setNotificationInterval(int msecs)
+{
+    d->notifyTimer->setInterval(qMax(0, msecs));
+}
+
+int UndoStack::notificationInterval() const
+{
+    return d->notifyTimer->interval();
+}
+
+int UndoStack::count() const
+{
+    return d->qtUndoStack ? d->qtUndoStack->count() : 0;
+}
+
+int UndoStack::index() const
+{
+    return d->qtUndoStack ? d->qtUndoStack->index() : 0;
+}
+
+QString UndoStack::text(int idx) const
+{
+    return d->qtUndoStack ? d->qtUndoStack->text(idx) : QString();
+}
+
+const QUndoCommand* UndoStack::command(int idx) const
+{
+    return d->qtUndoStack ? d->qtUndoStack->command(idx) : nullptr;
+}
+
+int UndoStack::cleanIndex() const
+{
+    return d->qtUndoStack ? d->qtUndoStack->cleanIndex() : -1;
+}
+
+void UndoStack::setIndex(int idx)
+{
+    if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::SetIndex, QString(), QByteArray(), idx);
+        d->qtUndoStack->setIndex(idx);
+        d->closeMergeWindow();
+        d->enforceBudget();
+    }
+}
+
 void UndoStack::beginMacro(const QString& text)
 {
     if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::BeginMacro, text);
+        if (d->qtUndoStack->index() < d->qtUndoStack->count()) {
+            emit historyTruncated(d->qtUndoStack->index());
+        }
         d->qtUndoStack->beginMacro(text);
     }
 }
@@ -140,7 +421,9 @@ void UndoStack::beginMacro(const QString& text)
 void UndoStack::endMacro()
 {
     if (d->qtUndoStack) {
+        d->appendJournal(EditJournalRecord::Op::EndMacro);
         d->qtUndoStack->endMacro();
+        d->enforceBudget();
     }
 }
 
@@ -151,7 +434,169 @@ Document* UndoStack::document() const
 
 void UndoStack::setDocument(Document* doc)
 {
+    if (d->document == doc) return;
+
+    for (const QMetaObject::Connection& connection : d->documentConnections) {
+        disconnect(connection);
+    }
+    d->documentConnections.clear();
+    d->journalSyncTimer->stop();
+    if (d->document && !d->document->isModified()) {
+        d->editJournal.remove();
+    } else {
+        d->editJournal.close(); // Synced; left for recovery if the edits are never saved
+    }
+
+    // The history belongs to the previous document. Journal records store
+    // absolute stack indexes, so the new document's journal must start from
+    // an empty stack. Not journaled: the old journal is already closed.
+    if (d->qtUndoStack->count() > 0) {
+        emit historyTruncated(0);
+        d->qtUndoStack->clear();
+    }
+
     d->document = doc; // QPointer handles deletion automatically
+    d->openJournal(doc);
+
+    if (doc) {
+        d->documentConnections << connect(doc, &Document::saved, this, &UndoStack::setClean);
+        // A document closed on purpose leaves nothing to recover
+        d->documentConnections << connect(doc, &Document::closed, this, [this]() {
+            d->journalSyncTimer->stop();
+            d->editJournal.remove();
+        });
+    }
+}
+
+bool UndoStack::hasRecoverableEdits() const
+{
+    return d->recoveryPending;
+}
+
+int UndoStack::recoverableEditCount() const
+{
+    return d->recoveryPending ? Private::replayableCount(d->editJournal.pendingRecords()) : 0;
+}
+
+int UndoStack::recoverFromJournal()
+{
+    if (!d->recoveryPending || !d->qtUndoStack) return 0;
+
+    const QList<EditJournalRecord> records = d->editJournal.pendingRecords();
+    d->recoveryPending = false;
+    d->replaying = true;
+
+    int replayed = 0;
+    qint64 keepUntil = 0;
+    for (const EditJournalRecord& record : records) {
+        bool ok = true;
+        switch (record.op) {
+            case EditJournalRecord::Op::Push: {
+                UndoCommand* cmd = UndoCommand::fromJournal(record.type, d->document.data(), record.payload);
+                if (!cmd) {
+                    LOG_WARN("Cannot recreate journaled command of type '" << record.type << "'; stopping recovery");
+                    ok = false;
+                    break;
+                }
+                cmd->m_lastEditMs = record.timeMs; // Merge as the original edits did
+                push(cmd);
+                break;
+            }
+            case EditJournalRecord::Op::Undo:       undo(); break;
+            case EditJournalRecord::Op::Redo:       redo(); break;
+            case EditJournalRecord::Op::SetIndex:   setIndex(record.argument); break;
+            case EditJournalRecord::Op::CloseMerge: closeMergeWindow(); break;
+            case EditJournalRecord::Op::BeginMacro: beginMacro(record.type); break;
+            case EditJournalRecord::Op::EndMacro:   endMacro(); break;
+            case EditJournalRecord::Op::Clear:      clear(); break;
+            case EditJournalRecord::Op::Barrier:
+                LOG_WARN("Journal reaches an edit that was not journaled; stopping recovery");
+                ok = false;
+                break;
+        }
+        if (!ok) break;
+        keepUntil = record.endOffset;
+        ++replayed;
+    }
+
+    d->replaying = false;
+    // Later appends continue from the last replayed record
+    d->editJournal.keepPending(keepUntil);
+    if (replayed > 0 && d->document) {
+        d->document->setModified(true);
+    }
+    LOG_INFO("Recovered " << replayed << " of " << records.size() << " journaled edits");
+    return replayed;
+}
+
+void UndoStack::discardJournal()
+{
+    d->recoveryPending = false;
+    if (d->editJournal.isOpen()) {
+        d->editJournal.reset();
+    }
+}
+
+void UndoStack::setClean()
+{
+    if (d->qtUndoStack) {
+        d->qtUndoStack->setClean();
+    }
+    // The saved file now contains every edit; journal from here on
+    d->recoveryPending = false;
+    d->journalSyncTimer->stop();
+    if (d->editJournal.isOpen()) {
+        d->editJournal.reset();
+    }
+}
+
+void UndoStack::setJournalSyncInterval(int msecs)
+{
+    d->journalSyncTimer->setInterval(qMax(0, msecs));
+}
+
+int UndoStack::journalSyncInterval() const
+{
+    return d->journalSyncTimer->interval();
+}
+
+void UndoStack::accountCommand(qint64 residentDelta, qint64 spilledDelta)
+{
+    d->residentBytes += residentDelta;
+    d->spilledBytes += spilledDelta;
+
+    // The journal is append-only; once nothing references it, start over
+    if (d->spilledBytes == 0 && d->journal && d->journal->size() > 0) {
+        d->journal->resize(0);
+        d->journal->seek(0);
+    }
+}
+
+qint64 UndoStack::writeJournal(const QByteArray& data)
+{
+    if (!d->journal) {
+        d->journal.reset(new QTemporaryFile(QDir::temp().filePath("quantilyxdoc-undo-XXXXXX.journal")));
+        if (!d->journal->open()) {
+            LOG_ERROR("Cannot create undo journal: " << d->journal->errorString());
+            d->journal.reset();
+            return -1;
+        }
+    }
+
+    const qint64 offset = d->journal->size();
+    if (!d->journal->seek(offset) || d->journal->write(data) != data.size()) {
+        LOG_ERROR("Cannot write undo journal: " << d->journal->errorString());
+        return -1;
+    }
+    return offset;
+}
+
+QByteArray UndoStack::readJournal(qint64 offset, qint64 length)
+{
+    if (!d->journal || !d->journal->flush() || !d->journal->seek(offset)) {
+        return QByteArray();
+    }
+    return d->journal->read(length);
 }
 
 } // namespace QuantilyxDoc
\ No newline at end of file
@@ -19,6 +19,7 @@
 namespace QuantilyxDoc {
 
 class Document;
+class UndoCommand;
 
 /**
  * @brief Extended undo stack supporting unlimited levels and branching.
@@ -27,7 +28,21 @@ class Document;
  * - Visual undo/redo tree visualization (requires UndoVisualization).
  * - Better integration with document states.
  * - Custom command grouping.
- * For now, it acts as a wrapper around QUndoStack.
+ *
+ * Memory is bounded by a byte budget rather than a command count: each
+ * UndoCommand reports its cost, and when the resident total exceeds the
+ * budget the commands farthest from the current index are spilled to a
+ * temporary journal file, to be reloaded when undo/redo reaches them.
+ *
+ * Continuous edits are coalesced: UndoCommands with the same merge id and
+ * target merge while they arrive within the merge window, and listeners
+ * such as UndoVisualization get at most one historyChanged() per
+ * notification interval instead of one signal per push.
+ *
+ * Every push, undo and redo is also appended to the document's EditJournal
+ * (fsynced periodically), so edits made since the last save survive a
+ * crash: after reopening, recoverFromJournal() replays them over the saved
+ * file.
  */
 class UndoStack : public QObject
 {
@@ -53,6 +68,8 @@ public:
 
     /**
      * @brief Push a command onto the stack.
+     * UndoCommand instances (and UndoCommand children) take part in memory
+     * accounting; plain QUndoCommands are treated as free.
      * @param cmd The command to push.
      */
     void push(QUndoCommand* cmd);
@@ -120,6 +137,98 @@ public:
      */
     int undoLimit() const;
 
+    /**
+     * @brief Set the memory budget for resident command state.
+     * @param bytes Budget in bytes (0 disables spilling).
+     */
+    void setMemoryBudget(qint64 bytes);
+
+    /**
+     * @brief Get the memory budget for resident command state.
+     * @return Budget in bytes (default 256 MiB).
+     */
+    qint64 memoryBudget() const;
+
+    /**
+     * @brief Get the memory currently held by command state.
+     * @return Sum of the costs of commands not spilled to disk.
+     */
+    qint64 residentBytes() const;
+
+    /**
+     * @brief Get the size of command state currently spilled to the journal.
+     * @return Bytes on disk that are still referenced.
+     */
+    qint64 spilledBytes() const;
+
+    /**
+     * @brief Set how long a pause may be before a continuous edit starts a new command.
+     * @param msecs Merge window in milliseconds (0 merges regardless of time).
+     */
+    void setMergeWindow(int msecs);
+
+    /**
+     * @brief Get the merge window.
+     * @return Merge window in milliseconds (default 1000).
+     */
+    int mergeWindow() const;
+
+    /**
+     * @brief End the current continuous edit (e.g. on mouse release).
+     * The next command starts a new undo step even if it would merge.
+     */
+    void closeMergeWindow();
+
+    /**
+     * @brief Set the minimum interval between historyChanged() signals.
+     * @param msecs Interval in milliseconds (0 notifies on the next event loop pass).
+     */
+    void setNotificationInterval(int msecs);
+
+    /**
+     * @brief Get the minimum interval between historyChanged() signals.
+     * @return Interval in milliseconds (default 100).
+     */
+    int notificationInterval() const;
+
+    /**
+     * @brief Get the total number of commands (undoable and redoable).
+     * @return Command count.
+     */
+    int count() const;
+
+    /**
+     * @brief Get the current index (number of applied commands).
+     * @return Index in [0, count()].
+     */
+    int index() const;
+
+    /**
+     * @brief Get the text of the command at an index.
+     * @param idx Command index.
+     * @return Command text.
+     */
+    QString text(int idx) const;
+
+    /**
+     * @brief Get the command at an index.
+     * @param idx Command index.
+     * @return The command, or nullptr if out of range.
+     */
+    const QUndoCommand* command(int idx) const;
+
+    /**
+     * @brief Get the index at which the document was last saved.
+     * @return Clean index, or -1 if that state is no longer in the history.
+     */
+    int cleanIndex() const;
+
+    /**
+     * @brief Undo or redo until the index is reached.
+     * @param idx Target index in [0, count()].
+     */
+    void setIndex(int idx);
+
     /**
      * @brief Begin a macro command group.
      * Commands pushed after this call will be grouped together.
@@ -140,10 +249,56 @@ public:
 
     /**
      * @brief Set the associated document.
+     * A different document clears the history and closes the previous
+     * document's edit journal; its commands cannot apply to the new one.
      * @param doc The document this stack operates on.
      */
     void setDocument(Document* doc);
 
+    /**
+     * @brief Check if the document's journal holds edits from a session that crashed.
+     * @return True if recoverFromJournal() has something to replay.
+     */
+    bool hasRecoverableEdits() const;
+
+    /**
+     * @brief Get the number of journal records left by the crashed session
+     * that recoverFromJournal() can replay, i.e. those before the first edit
+     * that was not journaled or whose command type is not registered.
+     */
+    int recoverableEditCount() const;
+
+    /**
+     * @brief Replay the journaled edits over the freshly opened document.
+     * Replay stops at the first command that cannot be recreated; the
+     * journal continues from there.
+     * @return Number of records replayed.
+     */
+    int recoverFromJournal();
+
+    /**
+     * @brief Throw away journaled edits from a crashed session and start a new journal.
+     */
+    void discardJournal();
+
+    /**
+     * @brief Mark the current state as saved: sets the clean index and restarts the journal.
+     * Called automatically when the document emits saved().
+     */
+    void setClean();
+
+    /**
+     * @brief Set how often journaled edits are fsynced.
+     * @param msecs Maximum time an edit stays unsynced (0 syncs every edit).
+     */
+    void setJournalSyncInterval(int msecs);
+
+    /**
+     * @brief Get how often journaled edits are fsynced.
+     * @return Interval in milliseconds (default 1000).
+     */
+    int journalSyncInterval() const;
+
 signals:
     /**
      * @brief Emitted when undo/redo availability changes.
@@ -162,9 +317,31 @@ signals:
      */
     void cleanChanged();
 
+    /**
+     * @brief Emitted after commands were pushed, merged, undone or redone.
+     * Coalesced: at most one emission per notification interval.
+     */
+    void historyChanged();
+
+    /**
+     * @brief Emitted (immediately, not coalesced) before the commands from an
+     * index onward are discarded: a push after undo, or clear().
+     * @param index First command index that is removed.
+     */
+    void historyTruncated(int index);
+
 private:
+    friend class UndoCommand;
+
+    // Called by UndoCommand when its resident or spilled size changes
+    void accountCommand(qint64 residentDelta, qint64 spilledDelta);
+    // Append spilled state to the journal; returns its offset or -1
+    qint64 writeJournal(const QByteArray& data);
+    QByteArray readJournal(qint64 offset, qint64 length);
+
     class Private;
     std::unique_ptr<Private> d;
+    static UndoStack* s_instance;
 };
 
 } // namespace QuantilyxDoc
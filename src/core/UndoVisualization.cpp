@@ -7,98 +7,71 @@
  * the Free Software Foundation, either version 3 of the License, or
  * (at your option) any later version.
  */
-#include "UndoVisualization.h"
+#include "UndoVizualization.h"
+#include "UndoHistoryModel.h"
 #include "UndoStack.h"
+#include "UndoCommand.h"
 #include "Document.h"
 #include "Logger.h"
-#include <QUndoStack>
 #include <QUndoCommand>
 #include <QMutex>
+#include <QPointer>
 #include <QMutexLocker>
 #include <QDateTime>
 #include <QImage>
-#include <QApplication> // For thumbnail generation context
-#include <QThread>      // To check if running on main thread
 
 namespace QuantilyxDoc {
 
 class UndoVisualization::Private {
 public:
     Private(UndoVisualization* q_ptr)
-        : q(q_ptr), document(nullptr), maxStates(100), autoThumbnailEnabled(false) {}
+        : q(q_ptr), document(nullptr), undoStack(nullptr), historyModel(nullptr)
+        , maxStates(100), autoThumbnailEnabled(false) {}
 
     UndoVisualization* q;
     QPointer<Document> document; // Use QPointer for safety
-    QUndoStack* qtUndoStack; // Weak pointer, owned by UndoStack singleton
-    mutable QMutex mutex; // Protect access to treeNodes map
-    QHash<quintptr, UndoStateNode> treeNodes; // ID -> Node
-    quintptr rootNodeId; // ID of the root node
-    quintptr currentId;  // ID of the current state node
+    UndoStack* undoStack; // Weak pointer, the UndoStack singleton
+    UndoHistoryModel* historyModel; // Owned by q
+    mutable QMutex mutex; // Protect access to the sparse per-state data
+    QHash<quintptr, QString> annotations; // Node ID -> annotation
+    QHash<quintptr, QImage> thumbnails;   // Node ID -> thumbnail
     int maxStates;
     bool autoThumbnailEnabled;
-    quintptr nextId; // For generating unique node IDs
-
-    // Helper to get current node from UndoStack index
-    quintptr getCurrentStateIdFromStack() const {
-        if (!qtUndoStack) return 0;
-        // This is a simplification. UndoStack doesn't directly expose state IDs.
-        // A real implementation would need to track IDs alongside QUndoCommand pushes.
-        // For now, we'll use the index as a proxy, though it's not ideal for branching.
-        // A better approach is to listen to push/undo/redo and maintain an internal map.
-        // This requires deeper integration with UndoStack's command execution.
-        // Let's assume an internal map: QHash<QUndoCommand*, quintptr> commandToId;
-        // This is complex and requires modifying UndoStack. We'll outline the concept.
-        // For this stub, we'll use a simple counter and assume linear history.
-        // This does NOT support branching correctly.
-        return currentId; // Return the last known current ID
+
+    // The state after k commands has node ID k + 1; 0 stays "no node"
+    static quintptr idForState(int state) { return static_cast<quintptr>(state) + 1; }
+    static int stateForId(quintptr id) { return static_cast<int>(id) - 1; }
+
+    int stateCount() const {
+        return undoStack ? undoStack->count() + 1 : 0;
     }
 
-    // Helper to build the tree structure from UndoStack's linear history
-    // This is a simplified approach assuming no branching for now.
-    void rebuildTreeFromLinearHistory() {
-        if (!qtUndoStack) return;
-
-        QMutexLocker locker(&mutex);
-        treeNodes.clear();
-        rootNodeId = 0;
-        currentId = 0;
-
-        // This logic is challenging without deep UndoStack integration.
-        // We'll simulate a simple linear tree based on UndoStack's state.
-        // A real branching tree needs UndoStack to track states as nodes in a graph.
-        // This requires significant changes to UndoStack or a custom implementation.
-        // For now, we'll create a linear chain of states.
-        int index = 0; // Start from 0 (initial state)
-        int count = qtUndoStack->count();
-        int currentIndex = qtUndoStack->index(); // Current position
-
-        for (int i = 0; i <= count; ++i) { // count+1 because index can be at 'count' (after last command)
-            quintptr id = nextId++;
-            UndoStateNode node;
-            node.id = id;
-            node.parentId = (i > 0) ? (id - 1) : 0; // Simple linear parent
-            node.depth = i;
-            node.isCurrent = (i == currentIndex);
-            node.timestamp = QDateTime::currentDateTime();
-            if (i < count) { // If it's a command state (not the initial state)
-                 node.commandText = qtUndoStack->text(i);
-                 // Link child to next state
-                 if (i + 1 <= count) {
-                     node.childIds.append(id + 1);
-                 }
-            } else {
-                 node.commandText = "Initial State";
-            }
+    // Materialize one node from the stack; caller holds the mutex
+    UndoStateNode nodeForState(int state) const {
+        UndoStateNode node;
+        if (state < 0 || state >= stateCount()) return node;
 
-            treeNodes.insert(id, node);
-            if (node.isCurrent) {
-                currentId = id;
-            }
-            if (rootNodeId == 0) { // First node is root
-                rootNodeId = id;
+        const int count = undoStack->count();
+        node.id = idForState(state);
+        node.parentId = state > 0 ? idForState(state - 1) : 0;
+        if (state < count) {
+            node.childIds.append(idForState(state + 1));
+        }
+        node.depth = state;
+        node.isCurrent = (state == undoStack->index());
+        node.isSaved = (state == undoStack->cleanIndex());
+        if (state == 0) {
+            node.commandText = QObject::tr("Initial State");
+        } else {
+            node.commandText = undoStack->text(state - 1);
+            const UndoCommand* cmd = dynamic_cast<const UndoCommand*>(undoStack->command(state - 1));
+            if (cmd) {
+                node.timestamp = QDateTime::fromMSecsSinceEpoch(cmd->lastEditTime());
             }
         }
-        LOG_DEBUG("Rebuilt undo tree with " << treeNodes.size() << " nodes.");
+        node.annotation = annotations.value(node.id);
+        node.thumbnail = thumbnails.value(node.id);
+        return node;
     }
 };
 
@@ -117,41 +90,40 @@ UndoVisualization::UndoVisualization(QObject* parent)
     : QObject(parent)
     , d(new Private(this))
 {
-    d->nextId = 1; // Start IDs from 1
-    // Connect to UndoStack signals to react to changes
-    // This requires UndoStack to emit signals when commands are pushed/undone/redone.
-    // We'll assume UndoStack::instance() has signals like commandPushed, commandUndone, commandRedone.
-    // UndoStack* uStack = &UndoStack::instance();
-    // connect(uStack, &UndoStack::indexChanged, this, &UndoVisualization::onUndoStackIndexChanged);
-    // connect(uStack, &UndoStack::commandExecuted, this, &UndoVisualization::onUndoCommandExecuted); // Custom signal needed
+    // React to UndoStack changes. historyChanged() is coalesced by the stack,
+    // so a drag or ink stroke notifies views a few times per second rather
+    // than once per mouse event.
+    UndoStack* uStack = &UndoStack::instance();
+    connect(uStack, &UndoStack::historyChanged,
+            this, &UndoVisualization::onUndoStackIndexChanged);
+    connect(uStack, &UndoStack::historyTruncated,
+            this, &UndoVisualization::onHistoryTruncated);
+
+    d->historyModel = new UndoHistoryModel(uStack, this);
+    d->historyModel->setAnnotationProvider([this](quintptr id) { return annotationForState(id); });
 }
 
-UndoVisualization::~UndoVisualization()
-{
-    // d->treeNodes will be cleared automatically by QHash destructor
-}
+UndoVisualization::~UndoVisualization() = default;
 
 void UndoVisualization::setDocument(Document* doc)
 {
     if (d->document == doc) return;
 
     // Disconnect from old document's undo stack if necessary
-    if (d->document && d->qtUndoStack) {
-         // Disconnect signals from previous UndoStack
-         // disconnect(d->qtUndoStack, ...);
+    if (d->document && d->undoStack) {
+         // The UndoStack singleton stays connected; nothing to disconnect
     }
 
     d->document = doc;
     if (doc) {
         UndoStack* uStack = &UndoStack::instance();
         uStack->setDocument(doc); // Ensure UndoStack knows about the document
-        d->qtUndoStack = uStack->qsettings(); // Assuming a method to access internal QUndoStack
-        // Connect to new document's undo stack signals
-        // connect(d->qtUndoStack, ...);
-        d->rebuildTreeFromLinearHistory(); // Rebuild for the new document
+        d->undoStack = uStack;
+        emit treeChanged();
+        emit currentStateChanged();
     } else {
-        d->qtUndoStack = nullptr;
-        d->clear();
+        d->undoStack = nullptr;
+        clear();
     }
     LOG_DEBUG("UndoVisualization set to document: " << (doc ? doc->filePath() : "nullptr"));
 }
@@ -164,36 +136,28 @@ Document* UndoVisualization::document() const
 UndoStateNode UndoVisualization::getRootNode() const
 {
     QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.constFind(d->rootNodeId);
-    return (it != d->treeNodes.constEnd()) ? it.value() : UndoStateNode();
+    return d->nodeForState(0);
 }
 
 UndoStateNode UndoVisualization::getCurrentNode() const
 {
     QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.constFind(d->currentId);
-    return (it != d->treeNodes.constEnd()) ? it.value() : UndoStateNode();
+    return d->undoStack ? d->nodeForState(d->undoStack->index()) : UndoStateNode();
 }
 
 UndoStateNode UndoVisualization::getNodeById(quintptr id) const
 {
     QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.constFind(id);
-    return (it != d->treeNodes.constEnd()) ? it.value() : UndoStateNode();
+    return d->nodeForState(Private::stateForId(id));
 }
 
 QList<UndoStateNode> UndoVisualization::getChildren(quintptr parentId) const
 {
     QList<UndoStateNode> children;
     QMutexLocker locker(&d->mutex);
-    auto parentIt = d->treeNodes.constFind(parentId);
-    if (parentIt != d->treeNodes.constEnd()) {
-        for (quintptr childId : parentIt->childIds) {
-            auto childIt = d->treeNodes.constFind(childId);
-            if (childIt != d->treeNodes.constEnd()) {
-                children.append(childIt.value());
-            }
-        }
+    const UndoStateNode parent = d->nodeForState(Private::stateForId(parentId));
+    for (quintptr childId : parent.childIds) {
+        children.append(d->nodeForState(Private::stateForId(childId)));
     }
     return children;
 }
@@ -201,65 +165,56 @@ QList<UndoStateNode> UndoVisualization::getChildren(quintptr parentId) const
 QList<UndoStateNode> UndoVisualization::getTreeNodes() const
 {
     QMutexLocker locker(&d->mutex);
+    const int states = d->stateCount();
+    const int first = qMax(0, states - d->maxStates);
     QList<UndoStateNode> nodes;
-    nodes.reserve(d->treeNodes.size());
-    for (const auto& node : d->treeNodes) {
-        nodes.append(node);
+    nodes.reserve(states - first);
+    for (int state = first; state < states; ++state) {
+        nodes.append(d->nodeForState(state));
     }
     return nodes;
 }
 
 bool UndoVisualization::navigateToState(quintptr nodeId)
 {
-    // This requires UndoStack to be able to jump to an arbitrary state ID.
-    // UndoStack only knows about command indices. This is a fundamental mismatch.
-    // A full implementation requires UndoStack to manage a graph of states, not just a linear stack.
-    // For now, we can only navigate to states that correspond to known indices in the current linear history.
-    QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.constFind(nodeId);
-    if (it != d->treeNodes.constEnd()) {
-        // Find the corresponding index in the linear UndoStack history
-        // This is difficult without storing the index in the node itself during rebuildTreeFromLinearHistory.
-        // We'd need to map nodeId -> UndoStack index.
-        // This requires UndoStack to notify us of the *new* index whenever a command is undone/redone/pushed.
-        // This is a complex synchronization problem.
-        LOG_WARN("navigateToState: Full implementation requires UndoStack graph support. Attempting linear navigation.");
-        // A stub: if nodeId corresponds to a command index (or initial state), navigate.
-        // This only works for linear history.
-        int targetIndex = static_cast<int>(nodeId - 1); // Assuming linear ID == index + 1
-        if (targetIndex >= 0 && targetIndex <= d->qtUndoStack->count()) {
-             d->qtUndoStack->setIndex(targetIndex);
-             // onUndoStackIndexChanged will be called, updating the tree
-             return true;
-        }
+    // History is linear: node IDs map directly to stack indices
+    const int targetIndex = Private::stateForId(nodeId);
+    if (!d->undoStack || targetIndex < 0 || targetIndex > d->undoStack->count()) {
+        return false;
     }
-    return false;
+    // Not under the mutex: setIndex() runs commands, and listeners may call back in
+    d->undoStack->setIndex(targetIndex);
+    return true;
 }
 
 bool UndoVisualization::annotateState(quintptr nodeId, const QString& annotation)
 {
-    QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.find(nodeId);
-    if (it != d->treeNodes.end()) {
-        it->annotation = annotation;
-        emit annotationChanged(nodeId, annotation);
-        return true;
+    {
+        QMutexLocker locker(&d->mutex);
+        const int state = Private::stateForId(nodeId);
+        if (state < 0 || state >= d->stateCount()) return false;
+        if (annotation.isEmpty()) {
+            d->annotations.remove(nodeId);
+        } else {
+            d->annotations.insert(nodeId, annotation);
+        }
     }
-    return false;
+    d->historyModel->annotationChanged(nodeId);
+    emit annotationChanged(nodeId, annotation);
+    return true;
 }
 
 QString UndoVisualization::annotationForState(quintptr nodeId) const
 {
     QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.constFind(nodeId);
-    return (it != d->treeNodes.constEnd()) ? it->annotation : QString();
+    return d->annotations.value(nodeId);
 }
 
 QImage UndoVisualization::generateThumbnailForState(quintptr nodeId)
 {
     QMutexLocker locker(&d->mutex);
-    auto it = d->treeNodes.find(nodeId);
-    if (it == d->treeNodes.end()) return QImage();
+    const int state = Private::stateForId(nodeId);
+    if (state < 0 || state >= d->stateCount()) return QImage();
 
     // This is a major challenge. To get a thumbnail of a *past* state,
     // you need to reconstruct the document as it was at that point.
@@ -274,7 +229,8 @@ QImage UndoVisualization::generateThumbnailForState(quintptr nodeId)
     // Draw a simple icon or text indicating "State X"
     // QPainter painter(&placeholder);
     // painter.drawText(placeholder.rect(), Qt::AlignCenter, QString("State\n%1").arg(nodeId));
-    it->thumbnail = placeholder;
+    d->thumbnails.insert(nodeId, placeholder);
+    locker.unlock();
     emit thumbnailGenerated(nodeId, placeholder);
     return placeholder;
 }
@@ -291,8 +247,6 @@ void UndoVisualization::setMaxVisualizedStates(int count)
     QMutexLocker locker(&d->mutex);
     if (d->maxStates != count) {
         d->maxStates = count;
-        // Truncate tree if necessary
-        // This requires a more complex tree management strategy.
         LOG_INFO("Max visualized undo states set to " << count);
     }
 }
@@ -313,34 +267,28 @@ bool UndoVisualization::isAutoThumbnailGenerationEnabled() const
 void UndoVisualization::clear()
 {
     QMutexLocker locker(&d->mutex);
-    d->treeNodes.clear();
-    d->rootNodeId = 0;
-    d->currentId = 0;
-    LOG_DEBUG("Cleared undo visualization tree.");
+    d->annotations.clear();
+    d->thumbnails.clear();
+    LOG_DEBUG("Cleared undo visualization data.");
+}
+
+UndoHistoryModel* UndoVisualization::historyModel() const
+{
+    return d->historyModel;
 }
 
 void UndoVisualization::onUndoStackIndexChanged()
 {
-    // Update the current state ID based on the stack's new index
-    // This requires UndoStack to provide a way to map its index to our node ID.
-    // A simple approach: maintain a map of UndoStack index -> Node ID inside this class.
-    // When UndoStack index changes, look up the corresponding Node ID.
-    // This map must be updated whenever commands are pushed/undone/redone.
-    // This is part of the complex synchronization needed.
-    // For now, rebuild the tree (inefficient but functional for linear history).
-    d->rebuildTreeFromLinearHistory();
+    // Nodes are read from the stack on demand, so there is nothing to rebuild;
+    // the history model updates itself from the same signal
     emit currentStateChanged();
     emit treeChanged();
 }
 
 void UndoVisualization::onUndoCommandExecuted(const QUndoCommand* cmd)
 {
-    // A new command was pushed onto the stack.
-    // Create a new node and add it to the tree.
-    // This requires UndoStack to emit this signal *after* the command is added and the index is updated.
-    // We need the new index to create the node correctly.
+    // A new command was pushed onto the stack; its node already exists
     Q_UNUSED(cmd);
-    d->rebuildTreeFromLinearHistory(); // For now, rebuild
     emit treeChanged();
     if (d->autoThumbnailEnabled) {
         // Request thumbnail generation for the new current state
@@ -352,4 +300,17 @@ void UndoVisualization::onUndoCommandExecuted(const QUndoCommand* cmd)
     }
 }
 
-} // namespace QuantilyxDoc
\ No newline at end of file
+void UndoVisualization::onHistoryTruncated(int index)
+{
+    // States after `index` commands are about to be replaced; their IDs will be reused
+    QMutexLocker locker(&d->mutex);
+    const quintptr firstDropped = Private::idForState(index + 1);
+    for (auto it = d->annotations.begin(); it != d->annotations.end();) {
+        it = it.key() >= firstDropped ? d->annotations.erase(it) : std::next(it);
+    }
+    for (auto it = d->thumbnails.begin(); it != d->thumbnails.end();) {
+        it = it.key() >= firstDropped ? d->thumbnails.erase(it) : std::next(it);
+    }
+}
+
+} // namespace QuantilyxDoc
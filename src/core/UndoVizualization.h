@@ -21,6 +21,7 @@ namespace QuantilyxDoc {
 
 class Document;
 class UndoStack;
+class UndoHistoryModel;
 
 /**
  * @brief Represents a single state in the undo/redo history tree.
@@ -48,9 +49,15 @@ struct UndoStateNode {
 /**
  * @brief Provides data and logic for visualizing the undo/redo history tree.
  * 
- * This class interfaces with the UndoStack to build and maintain a tree
- * representation of the document's modification history, suitable for
- * display in a UI panel. It can generate thumbnails and manage annotations.
+ * This class interfaces with the UndoStack to present the document's
+ * modification history, suitable for display in a UI panel. It can generate
+ * thumbnails and manage annotations.
+ *
+ * Nodes are not stored: the state after k commands has id k + 1 and is
+ * materialized from the UndoStack when asked for, so following a long
+ * history costs nothing per edit. Only annotations and thumbnails are kept,
+ * sparsely, and dropped when the states they belong to are discarded.
+ * Views should use historyModel(), which only touches the visible rows.
  */
 class UndoVisualization : public QObject
 {
@@ -113,8 +120,8 @@ public:
     QList<UndoStateNode> getChildren(quintptr parentId) const;
 
     /**
-     * @brief Get the full tree structure as a list of nodes.
-     * @return List of all nodes in the tree.
+     * @brief Get the newest states of the tree, at most maxVisualizedStates().
+     * @return List of nodes, oldest first.
      */
     QList<UndoStateNode> getTreeNodes() const;
 
@@ -177,6 +184,13 @@ public:
      */
     void clear();
 
+    /**
+     * @brief Get a list model of the history, one row per state.
+     * Rows are materialized on demand and updated incrementally.
+     * @return The model, owned by this object.
+     */
+    UndoHistoryModel* historyModel() const;
+
 signals:
     /**
      * @brief Emitted when the visualization tree structure changes.
@@ -205,10 +219,12 @@ signals:
 private slots:
     void onUndoStackIndexChanged(); // React to UndoStack changes
     void onUndoCommandExecuted(const QUndoCommand* cmd); // Capture new states
+    void onHistoryTruncated(int index); // Drop data of discarded states
 
 private:
     class Private;
     std::unique_ptr<Private> d;
+    static UndoVisualization* s_instance;
 };
 
 } // namespace QuantilyxDoc
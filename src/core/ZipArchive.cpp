@@ -0,0 +1,329 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "ZipArchive.h"
+#include "Logger.h"
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <limits>
+#include <zlib.h>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr quint32 LocalHeaderSignature = 0x04034b50;
+constexpr quint32 CentralHeaderSignature = 0x02014b50;
+constexpr quint32 EndSignature = 0x06054b50;
+constexpr quint32 Zip64EndSignature = 0x06064b50;
+constexpr quint32 Zip64LocatorSignature = 0x07064b50;
+constexpr quint64 LocalHeaderSize = 30;
+constexpr quint64 CentralHeaderSize = 46;
+constexpr quint64 EndSize = 22;
+constexpr quint64 Zip64EndSize = 56;
+constexpr quint64 Zip64LocatorSize = 20;
+constexpr quint64 MaxCommentSize = 0xFFFF;
+constexpr quint16 Zip64ExtraId = 0x0001;
+constexpr quint16 MethodStored = 0;
+constexpr quint16 MethodDeflated = 8;
+constexpr quint16 FlagEncrypted = 0x0001;
+
+inline quint16 u16(const uchar* p) { return qFromLittleEndian<quint16>(p); }
+inline quint32 u32(const uchar* p) { return qFromLittleEndian<quint32>(p); }
+inline quint64 u64(const uchar* p) { return qFromLittleEndian<quint64>(p); }
+
+} // namespace
+
+class ZipArchive::Private {
+public:
+    Private() : data(nullptr), size(0) {}
+
+    struct Entry {
+        quint64 headerOffset;   // Offset of the local header
+        quint64 compressedSize;
+        quint64 size;
+        quint32 crc;
+        quint16 method;
+        quint16 flags;
+    };
+
+    QFile file;
+    const uchar* data;      // The mapping, or fallback's buffer
+    quint64 size;
+    QByteArray fallback;    // File contents when the file system cannot map it
+    QStringList names;
+    QVector<Entry> entries;
+    QHash<QString, int> index; // Name -> entries position
+    QString lastError;
+
+    static QString normalized(const QString& name) {
+        return name.startsWith(QLatin1Char('/')) ? name.mid(1) : name;
+    }
+
+    const Entry* find(const QString& name) const {
+        const auto it = index.constFind(normalized(name));
+        return it == index.constEnd() ? nullptr : &entries.at(it.value());
+    }
+
+    bool fail(const QString& message) {
+        lastError = message;
+        return false;
+    }
+
+    // Checks that [offset, offset + length) lies in the file without overflowing
+    bool inRange(quint64 offset, quint64 length) const {
+        return offset <= size && length <= size - offset;
+    }
+
+    bool parseCentralDirectory() {
+        if (size < EndSize) return fail(QStringLiteral("Not a ZIP archive"));
+
+        // The end record is followed only by the archive comment
+        quint64 end = size;
+        const quint64 lowest = size - EndSize > MaxCommentSize ? size - EndSize - MaxCommentSize : 0;
+        for (quint64 pos = size - EndSize + 1; pos-- > lowest;) {
+            if (u32(data + pos) == EndSignature) {
+                end = pos;
+                break;
+            }
+        }
+        if (end == size) return fail(QStringLiteral("Not a ZIP archive (no end of central directory)"));
+
+        quint64 count = u16(data + end + 10);
+        quint64 dirSize = u32(data + end + 12);
+        quint64 dirOffset = u32(data + end + 16);
+        if (count == 0xFFFF || dirSize == 0xFFFFFFFF || dirOffset == 0xFFFFFFFF) {
+            // ZIP64: a locator right before the end record points at the 64-bit record
+            if (end < Zip64LocatorSize || u32(data + end - Zip64LocatorSize) != Zip64LocatorSignature) {
+                return fail(QStringLiteral("Missing ZIP64 end of central directory locator"));
+            }
+            const quint64 end64 = u64(data + end - Zip64LocatorSize + 8);
+            if (!inRange(end64, Zip64EndSize) || u32(data + end64) != Zip64EndSignature) {
+                return fail(QStringLiteral("Corrupt ZIP64 end of central directory"));
+            }
+            count = u64(data + end64 + 32);
+            dirSize = u64(data + end64 + 40);
+            dirOffset = u64(data + end64 + 48);
+        }
+        if (!inRange(dirOffset, dirSize)) return fail(QStringLiteral("Central directory out of range"));
+        if (count > dirSize / CentralHeaderSize) return fail(QStringLiteral("Central directory truncated"));
+
+        entries.reserve(int(count));
+        names.reserve(int(count));
+        index.reserve(int(count));
+        const quint64 dirEnd = dirOffset + dirSize;
+        quint64 pos = dirOffset;
+        for (quint64 i = 0; i < count; ++i) {
+            if (pos + CentralHeaderSize > dirEnd || u32(data + pos) != CentralHeaderSignature) {
+                return fail(QStringLiteral("Corrupt central directory entry %1").arg(i));
+            }
+            const uchar* header = data + pos;
+            Entry entry;
+            entry.flags = u16(header + 8);
+            entry.method = u16(header + 10);
+            entry.crc = u32(header + 16);
+            entry.compressedSize = u32(header + 20);
+            entry.size = u32(header + 24);
+            entry.headerOffset = u32(header + 42);
+            const quint64 nameLength = u16(header + 28);
+            const quint64 extraLength = u16(header + 30);
+            const quint64 commentLength = u16(header + 32);
+            const quint64 next = pos + CentralHeaderSize + nameLength + extraLength + commentLength;
+            if (next > dirEnd) return fail(QStringLiteral("Corrupt central directory entry %1").arg(i));
+
+            // Values that overflow 32 bits move to the ZIP64 extra field, in this order
+            const uchar* extra = header + CentralHeaderSize + nameLength;
+            for (quint64 at = 0; at + 4 <= extraLength;) {
+                const quint16 id = u16(extra + at);
+                const quint64 length = u16(extra + at + 2);
+                if (at + 4 + length > extraLength) break;
+                if (id == Zip64ExtraId) {
+                    const uchar* field = extra + at + 4;
+                    const uchar* fieldEnd = field + length;
+                    if (entry.size == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                        entry.size = u64(field);
+                        field += 8;
+                    }
+                    if (entry.compressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                        entry.compressedSize = u64(field);
+                        field += 8;
+                    }
+                    if (entry.headerOffset == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                        entry.headerOffset = u64(field);
+                    }
+                }
+                at += 4 + length;
+            }
+
+            // Flag bit 11 marks UTF-8 names; archivers that leave it unset mostly write UTF-8 anyway
+            const QString name = QString::fromUtf8(reinterpret_cast<const char*>(header + CentralHeaderSize),
+                                                   int(nameLength));
+            if (!index.contains(name)) index.insert(name, entries.size()); // First of duplicate names wins
+            names.append(name);
+            entries.append(entry);
+            pos = next;
+        }
+        return true;
+    }
+
+    // Start of an entry's data. The local header is read for its own name and
+    // extra field lengths, which may differ from the central directory's.
+    const uchar* entryData(const Entry& entry) const {
+        if (!inRange(entry.headerOffset, LocalHeaderSize)) return nullptr;
+        const uchar* header = data + entry.headerOffset;
+        if (u32(header) != LocalHeaderSignature) return nullptr;
+        const quint64 start = entry.headerOffset + LocalHeaderSize + u16(header + 26) + u16(header + 28);
+        if (!inRange(start, entry.compressedSize)) return nullptr;
+        return data + start;
+    }
+};
+
+ZipArchive::ZipArchive()
+    : d(new Private())
+{
+}
+
+ZipArchive::~ZipArchive() = default;
+
+bool ZipArchive::open(const QString& filePath)
+{
+    close();
+    d->lastError.clear();
+    d->file.setFileName(filePath);
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        d->lastError = d->file.errorString();
+        LOG_ERROR("ZipArchive: Cannot open " << filePath << ": " << d->lastError);
+        return false;
+    }
+
+    d->size = quint64(d->file.size());
+    d->data = d->size > 0 ? d->file.map(0, qint64(d->size)) : nullptr;
+    if (!d->data) {
+        // Some file systems cannot be mapped; fall back to reading the file
+        d->fallback = d->file.readAll();
+        d->data = reinterpret_cast<const uchar*>(d->fallback.constData());
+        d->size = quint64(d->fallback.size());
+        LOG_DEBUG("ZipArchive: Cannot map " << filePath << ", read into memory instead.");
+    }
+
+    if (!d->parseCentralDirectory()) {
+        const QString error = d->lastError;
+        LOG_ERROR("ZipArchive: " << filePath << ": " << error);
+        close();
+        d->lastError = error;
+        return false;
+    }
+    LOG_DEBUG("ZipArchive: Indexed " << d->entries.size() << " entries of " << filePath);
+    return true;
+}
+
+void ZipArchive::close()
+{
+    d->file.close(); // Also unmaps
+    d->fallback.clear();
+    d->data = nullptr;
+    d->size = 0;
+    d->names.clear();
+    d->entries.clear();
+    d->index.clear();
+}
+
+bool ZipArchive::isOpen() const
+{
+    return d->data != nullptr;
+}
+
+QString ZipArchive::fileName() const
+{
+    return isOpen() ? d->file.fileName() : QString();
+}
+
+int ZipArchive::entryCount() const
+{
+    return d->entries.size();
+}
+
+QStringList ZipArchive::entryNames() const
+{
+    return d->names;
+}
+
+bool ZipArchive::contains(const QString& name) const
+{
+    return d->find(name) != nullptr;
+}
+
+qint64 ZipArchive::entrySize(const QString& name) const
+{
+    const Private::Entry* entry = d->find(name);
+    return entry ? qint64(entry->size) : -1;
+}
+
+QByteArray ZipArchive::fileData(const QString& name) const
+{
+    const Private::Entry* entry = d->find(name);
+    if (!entry || entry->size == 0) return QByteArray();
+    if (entry->flags & FlagEncrypted) {
+        LOG_ERROR("ZipArchive: Encrypted entries are not supported: " << name);
+        return QByteArray();
+    }
+    if (entry->size > quint64(std::numeric_limits<int>::max())) {
+        LOG_ERROR("ZipArchive: Entry too large to read into memory: " << name);
+        return QByteArray();
+    }
+    const uchar* raw = d->entryData(*entry);
+    if (!raw) {
+        LOG_ERROR("ZipArchive: Corrupt local header or data out of range: " << name);
+        return QByteArray();
+    }
+
+    if (entry->method == MethodStored) {
+        if (entry->compressedSize != entry->size) {
+            LOG_ERROR("ZipArchive: Size mismatch in stored entry: " << name);
+            return QByteArray();
+        }
+        // Zero-copy view of the mapping; not CRC-checked, as that would read every byte
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(raw), int(entry->size));
+    }
+    if (entry->method != MethodDeflated) {
+        LOG_ERROR("ZipArchive: Unsupported compression method " << entry->method << ": " << name);
+        return QByteArray();
+    }
+
+    // Raw deflate straight into a buffer of the final size; the stream is
+    // local, so concurrent reads need no locking
+    QByteArray out(int(entry->size), Qt::Uninitialized);
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return QByteArray();
+    stream.next_in = const_cast<Bytef*>(raw);
+    stream.avail_in = uInt(qMin<quint64>(entry->compressedSize, std::numeric_limits<uInt>::max()));
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = uInt(out.size());
+    const int status = inflate(&stream, Z_FINISH);
+    const uLong produced = stream.total_out;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END || produced != uLong(out.size())) {
+        LOG_ERROR("ZipArchive: Failed to inflate " << name << " (zlib status " << status << ")");
+        return QByteArray();
+    }
+    if (::crc32(0L, reinterpret_cast<const Bytef*>(out.constData()), uInt(out.size())) != entry->crc) {
+        LOG_ERROR("ZipArchive: CRC mismatch: " << name);
+        return QByteArray();
+    }
+    return out;
+}
+
+QString ZipArchive::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace QuantilyxDoc
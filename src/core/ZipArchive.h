@@ -0,0 +1,109 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_ZIPARCHIVE_H
+#define QUANTILYX_ZIPARCHIVE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Read-only ZIP archive shared by the container formats (CBZ, EPUB, DOCX, XPS, ODT).
+ *
+ * The file is memory-mapped and its central directory parsed once on
+ * open() into a hash index from entry name to offsets, so a lookup costs no
+ * I/O. Stored entries (most images in comic archives) are returned as
+ * views of the mapping without copying; deflated entries are inflated on
+ * each request into a buffer of their exact size, and CRC-checked. ZIP64
+ * archives are supported; encrypted entries are not.
+ *
+ * After open() the archive is immutable, so fileData() may be called from
+ * several threads at once without locking. open() and close() must not run
+ * concurrently with reads.
+ */
+class ZipArchive
+{
+public:
+    ZipArchive();
+    ~ZipArchive();
+
+    /**
+     * @brief Map a file and index its central directory.
+     * An archive already open is closed first.
+     * @param filePath ZIP file.
+     * @return True if the file is a readable ZIP archive.
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Unmap the file. Views returned by fileData() become invalid.
+     */
+    void close();
+
+    /**
+     * @brief Check if an archive is open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the path of the open archive.
+     */
+    QString fileName() const;
+
+    /**
+     * @brief Get the number of entries, directories included.
+     */
+    int entryCount() const;
+
+    /**
+     * @brief Get the entry names in central directory order, directories included.
+     */
+    QStringList entryNames() const;
+
+    /**
+     * @brief Check if the archive has an entry.
+     * @param name Entry path; a leading '/' is ignored.
+     */
+    bool contains(const QString& name) const;
+
+    /**
+     * @brief Get the uncompressed size of an entry.
+     * @param name Entry path; a leading '/' is ignored.
+     * @return Size in bytes, or -1 if there is no such entry.
+     */
+    qint64 entrySize(const QString& name) const;
+
+    /**
+     * @brief Read an entry.
+     *
+     * For a stored entry the result refers into the mapping
+     * (QByteArray::fromRawData) and is only valid until close(); copy it
+     * to keep it longer. Writing to it detaches a private copy.
+     * @param name Entry path; a leading '/' is ignored.
+     * @return Entry contents, or an empty array if missing or unreadable.
+     */
+    QByteArray fileData(const QString& name) const;
+
+    /**
+     * @brief Get the last error message of open().
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_ZIPARCHIVE_H
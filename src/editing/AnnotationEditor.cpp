@@ -11,6 +11,11 @@
 #include "../core/Document.h"
 #include "../core/Page.h"
 #include "../core/Logger.h"
+#include "../core/UndoStack.h"
+#include "../annotations/AnnotationManager.h"
+#include "../formats/pdf/PdfAnnotation.h"
+#include "../formats/pdf/PdfDocument.h"
+#include "EditCommands.h"
 #include <QPointer>
 #include <QMutex>
 #include <QMutexLocker>
@@ -19,17 +24,163 @@
 #include <QMimeData>
 #include <QTimer>
 #include <QMetaObject>
+#include <QPainter>
+#include <QVector>
 #include <QDebug>
+#include <cmath>
 
 namespace QuantilyxDoc {
 
 // Forward declaration of base Annotation class if not included
 // class Annotation { ... };
 
+namespace {
+
+// Pressure deviation that keeps a point even if it lies on the line
+constexpr qreal InkPressureTolerance = 0.1;
+// Raw points an online segment may absorb before its end is committed anyway
+constexpr int InkMaxPendingPoints = 64;
+
+qreal distanceToSegment(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+    const QPointF ab = b - a;
+    const qreal lengthSquared = QPointF::dotProduct(ab, ab);
+    if (lengthSquared <= 0.0) {
+        const QPointF ap = p - a;
+        return std::sqrt(QPointF::dotProduct(ap, ap));
+    }
+    const qreal t = qBound<qreal>(0.0, QPointF::dotProduct(p - a, ab) / lengthSquared, 1.0);
+    const QPointF offset = p - (a + t * ab);
+    return std::sqrt(QPointF::dotProduct(offset, offset));
+}
+
+/**
+ * How far point i strays from the chord a-b, relative to what is visible:
+ * a heavy (wide) stroke hides more positional error, and pressure changes
+ * matter because they change the stroke width. Values above 1 must be kept.
+ */
+qreal inkDeviation(const QVector<QPointF>& points, const QVector<qreal>& pressures,
+                   int a, int b, int i, qreal tolerance)
+{
+    const qreal spatial = distanceToSegment(points[i], points[a], points[b])
+                          / (tolerance * qMax<qreal>(0.25, pressures[i]));
+    const qreal t = b > a ? static_cast<qreal>(i - a) / (b - a) : 0.0;
+    const qreal expectedPressure = pressures[a] + t * (pressures[b] - pressures[a]);
+    return qMax(spatial, std::abs(pressures[i] - expectedPressure) / InkPressureTolerance);
+}
+
+// Douglas–Peucker over the whole path (iterative, no recursion depth limit)
+QVector<int> simplifyInkPath(const QVector<QPointF>& points, const QVector<qreal>& pressures, qreal tolerance)
+{
+    const int n = points.size();
+    if (n <= 2) {
+        QVector<int> all(n);
+        for (int i = 0; i < n; ++i) all[i] = i;
+        return all;
+    }
+
+    QVector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+    QVector<QPair<int, int>> stack{{0, n - 1}};
+    while (!stack.isEmpty()) {
+        const QPair<int, int> range = stack.takeLast();
+        int worst = -1;
+        qreal worstDeviation = 1.0;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            const qreal deviation = inkDeviation(points, pressures, range.first, range.second, i, tolerance);
+            if (deviation > worstDeviation) {
+                worstDeviation = deviation;
+                worst = i;
+            }
+        }
+        if (worst >= 0) {
+            keep[worst] = true;
+            stack.append({range.first, worst});
+            stack.append({worst, range.second});
+        }
+    }
+
+    QVector<int> kept;
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) kept.append(i);
+    }
+    return kept;
+}
+
+} // namespace
+
+/**
+ * A freehand stroke in progress. Raw points are rendered into the buffer as
+ * they arrive; only points needed to stay within tolerance are stored.
+ */
+struct InkStroke {
+    QPointer<Document> document;
+    int pageIndex = -1;
+    QPen pen;
+    QTransform pageToBuffer;
+    QImage buffer;
+
+    QVector<QPointF> points;    // Committed (decimated) points
+    QVector<qreal> pressures;
+    QVector<QPointF> pending;   // Raw points since the last committed point
+    QVector<qreal> pendingPressures;
+    QPointF lastRaw;
+    qreal lastRawPressure = 1.0;
+    int rawCount = 0;
+
+    bool isActive() const { return pageIndex >= 0; }
+
+    // Online decimation: extend the segment from the last committed point to
+    // the new point while every raw point in between stays within tolerance;
+    // otherwise commit the previous raw point and start a new segment there.
+    void addPoint(const QPointF& point, qreal pressure, qreal tolerance) {
+        if (points.isEmpty()) {
+            points.append(point);
+            pressures.append(pressure);
+            return;
+        }
+
+        // Test the candidate segment with the pending points in between
+        QVector<QPointF> segment;
+        QVector<qreal> segmentPressures;
+        segment.reserve(pending.size() + 2);
+        segment.append(points.last());
+        segmentPressures.append(pressures.last());
+        segment += pending;
+        segmentPressures += pendingPressures;
+        segment.append(point);
+        segmentPressures.append(pressure);
+
+        bool fits = pending.size() < InkMaxPendingPoints;
+        for (int i = 1; fits && i < segment.size() - 1; ++i) {
+            fits = inkDeviation(segment, segmentPressures, 0, segment.size() - 1, i, tolerance) <= 1.0;
+        }
+
+        if (!fits && !pending.isEmpty()) {
+            points.append(pending.last());
+            pressures.append(pendingPressures.last());
+            pending.clear();
+            pendingPressures.clear();
+        }
+        pending.append(point);
+        pendingPressures.append(pressure);
+    }
+
+    // Commit the end of the stroke
+    void flush() {
+        if (!pending.isEmpty()) {
+            points.append(pending.last());
+            pressures.append(pendingPressures.last());
+            pending.clear();
+            pendingPressures.clear();
+        }
+    }
+};
+
 class AnnotationEditor::Private {
 public:
     Private(AnnotationEditor* q_ptr)
-        : q(q_ptr), activeDocument(nullptr), isEditingVal(false) {}
+        : q(q_ptr), activeDocument(nullptr), isEditingVal(false), inkTolerance(0.75) {}
 
     AnnotationEditor* q;
     QPointer<Document> activeDocument; // Use QPointer for safety
@@ -38,6 +189,8 @@ public:
     QHash<Document*, QSet<QPointer<Annotation>>> docToAnnotations; // Map Doc -> Set of all its Annotations
     bool isEditingVal;
     QPointer<Annotation> currentEditingAnnotation;
+    InkStroke ink;
+    qreal inkTolerance; // Page units (points) at full pressure
 
     // Helper to add an annotation to the internal maps
     void addToMaps(Document* doc, int pageIndex, Annotation* annotation) {
@@ -165,44 +318,23 @@ bool AnnotationEditor::modifyAnnotation(Annotation* annotation, const Annotation
         return false;
     }
 
-    // Find the document and page for this annotation by iterating maps (inefficient, needs better lookup)
-    // A better design would store document/page pointers directly in the Annotation object if possible.
-    // For now, assume the Annotation object has methods to get its page/document (which it should).
-    // Document* doc = annotation->document(); // Hypothetical method
-    // Page* page = annotation->page();       // Hypothetical method
-    // int pageIndex = page ? page->index() : -1; // Hypothetical method
-
-    // For this stub, we'll assume we have the doc and page index.
-    Document* doc = nullptr; // Placeholder
-    int pageIndex = -1;      // Placeholder
-    // ... Logic to find doc/pageIndex from annotation ...
-
+    Document* doc = AnnotationManager::instance().documentForAnnotation(annotation);
+    const int pageIndex = AnnotationManager::instance().pageIndexForAnnotation(annotation);
     if (!doc || pageIndex == -1) {
         LOG_ERROR("AnnotationEditor::modifyAnnotation: Could not find document or page index for annotation.");
         return false;
     }
+    if (newProperties.contents == annotation->contents() && newProperties.color == annotation->color()) {
+        return true;
+    }
 
-    // --- CRITICAL: Poppler-Qt5 is READ-ONLY ---
-    // Similar to addAnnotation, modifying the underlying Poppler::Annotation object is not possible.
-    // We must store the intended changes within the Annotation object itself (if it supports it)
-    // or in a separate map managed by the editor/document.
-    // The changes are applied later during document save.
-
-    // Assume the Annotation object has methods to set properties and mark itself as modified.
-    // annotation->setContents(newProperties.contents);
-    // annotation->setColor(newProperties.color);
-    // annotation->setBounds(newProperties.bounds);
-    // annotation->setModified(true); // Mark as needing save
-
-    LOG_WARN("AnnotationEditor::modifyAnnotation: Cannot modify annotation using Poppler-Qt5 (read-only). "
-             "Changes stored temporarily in annotation object. "
-             "Actual modification requires PDF writing library or external tool during save.");
-    // emit annotationModified(annotation);
-    // doc->markAsModified(); // Hypothetical method
-    // return true; // Indicate local change was accepted
-
-    // As a stub for now, return false to indicate the operation cannot be completed with Poppler alone.
-    return false;
+    // PdfAnnotation keeps the changes locally until the document is saved.
+    // Drag steps of a colour slider merge into the previous command until
+    // endInteraction() closes the merge window.
+    UndoStack::instance().push(new ModifyAnnotationCommand(doc, annotation, newProperties.contents,
+                                                           newProperties.color));
+    emit annotationModified(annotation);
+    return true;
 }
 
 bool AnnotationEditor::deleteAnnotation(Annotation* annotation)
@@ -414,6 +546,7 @@ void AnnotationEditor::finishEditing()
         }
         d->currentEditingAnnotation.clear(); // Clear the pointer
         d->isEditingVal = false;
+        endInteraction();
     } else {
         LOG_DEBUG("AnnotationEditor: finishEditing called but no edit was in progress.");
     }
@@ -431,11 +564,17 @@ void AnnotationEditor::cancelEditing()
         }
         d->currentEditingAnnotation.clear(); // Clear the pointer
         d->isEditingVal = false;
+        endInteraction();
     } else {
         LOG_DEBUG("AnnotationEditor: cancelEditing called but no edit was in progress.");
     }
 }
 
+void AnnotationEditor::endInteraction()
+{
+    UndoStack::instance().closeMergeWindow();
+}
+
 QList<AnnotationType> AnnotationEditor::supportedAnnotationTypes() const
 {
     // Define the list of types supported by the editor/UI for *creation*.
@@ -453,4 +592,154 @@ QList<AnnotationType> AnnotationEditor::supportedAnnotationTypes() const
            << AnnotationType::Stamp;
 }
 
-} // namespace QuantilyxDoc
\ No newline at end of file
+bool AnnotationEditor::beginInkStroke(Document* document, int pageIndex, const QPen& pen,
+                                      const QTransform& pageToBuffer, const QSize& bufferSize)
+{
+    if (!document || pageIndex < 0 || pageIndex >= document->pageCount() || bufferSize.isEmpty()) {
+        LOG_ERROR("AnnotationEditor::beginInkStroke: Invalid document, page index or buffer size.");
+        return false;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    d->ink = InkStroke();
+    d->ink.document = document;
+    d->ink.pageIndex = pageIndex;
+    d->ink.pen = pen;
+    d->ink.pen.setCapStyle(Qt::RoundCap);
+    d->ink.pen.setJoinStyle(Qt::RoundJoin);
+    d->ink.pageToBuffer = pageToBuffer;
+    d->ink.buffer = QImage(bufferSize, QImage::Format_ARGB32_Premultiplied);
+    d->ink.buffer.fill(Qt::transparent);
+    LOG_DEBUG("AnnotationEditor: Started ink stroke on page " << pageIndex);
+    return true;
+}
+
+QRect AnnotationEditor::addInkPoint(const QPointF& pagePoint, qreal pressure)
+{
+    QMutexLocker locker(&d->mutex);
+    InkStroke& ink = d->ink;
+    if (!ink.isActive()) return QRect();
+
+    pressure = qBound<qreal>(0.0, pressure, 1.0);
+    const QPointF from = ink.rawCount > 0 ? ink.lastRaw : pagePoint;
+    const qreal fromPressure = ink.rawCount > 0 ? ink.lastRawPressure : pressure;
+    ink.addPoint(pagePoint, pressure, d->inkTolerance);
+    ink.lastRaw = pagePoint;
+    ink.lastRawPressure = pressure;
+    ++ink.rawCount;
+
+    // Render only the new segment; the rest of the stroke is already in the buffer
+    QPen pen = ink.pen;
+    pen.setWidthF(qMax<qreal>(0.1, ink.pen.widthF() * (fromPressure + pressure) / 2.0));
+    QPainter painter(&ink.buffer);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setTransform(ink.pageToBuffer);
+    painter.setPen(pen);
+    if (from == pagePoint) {
+        painter.drawPoint(pagePoint);
+    } else {
+        painter.drawLine(from, pagePoint);
+    }
+
+    const qreal halfWidth = pen.widthF() / 2.0;
+    const QRectF segmentBounds = QRectF(from, pagePoint).normalized().adjusted(-halfWidth, -halfWidth, halfWidth, halfWidth);
+    return ink.pageToBuffer.mapRect(segmentBounds).toAlignedRect().adjusted(-1, -1, 1, 1) & ink.buffer.rect();
+}
+
+void AnnotationEditor::drawInkStroke(QPainter& painter, const QPoint& origin) const
+{
+    // Drawn under the lock rather than handed out, so the buffer is never
+    // shared and addInkPoint() keeps painting into it without a detach
+    QMutexLocker locker(&d->mutex);
+    if (d->ink.isActive()) {
+        painter.drawImage(origin, d->ink.buffer);
+    }
+}
+
+int AnnotationEditor::inkStrokePage(Document* document) const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->ink.isActive() && d->ink.document == document ? d->ink.pageIndex : -1;
+}
+
+AnnotationProperties AnnotationEditor::finishInkStroke()
+{
+    AnnotationProperties props;
+    QPointer<Document> document;
+    int pageIndex = -1;
+    {
+        QMutexLocker locker(&d->mutex);
+        InkStroke& ink = d->ink;
+        if (!ink.isActive()) return props;
+
+        // The online pass bounds memory; one global pass gives the final path
+        ink.flush();
+        const QVector<int> kept = simplifyInkPath(ink.points, ink.pressures, d->inkTolerance);
+
+        props.type = AnnotationType::Ink;
+        props.color = ink.pen.color();
+        props.pen = ink.pen;
+        qreal left = 0, top = 0, right = 0, bottom = 0;
+        for (int i : kept) {
+            const QPointF& p = ink.points[i];
+            props.inkPoints.append(p);
+            props.inkPressures.append(ink.pressures[i]);
+            if (props.inkPoints.size() == 1) {
+                left = right = p.x();
+                top = bottom = p.y();
+            } else {
+                left = qMin(left, p.x());
+                right = qMax(right, p.x());
+                top = qMin(top, p.y());
+                bottom = qMax(bottom, p.y());
+            }
+        }
+        const qreal halfWidth = ink.pen.widthF() / 2.0;
+        props.bounds = QRectF(QPointF(left, top), QPointF(right, bottom))
+                           .adjusted(-halfWidth, -halfWidth, halfWidth, halfWidth);
+
+        LOG_DEBUG("AnnotationEditor: Finished ink stroke with " << ink.rawCount << " input points, "
+                  << ink.points.size() << " after online decimation, " << kept.size() << " after simplification");
+        document = ink.document;
+        pageIndex = ink.pageIndex;
+        d->ink = InkStroke();
+    }
+
+    if (!document || props.inkPoints.isEmpty()) return props;
+
+    // Added through the undo stack, which registers it with AnnotationManager
+    // and journals it
+    if (auto* pdfDoc = qobject_cast<PdfDocument*>(document.data())) {
+        PdfAnnotation* annotation = new PdfAnnotation(PdfAnnotation::Type::Ink, props.bounds, pdfDoc, pageIndex);
+        annotation->setColor(props.color);
+        annotation->setBorderWidth(props.pen.widthF());
+        annotation->setInkPaths(QList<QList<QPointF>>() << props.inkPoints);
+        UndoStack::instance().push(new AddAnnotationCommand(document, pageIndex, annotation));
+        emit annotationAdded(annotation, document, pageIndex);
+    } else {
+        LOG_WARN("AnnotationEditor: Ink annotations are not supported for " << document->filePath());
+    }
+    emit inkStrokeFinished(document, pageIndex, props);
+    return props;
+}
+
+void AnnotationEditor::cancelInkStroke()
+{
+    QMutexLocker locker(&d->mutex);
+    d->ink = InkStroke();
+}
+
+void AnnotationEditor::setInkTolerance(qreal tolerance)
+{
+    if (tolerance <= 0.0) return;
+    QMutexLocker locker(&d->mutex);
+    d->inkTolerance = tolerance;
+}
+
+qreal AnnotationEditor::inkTolerance() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->inkTolerance;
+}
+
+} // namespace QuantilyxDoc
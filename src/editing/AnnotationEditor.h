@@ -17,9 +17,13 @@
 #include <QColor>
 #include <QPen>
 #include <QBrush>
+#include <QImage>
+#include <QTransform>
 #include <memory>
 #include <QHash>
 
+class QPainter;
+
 namespace QuantilyxDoc {
 
 class Document; // Forward declaration
@@ -70,6 +74,7 @@ struct AnnotationProperties {
     QRectF bounds;                // Bounding rectangle on the page
     QPointF position;             // Position (for point-based annotations like stamps)
     QList<QPointF> inkPoints;     // Points for ink annotations
+    QList<qreal> inkPressures;    // Pen pressure (0.0 - 1.0) per ink point, if captured
     QString linkDestination;      // Destination for link annotations
     bool isHidden = false;        // Visibility flag
     bool isPrintable = true;      // Print flag
@@ -119,6 +124,8 @@ public:
 
     /**
      * @brief Modify an existing annotation.
+     * Pushes a ModifyAnnotationCommand for its contents and colour; repeated
+     * changes merge into one undo step until endInteraction().
      * @param annotation The annotation object to modify.
      * @param newProperties The new properties to apply.
      * @return True if modification was successful.
@@ -217,12 +224,84 @@ public:
      */
     void cancelEditing();
 
+    /**
+     * @brief Mark the end of a user gesture (mouse release, slider let go, edit finished).
+     * Closes the undo merge window, so the next edit starts a new undo step.
+     */
+    void endInteraction();
+
     /**
      * @brief Get the list of supported annotation types for creation/modification.
      * @return List of AnnotationType enums.
      */
     QList<AnnotationType> supportedAnnotationTypes() const;
 
+    // --- Freehand ink input ---
+
+    /**
+     * @brief Start capturing a freehand ink stroke.
+     * Input points are rendered incrementally into a stroke buffer (one new
+     * segment per point) and decimated online, so long pen sessions stay at
+     * input rate. The buffer is meant to be composited over the page by the view.
+     * @param document The document being drawn on.
+     * @param pageIndex The 0-based page index.
+     * @param pen Stroke pen; its width is scaled by pen pressure.
+     * @param pageToBuffer Transform from page coordinates to buffer pixels.
+     * @param bufferSize Size of the stroke buffer in pixels (typically the page render size).
+     * @return True if the stroke started.
+     */
+    bool beginInkStroke(Document* document, int pageIndex, const QPen& pen,
+                        const QTransform& pageToBuffer, const QSize& bufferSize);
+
+    /**
+     * @brief Add an input point to the current ink stroke.
+     * @param pagePoint Point in page coordinates.
+     * @param pressure Pen pressure (0.0 - 1.0); use 1.0 for mouse input.
+     * @return Buffer area that changed and needs repainting, or an empty rect.
+     */
+    QRect addInkPoint(const QPointF& pagePoint, qreal pressure = 1.0);
+
+    /**
+     * @brief Composite the current stroke buffer onto a view.
+     * Does nothing if no stroke is active.
+     * @param painter Painter of the view.
+     * @param origin Position of the buffer's top-left corner (the page origin).
+     */
+    void drawInkStroke(QPainter& painter, const QPoint& origin) const;
+
+    /**
+     * @brief Get the page the current ink stroke is drawn on.
+     * @param document Document to check.
+     * @return 0-based page index, or -1 if no stroke is active on that document.
+     */
+    int inkStrokePage(Document* document) const;
+
+    /**
+     * @brief Finish the current ink stroke.
+     * The decimated path is simplified once more (Douglas–Peucker) and an Ink
+     * annotation is created from it and pushed on the undo stack
+     * (AddAnnotationCommand). Only PDF documents take ink annotations.
+     * @return Properties of the finished stroke (type Ink, with inkPoints and bounds),
+     *         or default properties if no stroke was active.
+     */
+    AnnotationProperties finishInkStroke();
+
+    /**
+     * @brief Abandon the current ink stroke.
+     */
+    void cancelInkStroke();
+
+    /**
+     * @brief Set the simplification tolerance for ink strokes.
+     * @param tolerance Maximum deviation in page units at full pressure.
+     */
+    void setInkTolerance(qreal tolerance);
+
+    /**
+     * @brief Get the simplification tolerance for ink strokes.
+     */
+    qreal inkTolerance() const;
+
 signals:
     /**
      * @brief Emitted when an annotation is added.
@@ -270,9 +349,19 @@ signals:
      */
     void editCanceled(QuantilyxDoc::Annotation* annotation);
 
+    /**
+     * @brief Emitted when a freehand ink stroke is finished.
+     * @param document The document drawn on.
+     * @param pageIndex The page index.
+     * @param properties The simplified stroke.
+     */
+    void inkStrokeFinished(QuantilyxDoc::Document* document, int pageIndex,
+                           const QuantilyxDoc::AnnotationProperties& properties);
+
 private:
     class Private;
     std::unique_ptr<Private> d;
+    static AnnotationEditor* s_instance;
 
     // Helper to validate annotation properties before adding/modifying
     bool validateProperties(const AnnotationProperties& props) const;
@@ -0,0 +1,485 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "EditCommands.h"
+#include "../core/Document.h"
+#include "../core/Logger.h"
+#include "../annotations/AnnotationManager.h"
+#include "../formats/pdf/PdfAnnotation.h"
+#include "../formats/pdf/PdfDocument.h"
+#include <QDataStream>
+#include <QObject>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+const QString AddAnnotationType = QStringLiteral("annotation.add");
+const QString RemoveAnnotationType = QStringLiteral("annotation.remove");
+const QString ModifyAnnotationType = QStringLiteral("annotation.modify");
+const QString RotatePageType = QStringLiteral("page.rotate");
+
+// Bounds read back through Poppler are normalized and rescaled; allow for rounding
+constexpr qreal BoundsTolerance = 0.01;
+
+// Rough size of an annotation object and its private data, before contents and points
+constexpr qint64 AnnotationBaseCost = 512;
+
+// Annotations loaded from the file are owned by their PdfPage; only the ones
+// created in this session are owned by the commands
+bool ownedByPage(Annotation* annotation)
+{
+    PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annotation);
+    return pdfAnnot && pdfAnnot->popplerAnnotation();
+}
+
+// What identifies an annotation across sessions: Poppler-Qt5 exposes no
+// annotation name, so the page, type and bounds stand in for it
+struct AnnotationKey {
+    int pageIndex = -1;
+    int type = 0;
+    QRectF bounds;
+};
+
+AnnotationKey keyOf(int pageIndex, Annotation* annotation)
+{
+    AnnotationKey key;
+    key.pageIndex = pageIndex;
+    if (PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annotation)) {
+        key.type = static_cast<int>(pdfAnnot->type());
+        key.bounds = pdfAnnot->bounds();
+    }
+    return key;
+}
+
+QDataStream& operator<<(QDataStream& stream, const AnnotationKey& key)
+{
+    return stream << qint32(key.pageIndex) << qint32(key.type) << key.bounds;
+}
+
+QDataStream& operator>>(QDataStream& stream, AnnotationKey& key)
+{
+    qint32 pageIndex = -1;
+    qint32 type = 0;
+    stream >> pageIndex >> type >> key.bounds;
+    key.pageIndex = pageIndex;
+    key.type = type;
+    return stream;
+}
+
+bool sameBounds(const QRectF& a, const QRectF& b)
+{
+    return qAbs(a.left() - b.left()) < BoundsTolerance && qAbs(a.top() - b.top()) < BoundsTolerance
+        && qAbs(a.right() - b.right()) < BoundsTolerance && qAbs(a.bottom() - b.bottom()) < BoundsTolerance;
+}
+
+// Find a registered annotation again after the document was reopened
+Annotation* findAnnotation(Document* document, const AnnotationKey& key)
+{
+    const QList<Annotation*> candidates = AnnotationManager::instance().annotationsForPage(document, key.pageIndex);
+    for (Annotation* annotation : candidates) {
+        PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annotation);
+        if (pdfAnnot && static_cast<int>(pdfAnnot->type()) == key.type && sameBounds(pdfAnnot->bounds(), key.bounds)) {
+            return annotation;
+        }
+    }
+    return nullptr;
+}
+
+// Memory an annotation held by a command stands for
+qint64 annotationCost(Annotation* annotation)
+{
+    qint64 bytes = AnnotationBaseCost + annotation->contents().size() * qint64(sizeof(QChar));
+    if (PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annotation)) {
+        for (const QList<QPointF>& path : pdfAnnot->inkPaths()) {
+            bytes += path.size() * qint64(sizeof(QPointF));
+        }
+    }
+    return bytes;
+}
+
+// The points of a locally created ink annotation are what a held annotation
+// can give up; Poppler-backed ones keep their data in the document
+PdfAnnotation* spillableInk(Annotation* annotation)
+{
+    PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(annotation);
+    if (!pdfAnnot || pdfAnnot->popplerAnnotation() || pdfAnnot->type() != PdfAnnotation::Type::Ink) return nullptr;
+    return pdfAnnot;
+}
+
+QByteArray saveInk(Annotation* annotation)
+{
+    PdfAnnotation* ink = spillableInk(annotation);
+    if (!ink || ink->inkPaths().isEmpty()) return QByteArray();
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream << ink->inkPaths();
+    return state;
+}
+
+bool loadInk(Annotation* annotation, const QByteArray& state)
+{
+    PdfAnnotation* ink = spillableInk(annotation);
+    if (!ink) return false;
+    QDataStream stream(state);
+    QList<QList<QPointF>> paths;
+    stream >> paths;
+    if (stream.status() != QDataStream::Ok) return false;
+    ink->restoreInkPaths(paths);
+    return true;
+}
+
+void releaseInk(Annotation* annotation)
+{
+    if (PdfAnnotation* ink = spillableInk(annotation)) {
+        ink->restoreInkPaths(QList<QList<QPointF>>());
+    }
+}
+
+void markModified(Document* document)
+{
+    if (document) {
+        document->setModified(true);
+    }
+}
+
+UndoCommand* createAddAnnotation(Document* document, const QByteArray& payload)
+{
+    PdfDocument* pdfDoc = dynamic_cast<PdfDocument*>(document);
+    if (!pdfDoc) return nullptr;
+
+    QDataStream stream(payload);
+    AnnotationKey key;
+    QString contents;
+    QColor color;
+    QString author;
+    QList<QList<QPointF>> inkPaths;
+    stream >> key >> contents >> color >> author >> inkPaths;
+    if (stream.status() != QDataStream::Ok || key.pageIndex < 0 || key.pageIndex >= document->pageCount()) {
+        return nullptr;
+    }
+
+    PdfAnnotation* annotation = new PdfAnnotation(static_cast<PdfAnnotation::Type>(key.type), key.bounds,
+                                                  pdfDoc, key.pageIndex);
+    annotation->setContents(contents);
+    annotation->setColor(color);
+    annotation->setAuthor(author);
+    if (!inkPaths.isEmpty()) {
+        annotation->setInkPaths(inkPaths);
+    }
+    return new AddAnnotationCommand(document, key.pageIndex, annotation);
+}
+
+UndoCommand* createRemoveAnnotation(Document* document, const QByteArray& payload)
+{
+    QDataStream stream(payload);
+    AnnotationKey key;
+    stream >> key;
+    if (stream.status() != QDataStream::Ok) return nullptr;
+
+    Annotation* annotation = findAnnotation(document, key);
+    return annotation ? new RemoveAnnotationCommand(document, annotation) : nullptr;
+}
+
+UndoCommand* createModifyAnnotation(Document* document, const QByteArray& payload)
+{
+    QDataStream stream(payload);
+    AnnotationKey key;
+    QString contents;
+    QColor color;
+    stream >> key >> contents >> color;
+    if (stream.status() != QDataStream::Ok) return nullptr;
+
+    Annotation* annotation = findAnnotation(document, key);
+    return annotation ? new ModifyAnnotationCommand(document, annotation, contents, color) : nullptr;
+}
+
+UndoCommand* createRotatePage(Document* document, const QByteArray& payload)
+{
+    QDataStream stream(payload);
+    qint32 pageIndex = -1;
+    qint32 degrees = 0;
+    stream >> pageIndex >> degrees;
+    if (stream.status() != QDataStream::Ok || !document || pageIndex < 0 || pageIndex >= document->pageCount()
+        || degrees < 0 || degrees >= 360 || degrees % 90 != 0) {
+        return nullptr;
+    }
+    return new RotatePageCommand(document, pageIndex, static_cast<PageRotation>(degrees));
+}
+
+} // namespace
+
+void registerEditCommandJournalTypes()
+{
+    UndoCommand::registerJournalType(AddAnnotationType, createAddAnnotation);
+    UndoCommand::registerJournalType(RemoveAnnotationType, createRemoveAnnotation);
+    UndoCommand::registerJournalType(ModifyAnnotationType, createModifyAnnotation);
+    UndoCommand::registerJournalType(RotatePageType, createRotatePage);
+}
+
+// --- AddAnnotationCommand ---
+
+AddAnnotationCommand::AddAnnotationCommand(Document* document, int pageIndex, Annotation* annotation)
+    : UndoCommand(QObject::tr("Add Annotation"))
+    , m_document(document)
+    , m_pageIndex(pageIndex)
+    , m_annotation(annotation)
+    , m_added(false)
+{
+    setCost(annotationCost(annotation));
+}
+
+AddAnnotationCommand::~AddAnnotationCommand()
+{
+    // Undone (or never done): nobody else knows the annotation
+    if (!m_added) {
+        delete m_annotation;
+    }
+}
+
+Annotation* AddAnnotationCommand::annotation() const
+{
+    return m_annotation;
+}
+
+QString AddAnnotationCommand::journalType() const
+{
+    return dynamic_cast<PdfAnnotation*>(m_annotation) ? AddAnnotationType : QString();
+}
+
+QByteArray AddAnnotationCommand::journalPayload() const
+{
+    PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(m_annotation);
+    if (!pdfAnnot) return QByteArray();
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << keyOf(m_pageIndex, m_annotation) << pdfAnnot->contents() << pdfAnnot->color()
+           << pdfAnnot->author() << pdfAnnot->inkPaths();
+    return payload;
+}
+
+void AddAnnotationCommand::doUndo()
+{
+    if (!m_document || !m_added) return;
+    if (AnnotationManager::instance().removeAnnotation(m_document, m_annotation)) {
+        m_added = false;
+        setCost(annotationCost(m_annotation));
+        markModified(m_document);
+    }
+}
+
+void AddAnnotationCommand::doRedo()
+{
+    if (!m_document || m_added) return;
+    if (AnnotationManager::instance().addAnnotation(m_document, m_pageIndex, m_annotation)) {
+        m_added = true;
+        setCost(0); // The page holds it now
+        markModified(m_document);
+    } else {
+        LOG_WARN("AddAnnotationCommand: AnnotationManager rejected the annotation on page " << m_pageIndex);
+    }
+}
+
+bool AddAnnotationCommand::supportsSpill() const
+{
+    return !m_added && spillableInk(m_annotation);
+}
+
+QByteArray AddAnnotationCommand::saveState() const
+{
+    return m_added ? QByteArray() : saveInk(m_annotation);
+}
+
+bool AddAnnotationCommand::loadState(const QByteArray& state)
+{
+    return loadInk(m_annotation, state);
+}
+
+void AddAnnotationCommand::releaseState()
+{
+    releaseInk(m_annotation);
+}
+
+// --- RemoveAnnotationCommand ---
+
+RemoveAnnotationCommand::RemoveAnnotationCommand(Document* document, Annotation* annotation)
+    : UndoCommand(QObject::tr("Delete Annotation"))
+    , m_document(document)
+    , m_pageIndex(AnnotationManager::instance().pageIndexForAnnotation(annotation))
+    , m_annotation(annotation)
+    , m_removed(false)
+{
+}
+
+RemoveAnnotationCommand::~RemoveAnnotationCommand()
+{
+    // Removed for good: the manager no longer references it. Annotations
+    // loaded from the file stay owned by their page.
+    if (m_removed && !ownedByPage(m_annotation)) {
+        delete m_annotation;
+    }
+}
+
+QString RemoveAnnotationCommand::journalType() const
+{
+    return dynamic_cast<PdfAnnotation*>(m_annotation) ? RemoveAnnotationType : QString();
+}
+
+QByteArray RemoveAnnotationCommand::journalPayload() const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << keyOf(m_pageIndex, m_annotation);
+    return payload;
+}
+
+void RemoveAnnotationCommand::doUndo()
+{
+    if (!m_document || !m_removed) return;
+    if (AnnotationManager::instance().addAnnotation(m_document, m_pageIndex, m_annotation)) {
+        m_removed = false;
+        setCost(0);
+        markModified(m_document);
+    }
+}
+
+void RemoveAnnotationCommand::doRedo()
+{
+    if (!m_document || m_removed || m_pageIndex < 0) return;
+    if (AnnotationManager::instance().removeAnnotation(m_document, m_annotation)) {
+        m_removed = true;
+        setCost(annotationCost(m_annotation));
+        markModified(m_document);
+    }
+}
+
+bool RemoveAnnotationCommand::supportsSpill() const
+{
+    return m_removed && spillableInk(m_annotation);
+}
+
+QByteArray RemoveAnnotationCommand::saveState() const
+{
+    return m_removed ? saveInk(m_annotation) : QByteArray();
+}
+
+bool RemoveAnnotationCommand::loadState(const QByteArray& state)
+{
+    return loadInk(m_annotation, state);
+}
+
+void RemoveAnnotationCommand::releaseState()
+{
+    releaseInk(m_annotation);
+}
+
+// --- ModifyAnnotationCommand ---
+
+ModifyAnnotationCommand::ModifyAnnotationCommand(Document* document, Annotation* annotation,
+                                                 const QString& contents, const QColor& color)
+    : UndoCommand(QObject::tr("Edit Annotation"))
+    , m_document(document)
+    , m_pageIndex(AnnotationManager::instance().pageIndexForAnnotation(annotation))
+    , m_annotation(annotation)
+    , m_oldContents(annotation->contents())
+    , m_oldColor(annotation->color())
+    , m_newContents(contents)
+    , m_newColor(color)
+{
+    setMergeId(UndoMergeId::AnnotationProperties, reinterpret_cast<quintptr>(annotation));
+}
+
+QString ModifyAnnotationCommand::journalType() const
+{
+    return dynamic_cast<PdfAnnotation*>(m_annotation) ? ModifyAnnotationType : QString();
+}
+
+QByteArray ModifyAnnotationCommand::journalPayload() const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << keyOf(m_pageIndex, m_annotation) << m_newContents << m_newColor;
+    return payload;
+}
+
+bool ModifyAnnotationCommand::mergeFrom(const UndoCommand* other)
+{
+    const ModifyAnnotationCommand* next = dynamic_cast<const ModifyAnnotationCommand*>(other);
+    if (!next) return false;
+    m_newContents = next->m_newContents;
+    m_newColor = next->m_newColor;
+    return true;
+}
+
+void ModifyAnnotationCommand::apply(const QString& contents, const QColor& color)
+{
+    // The annotation may be gone if its removal was not undoable
+    if (!m_document || AnnotationManager::instance().documentForAnnotation(m_annotation) != m_document) return;
+    m_annotation->setContents(contents);
+    m_annotation->setColor(color);
+    markModified(m_document);
+}
+
+void ModifyAnnotationCommand::doUndo()
+{
+    apply(m_oldContents, m_oldColor);
+}
+
+void ModifyAnnotationCommand::doRedo()
+{
+    apply(m_newContents, m_newColor);
+}
+
+// --- RotatePageCommand ---
+
+RotatePageCommand::RotatePageCommand(Document* document, int pageIndex, PageRotation rotation)
+    : UndoCommand(QObject::tr("Rotate Page"))
+    , m_document(document)
+    , m_pageIndex(pageIndex)
+    , m_oldRotation(PageRotation::Degrees0)
+    , m_newRotation(rotation)
+{
+    if (Page* page = document ? document->page(pageIndex) : nullptr) {
+        m_oldRotation = page->rotation();
+    }
+}
+
+QString RotatePageCommand::journalType() const
+{
+    return RotatePageType;
+}
+
+QByteArray RotatePageCommand::journalPayload() const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << qint32(m_pageIndex) << qint32(static_cast<int>(m_newRotation));
+    return payload;
+}
+
+void RotatePageCommand::apply(PageRotation rotation)
+{
+    Page* page = m_document ? m_document->page(m_pageIndex) : nullptr;
+    if (!page) return;
+    page->setRotation(rotation);
+    markModified(m_document);
+}
+
+void RotatePageCommand::doUndo()
+{
+    apply(m_oldRotation);
+}
+
+void RotatePageCommand::doRedo()
+{
+    apply(m_newRotation);
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,182 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_EDITCOMMANDS_H
+#define QUANTILYX_EDITCOMMANDS_H
+
+#include "../core/UndoCommand.h"
+#include "../core/Page.h"
+#include <QColor>
+#include <QPointer>
+#include <QString>
+
+namespace QuantilyxDoc {
+
+class Document;
+class Annotation;
+
+/**
+ * @brief Register the journal factories of the commands below.
+ * Call once at startup, before a document with a crash journal is opened.
+ */
+void registerEditCommandJournalTypes();
+
+/**
+ * @brief Adds an annotation to a page through AnnotationManager.
+ *
+ * The command owns the annotation while it is undone, and then counts it
+ * against the UndoStack memory budget; the points of an ink stroke may be
+ * spilled to the undo journal. Journaled as "annotation.add" with the
+ * annotation's properties; recovery creates an equivalent PdfAnnotation.
+ */
+class AddAnnotationCommand : public UndoCommand
+{
+public:
+    /**
+     * @brief Constructor. The annotation is added when the command is pushed.
+     * @param document Document to add to.
+     * @param pageIndex 0-based page index.
+     * @param annotation New annotation, not yet registered anywhere.
+     */
+    AddAnnotationCommand(Document* document, int pageIndex, Annotation* annotation);
+    ~AddAnnotationCommand() override;
+
+    /**
+     * @brief Get the annotation this command adds.
+     */
+    Annotation* annotation() const;
+
+    QString journalType() const override;
+    QByteArray journalPayload() const override;
+
+protected:
+    void doUndo() override;
+    void doRedo() override;
+    bool supportsSpill() const override;
+    QByteArray saveState() const override;
+    bool loadState(const QByteArray& state) override;
+    void releaseState() override;
+
+private:
+    QPointer<Document> m_document;
+    int m_pageIndex;
+    Annotation* m_annotation;
+    bool m_added;
+};
+
+/**
+ * @brief Removes an annotation from its page through AnnotationManager.
+ *
+ * The command owns the annotation while it is removed, unless it was loaded
+ * from the file (its PdfPage keeps it), and then counts it
+ * against the UndoStack memory budget like AddAnnotationCommand. Journaled
+ * as "annotation.remove"; recovery finds the annotation again by page, type
+ * and bounds.
+ */
+class RemoveAnnotationCommand : public UndoCommand
+{
+public:
+    /**
+     * @brief Constructor. The annotation is removed when the command is pushed.
+     * @param document Document holding the annotation.
+     * @param annotation Annotation registered with AnnotationManager.
+     */
+    RemoveAnnotationCommand(Document* document, Annotation* annotation);
+    ~RemoveAnnotationCommand() override;
+
+    QString journalType() const override;
+    QByteArray journalPayload() const override;
+
+protected:
+    void doUndo() override;
+    void doRedo() override;
+    bool supportsSpill() const override;
+    QByteArray saveState() const override;
+    bool loadState(const QByteArray& state) override;
+    void releaseState() override;
+
+private:
+    QPointer<Document> m_document;
+    int m_pageIndex;
+    Annotation* m_annotation;
+    bool m_removed;
+};
+
+/**
+ * @brief Changes the contents and colour of an annotation.
+ *
+ * Consecutive changes to the same annotation merge into one step
+ * (UndoMergeId::AnnotationProperties). Journaled as "annotation.modify".
+ */
+class ModifyAnnotationCommand : public UndoCommand
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param document Document holding the annotation.
+     * @param annotation Annotation registered with AnnotationManager.
+     * @param contents New contents.
+     * @param color New colour.
+     */
+    ModifyAnnotationCommand(Document* document, Annotation* annotation,
+                            const QString& contents, const QColor& color);
+
+    QString journalType() const override;
+    QByteArray journalPayload() const override;
+
+protected:
+    bool mergeFrom(const UndoCommand* other) override;
+    void doUndo() override;
+    void doRedo() override;
+
+private:
+    void apply(const QString& contents, const QColor& color);
+
+    QPointer<Document> m_document;
+    int m_pageIndex;
+    Annotation* m_annotation;
+    QString m_oldContents;
+    QColor m_oldColor;
+    QString m_newContents;
+    QColor m_newColor;
+};
+
+/**
+ * @brief Rotates a page. Journaled as "page.rotate".
+ */
+class RotatePageCommand : public UndoCommand
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param document Document holding the page.
+     * @param pageIndex 0-based page index.
+     * @param rotation New rotation.
+     */
+    RotatePageCommand(Document* document, int pageIndex, PageRotation rotation);
+
+    QString journalType() const override;
+    QByteArray journalPayload() const override;
+
+protected:
+    void doUndo() override;
+    void doRedo() override;
+
+private:
+    void apply(PageRotation rotation);
+
+    QPointer<Document> m_document;
+    int m_pageIndex;
+    PageRotation m_oldRotation;
+    PageRotation m_newRotation;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_EDITCOMMANDS_H
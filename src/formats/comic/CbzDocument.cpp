@@ -10,79 +10,50 @@
 #include "CbzDocument.h"
 #include "ComicPage.h" // Assuming this handles image-based pages
 #include "../../core/Logger.h"
+#include "../../core/ZipArchive.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QRegularExpression>
 #include <QTextStream>
 #include <QDebug>
-#include <zip.h> // Use libzip for CBZ (which is ZIP)
 
 namespace QuantilyxDoc {
 
 class CbzDocument::Private {
 public:
-    Private() : zipArchive(nullptr), isLoaded(false) {}
-    ~Private() {
-        if (zipArchive) {
-            zip_close(zipArchive);
-        }
-    }
+    Private() : isLoaded(false) {}
+    ~Private() = default;
 
-    zip_t* zipArchive;
+    ZipArchive zipArchive; // Shared by the page threads; reads need no locking
     bool isLoaded;
     QStringList imagePathsList;
     QStringList otherFilesList;
     QString comicInfoContent;
     QList<std::unique_ptr<ComicPage>> pages; // Own the page objects
 
-    // Helper to read a file from the ZIP archive
+    // Helper to read a file from the ZIP archive. Stored images come back as
+    // views of the mapped archive, valid until it is closed.
     QByteArray readFileFromZip(const QString& filePath) const {
-        if (!zipArchive) return QByteArray();
-
-        QString pathInZip = filePath;
-        if (pathInZip.startsWith("/")) pathInZip.remove(0, 1);
-
-        zip_stat_t stat;
-        int result = zip_stat(zipArchive, pathInZip.toUtf8().constData(), 0, &stat);
-        if (result < 0) {
-            LOG_ERROR("CbzDocument: Failed to stat file in archive: " << filePath);
-            return QByteArray();
-        }
+        if (!zipArchive.isOpen()) return QByteArray();
 
-        zip_file_t* file = zip_fopen(zipArchive, pathInZip.toUtf8().constData(), 0);
-        if (!file) {
-            LOG_ERROR("CbzDocument: Failed to open file in archive: " << filePath);
+        if (!zipArchive.contains(filePath)) {
+            LOG_ERROR("CbzDocument: File not found in archive: " << filePath);
             return QByteArray();
         }
-
-        QByteArray data(stat.size, 0);
-        zip_int64_t bytesRead = zip_fread(file, data.data(), stat.size);
-        zip_fclose(file);
-
-        if (bytesRead != static_cast<zip_int64_t>(stat.size)) {
-            LOG_ERROR("CbzDocument: Failed to read full file content: " << filePath);
-            return QByteArray();
-        }
-
-        return data;
+        return zipArchive.fileData(filePath);
     }
 
     // Helper to list all files in the archive and categorize them
     void listAndCategorizeFiles() {
-        if (!zipArchive) return;
+        if (!zipArchive.isOpen()) return;
 
-        int numFiles = zip_get_num_entries(zipArchive, 0);
         QRegularExpression imageRegex(R"(\.(jpg|jpeg|png|gif|webp|bmp|tiff|tif)$)", QRegularExpression::CaseInsensitiveOption);
-        for (int i = 0; i < numFiles; ++i) {
-            const char* fileNameC = zip_get_name(zipArchive, i, 0);
-            if (fileNameC) {
-                QString fileName = QString::fromUtf8(fileNameC);
-                if (imageRegex.match(fileName).hasMatch()) {
-                    imagePathsList.append(fileName);
-                } else {
-                    otherFilesList.append(fileName);
-                }
+        for (const QString& fileName : zipArchive.entryNames()) {
+            if (imageRegex.match(fileName).hasMatch()) {
+                imagePathsList.append(fileName);
+            } else {
+                otherFilesList.append(fileName);
             }
         }
         // Sort image paths to ensure correct page order (often relies on filename sorting)
@@ -108,22 +79,15 @@ bool CbzDocument::load(const QString& filePath, const QString& password)
     Q_UNUSED(password); // CBZs typically don't use archive-level passwords
 
     // Close any previously loaded archive
-    if (d->zipArchive) {
-        zip_close(d->zipArchive);
-        d->zipArchive = nullptr;
-    }
+    d->zipArchive.close();
     d->isLoaded = false;
     d->pages.clear();
     d->imagePathsList.clear();
     d->otherFilesList.clear();
 
     // Open the CBZ file as a ZIP archive
-    int zipError;
-    d->zipArchive = zip_open(filePath.toUtf8().constData(), ZIP_RDONLY, &zipError);
-    if (!d->zipArchive) {
-        char errorBuffer[256];
-        zip_error_to_str(errorBuffer, sizeof(errorBuffer), zipError, errno);
-        setLastError(tr("Failed to open CBZ file as ZIP archive: %1").arg(errorBuffer));
+    if (!d->zipArchive.open(filePath)) {
+        setLastError(tr("Failed to open CBZ file as ZIP archive: %1").arg(d->zipArchive.lastError()));
         LOG_ERROR(lastError());
         return false;
     }
@@ -225,6 +189,11 @@ QString CbzDocument::comicInfoXml() const
     return d->comicInfoContent;
 }
 
+QByteArray CbzDocument::getFileContent(const QString& filePath) const
+{
+    return d->readFileFromZip(filePath);
+}
+
 bool CbzDocument::extractImage(const QString& imagePath, const QString& outputPath) const
 {
     QByteArray imageData = d->readFileFromZip(imagePath);
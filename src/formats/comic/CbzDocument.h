@@ -79,6 +79,15 @@ public:
     QString comicInfoXml() const;
 
     // --- CBZ-Specific Functionality ---
+    /**
+     * @brief Get the raw content of a file within the CBZ archive.
+     * Safe to call from several threads. Stored (uncompressed) entries refer
+     * into the mapped archive and stay valid until the document is reloaded.
+     * @param filePath Path of the file inside the archive.
+     * @return File content as QByteArray.
+     */
+    QByteArray getFileContent(const QString& filePath) const;
+
     /**
      * @brief Extract a specific image file to a given path.
      * @param imagePath Path of the image inside the archive.
@@ -48,8 +48,7 @@ public:
         QByteArray imageData;
         if (cbzDoc) {
             // Load from CBZ archive
-            imageData = cbzDoc->getFileContent(imagePathVal); // This method needs to be added to CbzDocument if it doesn't exist for raw access
-            // Or use the Private access if necessary: cbzDoc->d->readFileFromZip(imagePathVal);
+            imageData = cbzDoc->getFileContent(imagePathVal); // Thread-safe; stored images are not copied
         } else if (cbrDoc) {
             // Load from CBR archive (requires RAR library integration)
             // imageData = cbrDoc->getFileContent(imagePathVal); // This method needs RAR integration
@@ -108,6 +107,7 @@ ComicPage::ComicPage(Document* document, int pageIndex, const QString& imagePath
 
 ComicPage::~ComicPage()
 {
+    detachTextLayer();
     LOG_DEBUG("ComicPage for index " << d->pageIndexVal << " destroyed.");
 }
 
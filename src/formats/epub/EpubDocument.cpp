@@ -10,6 +10,7 @@
 #include "EpubDocument.h"
 #include "EpubPage.h" // Assuming this will be created
 #include "../../core/Logger.h"
+#include "../../core/ZipArchive.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
@@ -21,7 +22,6 @@
 #include <QRegularExpression>
 #include <QUuid> // For generating temporary directory names if needed
 #include <QDebug>
-#include <zip.h> // Include libzip header
 
 namespace QuantilyxDoc {
 
@@ -30,14 +30,10 @@ namespace QuantilyxDoc {
 
 class EpubDocument::Private {
 public:
-    Private() : zipArchive(nullptr), isLoaded(false) {}
-    ~Private() {
-        if (zipArchive) {
-            zip_close(zipArchive);
-        }
-    }
+    Private() : isLoaded(false) {}
+    ~Private() = default;
 
-    zip_t* zipArchive;
+    ZipArchive zipArchive; // Indexed once on load; reads need no locking
     QString containerPath; // Path to META-INF/container.xml inside the archive
     QString packagePath;   // Path to the .opf file inside the archive
     QString navigationPath; // Path to nav.xhtml or toc.ncx inside the archive
@@ -54,34 +50,13 @@ public:
 
     // Helper to read a file from the ZIP archive
     QByteArray readFileFromZip(const QString& filePath) const {
-        if (!zipArchive) return QByteArray();
-
-        QString pathInZip = filePath;
-        if (pathInZip.startsWith("/")) pathInZip.remove(0, 1); // Remove leading slash if present
-
-        zip_stat_t stat;
-        int result = zip_stat(zipArchive, pathInZip.toUtf8().constData(), 0, &stat);
-        if (result < 0) {
-            LOG_ERROR("EpubDocument: Failed to stat file in archive: " << filePath);
-            return QByteArray();
-        }
+        if (!zipArchive.isOpen()) return QByteArray();
 
-        zip_file_t* file = zip_fopen(zipArchive, pathInZip.toUtf8().constData(), 0);
-        if (!file) {
-            LOG_ERROR("EpubDocument: Failed to open file in archive: " << filePath);
+        if (!zipArchive.contains(filePath)) {
+            LOG_ERROR("EpubDocument: File not found in archive: " << filePath);
             return QByteArray();
         }
-
-        QByteArray data(stat.size, 0);
-        zip_int64_t bytesRead = zip_fread(file, data.data(), stat.size);
-        zip_fclose(file);
-
-        if (bytesRead != static_cast<zip_int64_t>(stat.size)) {
-            LOG_ERROR("EpubDocument: Failed to read full file content: " << filePath);
-            return QByteArray();
-        }
-
-        return data;
+        return zipArchive.fileData(filePath);
     }
 
     // Helper to parse container.xml to find the package.opf path
@@ -439,20 +414,13 @@ bool EpubDocument::load(const QString& filePath, const QString& password)
     Q_UNUSED(password); // EPUBs typically don't use archive-level passwords like ZIPs often do
 
     // Close any previously loaded document
-    if (d->zipArchive) {
-        zip_close(d->zipArchive);
-        d->zipArchive = nullptr;
-    }
+    d->zipArchive.close();
     d->isLoaded = false;
     d->pages.clear();
 
     // Open the EPUB file as a ZIP archive
-    int zipError;
-    d->zipArchive = zip_open(filePath.toUtf8().constData(), ZIP_RDONLY, &zipError);
-    if (!d->zipArchive) {
-        char errorBuffer[256];
-        zip_error_to_str(errorBuffer, sizeof(errorBuffer), zipError, errno);
-        setLastError(tr("Failed to open EPUB file as ZIP archive: %1").arg(errorBuffer));
+    if (!d->zipArchive.open(filePath)) {
+        setLastError(tr("Failed to open EPUB file as ZIP archive: %1").arg(d->zipArchive.lastError()));
         LOG_ERROR(lastError());
         return false;
     }
@@ -88,6 +88,8 @@ public:
 
     /**
      * @brief Get the raw content of a specific file within the EPUB archive.
+     * Safe to call from several threads. Stored (uncompressed) entries refer
+     * into the mapped archive and stay valid until the document is reloaded.
      * @param filePath Path of the file inside the archive.
      * @return File content as QByteArray.
      */
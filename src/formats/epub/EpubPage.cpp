@@ -113,6 +113,7 @@ EpubPage::EpubPage(EpubDocument* document, int pageIndex, const QString& htmlFil
 
 EpubPage::~EpubPage()
 {
+    detachTextLayer();
     LOG_DEBUG("EpubPage for index " << d->pageIndexVal << " destroyed.");
 }
 
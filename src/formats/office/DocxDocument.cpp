@@ -10,11 +10,11 @@
 #include "DocxDocument.h"
 #include "DocxPage.h"
 #include "../../core/Logger.h"
+#include "../../core/ZipArchive.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QXmlStreamReader>
-#include <QZipReader> // Qt 5.12+
 #include <QDebug>
 
 namespace QuantilyxDoc {
@@ -33,7 +33,7 @@ public:
     QList<QString> embeddedObjects;
     bool hasTrackChangesVal;
     QList<std::unique_ptr<DocxPage>> pages;
-    QZipReader zipReader;
+    ZipArchive zipReader;
 
     // Helper to parse document.xml and core properties from DOCX
     bool parseDocxContent() {
@@ -105,9 +105,8 @@ bool DocxDocument::load(const QString& filePath, const QString& password)
     d->isLoaded = false;
     d->pages.clear();
 
-    d->zipReader.setFileName(filePath);
-    if (!d->zipReader.exists() || !d->zipReader.isOpen()) {
-        setLastError(tr("Failed to open DOCX file as ZIP archive."));
+    if (!d->zipReader.open(filePath)) {
+        setLastError(tr("Failed to open DOCX file as ZIP archive: %1").arg(d->zipReader.lastError()));
         LOG_ERROR(lastError());
         return false;
     }
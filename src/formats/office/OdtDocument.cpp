@@ -10,11 +10,11 @@
 #include "OdtDocument.h"
 #include "OdtPage.h"
 #include "../../core/Logger.h"
+#include "../../core/ZipArchive.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QXmlStreamReader>
-#include <QZipReader> // Qt 5.12+
 #include <QDebug>
 
 namespace QuantilyxDoc {
@@ -32,7 +32,7 @@ public:
     QStringList styles;
     QList<QString> embeddedObjects;
     QList<std::unique_ptr<OdtPage>> pages;
-    QZipReader zipReader;
+    ZipArchive zipReader;
 
     // Helper to parse content.xml and meta.xml from ODT
     bool parseOdtContent() {
@@ -97,9 +97,8 @@ bool OdtDocument::load(const QString& filePath, const QString& password)
     d->isLoaded = false;
     d->pages.clear();
 
-    d->zipReader.setFileName(filePath);
-    if (!d->zipReader.exists() || !d->zipReader.isOpen()) {
-        setLastError(tr("Failed to open ODT file as ZIP archive."));
+    if (!d->zipReader.open(filePath)) {
+        setLastError(tr("Failed to open ODT file as ZIP archive: %1").arg(d->zipReader.lastError()));
         LOG_ERROR(lastError());
         return false;
     }
@@ -9,12 +9,15 @@
  */
 #include "PdfAnnotation.h"
 #include "PdfDocument.h"
+#include "../../annotations/AnnotationManager.h"
+#include "../../core/Page.h"
 #include "../../core/Logger.h"
 #include <poppler-qt5.h>
 #include <QDateTime>
 #include <QColor>
 #include <QRectF>
 #include <QPointF>
+#include <QPolygonF>
 #include <QPair>
 #include <QList>
 #include <QVariant>
@@ -25,7 +28,8 @@ namespace QuantilyxDoc {
 class PdfAnnotation::Private {
 public:
     Private(Poppler::Annotation* pAnnot, PdfDocument* doc, int pIndex)
-        : popplerAnnot(pAnnot), document(doc), pageIndexVal(pIndex), typeVal(Type::Unknown), modified(false) {
+        : popplerAnnot(pAnnot), document(doc), pageIndexVal(pIndex), typeVal(Type::Unknown), modified(false), initialHidden(false),
+          localHidden(false), localBorderWidth(1.0), localOpacity(1.0), contentsChanged(false), colorChanged(false), hiddenChanged(false) {
             if (popplerAnnot) {
                 typeVal = convertPopplerType(popplerAnnot->subType());
                 // Store initial state for comparison later
@@ -43,6 +47,51 @@ public:
     // Store initial state from Poppler object
     QString initialContents;
     QColor initialColor;
+    bool initialHidden;
+
+    // State of annotations created without a Poppler object (UI tools, XFDF import)
+    QRectF localBounds;     // Page coordinates (points, top-left origin)
+    QString localContents;
+    QColor localColor;
+    QString localAuthor;
+    QDateTime localDate;
+    QList<QList<QPointF>> localInkPaths;
+    bool localHidden;
+    qreal localBorderWidth; // Points
+    qreal localOpacity;
+    QString localName;      // /NM
+
+    // Edits of Poppler-backed annotations, held until the writer saves them
+    bool contentsChanged;
+    bool colorChanged;
+    bool hiddenChanged;
+
+    static bool isHiddenFromPoppler(Poppler::Annotation* annot) {
+        const int HIDDEN_FLAG = 2;
+        return (annot->flags() & HIDDEN_FLAG) != 0;
+    }
+
+    // Page size in points, for mapping Poppler's normalized boundary
+    QSizeF pageSize() const {
+        Page* page = document ? document->page(pageIndexVal) : nullptr;
+        return page ? page->size() : QSizeF();
+    }
+
+    // Poppler's normalized [0, 1] page coordinates -> points
+    QPointF toPage(const QPointF& normalized) const {
+        const QSizeF size = pageSize();
+        return QPointF(normalized.x() * size.width(), normalized.y() * size.height());
+    }
+
+    // Record a local change and notify the owner
+    void markModified(PdfAnnotation* q) {
+        modified = true;
+        localDate = QDateTime::currentDateTime();
+        emit q->propertiesChanged();
+        if (document) {
+            AnnotationManager::instance().markAnnotationModified(document, q);
+        }
+    }
 
     // Helper to convert Poppler::Annotation::SubType to our Type
     static Type convertPopplerType(Poppler::Annotation::SubType popplerType) {
@@ -129,9 +178,12 @@ PdfAnnotation::PdfAnnotation(Type type, const QRectF& bounds, PdfDocument* docum
     // For QuantilyxDoc, we might need to defer full annotation *creation* until a writing library is integrated,
     // or use a hybrid approach where we create a temporary object here and handle the PDF writing later.
     // For now, this constructor might be a stub or only create a placeholder object.
+    // Until a writer persists it, the annotation lives in the local fields
     d->typeVal = type;
-    LOG_WARN("PdfAnnotation constructor for new annotation (type " << static_cast<int>(type) << ") is a stub. Poppler-Qt5 is read-only for annotations.");
-    Q_UNUSED(bounds);
+    d->localBounds = bounds;
+    d->localDate = QDateTime::currentDateTime();
+    d->modified = true;
+    LOG_DEBUG("PdfAnnotation created locally (type " << static_cast<int>(type) << ") on page " << pageIndex);
 }
 
 PdfAnnotation::~PdfAnnotation()
@@ -147,86 +199,109 @@ PdfAnnotation::Type PdfAnnotation::type() const
 QRectF PdfAnnotation::bounds() const
 {
     if (d->popplerAnnot) {
-        // Poppler::Annotation::boundary() returns the bounding box
-        QRectF boundary = d->popplerAnnot->boundary();
-        LOG_DEBUG("PdfAnnotation bounds: " << boundary);
-        return boundary;
+        // Poppler::Annotation::boundary() is normalized to [0, 1]; scale to points
+        const QRectF boundary = d->popplerAnnot->boundary();
+        const QSizeF size = d->pageSize();
+        return QRectF(boundary.x() * size.width(), boundary.y() * size.height(),
+                      boundary.width() * size.width(), boundary.height() * size.height());
+    }
+    return d->localBounds;
+}
+
+void PdfAnnotation::setBounds(const QRectF& bounds)
+{
+    if (d->popplerAnnot) {
+        LOG_WARN("PdfAnnotation::setBounds: Only annotations created locally can be changed.");
+        return;
+    }
+    if (bounds != d->localBounds) {
+        d->localBounds = bounds;
+        d->markModified(this);
     }
-    // If created new (popplerAnnot is null), return a stored value or default
-    LOG_WARN("PdfAnnotation::bounds: Poppler annotation is null, returning default.");
-    return QRectF(); // Or a stored value from a member variable if created new
 }
 
 QString PdfAnnotation::author() const
 {
-    return d->popplerAnnot ? d->popplerAnnot->author() : QString();
+    return d->popplerAnnot ? d->popplerAnnot->author() : d->localAuthor;
 }
 
 QString PdfAnnotation::contents() const
 {
-    return d->popplerAnnot ? d->popplerAnnot->contents() : QString();
+    return d->popplerAnnot && !d->contentsChanged ? d->popplerAnnot->contents() : d->localContents;
 }
 
 QDateTime PdfAnnotation::modificationDate() const
 {
-    return d->popplerAnnot ? d->popplerAnnot->modificationDate() : QDateTime();
+    return d->popplerAnnot ? d->popplerAnnot->modificationDate() : d->localDate;
 }
 
 QColor PdfAnnotation::color() const
+{
+    return d->popplerAnnot && !d->colorChanged ? d->popplerAnnot->color() : d->localColor;
+}
+
+void PdfAnnotation::setContents(const QString& contents)
+{
+    if (contents == this->contents()) return;
+    // Poppler annotations are read-only; the new value is kept here and
+    // written by PdfDocument's save path
+    d->localContents = contents;
+    d->contentsChanged = d->popplerAnnot != nullptr;
+    d->markModified(this);
+}
+
+void PdfAnnotation::setColor(const QColor& color)
+{
+    if (color == this->color()) return;
+    d->localColor = color;
+    d->colorChanged = d->popplerAnnot != nullptr;
+    d->markModified(this);
+}
+
+Poppler::Annotation* PdfAnnotation::popplerAnnotation() const
+{
+    return d->popplerAnnot;
+}
+
+PdfDocument* PdfAnnotation::document() const
+{
+    return d->document;
+}
+
+void PdfAnnotation::setAuthor(const QString& author)
 {
     if (d->popplerAnnot) {
-        // Poppler::Annotation::color() returns QColor
-        QColor c = d->popplerAnnot->color();
-        LOG_DEBUG("PdfAnnotation color: " << c.name());
-        return c;
+        LOG_WARN("PdfAnnotation::setAuthor: Only annotations created locally can be changed.");
+        return;
+    }
+    if (author != d->localAuthor) {
+        d->localAuthor = author;
+        d->markModified(this);
     }
-    return QColor(); // Default color
 }
 
-oid PdfAnnotation::setContents(const QString& contents)
+void PdfAnnotation::setModificationDate(const QDateTime& date)
 {
-    if (d->popplerAnnot) {
-        if (contents != d->initialContents) { // Compare to initial state
-            d->modified = true;
-            // Store new value locally if needed for QPDF writing
-            // d->localContents = contents; // Or update initialContents if you always compare to last saved
-            emit propertiesChanged();
-            if (d->document) {
-                 // Notify the document that its state has changed, requiring a save
-                 // This might involve calling a method on PdfDocument or using AnnotationManager
-                 // For now, let's assume AnnotationManager tracks this per document
-                 AnnotationManager::instance().markDocumentAsModified(d->document);
-                 // Or PdfDocument could have a method like markAnnotationModified(this)
-            }
-        } else {
-            // Contents reverted to initial state, maybe clear modified flag?
-            // d->modified = false; // Be careful with this logic
-        }
-    } else {
-        LOG_WARN("PdfAnnotation::setContents: Poppler annotation is null.");
+    if (!d->popplerAnnot) {
+        d->localDate = date;
     }
 }
 
-void PdfAnnotation::setColor(const QColor& color)
+void PdfAnnotation::setInkPaths(const QList<QList<QPointF>>& paths)
 {
     if (d->popplerAnnot) {
-        if (color != d->initialColor) {
-            d->modified = true;
-            // Store new value locally if needed
-            // d->localColor = color;
-            emit propertiesChanged();
-             if (d->document) {
-                 AnnotationManager::instance().markDocumentAsModified(d->document);
-             }
-        }
-    } else {
-        LOG_WARN("PdfAnnotation::setColor: Poppler annotation is null.");
+        LOG_WARN("PdfAnnotation::setInkPaths: Only annotations created locally can be changed.");
+        return;
     }
+    d->localInkPaths = paths;
+    d->markModified(this);
 }
 
-Poppler::Annotation* PdfAnnotation::popplerAnnotation() const
+void PdfAnnotation::restoreInkPaths(const QList<QList<QPointF>>& paths)
 {
-    return d->popplerAnnot;
+    if (!d->popplerAnnot) {
+        d->localInkPaths = paths;
+    }
 }
 
 int PdfAnnotation::pageIndex() const
@@ -236,11 +311,19 @@ int PdfAnnotation::pageIndex() const
 
 QString PdfAnnotation::name() const
 {
-    // Poppler might not expose 'name' directly, or it might be in specific annotation types.
-    // Check Poppler API documentation.
-    // For now, assume it's not directly available or is part of a more complex property map.
-    LOG_WARN("PdfAnnotation::name: Not directly available in Poppler-Qt5 API.");
-    return QString();
+    return d->popplerAnnot ? d->popplerAnnot->uniqueName() : d->localName;
+}
+
+void PdfAnnotation::setName(const QString& name)
+{
+    if (d->popplerAnnot) {
+        LOG_WARN("PdfAnnotation::setName: Only annotations created locally can be changed.");
+        return;
+    }
+    if (name != d->localName) {
+        d->localName = name;
+        d->markModified(this);
+    }
 }
 
 QString PdfAnnotation::subject() const
@@ -254,10 +337,20 @@ QString PdfAnnotation::subject() const
 
 qreal PdfAnnotation::opacity() const
 {
-    // Poppler might not expose opacity directly on the base Annotation class.
-    // It might be part of the appearance characteristics or specific to certain types.
-    LOG_WARN("PdfAnnotation::opacity: Not directly available in Poppler-Qt5 API.");
-    return 1.0; // Default opaque
+    return d->popplerAnnot ? d->popplerAnnot->style().opacity() : d->localOpacity;
+}
+
+void PdfAnnotation::setOpacity(qreal opacity)
+{
+    if (d->popplerAnnot) {
+        LOG_WARN("PdfAnnotation::setOpacity: Only annotations created locally can be changed.");
+        return;
+    }
+    opacity = qBound<qreal>(0.0, opacity, 1.0);
+    if (!qFuzzyCompare(opacity, d->localOpacity)) {
+        d->localOpacity = opacity;
+        d->markModified(this);
+    }
 }
 
 bool PdfAnnotation::isModified() const
@@ -267,63 +360,23 @@ bool PdfAnnotation::isModified() const
 
 bool PdfAnnotation::isHidden() const
 {
-    if (d->popplerAnnot) {
-        // Poppler::Annotation::Flag is an enum or bitmask. Check its values.
-        // Poppler::Annotation::Hidden is the flag we are looking for.
-        // The exact enum value might be different, check Poppler documentation.
-        // Common flags are: Invisible (1), Hidden (2), Print (4), NoZoom (8), NoRotate (16), NoView (32), ReadOnly (64), Locked (128)
-        // Hidden is typically 2 (1 << 1).
-        // Check the Poppler source or documentation for the exact enum.
-        // Assuming Poppler::Annotation::Hidden exists and has the correct value.
-        // int hiddenFlag = static_cast<int>(Poppler::Annotation::Hidden); // This might not be the exact syntax or value
-        // A safer way is to use the numeric value directly if documented.
-        // According to PDF spec and common Poppler usage: Hidden = 2
-        const int HIDDEN_FLAG = 2;
-        bool isHidden = (d->popplerAnnot->flags() & HIDDEN_FLAG) != 0;
-        LOG_DEBUG("PdfAnnotation::isHidden: Annotation '" << name() << "' is hidden: " << isHidden);
-        return isHidden;
+    if (d->popplerAnnot && !d->hiddenChanged) {
+        return Private::isHiddenFromPoppler(d->popplerAnnot);
     }
-    LOG_WARN("PdfAnnotation::isHidden: Poppler annotation is null, returning false.");
-    return false; // Default to not hidden if no object
+    return d->localHidden;
 }
 
-// Add a setter for the hidden property
 void PdfAnnotation::setHidden(bool hidden)
 {
-    if (d->popplerAnnot) {
-        // Poppler::Annotation objects are read-only. We cannot directly change the flag here.
-        // We need to store the intended new state and apply it during save using QPDF.
-        LOG_DEBUG("PdfAnnotation::setHidden: Marking annotation '" << name() << "' hidden state for change (requires saving with writer). New state: " << hidden);
-
-        // Store the new state locally (requires adding a member variable in Private)
-        // For example, add 'std::optional<bool> localHiddenState;' to Private class
-        // d->localHiddenState = hidden; // Assuming this member exists
-
-        // Mark the annotation as modified
-        if (hidden != isHidden()) { // Only mark if the value actually changed
-            d->modified = true;
-            emit propertiesChanged();
-            if (d->document) {
-                 AnnotationManager::instance().markDocumentAsModified(d->document);
-            }
-        }
-    } else {
-        LOG_WARN("PdfAnnotation::setHidden: Poppler annotation is null.");
-    }
+    if (hidden == isHidden()) return;
+    d->localHidden = hidden;
+    d->hiddenChanged = d->popplerAnnot != nullptr;
+    d->markModified(this);
 }
 
-// Add the getter for the local state (needed for QPDF save logic)
 bool PdfAnnotation::getLocalHiddenState() const
 {
-    // Return the locally stored intended state, or the original state if not modified
-    // This requires storing the intended state in the Private class.
-    // For example, if you added 'std::optional<bool> localHiddenState;' to Private:
-    // return d->localHiddenState.value_or(isHidden());
-    // For now, since we haven't added the member, we'll just return the original state from Poppler.
-    // This means the save logic will need to know if *this specific property* was modified separately.
-    // A better way is to add the member.
-    LOG_WARN("PdfAnnotation::getLocalHiddenState: Requires storing local state in Private class.");
-    return isHidden(); // Fallback to original state
+    return isHidden();
 }
 
 bool PdfAnnotation::isReadOnly() const
@@ -357,14 +410,12 @@ QString PdfAnnotation::appearance() const
 
 QString PdfAnnotation::iconName() const
 {
-    // For Text annotations, the icon name (e.g., "Comment", "Key") might be available.
-    // Check Poppler::TextAnnotation specific properties if accessible.
-    // Poppler::Annotation is the base class.
+    // Poppler::Annotation::subType() tells which subclass the object is
     if (d->popplerAnnot && d->popplerAnnot->subType() == Poppler::Annotation::AText) {
-         // Cast to Poppler::TextAnnotation if possible via dynamic_cast or a specific getter.
-         // Poppler::Annotation doesn't expose sub-type specific properties directly on the base class.
-         // This requires careful casting or a different design where PdfAnnotation stores its own copy of the specific data.
-         LOG_WARN("PdfAnnotation::iconName: Requires casting to Poppler::TextAnnotation.");
+        return static_cast<Poppler::TextAnnotation*>(d->popplerAnnot)->textIcon();
+    }
+    if (d->popplerAnnot && d->popplerAnnot->subType() == Poppler::Annotation::AStamp) {
+        return static_cast<Poppler::StampAnnotation*>(d->popplerAnnot)->stampIconName();
     }
     return QString();
 }
@@ -387,27 +438,76 @@ QString PdfAnnotation::stateModel() const
 
 QList<QList<QPointF>> PdfAnnotation::inkPaths() const
 {
-    if (d->popplerAnnot && d->popplerAnnot->subType() == Poppler::Annotation::AInk) {
-        // Cast to Poppler::InkAnnotation if possible.
-        // Poppler::Annotation doesn't expose sub-type specific properties directly.
-        // This is difficult with Poppler-Qt5's current API design for reading.
-        LOG_WARN("PdfAnnotation::inkPaths: Requires casting to Poppler::InkAnnotation, not directly supported for reading paths.");
-        // Poppler::InkAnnotation *inkAnnot = dynamic_cast<Poppler::InkAnnotation*>(d->popplerAnnot);
-        // if (inkAnnot) { ... get paths ... }
-        // But dynamic_cast might not work if the classes aren't polymorphically linked this way in the library.
-        // The API often requires using the Poppler::Page::annotations() list which returns Poppler::Annotation*,
-        // and the specific sub-type is only known via subType().
+    if (!d->popplerAnnot) return d->localInkPaths;
+    QList<QList<QPointF>> paths;
+    if (d->popplerAnnot->subType() == Poppler::Annotation::AInk) {
+        const auto popplerPaths = static_cast<Poppler::InkAnnotation*>(d->popplerAnnot)->inkPaths();
+        for (const auto& popplerPath : popplerPaths) {
+            QList<QPointF> path;
+            for (const QPointF& point : popplerPath) {
+                path.append(d->toPage(point));
+            }
+            paths.append(path);
+        }
     }
-    return QList<QList<QPointF>>(); // Default empty
+    return paths;
 }
 
 QPair<QPointF, QPointF> PdfAnnotation::lineCoordinates() const
 {
+    const QList<QPointF> points = vertices();
+    if (points.size() < 2) return QPair<QPointF, QPointF>();
+    return qMakePair(points.first(), points.last());
+}
+
+QList<QPointF> PdfAnnotation::vertices() const
+{
+    QList<QPointF> points;
     if (d->popplerAnnot && d->popplerAnnot->subType() == Poppler::Annotation::ALine) {
-        // Similar issue as inkPaths. Requires specific sub-type access.
-        LOG_WARN("PdfAnnotation::lineCoordinates: Requires casting to Poppler::LineAnnotation, not directly supported for reading coordinates.");
+        // Poppler-Qt5 models polylines and polygons as line annotations
+        const auto linePoints = static_cast<Poppler::LineAnnotation*>(d->popplerAnnot)->linePoints();
+        for (const QPointF& point : linePoints) {
+            points.append(d->toPage(point));
+        }
+    }
+    return points;
+}
+
+QList<QPolygonF> PdfAnnotation::quads() const
+{
+    QList<QPolygonF> result;
+    if (d->popplerAnnot && d->popplerAnnot->subType() == Poppler::Annotation::AHighlight) {
+        // Corners in order: top-left, top-right, bottom-right, bottom-left
+        const auto popplerQuads = static_cast<Poppler::HighlightAnnotation*>(d->popplerAnnot)->highlightQuads();
+        for (const Poppler::HighlightAnnotation::Quad& quad : popplerQuads) {
+            QPolygonF polygon;
+            for (const QPointF& corner : quad.points) {
+                polygon << d->toPage(corner);
+            }
+            result.append(polygon);
+        }
+    }
+    if (result.isEmpty()) {
+        result.append(QPolygonF(bounds()));
+    }
+    return result;
+}
+
+qreal PdfAnnotation::borderWidth() const
+{
+    return d->popplerAnnot ? d->popplerAnnot->style().width() : d->localBorderWidth;
+}
+
+void PdfAnnotation::setBorderWidth(qreal width)
+{
+    if (d->popplerAnnot) {
+        LOG_WARN("PdfAnnotation::setBorderWidth: Only annotations created locally can be changed.");
+        return;
+    }
+    if (width > 0.0 && !qFuzzyCompare(width, d->localBorderWidth)) {
+        d->localBorderWidth = width;
+        d->markModified(this);
     }
-    return QPair<QPointF, QPointF>(); // Default empty
 }
 
 void PdfAnnotation::syncToPopplerObject()
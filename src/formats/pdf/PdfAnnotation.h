@@ -15,6 +15,8 @@
 #include <memory>
 #include <QPointF>
 #include <QRectF>
+#include <QPolygonF>
+#include <QList>
 #include <QColor>
 #include <QDateTime>
 
@@ -101,11 +103,18 @@ public:
     Type type() const;
 
     /**
-     * @brief Get the bounds of this annotation in PDF coordinates.
-     * @return Rectangle in PDF coordinate system.
+     * @brief Get the bounds of this annotation in page coordinates.
+     * @return Rectangle in points, origin at the top-left of the page.
      */
     QRectF bounds() const override; // Assuming base Annotation class has this
 
+    /**
+     * @brief Move or resize a locally created annotation.
+     * Callers re-index it with AnnotationManager::updateAnnotationBounds().
+     * @param bounds Rectangle in points, origin at the top-left of the page.
+     */
+    void setBounds(const QRectF& bounds);
+
     /**
      * @brief Get the author of this annotation.
      * @return Author name.
@@ -149,6 +158,38 @@ public:
      */
     Poppler::Annotation* popplerAnnotation() const;
 
+    /**
+     * @brief Get the document this annotation belongs to.
+     * @return The PdfDocument, or nullptr.
+     */
+    PdfDocument* document() const;
+
+    /**
+     * @brief Set the author of a locally created annotation.
+     * @param author Author name.
+     */
+    void setAuthor(const QString& author);
+
+    /**
+     * @brief Set the modification date of a locally created annotation (e.g. on import).
+     * Does not mark the annotation as modified.
+     * @param date Modification date/time.
+     */
+    void setModificationDate(const QDateTime& date);
+
+    /**
+     * @brief Set the ink paths of a locally created ink annotation.
+     * @param paths List of paths in page coordinates.
+     */
+    void setInkPaths(const QList<QList<QPointF>>& paths);
+
+    /**
+     * @brief Put back ink paths of a locally created annotation without marking it modified.
+     * Lets an undo command holding the annotation move its points to disk and back.
+     * @param paths Paths previously returned by inkPaths(), or none to free them.
+     */
+    void restoreInkPaths(const QList<QList<QPointF>>& paths);
+
     /**
      * @brief Get the page index this annotation is associated with.
      * @return Page index (0-based).
@@ -156,11 +197,17 @@ public:
     int pageIndex() const;
 
     /**
-     * @brief Get the name of this annotation (optional PDF field).
-     * @return Annotation name.
+     * @brief Get the unique name of this annotation (PDF /NM).
+     * @return Annotation name, or an empty string if it has none.
      */
     QString name() const;
 
+    /**
+     * @brief Set the unique name of a locally created annotation.
+     * @param name Annotation name.
+     */
+    void setName(const QString& name);
+
     /**
      * @brief Get the subject of this annotation (optional PDF field).
      * @return Subject string.
@@ -173,12 +220,31 @@ public:
      */
     qreal opacity() const;
 
+    /**
+     * @brief Set the opacity of a locally created annotation.
+     * @param opacity Opacity, clamped to 0.0 - 1.0.
+     */
+    void setOpacity(qreal opacity);
+
     /**
      * @brief Check if this annotation is hidden.
      * @return True if hidden.
      */
     bool isHidden() const;
 
+    /**
+     * @brief Hide or show this annotation.
+     * Kept locally until the document is saved.
+     * @param hidden True to hide.
+     */
+    void setHidden(bool hidden);
+
+    /**
+     * @brief Get the hidden state to write on save, including unsaved changes.
+     * @return True if hidden.
+     */
+    bool getLocalHiddenState() const;
+
     /**
      * @brief Check if this annotation is read-only.
      * @return True if read-only.
@@ -233,6 +299,32 @@ public:
      */
     QPair<QPointF, QPointF> lineCoordinates() const;
 
+    /**
+     * @brief Get the vertices of line, polyline and polygon annotations.
+     * @return Points in page coordinates, or an empty list for other types.
+     */
+    QList<QPointF> vertices() const;
+
+    /**
+     * @brief Get the quadrilaterals covered by a text markup annotation
+     * (highlight, underline, squiggly, strike-out).
+     * @return Quads in page coordinates, corners ordered top-left, top-right,
+     *         bottom-right, bottom-left; the bounds if the annotation has none.
+     */
+    QList<QPolygonF> quads() const;
+
+    /**
+     * @brief Get the border or stroke width.
+     * @return Width in points.
+     */
+    qreal borderWidth() const;
+
+    /**
+     * @brief Set the stroke width of a locally created annotation.
+     * @param width Width in points.
+     */
+    void setBorderWidth(qreal width);
+
     // --- Modification ---
     /**
      * @brief Update the annotation's internal Poppler object based on local changes.
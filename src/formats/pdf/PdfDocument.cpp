@@ -18,6 +18,8 @@
 #include <QCryptographicHash>
 #include <QDir>
 #include <QSaveFile> // For safe saving
+#include <QMutex>
+#include <QMutexLocker>
 #include <QDebug>
 #include <qpdf/QPDF.hh>
 #include <qpdf/QPDFWriter.hh>
@@ -47,6 +49,11 @@ public:
     QList<std::unique_ptr<PdfAnnotation>> allAnnotations; // Own annotation objects associated with this doc
     QList<std::unique_ptr<PdfFormField>> formFields; // Own form field objects
     QStringList embeddedFileNames; // Cache list of embedded files
+    QString password; // Kept to open the display copy
+    // Second Poppler document for on-screen renders. The annotation hint is
+    // per-document, and print, export and OCR renders must keep annotations.
+    std::unique_ptr<Poppler::Document> displayDoc;
+    QMutex displayMutex; // Guards displayDoc: the render thread loads and uses it
 
     // Helper to get Poppler's Page from index
     Poppler::Page* getPopplerPage(int index) const {
@@ -74,6 +81,11 @@ bool PdfDocument::load(const QString& filePath, const QString& password)
     // Delete old Poppler document if it exists
     delete d->popplerDoc;
     d->popplerDoc = nullptr;
+    {
+        QMutexLocker locker(&d->displayMutex);
+        d->displayDoc.reset();
+    }
+    d->password = password;
     d->pages.clear();
     d->allAnnotations.clear();
     d->formFields.clear();
@@ -152,6 +164,104 @@ bool PdfDocument::load(const QString& filePath, const QString& password)
     return true;
 }
 
+std::function<QString()> PdfDocument::prepareCopy(const QString& filePath) const
+{
+    if (!d->popplerDoc) {
+        return []() { return tr("No document loaded to save."); };
+    }
+
+    // The QPDF rewrite starts from the *currently loaded* file
+    const std::string originalPathStdString = this->filePath().toStdString();
+    const std::string targetPathStdString = filePath.toStdString();
+    const QString originalPath = this->filePath();
+
+    // --- Capture Pending Annotation Changes ---
+    // Only plain values leave this thread: the writer may run on a pool
+    // thread while the user keeps editing.
+    // We need to map our QuantilyxDoc annotation objects to PDF annotation objects in the QPDF structure.
+    // A more robust way is if PdfAnnotation/PdfPage stored the original QPDF object handle;
+    // until then the original /Rect is matched against the annotation's bounds.
+    struct AnnotationEdit {
+        int pageIndex;
+        QRectF bounds;
+        QString contents;
+        QColor color;
+    };
+    QList<AnnotationEdit> edits;
+    const QList<Annotation*> modifiedAnnotations =
+        AnnotationManager::instance().getModifiedAnnotationsForDocument(const_cast<PdfDocument*>(this));
+    for (Annotation* qAnnot : modifiedAnnotations) {
+        PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(qAnnot);
+        if (pdfAnnot && pdfAnnot->document() == this) { // Ensure it belongs to this doc
+            edits.append({pdfAnnot->pageIndex(), pdfAnnot->bounds(), pdfAnnot->contents(), pdfAnnot->color()});
+        }
+    }
+
+    return [originalPath, originalPathStdString, targetPathStdString, edits]() -> QString {
+        std::unique_ptr<QPDF> qpdf = std::make_unique<QPDF>();
+        try {
+            LOG_DEBUG("QPDF: Loading original file: " << originalPathStdString);
+            qpdf->processFile(originalPathStdString.c_str());
+        } catch (const std::exception& e) {
+            return tr("QPDF failed to load original file '%1': %2").arg(originalPath).arg(e.what());
+        }
+
+        // --- Apply Pending Annotation Changes ---
+        std::vector<QPDFObjectHandle> allPages = qpdf->getAllPages();
+        const int pageCount = int(allPages.size());
+        for (const AnnotationEdit& edit : edits) {
+            if (edit.pageIndex < 0 || edit.pageIndex >= pageCount) {
+                LOG_WARN("QPDF: Annotation refers to invalid page index: " << edit.pageIndex);
+                continue;
+            }
+            QPDFObjectHandle pageObj = allPages[edit.pageIndex];
+            if (!pageObj.getKey("/Annots").isArray()) {
+                LOG_WARN("QPDF: Page " << edit.pageIndex << " has no /Annots array. Cannot modify annotations.");
+                continue;
+            }
+            // Find the QPDF object of this annotation (matched by its boundary, which is fragile)
+            QPDFObjectHandle annotObj = findQpdfAnnotationHandle(pageObj, edit.bounds);
+            if (!annotObj.isInitialized()) {
+                LOG_WARN("QPDF: Could not find matching QPDF object for modified QuantilyxDoc annotation on page " << edit.pageIndex);
+                continue;
+            }
+
+            // Apply changes from the annotation to the QPDF object handle
+            if (edit.contents != getQpdfAnnotationContents(annotObj)) {
+                LOG_DEBUG("QPDF: Modifying annotation contents on page " << edit.pageIndex);
+                annotObj.replaceKey("/Contents", QPDFObjectHandle::newUnicodeString(edit.contents.toStdU32String()));
+            }
+            if (edit.color != getQpdfAnnotationColor(annotObj)) {
+                LOG_DEBUG("QPDF: Modifying annotation color on page " << edit.pageIndex);
+                QPDFObjectHandle colorArray = QPDFObjectHandle::newArray({
+                    QPDFObjectHandle::newReal(edit.color.redF()),
+                    QPDFObjectHandle::newReal(edit.color.greenF()),
+                    QPDFObjectHandle::newReal(edit.color.blueF())
+                });
+                annotObj.replaceKey("/C", colorArray);
+            }
+            // Apply other properties like border style, opacity, etc., as needed.
+            LOG_DEBUG("QPDF: Modified annotation on page " << edit.pageIndex);
+        }
+
+        // --- Apply Pending Form Field Changes ---
+        // Similar process: get modified form fields, find their QPDF object handles, modify values.
+        // This involves navigating the /AcroForm structure in the QPDF object and
+        // requires mapping QuantilyxDoc PdfFormField objects to QPDF handles.
+
+        // --- Write the modified QPDF object to the target file ---
+        LOG_DEBUG("QPDF: Writing modified file to: " << targetPathStdString);
+        QPDFWriter writer(*qpdf, targetPathStdString.c_str());
+        try {
+            writer.write();
+        } catch (const std::exception& e) {
+            return tr("QPDF failed to write file '%1': %2")
+                .arg(QString::fromStdString(targetPathStdString)).arg(e.what());
+        }
+        return QString();
+    };
+}
+
 bool PdfDocument::save(const QString& filePath)
 {
     if (!d->popplerDoc) {
@@ -167,151 +277,17 @@ bool PdfDocument::save(const QString& filePath)
         return false;
     }
 
-     // --- NEW LOGIC: Use QPDF for writing ---
-    std::string originalPathStdString = filePath().toStdString(); // Path of the *currently loaded* file
-    std::string targetPathStdString = targetPath.toStdString();   // Path to *save* to
-
     // Check if we have pending modifications to apply
     if (!d->inMemoryStateModified) {
         LOG_INFO("No pending modifications. Performing standard Poppler save.");
-        // If no changes tracked by our system, try Poppler save (read-only properties only)
-        // This might be okay for just saving metadata changes made via Poppler's API, if any.
-        // For now, let's assume if inMemoryStateModified is false, the file is up-to-date or Poppler can't save changes anyway.
-        // We'll proceed with QPDF which handles both scenarios, but maybe just copies if no changes.
-        // Or, we could just return true if no modifications are tracked, assuming the file on disk is correct.
+        // If no changes tracked by our system, the file on disk may already be up to date.
         // For safety and consistency with the new system, let's use QPDF to ensure *any* internal state changes are reflected.
     }
 
-    std::unique_ptr<QPDF> qpdf = std::make_unique<QPDF>();
-    try {
-        LOG_DEBUG("QPDF: Loading original file: " << originalPathStdString);
-        qpdf->processFile(originalPathStdString.c_str());
-    } catch (const std::exception& e) {
-        setLastError(tr("QPDF failed to load original file '%1': %2").arg(filePath()).arg(e.what()));
-        LOG_ERROR(lastError());
-        return false;
-    }
-
-    // --- Apply Pending Annotation Changes ---
-    // Get changes from AnnotationManager
-    // This requires AnnotationManager to have a method returning serialized changes for *this* document.
-    // Let's assume it returns a structure like: struct Change { int page_idx; QString id; QString action; QVariantMap props; };
-    // We need to map our QuantilyxDoc annotation objects to PDF annotation objects in the QPDF structure.
-
-    // A more robust way is if PdfAnnotation/PdfPage stored the original QPDF object handle or a way to find it.
-    // For now, let's assume a mapping exists or we find by properties like contents/bounds/name.
-
-    // Example: Iterate through all pages and potentially modified annotations
-    // This is complex because we need to find the *original* annotation in the QPDF structure.
-    // Poppler::Annotation provides its boundary, contents, etc. We can use these as identifiers.
-    // QPDF: Iterate pages
-    std::vector<QPDFObjectHandle> allPages = qpdf->getAllPages();
-    int pageCount = allPages.size();
-
-    // Get *all* annotations for *this* document from AnnotationManager that are marked as modified
-    // This is a key function we need to implement in AnnotationManager.
-    // It should return annotations associated with *this* PdfDocument instance that have isModified() == true.
-    // For this example, let's call a hypothetical method.
-    QList<Annotation*> modifiedAnnotations = AnnotationManager::instance().getModifiedAnnotationsForDocument(this);
-
-    for (Annotation* qAnnot : modifiedAnnotations) {
-        PdfAnnotation* pdfAnnot = dynamic_cast<PdfAnnotation*>(qAnnot);
-        if (pdfAnnot && pdfAnnot->document() == this) { // Ensure it belongs to this doc
-            int pageIndex = pdfAnnot->pageIndex(); // This requires PdfAnnotation to store its page index correctly
-            if (pageIndex >= 0 && pageIndex < pageCount) {
-                QPDFObjectHandle pageObj = allPages[pageIndex];
-                QPDFObjectHandle annotsArray = pageObj.getKey("/Annots");
-
-                if (annotsArray.isArray()) {
-                    bool foundAndModified = false;
-                    // Iterate the /Annots array on this page to find the matching annotation
-                    for (size_t i = 0; i < annotsArray.getArrayNItems(); ++i) {
-                        QPDFObjectHandle annotObj = annotsArray.getArrayItem(i);
-
-                        // Find by a unique identifier if possible (e.g., original contents + bounds combination, or a stored ID)
-                        // Poppler::Annotation *popplerAnnot = pdfAnnot->popplerAnnotation(); // Need to link back
-                        // This is the crux: linking QuantilyxDoc's PdfAnnotation to QPDF's object handle.
-                        // The most reliable way is if PdfAnnotation stored the QPDF handle during creation/loading via Poppler.
-                        // Since we didn't do that initially, matching by properties is less robust but possible for basic types.
-                        // Let's assume PdfAnnotation has a method to get its original Poppler object and we can match by boundary/content.
-                        // OR, we enhance PdfAnnotation to store its QPDF handle when loaded.
-
-                        // For now, let's assume PdfAnnotation has a method getQpdfObjectHandle() that returns the original handle if loaded via a method that captured it.
-                        // This requires modification of PdfAnnotation.
-                        // QPDFObjectHandle originalQpdfHandle = pdfAnnot->getQpdfObjectHandle();
-
-                        // If we can't directly link, we must find by matching properties.
-                        // This is fragile. Let's assume a hypothetical match function exists or is added to PdfAnnotation.
-                        // bool matches = pdfAnnot->matchesQpdfHandle(annotObj); // Hypothetical
-
-                        // Let's try matching by boundary and type as a proxy (still fragile but better than nothing for a demo).
-                        // We need the original boundary from the QPDF object and compare to PdfAnnotation's current state.
-                        // QPDFObjectHandle originalBounds = annotObj.getKey("/Rect"); // Get /Rect from QPDF object
-                        // QRectF qpdfBounds = ...; // Parse QPDFObjectHandle to QRectF
-                        // if (qpdfBounds == pdfAnnot->bounds() && ...) { // Check type etc.
-
-                        // For this example, let's assume we have a way to identify the correct QPDF object handle.
-                        // Let's call a hypothetical method that attempts to find the matching handle based on stored initial state.
-                        QPDFObjectHandle matchingAnnotObj = findQpdfAnnotationHandle(pageObj, pdfAnnot);
-                        if (!matchingAnnotObj.isInitialized() || matchingAnnotObj.getOID() != annotObj.getOID()) {
-                             // If the handles don't match based on our lookup, keep searching.
-                             continue;
-                        }
-
-                        // Found the matching annotation object in QPDF structure
-                        // Apply changes from PdfAnnotation to the QPDF object handle
-                        // Example: Modify contents
-                        if (pdfAnnot->contents() != getQpdfAnnotationContents(annotObj)) { // Hypothetical getter
-                            LOG_DEBUG("QPDF: Modifying annotation contents on page " << pageIndex);
-                            annotObj.replaceKey("/Contents", QPDFObjectHandle::newUnicodeString(pdfAnnot->contents().toStdU32String()));
-                        }
-                        // Example: Modify color
-                        if (pdfAnnot->color() != getQpdfAnnotationColor(annotObj)) { // Hypothetical getter
-                            LOG_DEBUG("QPDF: Modifying annotation color on page " << pageIndex);
-                            QColor color = pdfAnnot->color();
-                            QPDFObjectHandle colorArray = QPDFObjectHandle::newArray({
-                                QPDFObjectHandle::newReal(color.redF()),
-                                QPDFObjectHandle::newReal(color.greenF()),
-                                QPDFObjectHandle::newReal(color.blueF())
-                            });
-                            annotObj.replaceKey("/C", colorArray);
-                        }
-                        // Apply other properties like border style, opacity, etc., as needed.
-                        foundAndModified = true;
-                        LOG_DEBUG("QPDF: Modified annotation on page " << pageIndex);
-                        break; // Stop searching once found and modified for this specific QuantilyxDoc annotation
-                    }
-                    if (!foundAndModified) {
-                        LOG_WARN("QPDF: Could not find matching QPDF object for modified QuantilyxDoc annotation on page " << pageIndex);
-                    }
-                } else {
-                    LOG_WARN("QPDF: Page " << pageIndex << " has no /Annots array. Cannot modify annotations.");
-                }
-            } else {
-                LOG_WARN("QPDF: Annotation refers to invalid page index: " << pageIndex);
-            }
-        }
-    }
-
-    // --- Apply Pending Form Field Changes ---
-    // Similar process: get modified form fields, find their QPDF object handles, modify values.
-    // This involves navigating the /AcroForm structure in the QPDF object.
-    // QPDFObjectHandle acroForm = qpdf->getRoot().getKey("/AcroForm");
-    // if (acroForm.isDictionary()) { ... iterate fields ... }
-    // This is also complex and requires mapping QuantilyxDoc PdfFormField objects to QPDF handles.
-    // QList<PdfFormField*> modifiedFormFields = getModifiedFormFields(); // Hypothetical method
-    // for (PdfFormField* field : modifiedFormFields) { ... apply changes ... }
-
-    // --- Write the modified QPDF object to the target file ---
-    LOG_DEBUG("QPDF: Writing modified file to: " << targetPathStdString);
-    QPDFWriter writer(*qpdf, targetPathStdString.c_str());
-    // Configure writer if needed
-    // writer.set PreserveUnreferencedObjects(true);
-    // writer.setMinimumVersion("1.4"); // Or keep original?
-    try {
-        writer.write();
-    } catch (const std::exception& e) {
-        setLastError(tr("QPDF failed to write file '%1': %2").arg(targetPath).arg(e.what()));
+    // --- NEW LOGIC: Use QPDF for writing ---
+    const QString error = prepareCopy(targetPath)();
+    if (!error.isEmpty()) {
+        setLastError(error);
         LOG_ERROR(lastError());
         return false;
     }
@@ -518,6 +494,27 @@ Poppler::Document* PdfDocument::popplerDocument() const
     return d->popplerDoc;
 }
 
+QImage PdfDocument::renderPageWithoutAnnotations(int pageIndex, qreal resolution) const
+{
+    QMutexLocker locker(&d->displayMutex);
+    if (!d->displayDoc) {
+        if (filePath().isEmpty()) return QImage();
+        d->displayDoc.reset(Poppler::Document::load(filePath(), d->password));
+        if (!d->displayDoc || d->displayDoc->isLocked()) {
+            LOG_ERROR("Failed to open display copy of PDF: " << filePath());
+            d->displayDoc.reset();
+            return QImage();
+        }
+        // Annotations are left out (form fields stay): DocumentView composites
+        // them from AnnotationManager, so edits show without a re-render
+        d->displayDoc->setRenderHint(Poppler::Document::HideAnnotations, true);
+    }
+    if (pageIndex < 0 || pageIndex >= d->displayDoc->numPages()) return QImage();
+
+    std::unique_ptr<Poppler::Page> popplerPage(d->displayDoc->page(pageIndex));
+    return popplerPage ? popplerPage->renderToImage(resolution, resolution) : QImage();
+}
+
 QList<PdfFormField*> PdfDocument::formFields() const
 {
     QList<PdfFormField*> ptrList;
@@ -809,7 +806,7 @@ QVariantList PdfDocument::convertTocElementToVariantList(const QDomElement& elem
 // Helper to find the QPDF object handle corresponding to a PdfAnnotation within a QPDF page object.
 // This is the critical link. It requires PdfAnnotation to store identifying information from its original load.
 // For now, this is a stub demonstrating the concept.
-QPDFObjectHandle PdfDocument::findQpdfAnnotationHandle(const QPDFObjectHandle& pageObj, PdfAnnotation* pdfAnnot) const {
+QPDFObjectHandle PdfDocument::findQpdfAnnotationHandle(const QPDFObjectHandle& pageObj, const QRectF& targetBounds) {
     // This function needs the PdfAnnotation to have stored information that can uniquely identify
     // its corresponding object in the QPDF structure when the PDF was initially loaded *via QPDF*.
     // Since PdfAnnotation wraps Poppler::Annotation, this link isn't direct.
@@ -822,7 +819,6 @@ QPDFObjectHandle PdfDocument::findQpdfAnnotationHandle(const QPDFObjectHandle& p
     // Example:
     QPDFObjectHandle annotsArray = pageObj.getKey("/Annots");
     if (annotsArray.isArray()) {
-        QRectF targetBounds = pdfAnnot->bounds(); // This comes from Poppler::Annotation::boundary()
         // We would need to iterate and compare /Rect keys in the QPDF objects.
         for (size_t i = 0; i < annotsArray.getArrayNItems(); ++i) {
             QPDFObjectHandle annotObj = annotsArray.getArrayItem(i);
@@ -844,7 +840,7 @@ QPDFObjectHandle PdfDocument::findQpdfAnnotationHandle(const QPDFObjectHandle& p
 }
 
 // Helper to get contents from a QPDF annotation object handle (for comparison)
-QString PdfDocument::getQpdfAnnotationContents(const QPDFObjectHandle& annotObj) const {
+QString PdfDocument::getQpdfAnnotationContents(const QPDFObjectHandle& annotObj) {
     QPDFObjectHandle contentsObj = annotObj.getKey("/Contents");
     if (contentsObj.isString()) {
         // Handle both regular and unicode strings if necessary
@@ -858,7 +854,7 @@ QString PdfDocument::getQpdfAnnotationContents(const QPDFObjectHandle& annotObj)
 }
 
 // Helper to get color from a QPDF annotation object handle (for comparison)
-QColor PdfDocument::getQpdfAnnotationColor(const QPDFObjectHandle& annotObj) const {
+QColor PdfDocument::getQpdfAnnotationColor(const QPDFObjectHandle& annotObj) {
     QPDFObjectHandle colorObj = annotObj.getKey("/C"); // /C key holds color array [r, g, b]
     if (colorObj.isArray() && colorObj.getArrayNItems() == 3) {
         double r = colorObj.getArrayItem(0).getNumericValue();
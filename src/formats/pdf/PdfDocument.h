@@ -47,6 +47,7 @@ public:
     // --- Document Interface Implementation ---
     bool load(const QString& filePath, const QString& password = QString()) override;
     bool save(const QString& filePath = QString()) override;
+    std::function<QString()> prepareCopy(const QString& filePath) const override;
     DocumentType type() const override;
     int pageCount() const override;
     Page* page(int index) const override;
@@ -141,6 +142,18 @@ public:
      */
     Poppler::Document* popplerDocument() const;
 
+    /**
+     * @brief Render a page with its annotations left out, for on-screen display.
+     *
+     * Renders from a second Poppler document opened on first use, so the
+     * annotation render hint never reaches print, export or OCR renders.
+     * Safe to call from the render thread.
+     * @param pageIndex 0-based page index.
+     * @param resolution Resolution in DPI.
+     * @return Rendered image, or a null image on failure.
+     */
+    QImage renderPageWithoutAnnotations(int pageIndex, qreal resolution) const;
+
     /**
      * @brief Get the list of all form fields in the document.
      * @return List of form fields.
@@ -257,9 +270,10 @@ private:
 
     // Helper to create PdfPage objects
     std::unique_ptr<PdfPage> createPdfPage(int index) const;
-    QPDFObjectHandle findQpdfAnnotationHandle(const QPDFObjectHandle& pageObj, PdfAnnotation* pdfAnnot) const;
-    QString getQpdfAnnotationContents(const QPDFObjectHandle& annotObj) const;
-    QColor getQpdfAnnotationColor(const QPDFObjectHandle& annotObj) const;
+    // Stateless, so copies can be written off the document's thread
+    static QPDFObjectHandle findQpdfAnnotationHandle(const QPDFObjectHandle& pageObj, const QRectF& targetBounds);
+    static QString getQpdfAnnotationContents(const QPDFObjectHandle& annotObj);
+    static QColor getQpdfAnnotationColor(const QPDFObjectHandle& annotObj);
 
     // Add a method to mark internal state as modified (called by AnnotationManager or setters)
     void setInMemoryStateModifiedFlag(bool modified);
@@ -12,6 +12,7 @@
 #include "PdfAnnotation.h"
 #include "PdfFormField.h"
 #include "../../core/Logger.h"
+#include "../../core/BinaryLog.h"
 #include <poppler-qt5.h>
 #include <QImage>
 #include <QPainter>
@@ -27,7 +28,7 @@ namespace QuantilyxDoc {
 class PdfPage::Private {
 public:
     Private(PdfDocument* doc, Poppler::Page* pPage, int pIndex)
-        : document(doc), popplerPage(pPage), pdfPageIndex(pIndex) {}
+        : document(doc), popplerPage(pPage), pdfPageIndex(pIndex), annotationsLoaded(false), formFieldsLoaded(false) {}
 
     PdfDocument* document;
     Poppler::Page* popplerPage;
@@ -106,39 +107,61 @@ PdfPage::PdfPage(PdfDocument* document, Poppler::Page* popplerPage, int pageInde
 
 PdfPage::~PdfPage()
 {
+    detachTextLayer(); // text() reads d, which goes before the base destructor runs
     LOG_DEBUG("PdfPage for index " << d->pdfPageIndex << " destroyed.");
 }
 
 QImage PdfPage::render(int width, int height, int dpi)
 {
     if (!d->popplerPage) {
-        LOG_ERROR("Cannot render PdfPage " << d->pdfPageIndex << ": Poppler page is null.");
+        LOG_CERROR(lcRender, "Cannot render PdfPage " << d->pdfPageIndex << ": Poppler page is null.");
         return QImage(); // Return null image
     }
 
-    // Calculate scale factors based on target pixel size and page size in points
-    // Poppler's renderToImage takes a scale factor (e.g., 72 for 72 DPI).
-    // We need to derive the scale from the desired pixel dimensions.
-    QSizeF pageSizePoints = d->popplerPage->pageSizeF();
-    qreal scaleX = (width > 0) ? (width / pageSizePoints.width()) * (dpi / 72.0) : 1.0;
-    qreal scaleY = (height > 0) ? (height / pageSizePoints.height()) * (dpi / 72.0) : 1.0;
-    // Use the smaller scale to fit within the bounds, or average/max depending on fit strategy
-    qreal scale = qMin(scaleX, scaleY);
+    // Poppler renders at a resolution, not to a pixel size: pick the resolution
+    // at which the page fits width x height with its aspect ratio kept. Without
+    // a target size the page is rendered at dpi.
+    const QSizeF pageSizePoints = d->popplerPage->pageSizeF();
+    qreal resolution = dpi;
+    if (width > 0 && height > 0 && !pageSizePoints.isEmpty()) {
+        resolution = qMin(width * 72.0 / pageSizePoints.width(), height * 72.0 / pageSizePoints.height());
+    }
 
-    // Render using Poppler
-    QImage image = d->popplerPage->renderToImage(scale * 72.0 / dpi, 0, 0, width, height); // Pass calculated DPI-like scale
+    // Render the whole page (-1 region)
+    QImage image = d->popplerPage->renderToImage(resolution, resolution, -1, -1, -1, -1);
 
     if (image.isNull()) {
-        LOG_ERROR("Poppler failed to render page " << d->pdfPageIndex);
+        LOG_CERROR(lcRender, "Poppler failed to render page " << d->pdfPageIndex);
         // Poppler doesn't give detailed error codes easily here.
         // Could check if page size is valid, etc.
     } else {
-        LOG_DEBUG("Rendered PdfPage " << d->pdfPageIndex << " to image size " << image.size());
+        LOG_BTRACE("Rendered PdfPage {} to image size {}x{}", d->pdfPageIndex, image.width(), image.height());
     }
 
     return image;
 }
 
+QImage PdfPage::renderForDisplay(int width, int height, int dpi)
+{
+    if (!d->popplerPage || !d->document) {
+        LOG_CERROR(lcRender, "Cannot render PdfPage " << d->pdfPageIndex << " for display: Poppler page is null.");
+        return QImage();
+    }
+
+    // Same resolution choice as render()
+    const QSizeF pageSizePoints = d->popplerPage->pageSizeF();
+    qreal resolution = dpi;
+    if (width > 0 && height > 0 && !pageSizePoints.isEmpty()) {
+        resolution = qMin(width * 72.0 / pageSizePoints.width(), height * 72.0 / pageSizePoints.height());
+    }
+
+    QImage image = d->document->renderPageWithoutAnnotations(d->pdfPageIndex, resolution);
+    if (image.isNull()) {
+        LOG_CERROR(lcRender, "Poppler failed to render page " << d->pdfPageIndex << " for display");
+    }
+    return image;
+}
+
 QString PdfPage::text() const
 {
     if (!d->popplerPage) return QString();
@@ -309,6 +332,15 @@ QList<PdfAnnotation*> PdfPage::pdfAnnotations() const
     return ptrList;
 }
 
+QList<Annotation*> PdfPage::annotations() const
+{
+    QList<Annotation*> ptrList;
+    for (PdfAnnotation* annot : pdfAnnotations()) {
+        ptrList.append(annot);
+    }
+    return ptrList;
+}
+
 QList<PdfFormField*> PdfPage::pdfFormFields() const
 {
     QList<PdfFormField*> ptrList;
@@ -334,6 +366,7 @@ QList<QRectF> PdfPage::textLayout() const
             layout.append(textBox->boundingBox());
         }
     }
+    qDeleteAll(textBoxes); // textList() transfers ownership
     return layout;
 }
 
@@ -363,12 +396,27 @@ QImage PdfPage::renderRectangle(const QRectF& rect, int width, int height, int d
     QRect cropRect(offsetX, offsetY, scaledW, scaledH);
     if (cropRect.intersects(fullPageImage.rect())) {
         QImage croppedImage = fullPageImage.copy(cropRect);
-        LOG_DEBUG("Rendered rectangle " << rect << " from PdfPage " << d->pdfPageIndex << " to image size " << croppedImage.size());
+        LOG_BTRACE("Rendered rectangle {},{} {}x{} from PdfPage {} to image size {}x{}", rect.x(), rect.y(),
+                   rect.width(), rect.height(), d->pdfPageIndex, croppedImage.width(), croppedImage.height());
         return croppedImage;
     }
     return QImage(); // Return null if crop rect is outside the rendered page
 }
 
+QImage PdfPage::renderRegion(const QRectF& rect, int dpi) const
+{
+    if (!d->popplerPage || rect.isEmpty() || dpi <= 0) return QImage();
+
+    // Poppler takes the region in pixels of the full page at the given resolution
+    const QRect pixels = QRectF(rect.x() * dpi / 72.0, rect.y() * dpi / 72.0,
+                                rect.width() * dpi / 72.0, rect.height() * dpi / 72.0).toAlignedRect();
+    QImage image = d->popplerPage->renderToImage(dpi, dpi, pixels.x(), pixels.y(), pixels.width(), pixels.height());
+    if (image.isNull()) {
+        LOG_CERROR(lcRender, "Poppler failed to render region " << rect << " of page " << d->pdfPageIndex);
+    }
+    return image;
+}
+
 QList<QRectF> PdfPage::imageLocations() const
 {
     // Poppler::Page might have a function to get image locations, or this requires
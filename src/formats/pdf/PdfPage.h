@@ -48,11 +48,13 @@ public:
 
     // --- Page Interface Implementation ---
     QImage render(int width, int height, int dpi = 72) override;
+    QImage renderForDisplay(int width, int height, int dpi = 72) override;
     QString text() const override;
     QList<QRectF> searchText(const QString& text, bool caseSensitive = false, bool wholeWords = false) const override;
     QObject* hitTest(const QPointF& position) const override;
     QList<QObject*> links() const override;
     QVariantMap metadata() const override;
+    QList<Annotation*> annotations() const override; // The annotations stored in the file, owned by this page
 
     // --- PDF-Specific Page Properties ---
     /**
@@ -125,6 +127,16 @@ public:
      */
     QImage renderRectangle(const QRectF& rect, int width, int height, int dpi = 72) const;
 
+    /**
+     * @brief Render part of the page at a given resolution.
+     * Only the region is rasterized, so a few lines can be rendered at high
+     * resolution without the cost of the whole page.
+     * @param rect Region in page points (top-left origin).
+     * @param dpi Resolution.
+     * @return Image of the region, rect.size() * dpi / 72 pixels.
+     */
+    QImage renderRegion(const QRectF& rect, int dpi) const;
+
     /**
      * @brief Get the list of images on this page.
      * @return List of image rectangles and potentially metadata.
@@ -0,0 +1,436 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "PdfTextLayerWriter.h"
+#include "../../core/EditJournal.h"
+#include "../../core/Logger.h"
+#include <QFile>
+#include <QObject>
+#include <algorithm>
+#include <set>
+#include <qpdf/QPDF.hh>
+#include <qpdf/QPDFObjectHandle.hh>
+#include <qpdf/QPDFPageObjectHelper.hh>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace QuantilyxDoc {
+
+namespace {
+
+const char* const FontResource = "/QxOcr"; // Marks pages that carry our layer
+
+// Serialized indirect object of the update
+struct UpdateObject {
+    int id;
+    int generation;
+    QByteArray body; // Everything between "obj" and "endobj"
+};
+
+QByteArray num(qreal value)
+{
+    QByteArray text = QByteArray::number(value, 'f', 3);
+    // Trim "1.500" to "1.5" and "2.000" to "2"
+    while (text.endsWith('0')) text.chop(1);
+    if (text.endsWith('.')) text.chop(1);
+    return text == "-0" ? QByteArray("0") : text;
+}
+
+QByteArray ref(int id, int generation = 0)
+{
+    return QByteArray::number(id) + ' ' + QByteArray::number(generation) + " R";
+}
+
+QByteArray unparse(const QPDFObjectHandle& object)
+{
+    return QByteArray::fromStdString(object.unparse());
+}
+
+QByteArray streamBody(const QByteArray& data)
+{
+    // qCompress output is a 4-byte length followed by a zlib stream, which is FlateDecode
+    const QByteArray deflated = qCompress(data, 6).mid(4);
+    return "<< /Length " + QByteArray::number(deflated.size()) + " /Filter /FlateDecode >>\nstream\n"
+           + deflated + "\nendstream";
+}
+
+QByteArray toUnicodeCMap()
+{
+    QByteArray cmap =
+        "/CIDInit /ProcSet findresource begin\n"
+        "12 dict begin\n"
+        "begincmap\n"
+        "/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n"
+        "/CMapName /Adobe-Identity-UCS def\n"
+        "/CMapType 2 def\n"
+        "1 begincodespacerange\n<0000> <FFFF>\nendcodespacerange\n";
+    // Codes are UTF-16 code units; a bfrange may not cross a high-byte boundary
+    for (int block = 0; block < 256; block += 64) {
+        cmap += "64 beginbfrange\n";
+        for (int high = block; high < block + 64; ++high) {
+            const QByteArray hex = QByteArray::number(high, 16).rightJustified(2, '0').toUpper();
+            cmap += '<' + hex + "00> <" + hex + "FF> <" + hex + "00>\n";
+        }
+        cmap += "endbfrange\n";
+    }
+    cmap += "endcmap\nCMapName currentdict /CMap defineresource pop\nend\nend\n";
+    return cmap;
+}
+
+QPDFObjectHandle pageResources(QPDFObjectHandle page)
+{
+    // Resources may be inherited from the page tree
+    return QPDFPageObjectHelper(page).getAttribute("/Resources", false);
+}
+
+bool hasTextLayer(QPDFObjectHandle page)
+{
+    QPDFObjectHandle resources = pageResources(page);
+    if (!resources.isDictionary()) return false;
+    QPDFObjectHandle fonts = resources.getKey("/Font");
+    return fonts.isDictionary() && fonts.hasKey(FontResource);
+}
+
+// Runs of consecutive ids, as (index of first object, count); objects sorted by id
+QList<QPair<int, int>> idRuns(const QList<UpdateObject>& objects)
+{
+    QList<QPair<int, int>> runs;
+    for (int start = 0; start < objects.size();) {
+        int end = start + 1;
+        while (end < objects.size() && objects.at(end).id == objects.at(end - 1).id + 1) ++end;
+        runs.append(qMakePair(start, end - start));
+        start = end;
+    }
+    return runs;
+}
+
+QByteArray bigEndian(qint64 value, int bytes)
+{
+    QByteArray data(bytes, '\0');
+    for (int i = bytes - 1; i >= 0; --i, value >>= 8) {
+        data[i] = char(value & 0xff);
+    }
+    return data;
+}
+
+bool syncFile(QFile& file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_UNIX
+    return ::fdatasync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+// Dictionary entries except the given keys, serialized
+QByteArray dictionaryEntries(QPDFObjectHandle dict, const std::set<std::string>& skip)
+{
+    QByteArray entries;
+    if (!dict.isDictionary()) return entries;
+    for (const std::string& key : dict.getKeys()) {
+        if (skip.count(key)) continue;
+        entries += unparse(QPDFObjectHandle::newName(key)) + ' ' + unparse(dict.getKey(key)) + '\n';
+    }
+    return entries;
+}
+
+} // namespace
+
+class PdfTextLayerWriter::Private {
+public:
+    Private(const QString& path) : filePath(path) {}
+
+    QString filePath;
+    QString error;
+
+    // Offset of the last xref section, from the file trailer
+    static qint64 previousXref(QFile& file) {
+        const qint64 tailSize = qMin<qint64>(file.size(), 2048);
+        file.seek(file.size() - tailSize);
+        const QByteArray tail = file.read(tailSize);
+        const int pos = tail.lastIndexOf("startxref");
+        if (pos < 0) return -1;
+        bool ok = false;
+        const qint64 offset = tail.mid(pos + 9).trimmed().split('\n').first().trimmed().toLongLong(&ok);
+        return ok ? offset : -1;
+    }
+
+    // The displayed page box in user space, normalized
+    static QRectF displayBox(QPDFObjectHandle page) {
+        QPDFPageObjectHelper helper(page);
+        QPDFObjectHandle box = helper.getAttribute("/CropBox", false);
+        if (!box.isRectangle()) box = helper.getAttribute("/MediaBox", false);
+        if (!box.isRectangle()) return QRectF(0, 0, 612, 792);
+        const QPDFObjectHandle::Rectangle r = box.getArrayAsRectangle();
+        return QRectF(QPointF(qMin(r.llx, r.urx), qMin(r.lly, r.ury)), QPointF(qMax(r.llx, r.urx), qMax(r.lly, r.ury)));
+    }
+
+    static int rotation(QPDFObjectHandle page) {
+        QPDFObjectHandle rotate = QPDFPageObjectHelper(page).getAttribute("/Rotate", false);
+        const int degrees = rotate.isInteger() ? int(rotate.getIntValue()) : 0;
+        return ((degrees % 360) + 360) % 360 / 90 * 90;
+    }
+
+    // Content that draws the words invisibly. Boxes are in displayed-page
+    // points (top-left origin); each word gets a text matrix mapping it into
+    // user space for the page rotation and box.
+    static QByteArray textContent(const PageWords& words, const QRectF& box, int rotate) {
+        // Display x direction and display "up" direction in user space
+        qreal dx[2], up[2];
+        switch (rotate) {
+        case 90:  dx[0] = 0;  dx[1] = 1;  up[0] = -1; up[1] = 0;  break;
+        case 180: dx[0] = -1; dx[1] = 0;  up[0] = 0;  up[1] = -1; break;
+        case 270: dx[0] = 0;  dx[1] = -1; up[0] = 1;  up[1] = 0;  break;
+        default:  dx[0] = 1;  dx[1] = 0;  up[0] = 0;  up[1] = 1;  break;
+        }
+        // QRectF::top() is the smaller y, i.e. lly in user space
+        auto toUser = [&](qreal x, qreal y) -> QPointF {
+            switch (rotate) {
+            case 90:  return QPointF(box.left() + y, box.top() + x);
+            case 180: return QPointF(box.right() - x, box.top() + y);
+            case 270: return QPointF(box.right() - y, box.bottom() - x);
+            default:  return QPointF(box.left() + x, box.bottom() - y);
+            }
+        };
+
+        QByteArray content = "Q\nBT\n3 Tr\n";
+        for (const auto& word : words) {
+            const QString text = word.first.trimmed();
+            const QRectF& r = word.second;
+            if (text.isEmpty() || r.width() <= 0 || r.height() <= 0) continue;
+
+            // Glyphs are 500 units wide and sit on the baseline, so the font
+            // size is the box height and Tz stretches the run to the box width
+            const qreal size = r.height();
+            const qreal scale = 100.0 * r.width() / (text.size() * 0.5 * size);
+            const QPointF origin = toUser(r.left(), r.bottom());
+            content += QByteArray(FontResource) + ' ' + num(size) + " Tf " + num(scale) + " Tz "
+                       + num(dx[0]) + ' ' + num(dx[1]) + ' ' + num(up[0]) + ' ' + num(up[1]) + ' '
+                       + num(origin.x()) + ' ' + num(origin.y()) + " Tm <";
+            for (QChar c : text) {
+                content += QByteArray::number(c.unicode(), 16).rightJustified(4, '0').toUpper();
+            }
+            content += "> Tj\n";
+        }
+        content += "ET\n";
+        return content;
+    }
+};
+
+PdfTextLayerWriter::PdfTextLayerWriter(const QString& filePath)
+    : d(new Private(filePath))
+{
+}
+
+PdfTextLayerWriter::~PdfTextLayerWriter() = default;
+
+QSet<int> PdfTextLayerWriter::pagesWithTextLayer() const
+{
+    QSet<int> pages;
+    try {
+        QPDF qpdf;
+        qpdf.processFile(d->filePath.toLocal8Bit().constData());
+        const std::vector<QPDFObjectHandle> allPages = qpdf.getAllPages();
+        for (size_t i = 0; i < allPages.size(); ++i) {
+            if (hasTextLayer(allPages[i])) pages.insert(int(i));
+        }
+    } catch (const std::exception& e) {
+        d->error = QObject::tr("Failed to read '%1': %2").arg(d->filePath, e.what());
+        LOG_ERROR("PdfTextLayerWriter: " << d->error);
+    }
+    return pages;
+}
+
+bool PdfTextLayerWriter::append(const QMap<int, PageWords>& pages)
+{
+    if (pages.isEmpty()) return true;
+
+    QList<UpdateObject> objects;
+    QByteArray trailerEntries;
+    bool xrefStream = false;
+    int size = 0;
+    try {
+        QPDF qpdf;
+        qpdf.processFile(d->filePath.toLocal8Bit().constData());
+        if (qpdf.isEncrypted()) {
+            d->error = QObject::tr("Encrypted PDFs cannot be updated in place.");
+            return false;
+        }
+        const std::vector<QPDFObjectHandle> allPages = qpdf.getAllPages();
+        QPDFObjectHandle trailer = qpdf.getTrailer();
+        size = int(trailer.getKey("/Size").getIntValue());
+        // The update's cross-reference section has the same form as the last
+        // one: a reader that only knows streams may not accept a classic
+        // section after them. Keys the section writes itself are replaced.
+        QPDFObjectHandle type = trailer.getKey("/Type");
+        xrefStream = type.isName() && type.getName() == "/XRef";
+        trailerEntries = xrefStream
+            ? dictionaryEntries(trailer, {"/Size", "/Prev", "/Type", "/W", "/Index", "/Length", "/Filter", "/DecodeParms"})
+            : dictionaryEntries(trailer, {"/Size", "/Prev", "/XRefStm"});
+
+        // Objects shared by all pages of this update
+        const int fontId = size++;
+        const int cidFontId = size++;
+        const int descriptorId = size++;
+        const int cmapId = size++;
+        const int saveId = size++;
+        objects.append({fontId, 0, "<< /Type /Font /Subtype /Type0 /BaseFont /GlyphLessFont /Encoding /Identity-H"
+                                   " /DescendantFonts [" + ref(cidFontId) + "] /ToUnicode " + ref(cmapId) + " >>"});
+        objects.append({cidFontId, 0, "<< /Type /Font /Subtype /CIDFontType2 /BaseFont /GlyphLessFont"
+                                      " /CIDSystemInfo << /Registry (Adobe) /Ordering (Identity) /Supplement 0 >>"
+                                      " /FontDescriptor " + ref(descriptorId) + " /DW 500 /CIDToGIDMap /Identity >>"});
+        objects.append({descriptorId, 0, "<< /Type /FontDescriptor /FontName /GlyphLessFont /Flags 5"
+                                         " /FontBBox [0 0 500 1000] /ItalicAngle 0 /Ascent 1000 /Descent 0"
+                                         " /CapHeight 1000 /StemV 80 >>"});
+        objects.append({cmapId, 0, streamBody(toUnicodeCMap())});
+        // Page content runs between q and Q so its graphics state cannot move the text
+        objects.append({saveId, 0, streamBody("q\n")});
+
+        int written = 0;
+        for (auto it = pages.constBegin(); it != pages.constEnd(); ++it) {
+            if (it.key() < 0 || it.key() >= int(allPages.size())) {
+                LOG_WARN("PdfTextLayerWriter: Skipping invalid page index " << it.key());
+                continue;
+            }
+            QPDFObjectHandle page = allPages[it.key()];
+            if (hasTextLayer(page)) {
+                LOG_DEBUG("PdfTextLayerWriter: Page " << it.key() << " already has a text layer.");
+                continue;
+            }
+
+            const int textId = size++;
+            objects.append({textId, 0, streamBody(Private::textContent(it.value(), Private::displayBox(page),
+                                                                      Private::rotation(page)))});
+
+            QByteArray contents = "[" + ref(saveId);
+            QPDFObjectHandle oldContents = page.getKey("/Contents");
+            if (oldContents.isArray()) {
+                for (int i = 0; i < oldContents.getArrayNItems(); ++i) {
+                    contents += ' ' + unparse(oldContents.getArrayItem(i));
+                }
+            } else if (oldContents.isIndirect()) {
+                contents += ' ' + unparse(oldContents);
+            }
+            contents += ' ' + ref(textId) + ']';
+
+            // Rewrite the resources as a direct dictionary on the page so a
+            // shared or inherited one is left untouched
+            QPDFObjectHandle resources = pageResources(page);
+            const QByteArray fonts = "<< " + dictionaryEntries(resources.isDictionary() ? resources.getKey("/Font")
+                                                                                         : QPDFObjectHandle::newNull(), {})
+                                     + FontResource + ' ' + ref(fontId) + " >>";
+            const QByteArray resourceDict = "<< " + dictionaryEntries(resources, {"/Font"}) + "/Font " + fonts + " >>";
+
+            objects.append({page.getObjectID(), page.getGeneration(),
+                            "<< " + dictionaryEntries(page, {"/Contents", "/Resources"}) + "/Contents " + contents
+                            + "\n/Resources " + resourceDict + " >>"});
+            ++written;
+        }
+        if (written == 0) return true;
+    } catch (const std::exception& e) {
+        d->error = QObject::tr("Failed to read '%1': %2").arg(d->filePath, e.what());
+        LOG_ERROR("PdfTextLayerWriter: " << d->error);
+        return false;
+    }
+
+    // The QPDF instance is closed; append the update
+    qint64 previousSize = 0;
+    qint64 previousMtimeMs = 0;
+    EditJournal::fingerprint(d->filePath, previousSize, previousMtimeMs);
+    QFile file(d->filePath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        d->error = QObject::tr("Cannot open '%1' for writing: %2").arg(d->filePath, file.errorString());
+        return false;
+    }
+    const qint64 prev = Private::previousXref(file);
+    if (prev < 0) {
+        d->error = QObject::tr("'%1' has no readable startxref.").arg(d->filePath);
+        return false;
+    }
+    file.seek(file.size() - 1);
+    const bool needsNewline = file.read(1) != "\n";
+
+    const qint64 base = file.size();
+    QByteArray update = needsNewline ? QByteArray("\n") : QByteArray();
+    std::sort(objects.begin(), objects.end(), [](const UpdateObject& a, const UpdateObject& b) { return a.id < b.id; });
+    QList<qint64> offsets;
+    for (const UpdateObject& object : objects) {
+        offsets.append(base + update.size());
+        update += QByteArray::number(object.id) + ' ' + QByteArray::number(object.generation) + " obj\n"
+                  + object.body + "\nendobj\n";
+    }
+
+    const qint64 xrefOffset = base + update.size();
+    if (xrefStream) {
+        // Cross-reference stream, listing itself too; one /Index pair per run
+        const int xrefId = qMax(size, objects.last().id + 1);
+        objects.append({xrefId, 0, QByteArray()});
+        offsets.append(xrefOffset);
+        size = xrefId + 1;
+        int offsetBytes = 1;
+        while (offsetBytes < 8 && (xrefOffset >> (8 * offsetBytes)) != 0) ++offsetBytes;
+
+        QByteArray index;
+        QByteArray rows;
+        for (const QPair<int, int>& run : idRuns(objects)) {
+            index += QByteArray::number(objects.at(run.first).id) + ' ' + QByteArray::number(run.second) + ' ';
+            for (int i = run.first; i < run.first + run.second; ++i) {
+                rows += char(1) + bigEndian(offsets.at(i), offsetBytes) + bigEndian(objects.at(i).generation, 2);
+            }
+        }
+        index.chop(1);
+        const QByteArray deflated = qCompress(rows, 6).mid(4);
+        update += QByteArray::number(xrefId) + " 0 obj\n<< /Type /XRef /Size " + QByteArray::number(size)
+                  + " /W [1 " + QByteArray::number(offsetBytes) + " 2] /Index [" + index + "] /Prev "
+                  + QByteArray::number(prev) + '\n' + trailerEntries + "/Length " + QByteArray::number(deflated.size())
+                  + " /Filter /FlateDecode >>\nstream\n" + deflated + "\nendstream\nendobj\n";
+    } else {
+        // Classic xref section with one subsection per run of consecutive ids
+        update += "xref\n";
+        for (const QPair<int, int>& run : idRuns(objects)) {
+            update += QByteArray::number(objects.at(run.first).id) + ' ' + QByteArray::number(run.second) + '\n';
+            for (int i = run.first; i < run.first + run.second; ++i) {
+                update += QByteArray::number(offsets.at(i)).rightJustified(10, '0') + ' '
+                          + QByteArray::number(objects.at(i).generation).rightJustified(5, '0') + " n\r\n";
+            }
+        }
+        size = qMax(size, objects.last().id + 1);
+        update += "trailer\n<< /Size " + QByteArray::number(size) + " /Prev " + QByteArray::number(prev) + '\n'
+                  + trailerEntries + ">>\n";
+    }
+    update += "startxref\n" + QByteArray::number(xrefOffset) + "\n%%EOF\n";
+
+    // Durable before success is reported: the caller then treats the pages as done
+    file.seek(base);
+    if (file.write(update) != update.size() || !syncFile(file)) {
+        // Cut off a partial update so the file stays valid
+        file.resize(base);
+        d->error = QObject::tr("Failed to write '%1': %2").arg(d->filePath, file.errorString());
+        return false;
+    }
+    file.close();
+    LOG_DEBUG("PdfTextLayerWriter: Appended " << update.size() << " bytes to " << d->filePath);
+
+    // Unsaved edits journaled against the previous version still apply
+    if (!EditJournal::rebase(d->filePath, previousSize, previousMtimeMs)) {
+        LOG_WARN("PdfTextLayerWriter: Could not re-key the edit journal of " << d->filePath
+                 << "; unsaved edits will not be recovered after a crash");
+    }
+    return true;
+}
+
+QString PdfTextLayerWriter::lastError() const
+{
+    return d->error;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,86 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_PDFTEXTLAYERWRITER_H
+#define QUANTILYX_PDFTEXTLAYERWRITER_H
+
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QRectF>
+#include <QSet>
+#include <QString>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Adds invisible OCR text layers to a PDF file in place.
+ *
+ * Each call to append() writes one incremental update at the end of the
+ * file: new content streams that draw the words in text render mode 3
+ * (neither filled nor stroked), the modified page dictionaries, and a
+ * cross-reference section chained to the previous one with /Prev (a stream
+ * if the last one is a stream, a classic table otherwise). The original
+ * bytes are never rewritten, so appending a few pages to a large scan costs
+ * only the size of their text, and an interrupted run leaves every earlier
+ * update intact. The update is synced to disk before append() returns, and
+ * the document's edit journal is re-keyed to the updated file.
+ *
+ * The text uses a Type0 font with Identity-H encoding whose character codes
+ * are UTF-16 code units, plus an identity ToUnicode map, so any script can
+ * be selected and searched. Pages that carry the layer are recognized by the
+ * font resource name, which lets a batch run skip them when it resumes.
+ *
+ * QPDF is used to read the file structure; objects are serialized here
+ * because QPDFWriter always rewrites the whole file.
+ */
+class PdfTextLayerWriter
+{
+public:
+    /// Words of one page: text and box in page points, origin top-left of the displayed page
+    using PageWords = QList<QPair<QString, QRectF>>;
+
+    /**
+     * @brief Constructor.
+     * @param filePath PDF file to update.
+     */
+    explicit PdfTextLayerWriter(const QString& filePath);
+
+    /**
+     * @brief Destructor.
+     */
+    ~PdfTextLayerWriter();
+
+    /**
+     * @brief Get the pages that already carry a text layer written by this class.
+     * @return 0-based page indices; empty if the file cannot be read.
+     */
+    QSet<int> pagesWithTextLayer() const;
+
+    /**
+     * @brief Append an incremental update with the text layers of some pages.
+     * @param pages Words by 0-based page index.
+     * @return True if the update was written.
+     */
+    bool append(const QMap<int, PageWords>& pages);
+
+    /**
+     * @brief Get the error of the last failed call.
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_PDFTEXTLAYERWRITER_H
@@ -88,6 +88,7 @@ PsPage::PsPage(PsDocument* document, int pageIndex, QObject* parent)
 
 PsPage::~PsPage()
 {
+    detachTextLayer();
     LOG_DEBUG("PsPage for index " << d->pageIndexVal << " destroyed.");
 }
 
@@ -10,11 +10,11 @@
 #include "XpsDocument.h"
 #include "XpsPage.h"
 #include "../../core/Logger.h"
+#include "../../core/ZipArchive.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QXmlStreamReader>
-#include <QZipReader> // Requires Qt5::Gui or Qt5::Core (Qt 5.12+)
 #include <QDebug>
 
 namespace QuantilyxDoc {
@@ -31,7 +31,7 @@ public:
     QList<QString> keywords;
     bool hasSignatureVal = false;
     QList<std::unique_ptr<XpsPage>> pages;
-    QZipReader zipReader; // Qt's built-in ZIP reader
+    ZipArchive zipReader;
 
     // Helper to parse the FixedDocumentSequence.fdseq file to get document structure and page count
     bool parseFixedDocSequence() {
@@ -133,10 +133,9 @@ bool XpsDocument::load(const QString& filePath, const QString& password)
     d->isLoaded = false;
     d->pages.clear();
 
-    // Open XPS as ZIP archive using Qt's QZipReader
-    d->zipReader.setFileName(filePath);
-    if (!d->zipReader.exists() || !d->zipReader.isOpen()) {
-        setLastError(tr("Failed to open XPS file as ZIP archive."));
+    // Open XPS as ZIP archive
+    if (!d->zipReader.open(filePath)) {
+        setLastError(tr("Failed to open XPS file as ZIP archive: %1").arg(d->zipReader.lastError()));
         LOG_ERROR(lastError());
         return false;
     }
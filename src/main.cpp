@@ -11,6 +11,7 @@
 #include "ui/MainWindow.h"
 #include "core/Application.h"
 #include "core/Logger.h"
+#include "core/BinaryLog.h"
 #include "core/ConfigManager.h"
 #include "core/Settings.h"
 #include "core/RecentFiles.h"
@@ -65,6 +66,14 @@ int main(int argc, char *argv[])
                                             "Disable all plugins for this session.");
     QCommandLineOption verboseOption(QStringList() << "verbose",
                                      "Enable verbose logging.");
+    QCommandLineOption logCategoriesOption(QStringList() << "log-categories",
+                                           "Per-category log levels, e.g. render=trace,cache=warning.",
+                                           "rules");
+    QCommandLineOption binaryLogOption(QStringList() << "binary-log",
+                                       "Also record structured binary log events (<logfile>.qlb).");
+    QCommandLineOption binaryLogLevelOption(QStringList() << "binary-log-level",
+                                            "Lowest level recorded in the binary log (default trace).",
+                                            "level", "trace");
     QCommandLineOption configPathOption(QStringList() << "config",
                                         "Specify a custom configuration file path.",
                                         "config_path");
@@ -74,6 +83,9 @@ int main(int argc, char *argv[])
     parser.addOption(profileArgument);
     parser.addOption(disablePluginsOption);
     parser.addOption(verboseOption);
+    parser.addOption(logCategoriesOption);
+    parser.addOption(binaryLogOption);
+    parser.addOption(binaryLogLevelOption);
     parser.addOption(configPathOption);
 
     parser.process(app);
@@ -85,6 +97,7 @@ int main(int argc, char *argv[])
     QString startupProfile = parser.value(profileArgument);
     bool disablePlugins = parser.isSet(disablePluginsOption);
     bool verboseLogging = parser.isSet(verboseOption);
+    QString logCategoryRules = parser.value(logCategoriesOption);
     QString customConfigPath = parser.value(configPathOption);
 
     // --- Application Initialization Sequence ---
@@ -105,7 +118,21 @@ int main(int argc, char *argv[])
     } else {
         LOG_INFO("Logger initialized successfully.");
         if (verboseLogging) {
-             QuantilyxDoc::Logger::instance().setLogLevel(QuantilyxDoc::Logger::Debug); // Increase verbosity if requested
+             QuantilyxDoc::Logger::instance().setLogLevel(QuantilyxDoc::LogLevel::Debug); // Increase verbosity if requested
+        }
+        if (!logCategoryRules.isEmpty()) {
+            QuantilyxDoc::Logger::instance().setCategoryRules(logCategoryRules);
+        }
+        if (parser.isSet(binaryLogOption)) {
+            bool levelOk = false;
+            const QuantilyxDoc::LogLevel binaryLevel =
+                QuantilyxDoc::Logger::levelFromString(parser.value(binaryLogLevelOption), &levelOk);
+            if (levelOk) {
+                QuantilyxDoc::BinaryLog::instance().setLevel(binaryLevel);
+            } else {
+                LOG_WARN("Unknown binary log level: " << parser.value(binaryLogLevelOption));
+            }
+            QuantilyxDoc::Logger::instance().setBinaryOutput(true);
         }
     }
 
@@ -269,7 +296,7 @@ int main(int argc, char *argv[])
     qint64 initTimeMs = initTimer.elapsed();
     if (!initSuccess) {
         // Critical failure during initialization
-        QuantilyxDoc::LOG_CRITICAL("Application initialization failed after " << initTimeMs << " ms: " << initError);
+        LOG_CRITICAL("Application initialization failed after " << initTimeMs << " ms: " << initError);
         QMessageBox::critical(nullptr, QObject::tr("Initialization Error"), initError);
         return -1; // Exit with error code
     }
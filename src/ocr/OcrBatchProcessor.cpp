@@ -0,0 +1,423 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "OcrBatchProcessor.h"
+#include "OcrEngine.h"
+#include "OcrLayoutAnalyzer.h"
+#include "OcrPage.h"
+#include "../core/Document.h"
+#include "../core/Logger.h"
+#include "../core/Page.h"
+#include "../core/ThreadPool.h"
+#include "../formats/pdf/PdfPage.h"
+#include "../formats/pdf/PdfTextLayerWriter.h"
+#include "../search/FullTextIndex.h"
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr int AnalysisDpi = 100;        // Layout analysis render; OCR uses the engine resolution
+constexpr qreal MinTextCoverage = 0.5;  // Blocks the text layer covers at least this much are skipped
+
+} // namespace
+
+class OcrBatchProcessor::Private {
+public:
+    Private(OcrBatchProcessor* q_ptr)
+        : q(q_ptr), running(false), paused(false), cancelled(false), failed(false)
+        , inFlight(0), workers(0), done(0), total(0), skipped(0), failedPages(0), skipExisting(true)
+        , maxConcurrent(qMax(1, QThread::idealThreadCount() - 1)), flushPages(8) {}
+
+    OcrBatchProcessor* q;
+    mutable QMutex mutex; // Protects the run state below
+    QWaitCondition idle;  // Signalled when the last worker returns
+    QPointer<Document> document;
+    QString filePath;
+    bool running;
+    bool paused;
+    bool cancelled;
+    bool failed;
+    QList<int> queue;     // Pages not yet scheduled
+    QHash<int, Page*> pages; // Looked up on the starting thread; workers only read them
+    int inFlight;         // Pages being recognized
+    int workers;          // Tasks that may still touch this object
+    int done;
+    int total;
+    int skipped;
+    int failedPages;
+    bool skipExisting;
+    int maxConcurrent;
+    int flushPages;
+    QMap<int, PdfTextLayerWriter::PageWords> pendingWords; // Finished, not yet written
+
+    QMutex writeMutex; // One incremental update at a time
+    std::unique_ptr<PdfTextLayerWriter> writer; // Null for non-PDF documents
+
+    // What a page needs: nothing, a full-page OCR, or OCR of some blocks
+    struct PagePlan {
+        bool skip = false;
+        bool fullPage = true;
+        QList<QRectF> regions; // Page points
+    };
+
+    static PagePlan planPage(Page* page) {
+        PagePlan plan;
+        const QSizeF size = page->size();
+        const QImage image = page->render(qRound(size.width() * AnalysisDpi / 72.0),
+                                          qRound(size.height() * AnalysisDpi / 72.0), AnalysisDpi);
+        if (image.isNull()) return plan;
+
+        const QList<OcrTextBlock> blocks = OcrLayoutAnalyzer::textBlocks(image, AnalysisDpi);
+        if (blocks.isEmpty()) {
+            plan.skip = true; // Blank or pictures only
+            return plan;
+        }
+
+        // Existing text layer, mapped from points to analysis pixels
+        auto* pdfPage = qobject_cast<PdfPage*>(page);
+        const QList<QRectF> layout = pdfPage ? pdfPage->textLayout() : QList<QRectF>();
+        if (layout.isEmpty()) return plan; // A scan: recognize the whole page
+        const qreal toPixels = AnalysisDpi / 72.0;
+        QList<QRectF> textBoxes;
+        textBoxes.reserve(layout.size());
+        for (const QRectF& box : layout) {
+            textBoxes.append(QRectF(box.x() * toPixels, box.y() * toPixels, box.width() * toPixels, box.height() * toPixels));
+        }
+
+        plan.fullPage = false;
+        for (const OcrTextBlock& block : blocks) {
+            if (OcrLayoutAnalyzer::coverage(block, textBoxes) < MinTextCoverage) {
+                const QRectF& r = block.box;
+                plan.regions.append(QRectF(r.x() / toPixels, r.y() / toPixels, r.width() / toPixels, r.height() / toPixels));
+            }
+        }
+        plan.skip = plan.regions.isEmpty();
+        return plan;
+    }
+
+    // Submit pages until the concurrency limit is reached
+    void scheduleMore() {
+        QMutexLocker locker(&mutex);
+        while (running && !paused && !cancelled && inFlight < maxConcurrent && !queue.isEmpty()) {
+            const int pageIndex = queue.takeFirst();
+            ++inFlight;
+            ++workers;
+            ThreadPool::instance().submitTask([this, pageIndex]() {
+                processPage(pageIndex);
+                QMutexLocker locker(&mutex);
+                if (--workers == 0) idle.wakeAll();
+            }, QStringLiteral("Batch OCR page"), Task::Priority::Low);
+        }
+    }
+
+    void processPage(int pageIndex) {
+        // Pages are read here under Page's threading rule: the document
+        // outlives the run, and the text goes through the page's text layer
+        Document* doc;
+        Page* page;
+        bool analyze;
+        {
+            QMutexLocker locker(&mutex);
+            doc = document.data();
+            page = doc ? pages.value(pageIndex) : nullptr;
+            analyze = skipExisting;
+        }
+        OcrPage ocrPage(doc, page);
+        PagePlan plan;
+        if (page && analyze) {
+            plan = planPage(page);
+        }
+
+        bool ok = page != nullptr;
+        if (ok && !plan.skip) {
+            ok = plan.fullPage ? ocrPage.performOcr() : ocrPage.performRegionOcr(plan.regions);
+        }
+        const PdfTextLayerWriter::PageWords words = ocrPage.textElements();
+        QString text = ocrPage.fullText();
+        if (ok && !plan.fullPage) {
+            // Index the born-digital text together with what OCR added
+            const QString existing = page->textLayer()->text().trimmed();
+            text = text.isEmpty() ? existing : existing + "\n\n" + text;
+        }
+
+        if (ok) {
+            // The index's database connection belongs to its own thread
+            const QString path = filePath;
+            FullTextIndex* index = &FullTextIndex::instance();
+            QMetaObject::invokeMethod(index, [index, path, pageIndex, text]() {
+                index->addPage(path, pageIndex, text);
+            }, Qt::QueuedConnection);
+        } else {
+            LOG_WARN("OcrBatchProcessor: OCR failed for page " << pageIndex);
+            emit q->error(QObject::tr("OCR failed for page %1.").arg(pageIndex + 1));
+        }
+
+        int doneNow, totalNow;
+        bool flushNow;
+        {
+            QMutexLocker locker(&mutex);
+            --inFlight;
+            ++done;
+            if (ok && plan.skip) ++skipped;
+            if (!ok) ++failedPages;
+            doneNow = done;
+            totalNow = total;
+            if (ok && writer && !words.isEmpty()) {
+                pendingWords.insert(pageIndex, words);
+            }
+            // Write a full batch, or whatever is left once nothing is in flight
+            const bool drained = inFlight == 0 && (queue.isEmpty() || paused || cancelled);
+            flushNow = pendingWords.size() >= flushPages || (drained && !pendingWords.isEmpty());
+        }
+
+        emit q->pageFinished(pageIndex);
+        emit q->progress(doneNow, totalNow);
+
+        if (flushNow) {
+            flush();
+        }
+        finishOrContinue();
+    }
+
+    void flush() {
+        QMutexLocker writeLocker(&writeMutex);
+        QMap<int, PdfTextLayerWriter::PageWords> batch;
+        {
+            QMutexLocker locker(&mutex);
+            batch.swap(pendingWords);
+        }
+        if (batch.isEmpty() || !writer) return;
+
+        if (!writer->append(batch)) {
+            LOG_ERROR("OcrBatchProcessor: Failed to write text layer: " << writer->lastError());
+            {
+                QMutexLocker locker(&mutex);
+                failed = true;
+                cancelled = true; // Later updates would fail the same way
+                queue.clear();
+            }
+            emit q->error(writer->lastError());
+            return;
+        }
+        LOG_DEBUG("OcrBatchProcessor: Wrote text layer for " << batch.size() << " pages.");
+    }
+
+    void finishOrContinue() {
+        bool finishedRun = false;
+        bool success = false;
+        {
+            QMutexLocker locker(&mutex);
+            if (inFlight == 0 && running && (queue.isEmpty() || cancelled)) {
+                running = false;
+                paused = false;
+                finishedRun = true;
+                success = !failed && !cancelled;
+            }
+        }
+        if (finishedRun) {
+            LOG_INFO("OcrBatchProcessor: Finished " << filePath << (success ? "" : " (incomplete)")
+                     << ", " << skipped << " of " << total << " pages needed no OCR.");
+            emit q->finished(success);
+        } else {
+            scheduleMore();
+        }
+    }
+};
+
+OcrBatchProcessor::OcrBatchProcessor(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+}
+
+OcrBatchProcessor::~OcrBatchProcessor()
+{
+    cancel();
+    QMutexLocker locker(&d->mutex);
+    while (d->workers > 0) {
+        d->idle.wait(&d->mutex);
+    }
+}
+
+bool OcrBatchProcessor::start(Document* document)
+{
+    if (!document) return false;
+    if (isRunning()) {
+        LOG_WARN("OcrBatchProcessor::start: A run is already in progress.");
+        return false;
+    }
+    if (!OcrEngine::instance().isReady()) {
+        LOG_ERROR("OcrBatchProcessor::start: OcrEngine is not ready.");
+        emit error(tr("OCR Engine not initialized."));
+        return false;
+    }
+
+    const QString path = document->filePath();
+    std::unique_ptr<PdfTextLayerWriter> writer;
+    QSet<int> skip;
+    if (document->type() == DocumentType::PDF && !path.isEmpty()) {
+        writer.reset(new PdfTextLayerWriter(path));
+        skip = writer->pagesWithTextLayer(); // Resume an earlier run
+    }
+
+    QList<int> pages;
+    QHash<int, Page*> pageObjects;
+    for (int i = 0; i < document->pageCount(); ++i) {
+        if (skip.contains(i)) continue;
+        pages.append(i);
+        pageObjects.insert(i, document->page(i));
+    }
+
+    {
+        QMutexLocker locker(&d->mutex);
+        d->document = document;
+        d->filePath = path;
+        d->writer = std::move(writer);
+        d->queue = pages;
+        d->pages = pageObjects;
+        d->pendingWords.clear();
+        d->done = 0;
+        d->skipped = 0;
+        d->failedPages = 0;
+        d->total = pages.size();
+        d->paused = false;
+        d->cancelled = false;
+        d->failed = false;
+        d->running = !pages.isEmpty();
+    }
+
+    LOG_INFO("OcrBatchProcessor: Starting " << path << ", " << pages.size() << " pages ("
+             << skip.size() << " already have a text layer).");
+    if (pages.isEmpty()) {
+        emit finished(true);
+        return true;
+    }
+    d->scheduleMore();
+    return true;
+}
+
+void OcrBatchProcessor::pause()
+{
+    QMutexLocker locker(&d->mutex);
+    if (d->running) d->paused = true;
+}
+
+void OcrBatchProcessor::resume()
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        if (!d->running || !d->paused) return;
+        d->paused = false;
+    }
+    d->scheduleMore();
+}
+
+void OcrBatchProcessor::cancel()
+{
+    bool finishNow = false;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (!d->running) return;
+        d->cancelled = true;
+        d->queue.clear();
+        finishNow = d->inFlight == 0; // A paused run has no worker left to end it
+    }
+    if (finishNow) {
+        d->flush();
+        d->finishOrContinue();
+    }
+}
+
+bool OcrBatchProcessor::isRunning() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->running;
+}
+
+bool OcrBatchProcessor::isPaused() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->paused;
+}
+
+int OcrBatchProcessor::pagesDone() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->done;
+}
+
+int OcrBatchProcessor::pagesTotal() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->total;
+}
+
+int OcrBatchProcessor::pagesSkipped() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->skipped;
+}
+
+int OcrBatchProcessor::pagesFailed() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->failedPages;
+}
+
+bool OcrBatchProcessor::skipExistingText() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->skipExisting;
+}
+
+void OcrBatchProcessor::setSkipExistingText(bool skip)
+{
+    QMutexLocker locker(&d->mutex);
+    d->skipExisting = skip;
+}
+
+int OcrBatchProcessor::maxConcurrentPages() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxConcurrent;
+}
+
+void OcrBatchProcessor::setMaxConcurrentPages(int pages)
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->maxConcurrent = qMax(1, pages);
+    }
+    d->scheduleMore();
+}
+
+int OcrBatchProcessor::flushInterval() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->flushPages;
+}
+
+void OcrBatchProcessor::setFlushInterval(int pages)
+{
+    QMutexLocker locker(&d->mutex);
+    d->flushPages = qMax(1, pages);
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,177 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_OCRBATCHPROCESSOR_H
+#define QUANTILYX_OCRBATCHPROCESSOR_H
+
+#include <QObject>
+#include <QString>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+class Document;
+
+/**
+ * @brief Recognizes every page of a document in the background.
+ *
+ * Pages are rendered at the OCR resolution and recognized in parallel on
+ * the project ThreadPool, a bounded number at a time (by default one less
+ * than the cores, leaving one for interactive work). The tasks are queued
+ * at Task::Priority::Low, so interactive tasks submitted meanwhile run
+ * first; the OS scheduling priority of the pool threads is not changed. As
+ * pages finish, their text is fed to FullTextIndex, and for PDF documents
+ * the words are written into the file as an invisible text layer
+ * (PdfTextLayerWriter), in incremental updates of flushInterval() pages, so
+ * the file becomes searchable in any viewer.
+ *
+ * The run can be paused and resumed; pausing lets the pages in flight
+ * finish and writes them out. Pages that already carry a layer are skipped,
+ * so a run interrupted by closing the application resumes where it stopped.
+ *
+ * Signals are emitted from worker threads; connect with Qt::QueuedConnection
+ * when updating the UI.
+ */
+class OcrBatchProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor.
+     * @param parent Parent object.
+     */
+    explicit OcrBatchProcessor(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor. Cancels the run and waits for the pages in flight.
+     */
+    ~OcrBatchProcessor() override;
+
+    /**
+     * @brief Start recognizing a document.
+     * The document must outlive the run. The PDF file is updated in place.
+     * @param document Document to process.
+     * @return True if the run started (or there was nothing to do).
+     */
+    bool start(Document* document);
+
+    /**
+     * @brief Stop scheduling pages; the pages in flight finish and are written.
+     */
+    void pause();
+
+    /**
+     * @brief Continue a paused run.
+     */
+    void resume();
+
+    /**
+     * @brief Abandon the run. Finished pages are still written.
+     */
+    void cancel();
+
+    /**
+     * @brief Check if a run is in progress (including paused).
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Check if the run is paused.
+     */
+    bool isPaused() const;
+
+    /**
+     * @brief Get the number of pages finished in this run.
+     */
+    int pagesDone() const;
+
+    /**
+     * @brief Get the number of pages this run will process.
+     */
+    int pagesTotal() const;
+
+    /**
+     * @brief Get the number of pages of this run that needed no OCR.
+     */
+    int pagesSkipped() const;
+
+    /**
+     * @brief Get the number of pages of this run whose OCR failed.
+     */
+    int pagesFailed() const;
+
+    /**
+     * @brief Check if pages are analyzed before OCR (default true).
+     */
+    bool skipExistingText() const;
+
+    /**
+     * @brief Set whether pages are analyzed before OCR.
+     * When enabled, a low-resolution render of each page is split into text
+     * blocks (OcrLayoutAnalyzer). Blank and picture-only pages, and pages
+     * whose text layer already covers every block, are skipped. On pages
+     * with a partial text layer only the uncovered blocks are recognized.
+     */
+    void setSkipExistingText(bool skip);
+
+    /**
+     * @brief Get the maximum number of pages recognized at once.
+     */
+    int maxConcurrentPages() const;
+
+    /**
+     * @brief Set the maximum number of pages recognized at once (default: cores - 1).
+     */
+    void setMaxConcurrentPages(int pages);
+
+    /**
+     * @brief Get the number of finished pages written per incremental update.
+     */
+    int flushInterval() const;
+
+    /**
+     * @brief Set the number of finished pages written per incremental update (default 8).
+     */
+    void setFlushInterval(int pages);
+
+signals:
+    /**
+     * @brief Emitted when a page has been recognized.
+     * @param pageIndex 0-based page index.
+     */
+    void pageFinished(int pageIndex);
+
+    /**
+     * @brief Emitted after each page.
+     * @param done Pages finished.
+     * @param total Pages in the run.
+     */
+    void progress(int done, int total);
+
+    /**
+     * @brief Emitted when the run ends.
+     * @param success False if it was cancelled or a write failed.
+     */
+    void finished(bool success);
+
+    /**
+     * @brief Emitted when a page or an update fails.
+     * @param message Error message.
+     */
+    void error(const QString& message);
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_OCRBATCHPROCESSOR_H
@@ -0,0 +1,286 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "OcrCache.h"
+#include "../core/Logger.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr quint32 EntryMagic = 0x514F4352; // "QOCR"
+constexpr quint16 EntryVersion = 2;     // 2: failed recognitions are no longer stored
+constexpr int PruneInterval = 32;          // Stores between size checks
+
+} // namespace
+
+class OcrCache::Private {
+public:
+    Private(OcrCache* q_ptr)
+        : q(q_ptr)
+        , directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ocr")
+        , maxSizeBytes(256 * 1024 * 1024)
+        , hits(0)
+        , misses(0)
+        , storesSincePrune(PruneInterval) {}
+
+    OcrCache* q;
+    mutable QMutex mutex; // Protects the settings and counters; files are replaced atomically
+    QString directory;
+    qint64 maxSizeBytes;
+    int hits;
+    int misses;
+    int storesSincePrune;
+
+    // Two-level fan-out keeps directories small
+    QString entryPath(const QString& dir, const QByteArray& key) const {
+        return dir + "/" + QString::fromLatin1(key.left(2)) + "/" + QString::fromLatin1(key) + ".ocr";
+    }
+
+    QString aliasPath(const QString& dir, const QByteArray& pageKey) const {
+        return dir + "/alias/" + QString::fromLatin1(pageKey);
+    }
+
+    static QByteArray serialize(const Entry& entry) {
+        QByteArray bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream << EntryMagic << EntryVersion << entry.imageSize << entry.result.text << entry.result.language
+               << entry.result.confidence << qint32(entry.result.words.size());
+        for (const OcrWord& word : entry.result.words) {
+            stream << word.text << word.box << word.confidence;
+        }
+        return bytes;
+    }
+
+    static bool deserialize(const QByteArray& bytes, Entry& entry) {
+        QDataStream stream(bytes);
+        stream.setVersion(QDataStream::Qt_5_12);
+        quint32 magic = 0;
+        quint16 version = 0;
+        qint32 count = 0;
+        stream >> magic >> version;
+        if (magic != EntryMagic || version != EntryVersion) return false;
+        stream >> entry.imageSize >> entry.result.text >> entry.result.language >> entry.result.confidence >> count;
+        if (stream.status() != QDataStream::Ok || count < 0) return false;
+
+        entry.result.words.clear();
+        entry.result.boundingBoxes.clear();
+        entry.result.ok = true; // Only completed recognitions are stored
+        entry.result.words.reserve(count);
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            OcrWord word;
+            stream >> word.text >> word.box >> word.confidence;
+            entry.result.words.append(word);
+            entry.result.boundingBoxes.append(word.box);
+        }
+        return stream.status() == QDataStream::Ok;
+    }
+
+    bool read(const QString& path, Entry& entry) const {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        if (!deserialize(file.readAll(), entry)) {
+            LOG_WARN("OcrCache: Dropping unreadable entry " << path);
+            file.close();
+            QFile::remove(path);
+            return false;
+        }
+        // The modification time doubles as the last-use time for trimming
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        return true;
+    }
+
+    static bool write(const QString& path, const QByteArray& bytes) {
+        if (!QDir().mkpath(QFileInfo(path).absolutePath())) return false;
+        QSaveFile file(path);
+        return file.open(QIODevice::WriteOnly) && file.write(bytes) == bytes.size() && file.commit();
+    }
+
+    // Delete least recently used entries until the directory is under 90% of the limit
+    void prune(const QString& dir, qint64 limit) {
+        QList<QFileInfo> files;
+        qint64 total = 0;
+        QDirIterator it(dir, QStringList() << "*.ocr", QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            files.append(it.fileInfo());
+            total += it.fileInfo().size();
+        }
+        if (total <= limit) return;
+
+        std::sort(files.begin(), files.end(), [](const QFileInfo& a, const QFileInfo& b) {
+            return a.lastModified() < b.lastModified();
+        });
+        const qint64 target = limit / 10 * 9;
+        int removed = 0;
+        for (const QFileInfo& info : files) {
+            if (total <= target) break;
+            if (QFile::remove(info.absoluteFilePath())) {
+                total -= info.size();
+                ++removed;
+            }
+        }
+        // Aliases of removed entries simply miss on lookup and are rewritten on the next store
+        LOG_DEBUG("OcrCache: Trimmed " << removed << " entries, " << total << " bytes left.");
+    }
+};
+
+// Static instance pointer
+OcrCache* OcrCache::s_instance = nullptr;
+
+OcrCache& OcrCache::instance()
+{
+    if (!s_instance) {
+        s_instance = new OcrCache();
+    }
+    return *s_instance;
+}
+
+OcrCache::OcrCache(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+}
+
+OcrCache::~OcrCache() = default;
+
+QByteArray OcrCache::imageKey(const QImage& image, const QByteArray& settings)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(settings);
+    const QByteArray header = QByteArray::number(image.width()) + 'x' + QByteArray::number(image.height())
+                            + ':' + QByteArray::number(int(image.format()));
+    hash.addData(header);
+    // Hash only the pixels of each scanline, not the row padding
+    const int rowBytes = (image.width() * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        hash.addData(reinterpret_cast<const char*>(image.constScanLine(y)), rowBytes);
+    }
+    return hash.result().toHex();
+}
+
+QByteArray OcrCache::pageKey(const QString& filePath, int pageIndex, const QByteArray& settings)
+{
+    const QFileInfo info(filePath);
+    if (filePath.isEmpty() || !info.exists()) return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(settings);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(pageIndex));
+    return hash.result().toHex();
+}
+
+bool OcrCache::lookup(const QByteArray& key, Entry& entry)
+{
+    const QString dir = directory();
+    const bool hit = !key.isEmpty() && d->read(d->entryPath(dir, key), entry);
+    QMutexLocker locker(&d->mutex);
+    hit ? ++d->hits : ++d->misses;
+    return hit;
+}
+
+bool OcrCache::lookupPage(const QByteArray& pageKey, Entry& entry)
+{
+    if (pageKey.isEmpty()) return false;
+    QFile alias(d->aliasPath(directory(), pageKey));
+    if (!alias.open(QIODevice::ReadOnly)) {
+        QMutexLocker locker(&d->mutex);
+        ++d->misses;
+        return false;
+    }
+    return lookup(alias.readAll().trimmed(), entry);
+}
+
+bool OcrCache::store(const QByteArray& key, const Entry& entry, const QByteArray& pageKey)
+{
+    if (key.isEmpty() || !entry.result.ok) return false;
+    QString dir;
+    qint64 limit;
+    bool pruneNow;
+    {
+        QMutexLocker locker(&d->mutex);
+        dir = d->directory;
+        limit = d->maxSizeBytes;
+        pruneNow = ++d->storesSincePrune >= PruneInterval;
+        if (pruneNow) d->storesSincePrune = 0;
+    }
+
+    if (!d->write(d->entryPath(dir, key), Private::serialize(entry))) {
+        LOG_WARN("OcrCache: Failed to write entry " << key);
+        return false;
+    }
+    if (!pageKey.isEmpty() && !d->write(d->aliasPath(dir, pageKey), key)) {
+        LOG_WARN("OcrCache: Failed to write page alias " << pageKey);
+    }
+    if (pruneNow) {
+        d->prune(dir, limit);
+    }
+    return true;
+}
+
+void OcrCache::clear()
+{
+    QDir(directory()).removeRecursively();
+    LOG_INFO("OcrCache: Cleared.");
+}
+
+QString OcrCache::directory() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->directory;
+}
+
+void OcrCache::setDirectory(const QString& path)
+{
+    QMutexLocker locker(&d->mutex);
+    d->directory = path;
+    d->storesSincePrune = PruneInterval; // Check the new directory on the next store
+}
+
+qint64 OcrCache::maxSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maxSizeBytes;
+}
+
+void OcrCache::setMaxSize(qint64 bytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->maxSizeBytes = qMax<qint64>(0, bytes);
+    d->storesSincePrune = PruneInterval;
+}
+
+int OcrCache::hitCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->hits;
+}
+
+int OcrCache::missCount() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->misses;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,155 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_OCRCACHE_H
+#define QUANTILYX_OCRCACHE_H
+
+#include "OcrEngine.h"
+#include <QObject>
+#include <QByteArray>
+#include <QSize>
+#include <QString>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Persistent cache of OCR results.
+ *
+ * Results are keyed by a hash of the rendered page image together with the
+ * engine settings that affect recognition (OcrEngine::settingsFingerprint():
+ * language, engine version, resolution and preprocessing), so a page is
+ * recognized once across sessions and a settings change never returns stale
+ * text. Each entry is a small file under the cache directory, written
+ * atomically; the directory is trimmed to maxSize() by least recent use.
+ *
+ * To skip rendering on reopen, a page can also be looked up by an alias made
+ * from the document file (path, size, modification time) and page index,
+ * which points at the image key it was last stored under.
+ *
+ * All methods are thread-safe.
+ */
+class OcrCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief A cached result together with the size of the image it was recognized on.
+     */
+    struct Entry {
+        OcrResult result;   // Word boxes are in pixels of an image of imageSize
+        QSize imageSize;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param parent Parent object.
+     */
+    explicit OcrCache(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~OcrCache() override;
+
+    /**
+     * @brief Get singleton instance.
+     * @return Reference to the global OcrCache instance.
+     */
+    static OcrCache& instance();
+
+    /**
+     * @brief Compute the key of a rendered page.
+     * @param image The image given to the engine.
+     * @param settings OcrEngine::settingsFingerprint().
+     * @return Hex SHA-256 key.
+     */
+    static QByteArray imageKey(const QImage& image, const QByteArray& settings);
+
+    /**
+     * @brief Compute the alias key of a document page.
+     * @param filePath Document file.
+     * @param pageIndex 0-based page index.
+     * @param settings OcrEngine::settingsFingerprint().
+     * @return Hex SHA-256 key, or empty if the file does not exist.
+     */
+    static QByteArray pageKey(const QString& filePath, int pageIndex, const QByteArray& settings);
+
+    /**
+     * @brief Look up a result.
+     * @param key Image key.
+     * @param entry Receives the entry on a hit.
+     * @return True on a hit.
+     */
+    bool lookup(const QByteArray& key, Entry& entry);
+
+    /**
+     * @brief Look up a result through a page alias.
+     * @return True on a hit.
+     */
+    bool lookupPage(const QByteArray& pageKey, Entry& entry);
+
+    /**
+     * @brief Store a result.
+     * Failed recognitions (OcrResult::ok unset) are not stored; completed
+     * ones are, even without any words, so blank pages are not recognized
+     * again.
+     * @param key Image key.
+     * @param entry The entry.
+     * @param pageKey Optional alias pointing at the key.
+     * @return True if written.
+     */
+    bool store(const QByteArray& key, const Entry& entry, const QByteArray& pageKey = QByteArray());
+
+    /**
+     * @brief Remove all entries.
+     */
+    void clear();
+
+    /**
+     * @brief Get the cache directory.
+     */
+    QString directory() const;
+
+    /**
+     * @brief Set the cache directory (default: <cache>/ocr).
+     */
+    void setDirectory(const QString& path);
+
+    /**
+     * @brief Get the size limit of the cache directory in bytes.
+     */
+    qint64 maxSize() const;
+
+    /**
+     * @brief Set the size limit of the cache directory in bytes.
+     */
+    void setMaxSize(qint64 bytes);
+
+    /**
+     * @brief Get the number of hits since startup.
+     */
+    int hitCount() const;
+
+    /**
+     * @brief Get the number of misses since startup.
+     */
+    int missCount() const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+
+    static OcrCache* s_instance;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_OCRCACHE_H
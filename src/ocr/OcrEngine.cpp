@@ -1,58 +1,282 @@
 /**
  * QuantilyxDoc - Professional Document Editor
  * Copyright (C) 2025 R² Innovative Software
- * 
+ *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation, either version 3 of the License, or
  * (at your option) any later version.
  */
 #include "OcrEngine.h"
+#include "PaddleOcrBackend.h"
 #include "../core/Logger.h"
+#include "../core/ThreadPool.h"
 #include <QImage>
 #include <QRectF>
 #include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+#include <QFutureInterface>
+#include <QDir>
+#include <QFile>
 #include <QThread>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QDebug>
-// #include <tesseract/baseapi.h> // Hypothetical Tesseract C++ API header
-// #include <leptonica/allheaders.h> // Hypothetical Leptonica header for image handling with Tesseract
+#include <functional>
+#ifdef HAVE_TESSERACT
+#include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+#endif
 
 namespace QuantilyxDoc {
 
+namespace {
+
+// Run a function on the project thread pool and expose its result as a QFuture
+template <typename T>
+QFuture<T> runOnThreadPool(std::function<T()> func, const QString& name)
+{
+    QFutureInterface<T> promise;
+    promise.reportStarted();
+    QFuture<T> future = promise.future();
+    ThreadPool::instance().submitTask([promise, func]() mutable {
+        promise.reportResult(func());
+        promise.reportFinished();
+    }, name);
+    return future;
+}
+
+} // namespace
+
 class OcrEngine::Private {
 public:
     Private(OcrEngine* q_ptr)
-        : q(q_ptr), initialized(false), resolutionVal(300), confidenceThresholdVal(0.5f) {}
+        : q(q_ptr), initialized(false), resolutionVal(300), confidenceThresholdVal(0.5f)
+        , backendVal(Backend::Tesseract), activeBackend(Backend::Tesseract), generation(0), instanceCount(0) {}
+
+    ~Private() {
+        releaseIdle();
+    }
 
     OcrEngine* q;
-    mutable QMutex mutex; // Protect access to the Tesseract API instance if shared across threads
-    // tesseract::TessBaseAPI* tessApi; // Hypothetical Tesseract API instance
+    mutable QMutex mutex; // Protects the settings below
     bool initialized;
     QString currentLanguageCode;
     QString datapathStr;
     int resolutionVal;
     float confidenceThresholdVal;
+    OcrPreprocessOptions preprocess;
+    OcrRefineOptions refine;
+    Backend backendVal;   // Applied by initialize()
+    Backend activeBackend;
+    quint64 generation;   // Bumped when language data settings change; stale engines are dropped
+
+    // Engine pool. Each instance is used by one thread at a time.
+    struct Engine {
+#ifdef HAVE_TESSERACT
+        std::unique_ptr<tesseract::TessBaseAPI> api;
+#endif
+        QString language;
+        quint64 generation;
+    };
+    mutable QMutex poolMutex;
+    QList<Engine*> idleEngines;
+    int instanceCount;
+
+    // Settings snapshot taken once per recognition call
+    struct Settings {
+        QString language;
+        QString datapath;
+        int resolution;
+        OcrPreprocessOptions preprocess;
+        quint64 generation;
+        float confidenceThreshold;
+        OcrRefineOptions refine;
+        Backend backend;
+    };
+
+    Settings settings() const {
+        QMutexLocker locker(&mutex);
+        OcrPreprocessOptions options = preprocess;
+        options.targetDpi = resolutionVal;
+        return Settings{currentLanguageCode, datapathStr, resolutionVal, options, generation,
+                        confidenceThresholdVal, refine, activeBackend};
+    }
 
-    // Helper to convert QImage to Pix (Leptonica format) for Tesseract
-    // Pix* qImageToPix(const QImage& image) const {
-    //     // This conversion is complex and depends on the image format.
-    //     // Leptonica provides functions like pixCreateFromQImage or similar.
-    //     // For now, assume a conversion exists.
-    //     // Example using hypothetical function:
-    //     // return pixCreateFromQImage(image);
-    //     LOG_WARN("OcrEngine::qImageToPix: Requires Leptonica integration.");
-    //     return nullptr; // Placeholder
-    // }
-
-    // Helper to convert Pix (Leptonica format) back to QImage
-    // QImage pixToQImage(Pix* pix) const {
-    //     // Reverse conversion
-    //     LOG_WARN("OcrEngine::pixToQImage: Requires Leptonica integration.");
-    //     return QImage(); // Placeholder
-    // }
+    // Resolution recorded in the image, or 0 if it only carries Qt's default
+    static int imageDpi(const QImage& image) {
+        const int dpi = qRound(image.dotsPerMeterX() * 0.0254);
+        return dpi == 96 || dpi == 72 ? 0 : dpi;
+    }
+
+    // Take an idle engine for the language, or initialize a new one
+    Engine* acquire(const Settings& settings) {
+        {
+            QMutexLocker locker(&poolMutex);
+            for (int i = 0; i < idleEngines.size(); ++i) {
+                Engine* engine = idleEngines.at(i);
+                if (engine->language == settings.language && engine->generation == settings.generation) {
+                    idleEngines.removeAt(i);
+                    return engine;
+                }
+            }
+        }
+
+#ifdef HAVE_TESSERACT
+        // Loading a language model is slow; do it outside the pool lock
+        std::unique_ptr<Engine> engine(new Engine{std::unique_ptr<tesseract::TessBaseAPI>(new tesseract::TessBaseAPI()),
+                                                  settings.language, settings.generation});
+        const QByteArray path = settings.datapath.toUtf8();
+        if (engine->api->Init(path.isEmpty() ? nullptr : path.constData(), settings.language.toUtf8().constData()) != 0) {
+            LOG_ERROR("OcrEngine: Failed to initialize Tesseract for language '" << settings.language
+                      << "', datapath: " << settings.datapath);
+            return nullptr;
+        }
+        QMutexLocker locker(&poolMutex);
+        ++instanceCount;
+        LOG_DEBUG("OcrEngine: Initialized Tesseract instance " << instanceCount << " for '" << settings.language
+                  << "' on thread " << QThread::currentThread());
+        return engine.release();
+#else
+        Q_UNUSED(settings);
+        return nullptr;
+#endif
+    }
+
+    void release(Engine* engine) {
+        if (!engine) return;
+        bool stale;
+        {
+            QMutexLocker locker(&mutex);
+            stale = engine->generation != generation;
+        }
+        QMutexLocker locker(&poolMutex);
+        if (stale) {
+            --instanceCount;
+            delete engine;
+        } else {
+            idleEngines.append(engine);
+        }
+    }
+
+    void releaseIdle() {
+        QList<Engine*> engines;
+        {
+            QMutexLocker locker(&poolMutex);
+            engines.swap(idleEngines);
+            instanceCount -= engines.size();
+        }
+        qDeleteAll(engines);
+    }
+
+    // Returns an engine to the pool when it goes out of scope
+    class Lease {
+    public:
+        Lease(Private* d, const Settings& settings) : m_d(d), m_engine(d->acquire(settings)) {}
+        ~Lease() { m_d->release(m_engine); }
+        Engine* operator->() const { return m_engine; }
+        explicit operator bool() const { return m_engine != nullptr; }
+    private:
+        Private* m_d;
+        Engine* m_engine;
+    };
+
+    // Recognize an image, or a region of it (null region = whole image)
+    OcrResult recognize(const QImage& image, const QRect& region, const OcrPreprocessOptions* preprocess = nullptr) {
+        OcrResult result;
+        const Settings s = settings();
+        const OcrPreprocessOptions& options = preprocess ? *preprocess : s.preprocess;
+        result.language = s.language;
+        if (image.isNull()) {
+            result.error = QStringLiteral("Empty image.");
+            return result;
+        }
+
+        if (s.backend == Backend::PaddleOcr) {
+            // The models read color and grayscale alike, so the binarizing preprocessor is skipped
+            const QRect r = region.isNull() ? image.rect() : region.intersected(image.rect());
+            if (r.isEmpty()) {
+                result.error = QStringLiteral("Region outside the image.");
+                return result;
+            }
+            OcrResult lines = PaddleOcrBackend::instance().recognize(r == image.rect() ? image : image.copy(r));
+            for (OcrWord& word : lines.words) {
+                word.box.translate(r.topLeft());
+            }
+            for (QRectF& box : lines.boundingBoxes) {
+                box.translate(r.topLeft());
+            }
+            lines.language = s.language;
+            return lines;
+        }
+
+#ifdef HAVE_TESSERACT
+        Lease engine(this, s);
+        if (!engine) {
+            result.error = QStringLiteral("No Tesseract instance for language '%1'.").arg(s.language);
+            return result;
+        }
+        tesseract::TessBaseAPI* api = engine->api.get();
+
+        // Cleaned up 8-bit grayscale is passed as-is, no Leptonica conversion needed.
+        // Word boxes are mapped back to the caller's image through the
+        // preprocessing transform.
+        OcrPreprocessStats stats;
+        const int sourceDpi = imageDpi(image);
+        const QImage gray = OcrPreprocessor(options).process(image, sourceDpi, &stats);
+        const QTransform toSource = stats.transform.inverted();
+        api->SetImage(gray.constBits(), gray.width(), gray.height(), 1, gray.bytesPerLine());
+        // Images of unknown resolution are assumed to be rendered at resolution() already
+        if (sourceDpi == 0) {
+            api->SetSourceResolution(s.resolution);
+        } else {
+            api->SetSourceResolution(options.enabled && options.targetDpi > 0 ? options.targetDpi : sourceDpi);
+        }
+        if (!region.isNull()) {
+            const QRect r = stats.transform.mapRect(QRectF(region)).toAlignedRect().intersected(gray.rect());
+            if (r.isEmpty()) {
+                api->Clear();
+                result.error = QStringLiteral("Region outside the image.");
+                return result;
+            }
+            api->SetRectangle(r.x(), r.y(), r.width(), r.height());
+        }
+
+        if (api->Recognize(nullptr) != 0) {
+            LOG_ERROR("OcrEngine: Tesseract recognition failed.");
+            api->Clear();
+            result.error = QStringLiteral("Tesseract recognition failed.");
+            return result;
+        }
+
+        std::unique_ptr<tesseract::ResultIterator> it(api->GetIterator());
+        if (it) {
+            const tesseract::PageIteratorLevel level = tesseract::RIL_WORD;
+            do {
+                if (it->Empty(level)) continue;
+                std::unique_ptr<char[]> word(it->GetUTF8Text(level));
+                int left, top, right, bottom;
+                if (!word || !it->BoundingBox(level, &left, &top, &right, &bottom)) continue;
+                OcrWord w;
+                w.text = QString::fromUtf8(word.get());
+                w.box = toSource.mapRect(QRectF(left, top, right - left, bottom - top));
+                w.confidence = it->Confidence(level) / 100.0f;
+                result.words.append(w);
+                result.boundingBoxes.append(w.box);
+            } while (it->Next(level));
+        }
+
+        std::unique_ptr<char[]> text(api->GetUTF8Text());
+        result.text = text ? QString::fromUtf8(text.get()) : QString();
+        result.confidence = api->MeanTextConf() / 100.0f;
+        result.ok = true;
+        api->Clear();
+#else
+        Q_UNUSED(region);
+        Q_UNUSED(options);
+        result.error = QStringLiteral("Built without Tesseract support.");
+#endif
+        return result;
+    }
 };
 
 // Static instance pointer
@@ -70,40 +294,57 @@ OcrEngine::OcrEngine(QObject* parent)
     : QObject(parent)
     , d(new Private(this))
 {
-    // d->tessApi = new tesseract::TessBaseAPI(); // Initialize Tesseract API
     LOG_INFO("OcrEngine created.");
 }
 
 OcrEngine::~OcrEngine()
 {
-    // if (d->tessApi) {
-    //     d->tessApi->End(); // Cleanup Tesseract
-    //     delete d->tessApi;
-    // }
     LOG_INFO("OcrEngine destroyed.");
 }
 
 bool OcrEngine::initialize(const QString& language, const QString& datapath)
 {
-    QMutexLocker locker(&d->mutex);
+    Backend backend;
+    {
+        QMutexLocker locker(&d->mutex);
+        backend = d->backendVal;
+        d->activeBackend = backend;
+        d->currentLanguageCode = language;
+        if (!datapath.isEmpty()) {
+            d->datapathStr = datapath;
+        } else if (backend == Backend::PaddleOcr) {
+            d->datapathStr = qEnvironmentVariable("PADDLEOCR_MODEL_DIR", "/usr/share/paddleocr");
+        } else {
+            d->datapathStr = qEnvironmentVariable("TESSDATA_PREFIX", "/usr/share/tessdata");
+        }
+        ++d->generation;
+    }
+    d->releaseIdle();
+
+    bool success;
+    if (backend == Backend::PaddleOcr) {
+        // The language is a property of the models in the directory
+        success = PaddleOcrBackend::instance().initialize(datapath());
+    } else {
+#ifdef HAVE_TESSERACT
+        // Load the first instance now so configuration errors show up here
+        Private::Lease engine(d.get(), d->settings());
+        success = static_cast<bool>(engine);
+#else
+        LOG_ERROR("OcrEngine: Built without Tesseract support (HAVE_TESSERACT).");
+        success = false;
+#endif
+    }
 
-    // This is where the actual Tesseract initialization happens.
-    // int initResult = d->tessApi->Init(datapath.isEmpty() ? nullptr : datapath.toUtf8().constData(), language.toUtf8().constData());
-    // if (initResult != 0) {
-    //     LOG_ERROR("OcrEngine: Failed to initialize Tesseract API for language '" << language << "', datapath: " << datapath);
-    //     d->initialized = false;
-    //     emit initializationComplete(false);
-    //     return false;
-    // }
-
-    // d->tessApi->SetVariable("tessedit_char_whitelist", ""); // Optionally set whitelist
-    d->currentLanguageCode = language;
-    d->datapathStr = datapath.isEmpty() ? "/usr/share/tessdata" : datapath; // Default path
-    d->initialized = true;
-
-    LOG_INFO("OcrEngine: Initialized with language '" << language << "', datapath: " << d->datapathStr);
-    emit initializationComplete(true);
-    return true;
+    {
+        QMutexLocker locker(&d->mutex);
+        d->initialized = success;
+    }
+    if (success) {
+        LOG_INFO("OcrEngine: Initialized with language '" << language << "', datapath: " << datapath);
+    }
+    emit initializationComplete(success);
+    return success;
 }
 
 bool OcrEngine::isReady() const
@@ -115,99 +356,93 @@ bool OcrEngine::isReady() const
 QString OcrEngine::recognizeText(const QImage& image) const
 {
     if (!isReady() || image.isNull()) return QString();
-
-    // QMutexLocker locker(&d->mutex); // Lock during Tesseract call
-    // Pix* pixImage = d->qImageToPix(image);
-    // if (!pixImage) {
-    //     LOG_ERROR("OcrEngine::recognizeText: Failed to convert QImage to Pix.");
-    //     return QString();
-    // }
-
-    // d->tessApi->SetImage(pixImage);
-    // d->tessApi->SetSourceResolution(d->resolutionVal); // Set DPI
-
-    // char* outText = d->tessApi->GetUTF8Text();
-    // QString result(outText);
-    // delete[] outText;
-
-    // pixDestroy(&pixImage); // Clean up Pix
-
-    LOG_WARN("OcrEngine::recognizeText: Requires Tesseract integration. Returning placeholder.");
-    return "OCR text placeholder"; // Placeholder
+    return d->recognize(image, QRect()).text;
 }
 
 QString OcrEngine::recognizeText(const QImage& image, const QRectF& region) const
 {
     if (!isReady() || image.isNull() || region.isEmpty()) return QString();
-
-    // Crop image to region first, then call full-image recognizeText
-    // QRect rect = region.toRect(); // Convert to integer QRect
-    // QImage croppedImage = image.copy(rect);
-    // return recognizeText(croppedImage);
-
-    LOG_WARN("OcrEngine::recognizeText (region): Requires Tesseract integration. Returning placeholder.");
-    return "OCR text for region placeholder"; // Placeholder
+    return d->recognize(image, region.toAlignedRect()).text;
 }
 
 QFuture<QString> OcrEngine::recognizeTextAsync(const QImage& image) const
 {
-    // Use QtConcurrent to run the OCR in a separate thread
-    return QtConcurrent::run([this, image]() {
-        return this->recognizeText(image);
-    });
+    return runOnThreadPool<QString>([this, image]() {
+        emit const_cast<OcrEngine*>(this)->recognitionStarted();
+        const QString text = recognizeText(image);
+        emit const_cast<OcrEngine*>(this)->recognitionFinished();
+        return text;
+    }, QStringLiteral("OCR"));
 }
 
-OcrResult OcrEngine::recognizeDetailed(const QImage& image) const
+QFuture<OcrResult> OcrEngine::recognizeDetailedAsync(const QImage& image) const
 {
-    OcrResult result;
-    if (!isReady() || image.isNull()) return result;
+    return runOnThreadPool<OcrResult>([this, image]() {
+        emit const_cast<OcrEngine*>(this)->recognitionStarted();
+        const OcrResult result = recognizeDetailed(image);
+        emit const_cast<OcrEngine*>(this)->recognitionFinished();
+        return result;
+    }, QStringLiteral("OCR"));
+}
 
-    // Similar to recognizeText, but use Tesseract's HOCR or BoxText functions
-    // to get bounding boxes and confidences.
-    // This requires more complex parsing of Tesseract's output formats.
-    // result.text = ...;
-    // result.boundingBoxes = ...; // Parsed from HOCR or Boxes
-    // result.confidence = ...; // Average or per-word confidence
+OcrResult OcrEngine::recognizeDetailed(const QImage& image) const
+{
+    if (!isReady() || image.isNull()) {
+        OcrResult result;
+        result.language = currentLanguage();
+        result.error = isReady() ? QStringLiteral("Empty image or region.") : QStringLiteral("OCR engine not initialized.");
+        return result;
+    }
+    return d->recognize(image, QRect());
+}
 
-    LOG_WARN("OcrEngine::recognizeDetailed: Requires Tesseract HOCR/BoxText integration. Returning placeholder.");
-    result.text = "Detailed OCR text placeholder";
-    result.confidence = 0.8f;
-    result.language = currentLanguage();
-    return result; // Placeholder
+OcrResult OcrEngine::recognizeDetailed(const QImage& image, const OcrPreprocessOptions& preprocess) const
+{
+    if (!isReady() || image.isNull()) {
+        OcrResult result;
+        result.language = currentLanguage();
+        result.error = isReady() ? QStringLiteral("Empty image or region.") : QStringLiteral("OCR engine not initialized.");
+        return result;
+    }
+    return d->recognize(image, QRect(), &preprocess);
 }
 
 OcrResult OcrEngine::recognizeDetailed(const QImage& image, const QRectF& region) const
 {
-    // Crop image and call detailed OCR on the cropped part
-    // QRect rect = region.toRect();
-    // QImage croppedImage = image.copy(rect);
-    // return recognizeDetailed(croppedImage);
+    if (!isReady() || image.isNull() || region.isEmpty()) {
+        OcrResult result;
+        result.language = currentLanguage();
+        result.error = isReady() ? QStringLiteral("Empty image or region.") : QStringLiteral("OCR engine not initialized.");
+        return result;
+    }
+    // Boxes stay in the coordinates of the full image
+    return d->recognize(image, region.toAlignedRect());
+}
 
-    LOG_WARN("OcrEngine::recognizeDetailed (region): Requires Tesseract HOCR/BoxText integration. Returning placeholder.");
-    OcrResult result;
-    result.text = "Detailed OCR text for region placeholder";
-    result.confidence = 0.8f;
-    result.language = currentLanguage();
-    return result; // Placeholder
+OcrEngine::Backend OcrEngine::backend() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->backendVal;
 }
 
-QStringList OcrEngine::supportedLanguages() const
+void OcrEngine::setBackend(Backend backend)
 {
-    // Tesseract does not provide a direct API to list installed languages.
-    // You need to scan the tessdata directory for .traineddata files.
-    // QDir tessdataDir(d->datapathStr);
-    // QStringList filters;
-    // filters << "*.traineddata";
-    // QStringList langFiles = tessdataDir.entryList(filters);
-    // QStringList langs;
-    // for (const QString& file : langFiles) {
-    //     QString langCode = file.left(file.lastIndexOf('.')); // Remove .traineddata extension
-    //     langs.append(langCode);
-    // }
-    // return langs;
+    QMutexLocker locker(&d->mutex);
+    d->backendVal = backend;
+}
 
-    LOG_WARN("OcrEngine::supportedLanguages: Requires scanning tessdata directory. Returning placeholder.");
-    return QStringList() << "eng" << "deu" << "fra"; // Placeholder
+QStringList OcrEngine::supportedLanguages() const
+{
+    // Tesseract only reports languages after Init(); scan tessdata instead
+    QDir tessdataDir(datapath());
+    QStringList langs;
+    for (const QString& file : tessdataDir.entryList(QStringList() << "*.traineddata", QDir::Files, QDir::Name)) {
+        const QString langCode = file.left(file.lastIndexOf('.')); // Remove .traineddata extension
+        if (langCode != "osd") {
+            langs.append(langCode);
+        }
+    }
+    return langs;
 }
 
 QString OcrEngine::currentLanguage() const
@@ -218,19 +453,30 @@ QString OcrEngine::currentLanguage() const
 
 bool OcrEngine::setLanguage(const QString& language)
 {
-    // if (!isReady()) return false;
-    // int initResult = d->tessApi->Init(d->datapathStr.isEmpty() ? nullptr : d->datapathStr.toUtf8().constData(), language.toUtf8().constData());
-    // if (initResult != 0) {
-    //     LOG_ERROR("OcrEngine: Failed to set Tesseract language to '" << language << "'");
-    //     return false;
-    // }
-    // d->currentLanguageCode = language;
-    // LOG_INFO("OcrEngine: Language set to '" << language << "'");
-    // return true;
+    if (d->settings().backend == Backend::PaddleOcr) {
+        // Recognition follows the loaded models; the code is only recorded
+        QMutexLocker locker(&d->mutex);
+        d->currentLanguageCode = language;
+        return true;
+    }
+
+    // Instances are initialized lazily per language; only check the data exists.
+    // Combined languages ("eng+deu") need every part.
+    const QDir tessdataDir(datapath());
+    for (const QString& part : language.split('+', Qt::SkipEmptyParts)) {
+        if (!tessdataDir.exists(part + ".traineddata")) {
+            LOG_ERROR("OcrEngine: No language data for '" << part << "' in " << tessdataDir.path());
+            return false;
+        }
+    }
 
-    LOG_WARN("OcrEngine::setLanguage: Requires Tesseract integration. Returning true.");
-    d->currentLanguageCode = language;
-    return true; // Placeholder
+    QMutexLocker locker(&d->mutex);
+    if (d->currentLanguageCode != language) {
+        // Engines for other languages stay in the pool for when the language is switched back
+        d->currentLanguageCode = language;
+        LOG_INFO("OcrEngine: Language set to '" << language << "'");
+    }
+    return true;
 }
 
 QString OcrEngine::datapath() const
@@ -241,12 +487,14 @@ QString OcrEngine::datapath() const
 
 void OcrEngine::setDatapath(const QString& path)
 {
-    QMutexLocker locker(&d->mutex);
-    if (d->datapathStr != path) {
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->datapathStr == path) return;
         d->datapathStr = path;
+        ++d->generation; // Instances loaded from the old path are dropped as they are returned
         LOG_INFO("OcrEngine: Datapath set to '" << path << "'");
-        // Re-initialization might be needed if API is already initialized
     }
+    d->releaseIdle();
 }
 
 int OcrEngine::resolution() const
@@ -279,4 +527,79 @@ void OcrEngine::setConfidenceThreshold(float threshold)
     }
 }
 
-} // namespace QuantilyxDoc
\ No newline at end of file
+OcrPreprocessOptions OcrEngine::preprocessOptions() const
+{
+    QMutexLocker locker(&d->mutex);
+    OcrPreprocessOptions options = d->preprocess;
+    options.targetDpi = d->resolutionVal;
+    return options;
+}
+
+void OcrEngine::setPreprocessOptions(const OcrPreprocessOptions& options)
+{
+    QMutexLocker locker(&d->mutex);
+    d->preprocess = options;
+}
+
+OcrRefineOptions OcrEngine::refineOptions() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->refine;
+}
+
+void OcrEngine::setRefineOptions(const OcrRefineOptions& options)
+{
+    QMutexLocker locker(&d->mutex);
+    d->refine = options;
+}
+
+int OcrEngine::engineInstanceCount() const
+{
+    QMutexLocker locker(&d->poolMutex);
+    return d->instanceCount;
+}
+
+void OcrEngine::releaseIdleEngines()
+{
+    d->releaseIdle();
+}
+
+QString OcrEngine::engineVersion()
+{
+#ifdef HAVE_TESSERACT
+    return QString::fromLatin1(tesseract::TessBaseAPI::Version());
+#else
+    return QStringLiteral("none");
+#endif
+}
+
+QByteArray OcrEngine::settingsFingerprint() const
+{
+    const Private::Settings s = d->settings();
+    const OcrPreprocessOptions& p = s.preprocess;
+    const OcrRefineOptions& r = s.refine;
+    // The SIMD kernel is left out: every kernel produces the same image
+    const QString refine = r.enabled ? QStringLiteral("|refine:%1,%2,%3,%4")
+                                           .arg(s.confidenceThreshold)
+                                           .arg(r.dpi)
+                                           .arg(int(r.alternateBinarization))
+                                           .arg(r.maxRegions)
+                                     : QString();
+    const QString engine = s.backend == Backend::PaddleOcr
+                               ? QStringLiteral("paddle-") + PaddleOcrBackend::engineVersion()
+                               : engineVersion();
+    return (QStringLiteral("v1|%1|%2|%3|pre:%4,%5,%6,%7,%8,%9,%10,%11,%12")
+        .arg(s.language, engine)
+        .arg(s.resolution)
+        .arg(int(p.enabled))
+        .arg(int(p.binarization))
+        .arg(p.sauvolaRadius)
+        .arg(p.sauvolaK)
+        .arg(int(p.deskew))
+        .arg(p.maxSkewDegrees)
+        .arg(int(p.despeckle))
+        .arg(p.targetDpi) + refine)
+        .toUtf8();
+}
+
+} // namespace QuantilyxDoc
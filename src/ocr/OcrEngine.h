@@ -18,17 +18,40 @@
 #include <QFutureWatcher>
 #include <memory>
 #include <QThread>
+#include "OcrPreprocessor.h"
 
 namespace QuantilyxDoc {
 
+/**
+ * @brief A single recognized word.
+ */
+struct OcrWord {
+    QString text;                 // The word
+    QRectF box;                   // Bounding box in image pixels
+    float confidence = 0.0f;      // Confidence level (0.0 to 1.0)
+};
+
 /**
  * @brief Structure holding the result of an OCR operation on a specific region of an image.
  */
 struct OcrResult {
     QString text;                 // The recognized text
     QList<QRectF> boundingBoxes;  // Bounding boxes for individual words/lines within the text
-    float confidence;             // Confidence level (0.0 to 1.0)
+    float confidence = 0.0f;      // Confidence level (0.0 to 1.0)
     QString language;             // Language detected or used for recognition
+    QList<OcrWord> words;         // Word-level results, in reading order
+    bool ok = false;              // Recognition ran to completion (a blank image still counts)
+    QString error;                // Why recognition failed, when !ok
+};
+
+/**
+ * @brief Options of the second pass over low-confidence words (OcrRefiner).
+ */
+struct OcrRefineOptions {
+    bool enabled = true;
+    int dpi = 0;                       // Second-pass resolution (0 = twice resolution(), at most 600)
+    bool alternateBinarization = true; // Use Sauvola if the first pass used Otsu, and vice versa
+    int maxRegions = 48;               // Lines re-recognized per image, lowest confidence first
 };
 
 /**
@@ -36,12 +59,29 @@ struct OcrResult {
  * 
  * Provides methods for performing OCR on images and text regions.
  * Can operate synchronously or asynchronously.
+ *
+ * Tesseract (HAVE_TESSERACT) is not thread-safe per instance, so the engine
+ * keeps a pool of TessBaseAPI instances keyed by language: a recognition
+ * call leases an idle instance for the current language, initializing a new
+ * one on first use, and returns it afterwards. Concurrent calls (e.g. one
+ * page per ThreadPool worker) each get their own instance.
+ *
+ * With the PaddleOcr backend (HAVE_PADDLEOCR) recognition goes through
+ * PaddleOcrBackend, which batches the text lines of concurrent calls.
  */
 class OcrEngine : public QObject
 {
     Q_OBJECT
 
 public:
+    /**
+     * @brief Recognition library behind the engine.
+     */
+    enum class Backend {
+        Tesseract, // One TessBaseAPI per concurrent call; datapath() is the tessdata directory
+        PaddleOcr  // PaddleOcrBackend; datapath() is the model directory
+    };
+
     /**
      * @brief Constructor.
      * @param parent Parent object.
@@ -96,6 +136,14 @@ public:
      */
     QFuture<QString> recognizeTextAsync(const QImage& image) const;
 
+    /**
+     * @brief Perform detailed OCR on an image asynchronously.
+     * Scheduled through the project ThreadPool.
+     * @param image The image to recognize text from.
+     * @return A QFuture that will hold the result upon completion.
+     */
+    QFuture<OcrResult> recognizeDetailedAsync(const QImage& image) const;
+
     /**
      * @brief Perform detailed OCR on an image synchronously.
      * Provides text along with bounding boxes for individual elements.
@@ -104,6 +152,14 @@ public:
      */
     OcrResult recognizeDetailed(const QImage& image) const;
 
+    /**
+     * @brief Perform detailed OCR with preprocessing other than preprocessOptions().
+     * @param image The image to recognize text from.
+     * @param preprocess Preprocessing for this call only.
+     * @return Detailed OCR result structure.
+     */
+    OcrResult recognizeDetailed(const QImage& image, const OcrPreprocessOptions& preprocess) const;
+
     /**
      * @brief Perform detailed OCR on a specific region of an image synchronously.
      * @param image The image to recognize text from.
@@ -112,6 +168,16 @@ public:
      */
     OcrResult recognizeDetailed(const QImage& image, const QRectF& region) const;
 
+    /**
+     * @brief Get the recognition library in use.
+     */
+    Backend backend() const;
+
+    /**
+     * @brief Set the recognition library. Takes effect on the next initialize().
+     */
+    void setBackend(Backend backend);
+
     /**
      * @brief Get the list of supported languages.
      * @return List of language codes (e.g., "eng", "deu").
@@ -163,11 +229,59 @@ public:
 
     /**
      * @brief Set the confidence threshold for OCR results.
-     * Results below this threshold might be filtered out.
+     * Words below this threshold are re-recognized at a higher resolution
+     * (see refineOptions()).
      * @param threshold Threshold value (0.0 - 1.0).
      */
     void setConfidenceThreshold(float threshold);
 
+    /**
+     * @brief Get the preprocessing applied to images before recognition.
+     * @return Preprocessing options (targetDpi follows resolution()).
+     */
+    OcrPreprocessOptions preprocessOptions() const;
+
+    /**
+     * @brief Set the preprocessing applied to images before recognition.
+     * @param options Preprocessing options.
+     */
+    void setPreprocessOptions(const OcrPreprocessOptions& options);
+
+    /**
+     * @brief Get the options of the low-confidence second pass.
+     */
+    OcrRefineOptions refineOptions() const;
+
+    /**
+     * @brief Set the options of the low-confidence second pass.
+     */
+    void setRefineOptions(const OcrRefineOptions& options);
+
+    /**
+     * @brief Get the number of engine instances, leased and idle.
+     * @return Instance count.
+     */
+    int engineInstanceCount() const;
+
+    /**
+     * @brief Free the idle engine instances (each holds its language model).
+     */
+    void releaseIdleEngines();
+
+    /**
+     * @brief Get the version of the underlying OCR library.
+     * @return Version string, or "none" when built without one.
+     */
+    static QString engineVersion();
+
+    /**
+     * @brief Get a fingerprint of the settings that affect recognition output.
+     * Covers backend, language, engine version, resolution, preprocessing and the
+     * second pass; used as part of the OcrCache key.
+     * @return Opaque byte string; equal settings give equal fingerprints.
+     */
+    QByteArray settingsFingerprint() const;
+
 signals:
     /**
      * @brief Emitted when OCR initialization is complete.
@@ -194,6 +308,8 @@ signals:
 private:
     class Private;
     std::unique_ptr<Private> d;
+
+    static OcrEngine* s_instance;
 };
 
 } // namespace QuantilyxDoc
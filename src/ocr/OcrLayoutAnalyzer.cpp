@@ -0,0 +1,228 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "OcrLayoutAnalyzer.h"
+#include "OcrPreprocessor.h"
+#include <QRect>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr int WorkDpi = 75;          // Resolution the analysis runs at
+constexpr int MaxInkLevel = 180;     // Otsu on a nearly blank page would call paper ink
+constexpr qreal MinTextPoints = 3.0; // Component heights kept as text, in points
+constexpr qreal MaxTextPoints = 48.0;
+constexpr int RuleAspect = 20;       // Longer than this many times its thickness: a rule
+constexpr int MaxCutDepth = 32;
+
+struct Gap {
+    int size = 0;
+    int at = 0; // Cut position; boxes starting before it go first
+};
+
+// Widest gap between the projections of the boxes on one axis
+Gap widestGap(QVector<QRect>& boxes, bool alongY)
+{
+    std::sort(boxes.begin(), boxes.end(), [alongY](const QRect& a, const QRect& b) {
+        return alongY ? a.top() < b.top() : a.left() < b.left();
+    });
+    Gap best;
+    int end = alongY ? boxes.first().bottom() + 1 : boxes.first().right() + 1;
+    for (int i = 1; i < boxes.size(); ++i) {
+        const QRect& box = boxes.at(i);
+        const int start = alongY ? box.top() : box.left();
+        if (start - end > best.size) {
+            best.size = start - end;
+            best.at = start;
+        }
+        end = qMax(end, alongY ? box.bottom() + 1 : box.right() + 1);
+    }
+    return best;
+}
+
+// Recursive XY-cut: split at the widest gap relative to its threshold until none qualifies
+void xyCut(QVector<QRect> boxes, int minGapX, int minGapY, int depth, QList<QVector<QRect>>& leaves)
+{
+    if (boxes.size() > 1 && depth < MaxCutDepth) {
+        QVector<QRect> byX = boxes;
+        const Gap gapY = widestGap(boxes, true);
+        const Gap gapX = widestGap(byX, false);
+        const qreal scoreY = qreal(gapY.size) / minGapY;
+        const qreal scoreX = qreal(gapX.size) / minGapX;
+        if (scoreY >= 1.0 || scoreX >= 1.0) {
+            // Boxes are sorted along the chosen axis, so the cut is a prefix
+            const bool cutY = scoreY >= scoreX;
+            const QVector<QRect>& sorted = cutY ? boxes : byX;
+            const int at = cutY ? gapY.at : gapX.at;
+            int split = 0;
+            while (split < sorted.size() && (cutY ? sorted.at(split).top() : sorted.at(split).left()) < at) ++split;
+            xyCut(sorted.mid(0, split), minGapX, minGapY, depth + 1, leaves);
+            xyCut(sorted.mid(split), minGapX, minGapY, depth + 1, leaves);
+            return;
+        }
+    }
+    if (!boxes.isEmpty()) leaves.append(boxes);
+}
+
+int findRoot(QVector<int>& parent, int label)
+{
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]]; // Path halving
+        label = parent[label];
+    }
+    return label;
+}
+
+} // namespace
+
+QList<OcrTextBlock> OcrLayoutAnalyzer::textBlocks(const QImage& image, int dpi)
+{
+    QList<OcrTextBlock> blocks;
+    if (image.isNull()) return blocks;
+    if (dpi <= 0) dpi = 300;
+
+    // Threshold and OR-reduce to the working resolution in one pass. The
+    // factor is fractional (4/3 for the 100 DPI analysis render), so a cell
+    // covers one or two pixels per axis; the pixel-to-cell map is built once.
+    const QImage gray = OcrPreprocessor::toGrayscale(image);
+    const int inkLevel = qMin(OcrPreprocessor::otsuThreshold(gray), MaxInkLevel);
+    const qreal factor = qMax<qreal>(1.0, qreal(dpi) / WorkDpi);
+    const int w = qMax(1, qCeil(gray.width() / factor));
+    const int h = qMax(1, qCeil(gray.height() / factor));
+    QVector<int> columnCell(gray.width());
+    for (int x = 0; x < gray.width(); ++x) {
+        columnCell[x] = qMin(w - 1, int(x / factor));
+    }
+    QVector<quint8> mask(w * h, 0);
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar* row = gray.constScanLine(y);
+        quint8* cells = mask.data() + qMin(h - 1, int(y / factor)) * w;
+        for (int x = 0; x < gray.width(); ++x) {
+            if (row[x] <= inkLevel) cells[columnCell.at(x)] = 1;
+        }
+    }
+
+    const QVector<QRect> components = connectedComponents(mask, w, h, 3);
+
+    // Keep components sized like text
+    const qreal cellsPerPoint = dpi / factor / 72.0;
+    const int minHeight = qMax(2, qRound(MinTextPoints * cellsPerPoint));
+    const int maxHeight = qRound(MaxTextPoints * cellsPerPoint);
+    QVector<QRect> text;
+    QVector<int> heights;
+    for (const QRect& box : components) {
+        if (box.height() < minHeight || box.height() > maxHeight) continue;
+        if (box.width() >= RuleAspect * box.height()) continue;
+        text.append(box);
+        heights.append(box.height());
+    }
+    if (text.isEmpty()) return blocks;
+
+    // Thresholds follow the typical text height: lines of a paragraph stay
+    // together, paragraphs and columns are cut apart
+    std::nth_element(heights.begin(), heights.begin() + heights.size() / 2, heights.end());
+    const int medianHeight = heights.at(heights.size() / 2);
+    QList<QVector<QRect>> leaves;
+    xyCut(text, qMax(2, medianHeight * 2), qMax(2, medianHeight * 3 / 2), 0, leaves);
+
+    const qreal margin = qMax(1, medianHeight / 2) * factor;
+    const QRectF imageRect = image.rect();
+    for (const QVector<QRect>& leaf : leaves) {
+        OcrTextBlock block;
+        QRect united;
+        for (const QRect& part : leaf) {
+            united = united.united(part);
+            block.parts.append(QRectF(part.x() * factor, part.y() * factor,
+                                      part.width() * factor, part.height() * factor).intersected(imageRect));
+        }
+        block.box = QRectF(united.x() * factor, united.y() * factor, united.width() * factor, united.height() * factor)
+                        .adjusted(-margin, -margin, margin, margin)
+                        .intersected(imageRect);
+        blocks.append(block);
+    }
+    return blocks;
+}
+
+QVector<QRect> OcrLayoutAnalyzer::connectedComponents(const QVector<quint8>& mask, int w, int h, int minCells)
+{
+    // Two-pass 8-connected labelling with union-find
+    QVector<int> labels(w * h, 0);
+    QVector<int> parent(1, 0);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (!mask[y * w + x]) continue;
+            int neighbours[4];
+            int count = 0;
+            if (x > 0 && labels[y * w + x - 1]) neighbours[count++] = labels[y * w + x - 1];
+            if (y > 0) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int nx = x + dx;
+                    if (nx >= 0 && nx < w && labels[(y - 1) * w + nx]) neighbours[count++] = labels[(y - 1) * w + nx];
+                }
+            }
+            if (count == 0) {
+                labels[y * w + x] = parent.size();
+                parent.append(parent.size());
+                continue;
+            }
+            int root = findRoot(parent, neighbours[0]);
+            for (int i = 1; i < count; ++i) {
+                const int other = findRoot(parent, neighbours[i]);
+                if (other != root) {
+                    const int low = qMin(root, other);
+                    parent[qMax(root, other)] = low;
+                    root = low;
+                }
+            }
+            labels[y * w + x] = root;
+        }
+    }
+
+    QVector<QRect> bounds(parent.size());
+    QVector<int> cellCounts(parent.size(), 0);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const int label = labels[y * w + x];
+            if (!label) continue;
+            const int root = findRoot(parent, label);
+            bounds[root] = bounds[root].isNull() ? QRect(x, y, 1, 1) : bounds[root].united(QRect(x, y, 1, 1));
+            ++cellCounts[root];
+        }
+    }
+
+    QVector<QRect> components;
+    for (int label = 1; label < parent.size(); ++label) {
+        if (parent.at(label) == label && cellCounts.at(label) >= minCells) components.append(bounds.at(label));
+    }
+    return components;
+}
+
+qreal OcrLayoutAnalyzer::coverage(const OcrTextBlock& block, const QList<QRectF>& textBoxes)
+{
+    qreal total = 0.0;
+    qreal covered = 0.0;
+    for (const QRectF& part : block.parts) {
+        const qreal area = part.width() * part.height();
+        total += area;
+        const QPointF center = part.center();
+        for (const QRectF& box : textBoxes) {
+            if (box.contains(center)) {
+                covered += area;
+                break;
+            }
+        }
+    }
+    return total > 0.0 ? covered / total : 1.0;
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,74 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_OCRLAYOUTANALYZER_H
+#define QUANTILYX_OCRLAYOUTANALYZER_H
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+#include <QVector>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief A block of text found on a page image.
+ */
+struct OcrTextBlock {
+    QRectF box;            // Block bounds in image pixels, with a small margin
+    QList<QRectF> parts;   // Text-like connected components inside it, in image pixels
+};
+
+/**
+ * @brief Cheap layout analysis used to decide what a page needs OCR for.
+ *
+ * The page is thresholded and reduced to about 75 DPI (a cell is ink if any
+ * of its pixels is), which merges the letters of a word into one connected
+ * component and a halftone photo into one large blob. Components are
+ * labelled with a two-pass union-find; those sized like words or characters
+ * are kept, while photos, rules and specks are dropped. A recursive XY-cut
+ * over the kept components then splits the page at the widest whitespace
+ * gaps into columns and paragraphs, in reading order.
+ *
+ * Stateless; safe to use from several threads.
+ */
+class OcrLayoutAnalyzer
+{
+public:
+    /**
+     * @brief Find the text blocks of a page image.
+     * @param image Page image, any format.
+     * @param dpi Resolution of the image.
+     * @return Blocks in reading order; empty for a blank or picture-only page.
+     */
+    static QList<OcrTextBlock> textBlocks(const QImage& image, int dpi);
+
+    /**
+     * @brief Measure how much of a block an existing text layer accounts for.
+     * @param block A block from textBlocks().
+     * @param textBoxes Word or line boxes of the text layer, in the same pixels.
+     * @return Share of the block's component area (0.0 to 1.0) whose centers fall in a text box.
+     */
+    static qreal coverage(const OcrTextBlock& block, const QList<QRectF>& textBoxes);
+
+    /**
+     * @brief Find the 8-connected components of a binary mask.
+     * @param mask Row-major cells, non-zero for set cells.
+     * @param width Mask width.
+     * @param height Mask height.
+     * @param minCells Components with fewer set cells are dropped.
+     * @return Component bounds in cells, in order of their first cell.
+     */
+    static QVector<QRect> connectedComponents(const QVector<quint8>& mask, int width, int height, int minCells = 1);
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_OCRLAYOUTANALYZER_H
@@ -9,15 +9,19 @@
  */
 #include "OcrPage.h"
 #include "OcrEngine.h"
+#include "OcrCache.h"
+#include "OcrRefiner.h"
 #include "../core/Document.h"
 #include "../core/Page.h"
 #include "../core/Logger.h"
+#include "../core/ThreadPool.h"
+#include "../formats/pdf/PdfPage.h"
 #include <QImage>
 #include <QRectF>
 #include <QPair>
 #include <QList>
 #include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+#include <QFutureInterface>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QDebug>
@@ -26,7 +30,7 @@ namespace QuantilyxDoc {
 
 class OcrPage::Private {
 public:
-    Private(Document* doc, Page* p) : document(doc), page(p), processed(false), avgConfidence(0.0f) {}
+    Private(Document* doc, Page* p) : document(doc), page(p), processed(false), avgConfidence(0.0f), imageScale(1.0) {}
 
     Document* document;
     Page* page;
@@ -35,7 +39,51 @@ public:
     QList<QPair<QString, QRectF>> elements;
     QList<float> confidences;
     float avgConfidence;
+    qreal imageScale; // Page points per pixel of the image given to the engine
     mutable QMutex mutex; // Protect access to the stored OCR data
+
+    // Render the page at the OCR resolution and record the pixel-to-point scale
+    QImage render(int dpi) {
+        if (!page) return QImage();
+        const QSizeF pageSize = page->size(); // Points
+        const int width = qRound(pageSize.width() * dpi / 72.0);
+        const int height = qRound(pageSize.height() * dpi / 72.0);
+        QImage image = page->render(width, height, dpi);
+        if (!image.isNull()) {
+            // Lets the engine's preprocessing know no rescale is needed
+            image.setDotsPerMeterX(qRound(dpi / 0.0254));
+            image.setDotsPerMeterY(qRound(dpi / 0.0254));
+            QMutexLocker locker(&mutex);
+            imageScale = pageSize.width() / image.width();
+        }
+        return image;
+    }
+
+    // Render part of the page for the second pass. Only PDF pages can
+    // rasterize a region; others render the whole page once per pass.
+    QImage renderRegion(const QRectF& points, int dpi, QImage& fullPage) {
+        if (auto* pdfPage = qobject_cast<PdfPage*>(page)) {
+            return pdfPage->renderRegion(points, dpi);
+        }
+        if (fullPage.isNull() && page) {
+            const QSizeF pageSize = page->size();
+            fullPage = page->render(qRound(pageSize.width() * dpi / 72.0), qRound(pageSize.height() * dpi / 72.0), dpi);
+        }
+        return fullPage.copy(QRectF(points.x() * dpi / 72.0, points.y() * dpi / 72.0,
+                                    points.width() * dpi / 72.0, points.height() * dpi / 72.0).toAlignedRect());
+    }
+
+    // Second pass over the low-confidence lines of a result whose word boxes
+    // are in pixels of an image at dpi, placed at origin (pixels) on the page
+    void refine(OcrResult& result, const QSize& imageSize, int dpi, const QPointF& origin = QPointF()) {
+        QImage fullPage;
+        OcrRefiner().refine(result, imageSize, dpi, [this, dpi, origin, &fullPage](const QRectF& rect, int refineDpi) {
+            const QRectF pixels = rect.translated(origin);
+            const QRectF points(pixels.x() * 72.0 / dpi, pixels.y() * 72.0 / dpi,
+                                pixels.width() * 72.0 / dpi, pixels.height() * 72.0 / dpi);
+            return renderRegion(points, refineDpi, fullPage);
+        });
+    }
 };
 
 OcrPage::OcrPage(Document* document, Page* page, QObject* parent)
@@ -105,43 +153,155 @@ bool OcrPage::performOcr(bool force)
 
     emit ocrStarted();
 
-    // Get the page image from the Page object
-    // This might involve rendering the page at a high resolution.
-    int dpi = OcrEngine::instance().resolution(); // Use engine's resolution setting
-    // Assume Page::render(width, height, dpi) exists and returns a QImage
-    // QImage pageImage = d->page->render(0, 0, dpi); // 0, 0 means render entire page
-    QImage pageImage; // Placeholder
+    OcrEngine& engine = OcrEngine::instance();
+    OcrCache& cache = OcrCache::instance();
+    const QByteArray settings = engine.settingsFingerprint();
+    const QSizeF pageSize = d->page ? d->page->size() : QSizeF(); // Points
 
+    // A page of an unchanged file is found without rendering it
+    QByteArray pageKey;
+    if (d->document && d->page) {
+        pageKey = OcrCache::pageKey(d->document->filePath(), d->page->pageIndex(), settings);
+    }
+    OcrCache::Entry cached;
+    if (cache.lookupPage(pageKey, cached) && cached.imageSize.width() > 0) {
+        {
+            QMutexLocker locker(&d->mutex);
+            d->imageScale = pageSize.width() / cached.imageSize.width();
+        }
+        finishOcr(cached.result);
+        LOG_DEBUG("OcrPage::performOcr: Page result served from cache.");
+        return true;
+    }
+
+    // Render the page at the engine's resolution
+    const int dpi = engine.resolution();
+    const QImage pageImage = d->render(dpi);
     if (pageImage.isNull()) {
         LOG_ERROR("OcrPage::performOcr: Failed to render page image for OCR.");
         emit ocrFailed("Could not render page image.");
         return false;
     }
 
-    // Perform OCR using the engine
-    OcrResult result = OcrEngine::instance().recognizeDetailed(pageImage);
+    // Identical renders (e.g. the same scan in another file) share a result
+    const QByteArray imageKey = OcrCache::imageKey(pageImage, settings);
+    if (cache.lookup(imageKey, cached)) {
+        if (!pageKey.isEmpty()) cache.store(imageKey, cached, pageKey);
+        finishOcr(cached.result);
+        LOG_DEBUG("OcrPage::performOcr: Image result served from cache.");
+        return true;
+    }
+
+    // Perform OCR using the engine, then again at a higher resolution for unsure lines
+    OcrResult result = engine.recognizeDetailed(pageImage);
+    if (!result.ok) {
+        LOG_ERROR("OcrPage::performOcr: Recognition failed: " << result.error);
+        emit ocrFailed(result.error);
+        return false;
+    }
+    d->refine(result, pageImage.size(), dpi);
+
+    if (result.words.isEmpty()) {
+        LOG_DEBUG("OcrPage::performOcr: OCR found no text on page.");
+    }
+    // Cached even when empty: recognition completed, and a blank page costs
+    // a full recognition every session otherwise
+    cache.store(imageKey, OcrCache::Entry{result, pageImage.size()}, pageKey);
+
+    finishOcr(result);
+    LOG_DEBUG("OcrPage::performOcr: Completed OCR for page, text length: " << result.text.length());
+    return true;
+}
+
+bool OcrPage::performRegionOcr(const QList<QRectF>& regions)
+{
+    if (!OcrEngine::instance().isReady()) {
+        LOG_ERROR("OcrPage::performRegionOcr: OcrEngine is not ready.");
+        emit ocrFailed("OCR Engine not initialized.");
+        return false;
+    }
+
+    emit ocrStarted();
+
+    OcrEngine& engine = OcrEngine::instance();
+    OcrCache& cache = OcrCache::instance();
+    const QByteArray settings = engine.settingsFingerprint();
+    const int dpi = engine.resolution();
+    const QImage pageImage = d->render(dpi);
+    if (pageImage.isNull()) {
+        LOG_ERROR("OcrPage::performRegionOcr: Failed to render page image for OCR.");
+        emit ocrFailed("Could not render page image.");
+        return false;
+    }
+
+    // Word boxes of all regions, in pixels of the full page image
+    OcrResult merged;
+    merged.language = engine.currentLanguage();
+    QStringList texts;
+    qreal confidenceSum = 0.0;
+    for (const QRectF& region : regions) {
+        const QRect pixels = QRectF(region.x() * dpi / 72.0, region.y() * dpi / 72.0,
+                                    region.width() * dpi / 72.0, region.height() * dpi / 72.0)
+                                 .toAlignedRect().intersected(pageImage.rect());
+        if (pixels.isEmpty()) continue;
+
+        // Crops are cached like pages; the key covers only the pixels recognized
+        QImage crop = pageImage.copy(pixels);
+        crop.setDotsPerMeterX(pageImage.dotsPerMeterX());
+        crop.setDotsPerMeterY(pageImage.dotsPerMeterY());
+        const QByteArray key = OcrCache::imageKey(crop, settings);
+        OcrCache::Entry entry;
+        if (!cache.lookup(key, entry)) {
+            entry.result = engine.recognizeDetailed(crop);
+            entry.imageSize = crop.size();
+            if (!entry.result.ok) {
+                LOG_WARN("OcrPage::performRegionOcr: Recognition of " << region << " failed: " << entry.result.error);
+                continue;
+            }
+            d->refine(entry.result, crop.size(), dpi, pixels.topLeft());
+            cache.store(key, entry);
+        }
 
-    if (result.text.isEmpty()) {
-        LOG_WARN("OcrPage::performOcr: OCR returned no text for page.");
-        // Still consider it processed, even if no text was found.
+        for (OcrWord word : entry.result.words) {
+            word.box.translate(pixels.topLeft());
+            merged.words.append(word);
+            merged.boundingBoxes.append(word.box);
+            confidenceSum += word.confidence;
+        }
+        if (!entry.result.text.trimmed().isEmpty()) {
+            texts.append(entry.result.text.trimmed());
+        }
     }
+    merged.text = texts.join("\n\n");
+    merged.confidence = merged.words.isEmpty() ? 0.0f : float(confidenceSum / merged.words.size());
+    merged.ok = true;
+
+    finishOcr(merged);
+    LOG_DEBUG("OcrPage::performRegionOcr: Recognized " << regions.size() << " regions, " << merged.words.size() << " words.");
+    return true;
+}
 
-    // Store the results
+void OcrPage::finishOcr(const OcrResult& result)
+{
     storeOcrResults(result);
 
     emit ocrFinished();
     emit textChanged(); // Notify that text content has changed/updated
-    LOG_DEBUG("OcrPage::performOcr: Completed OCR for page, text length: " << result.text.length());
-    return true;
 }
 
 QFuture<bool> OcrPage::performOcrAsync(bool force)
 {
-    // Use QtConcurrent to run performOcr in a separate thread
+    // Run on the project thread pool; pages of a book are recognized in
+    // parallel, each with its own engine instance.
     // This emits signals from the worker thread, so UI should connect with Qt::QueuedConnection.
-    return QtConcurrent::run([this, force]() {
-        return this->performOcr(force);
-    });
+    QFutureInterface<bool> promise;
+    promise.reportStarted();
+    QFuture<bool> future = promise.future();
+    ThreadPool::instance().submitTask([this, force, promise]() mutable {
+        promise.reportResult(performOcr(force));
+        promise.reportFinished();
+    }, QStringLiteral("OCR page"));
+    return future;
 }
 
 QList<QRectF> OcrPage::searchText(const QString& searchText, bool caseSensitive, bool wholeWords) const
@@ -259,11 +419,16 @@ void OcrPage::storeOcrResults(const OcrResult& result)
     d->elements.clear();
     d->confidences.clear();
 
-    // This is a simplification. OcrResult.boundingBoxes and OcrResult.text need to be mapped correctly.
-    // Tesseract's HOCR output provides structured text with bounding boxes for words/phrases/lines.
-    // Parsing HOCR or the detailed box output is needed to populate elements correctly.
-    // For now, assume result.text is a single element (which is often not the case).
-    if (!result.text.isEmpty()) {
+    if (!result.words.isEmpty()) {
+        // One element per word, with boxes mapped from image pixels to page points
+        const qreal scale = d->imageScale;
+        for (const OcrWord& word : result.words) {
+            const QRectF box(word.box.x() * scale, word.box.y() * scale,
+                             word.box.width() * scale, word.box.height() * scale);
+            d->elements.append(qMakePair(word.text, box));
+            d->confidences.append(word.confidence);
+        }
+    } else if (!result.text.isEmpty()) {
         QRectF pageRect; // Need page dimensions to map relative box coordinates if needed
         if (d->page) {
             // pageRect = QRectF(QPointF(0, 0), d->page->size()); // Assuming Page::size() returns QSizeF
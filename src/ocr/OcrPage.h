@@ -96,6 +96,16 @@ public:
      */
     bool performOcr(bool force = false);
 
+    /**
+     * @brief Perform OCR on parts of the page only.
+     * Each region is cropped from the rendered page and recognized on its
+     * own, so the engine never sees the rest of the page. Used for pages
+     * that already have a text layer except for a few blocks.
+     * @param regions Regions in page points (top-left origin).
+     * @return True if OCR was successful.
+     */
+    bool performRegionOcr(const QList<QRectF>& regions);
+
     /**
      * @brief Perform OCR on the page's content asynchronously.
      * @param force If true, re-perform OCR even if already processed.
@@ -165,6 +175,9 @@ private:
 
     // Helper to store OCR results internally
     void storeOcrResults(const OcrResult& result);
+
+    // Store a result (fresh or cached) and emit the completion signals
+    void finishOcr(const OcrResult& result);
 };
 
 } // namespace QuantilyxDoc
@@ -0,0 +1,685 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "OcrPreprocessor.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <QtMath>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define QUANTILYX_X86_SIMD 1
+#include <immintrin.h>
+#define QUANTILYX_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define QUANTILYX_X86_SIMD 1
+#include <intrin.h>
+#include <immintrin.h>
+#define QUANTILYX_TARGET_AVX2
+#endif
+
+namespace QuantilyxDoc {
+
+using Kernel = OcrPreprocessOptions::Kernel;
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Row kernels. Each SIMD variant handles the bulk of the row and leaves the
+// tail to the scalar one, so all variants produce identical output.
+// ---------------------------------------------------------------------------
+
+inline uchar lumaOf(quint32 p)
+{
+    return uchar((((p >> 16) & 0xff) * 77 + ((p >> 8) & 0xff) * 150 + (p & 0xff) * 29) >> 8);
+}
+
+void grayRowScalar(const quint32* src, uchar* dst, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        dst[i] = lumaOf(src[i]);
+    }
+}
+
+void thresholdRowScalar(const uchar* src, uchar* dst, int n, int t)
+{
+    for (int i = 0; i < n; ++i) {
+        dst[i] = src[i] > t ? 255 : 0;
+    }
+}
+
+// Window column sums for Sauvola: add (or remove) one image row
+void accumulateRowScalar(quint32* sum, quint32* sq, const uchar* row, int n, bool subtract)
+{
+    if (subtract) {
+        for (int i = 0; i < n; ++i) {
+            sum[i] -= row[i];
+            sq[i] -= quint32(row[i]) * row[i];
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            sum[i] += row[i];
+            sq[i] += quint32(row[i]) * row[i];
+        }
+    }
+}
+
+// A dark pixel with at most one dark 8-neighbour becomes white. Rows outside
+// the image are passed as nullptr and count as white.
+inline bool isDark(const uchar* row, int x, int n)
+{
+    return row && x >= 0 && x < n && row[x] == 0;
+}
+
+void despeckleRangeScalar(const uchar* up, const uchar* cur, const uchar* down, uchar* dst, int from, int to, int n)
+{
+    for (int x = from; x < to; ++x) {
+        if (cur[x] != 0) {
+            dst[x] = cur[x];
+            continue;
+        }
+        const int neighbours = isDark(up, x - 1, n) + isDark(up, x, n) + isDark(up, x + 1, n)
+                             + isDark(cur, x - 1, n) + isDark(cur, x + 1, n)
+                             + isDark(down, x - 1, n) + isDark(down, x, n) + isDark(down, x + 1, n);
+        dst[x] = neighbours <= 1 ? 255 : 0;
+    }
+}
+
+#ifdef QUANTILYX_X86_SIMD
+
+void grayRowSse2(const quint32* src, uchar* dst, int n)
+{
+    // Channels are isolated into 32-bit lanes; madd_epi16 against [w, 0]
+    // pairs multiplies them by their weight without SSE4.1's mullo_epi32.
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i wr = _mm_set1_epi32(77);
+    const __m128i wg = _mm_set1_epi32(150);
+    const __m128i wb = _mm_set1_epi32(29);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i b = _mm_and_si128(px, mask);
+        const __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+        const __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+        __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, wr), _mm_madd_epi16(g, wg)), _mm_madd_epi16(b, wb));
+        sum = _mm_srli_epi32(sum, 8);
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sum, sum), _mm_setzero_si128());
+        const int bytes = _mm_cvtsi128_si32(packed);
+        std::memcpy(dst + i, &bytes, 4);
+    }
+    grayRowScalar(src + i, dst + i, n - i);
+}
+
+void thresholdRowSse2(const uchar* src, uchar* dst, int n, int t)
+{
+    // Unsigned "v > t" as max(v, t + 1) == v; t == 255 never gets here
+    const __m128i limit = _mm_set1_epi8(char(t + 1));
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cmpeq_epi8(_mm_max_epu8(v, limit), v));
+    }
+    thresholdRowScalar(src + i, dst + i, n - i, t);
+}
+
+void accumulateRowSse2(quint32* sum, quint32* sq, const uchar* row, int n, bool subtract)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        // 255^2 fits in 16 unsigned bits, so the low half of the product is exact
+        const __m128i lo2 = _mm_mullo_epi16(lo, lo);
+        const __m128i hi2 = _mm_mullo_epi16(hi, hi);
+        const __m128i values[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                    _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+        const __m128i squares[4] = { _mm_unpacklo_epi16(lo2, zero), _mm_unpackhi_epi16(lo2, zero),
+                                     _mm_unpacklo_epi16(hi2, zero), _mm_unpackhi_epi16(hi2, zero) };
+        for (int k = 0; k < 4; ++k) {
+            __m128i* s = reinterpret_cast<__m128i*>(sum + i + 4 * k);
+            __m128i* q = reinterpret_cast<__m128i*>(sq + i + 4 * k);
+            const __m128i sv = _mm_loadu_si128(s);
+            const __m128i qv = _mm_loadu_si128(q);
+            _mm_storeu_si128(s, subtract ? _mm_sub_epi32(sv, values[k]) : _mm_add_epi32(sv, values[k]));
+            _mm_storeu_si128(q, subtract ? _mm_sub_epi32(qv, squares[k]) : _mm_add_epi32(qv, squares[k]));
+        }
+    }
+    accumulateRowScalar(sum + i, sq + i, row + i, n - i, subtract);
+}
+
+void despeckleRowSse2(const uchar* up, const uchar* cur, const uchar* down, uchar* dst, int n)
+{
+    // Border columns and rows are left to the scalar code
+    if (!up || !down || n < 18) {
+        despeckleRangeScalar(up, cur, down, dst, 0, n, n);
+        return;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    auto dark = [&](const uchar* p) {
+        return _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), zero);
+    };
+    despeckleRangeScalar(up, cur, down, dst, 0, 1, n);
+    int x = 1;
+    for (; x + 17 <= n; x += 16) {
+        // Each dark mask byte is -1, so the sum is minus the neighbour count
+        __m128i count = _mm_add_epi8(_mm_add_epi8(dark(up + x - 1), dark(up + x)), dark(up + x + 1));
+        count = _mm_add_epi8(count, _mm_add_epi8(dark(cur + x - 1), dark(cur + x + 1)));
+        count = _mm_add_epi8(count, _mm_add_epi8(_mm_add_epi8(dark(down + x - 1), dark(down + x)), dark(down + x + 1)));
+        count = _mm_sub_epi8(zero, count);
+        const __m128i centre = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + x));
+        const __m128i isolated = _mm_andnot_si128(_mm_cmpgt_epi8(count, one), _mm_cmpeq_epi8(centre, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_or_si128(centre, isolated));
+    }
+    despeckleRangeScalar(up, cur, down, dst, x, n, n);
+}
+
+QUANTILYX_TARGET_AVX2
+void grayRowAvx2(const quint32* src, uchar* dst, int n)
+{
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    const __m256i wr = _mm256_set1_epi32(77);
+    const __m256i wg = _mm256_set1_epi32(150);
+    const __m256i wb = _mm256_set1_epi32(29);
+    // Gathers the low dword of each 128-bit lane after packing
+    const __m256i gather = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i b = _mm256_and_si256(px, mask);
+        const __m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+        const __m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+        __m256i sum = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(r, wr), _mm256_madd_epi16(g, wg)),
+                                       _mm256_madd_epi16(b, wb));
+        sum = _mm256_srli_epi32(sum, 8);
+        const __m256i words = _mm256_packs_epi32(sum, sum);
+        const __m256i bytes = _mm256_packus_epi16(words, words);
+        const __m256i packed = _mm256_permutevar8x32_epi32(bytes, gather);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+    }
+    grayRowScalar(src + i, dst + i, n - i);
+}
+
+QUANTILYX_TARGET_AVX2
+void thresholdRowAvx2(const uchar* src, uchar* dst, int n, int t)
+{
+    const __m256i limit = _mm256_set1_epi8(char(t + 1));
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), v));
+    }
+    thresholdRowScalar(src + i, dst + i, n - i, t);
+}
+
+QUANTILYX_TARGET_AVX2
+void accumulateRowAvx2(quint32* sum, quint32* sq, const uchar* row, int n, bool subtract)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + i)));
+        const __m256i v2 = _mm256_mullo_epi32(v, v);
+        __m256i* s = reinterpret_cast<__m256i*>(sum + i);
+        __m256i* q = reinterpret_cast<__m256i*>(sq + i);
+        const __m256i sv = _mm256_loadu_si256(s);
+        const __m256i qv = _mm256_loadu_si256(q);
+        _mm256_storeu_si256(s, subtract ? _mm256_sub_epi32(sv, v) : _mm256_add_epi32(sv, v));
+        _mm256_storeu_si256(q, subtract ? _mm256_sub_epi32(qv, v2) : _mm256_add_epi32(qv, v2));
+    }
+    accumulateRowScalar(sum + i, sq + i, row + i, n - i, subtract);
+}
+
+QUANTILYX_TARGET_AVX2
+inline __m256i darkMaskAvx2(const uchar* p)
+{
+    return _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_setzero_si256());
+}
+
+QUANTILYX_TARGET_AVX2
+void despeckleRowAvx2(const uchar* up, const uchar* cur, const uchar* down, uchar* dst, int n)
+{
+    if (!up || !down || n < 34) {
+        despeckleRangeScalar(up, cur, down, dst, 0, n, n);
+        return;
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    despeckleRangeScalar(up, cur, down, dst, 0, 1, n);
+    int x = 1;
+    for (; x + 33 <= n; x += 32) {
+        __m256i count = _mm256_add_epi8(_mm256_add_epi8(darkMaskAvx2(up + x - 1), darkMaskAvx2(up + x)), darkMaskAvx2(up + x + 1));
+        count = _mm256_add_epi8(count, _mm256_add_epi8(darkMaskAvx2(cur + x - 1), darkMaskAvx2(cur + x + 1)));
+        count = _mm256_add_epi8(count, _mm256_add_epi8(_mm256_add_epi8(darkMaskAvx2(down + x - 1), darkMaskAvx2(down + x)), darkMaskAvx2(down + x + 1)));
+        count = _mm256_sub_epi8(zero, count);
+        const __m256i centre = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + x));
+        const __m256i isolated = _mm256_andnot_si256(_mm256_cmpgt_epi8(count, one), _mm256_cmpeq_epi8(centre, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_or_si256(centre, isolated));
+    }
+    despeckleRangeScalar(up, cur, down, dst, x, n, n);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__)
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#endif
+}
+
+#endif // QUANTILYX_X86_SIMD
+
+Kernel resolve(Kernel kernel)
+{
+    const Kernel best = OcrPreprocessor::bestKernel();
+    if (kernel == Kernel::Auto) return best;
+    // A forced kernel the CPU cannot run falls back to the best one
+    return int(kernel) <= int(best) ? kernel : best;
+}
+
+void grayRow(Kernel kernel, const quint32* src, uchar* dst, int n)
+{
+#ifdef QUANTILYX_X86_SIMD
+    if (kernel == Kernel::Avx2) return grayRowAvx2(src, dst, n);
+    if (kernel == Kernel::Sse2) return grayRowSse2(src, dst, n);
+#endif
+    Q_UNUSED(kernel);
+    grayRowScalar(src, dst, n);
+}
+
+void thresholdRow(Kernel kernel, const uchar* src, uchar* dst, int n, int t)
+{
+#ifdef QUANTILYX_X86_SIMD
+    if (t < 255) {
+        if (kernel == Kernel::Avx2) return thresholdRowAvx2(src, dst, n, t);
+        if (kernel == Kernel::Sse2) return thresholdRowSse2(src, dst, n, t);
+    }
+#endif
+    Q_UNUSED(kernel);
+    thresholdRowScalar(src, dst, n, t);
+}
+
+void accumulateRow(Kernel kernel, quint32* sum, quint32* sq, const uchar* row, int n, bool subtract)
+{
+#ifdef QUANTILYX_X86_SIMD
+    if (kernel == Kernel::Avx2) return accumulateRowAvx2(sum, sq, row, n, subtract);
+    if (kernel == Kernel::Sse2) return accumulateRowSse2(sum, sq, row, n, subtract);
+#endif
+    Q_UNUSED(kernel);
+    accumulateRowScalar(sum, sq, row, n, subtract);
+}
+
+void despeckleRow(Kernel kernel, const uchar* up, const uchar* cur, const uchar* down, uchar* dst, int n)
+{
+#ifdef QUANTILYX_X86_SIMD
+    if (kernel == Kernel::Avx2) return despeckleRowAvx2(up, cur, down, dst, n);
+    if (kernel == Kernel::Sse2) return despeckleRowSse2(up, cur, down, dst, n);
+#endif
+    Q_UNUSED(kernel);
+    despeckleRangeScalar(up, cur, down, dst, 0, n, n);
+}
+
+// Projection-profile score of dark points sheared by an angle: sharp line
+// profiles (text lines aligned with rows) give large adjacent differences
+double profileScore(const QVector<QPoint>& points, int width, int height, qreal degrees, QVector<int>& bins)
+{
+    const qreal slope = qTan(qDegreesToRadians(degrees));
+    const int margin = int(std::ceil(qAbs(slope) * width)) + 2;
+    bins.fill(0, height + 2 * margin);
+    for (const QPoint& p : points) {
+        const int y = qRound(p.y() - p.x() * slope) + margin;
+        if (y >= 0 && y < bins.size()) ++bins[y];
+    }
+    double score = 0;
+    for (int i = 1; i < bins.size(); ++i) {
+        const double diff = bins[i] - bins[i - 1];
+        score += diff * diff;
+    }
+    return score;
+}
+
+} // namespace
+
+OcrPreprocessor::OcrPreprocessor(const OcrPreprocessOptions& options)
+    : m_options(options)
+{
+}
+
+OcrPreprocessOptions OcrPreprocessor::options() const
+{
+    return m_options;
+}
+
+void OcrPreprocessor::setOptions(const OcrPreprocessOptions& options)
+{
+    m_options = options;
+}
+
+QImage OcrPreprocessor::process(const QImage& image, int sourceDpi, OcrPreprocessStats* stats) const
+{
+    OcrPreprocessStats local;
+    OcrPreprocessStats& s = stats ? *stats : local;
+    s = OcrPreprocessStats();
+    const Kernel kernel = resolve(m_options.kernel);
+    s.kernel = kernelName(kernel);
+    if (image.isNull()) return QImage();
+
+    QElapsedTimer timer;
+    timer.start();
+    QImage gray = toGrayscale(image, kernel);
+    s.grayscaleNs = timer.nsecsElapsed();
+    if (!m_options.enabled) return gray;
+
+    // Rescale first so the remaining stages work at the resolution Tesseract sees
+    timer.restart();
+    if (m_options.targetDpi > 0 && sourceDpi > 0) {
+        const qreal factor = qBound(0.25, qreal(m_options.targetDpi) / sourceDpi, 4.0);
+        if (qAbs(factor - 1.0) > 0.1) {
+            const QSize size(qMax(1, qRound(gray.width() * factor)), qMax(1, qRound(gray.height() * factor)));
+            s.transform.scale(qreal(size.width()) / gray.width(), qreal(size.height()) / gray.height());
+            gray = gray.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                       .convertToFormat(QImage::Format_Grayscale8);
+        }
+    }
+    s.rescaleNs = timer.nsecsElapsed();
+
+    timer.restart();
+    if (m_options.deskew && m_options.maxSkewDegrees > 0) {
+        s.skewDegrees = detectSkew(gray, m_options.maxSkewDegrees);
+        if (qAbs(s.skewDegrees) >= 0.1) {
+            gray = rotate(gray, s.skewDegrees);
+            const QPointF centre(gray.width() / 2.0, gray.height() / 2.0);
+            QTransform rotation;
+            rotation.translate(centre.x(), centre.y());
+            rotation.rotate(-s.skewDegrees);
+            rotation.translate(-centre.x(), -centre.y());
+            s.transform = s.transform * rotation;
+        } else {
+            s.skewDegrees = 0.0;
+        }
+    }
+    s.deskewNs = timer.nsecsElapsed();
+
+    timer.restart();
+    switch (m_options.binarization) {
+    case OcrPreprocessOptions::Binarization::Otsu:
+        s.threshold = otsuThreshold(gray);
+        gray = threshold(gray, s.threshold, kernel);
+        break;
+    case OcrPreprocessOptions::Binarization::Sauvola:
+        gray = sauvola(gray, m_options.sauvolaRadius, m_options.sauvolaK, kernel);
+        break;
+    case OcrPreprocessOptions::Binarization::None:
+        break;
+    }
+    s.binarizeNs = timer.nsecsElapsed();
+
+    timer.restart();
+    if (m_options.despeckle && m_options.binarization != OcrPreprocessOptions::Binarization::None) {
+        gray = despeckle(gray, kernel);
+    }
+    s.despeckleNs = timer.nsecsElapsed();
+    return gray;
+}
+
+QImage OcrPreprocessor::toGrayscale(const QImage& image, Kernel kernel)
+{
+    if (image.isNull()) return QImage();
+    if (image.format() == QImage::Format_Grayscale8) return image;
+
+    kernel = resolve(kernel);
+    const QImage rgb = (image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32)
+                     ? image : image.convertToFormat(QImage::Format_RGB32);
+    QImage gray(rgb.size(), QImage::Format_Grayscale8);
+    if (gray.isNull()) return QImage();
+    gray.setDotsPerMeterX(image.dotsPerMeterX());
+    gray.setDotsPerMeterY(image.dotsPerMeterY());
+    for (int y = 0; y < rgb.height(); ++y) {
+        grayRow(kernel, reinterpret_cast<const quint32*>(rgb.constScanLine(y)), gray.scanLine(y), rgb.width());
+    }
+    return gray;
+}
+
+int OcrPreprocessor::otsuThreshold(const QImage& gray)
+{
+    if (gray.isNull()) return 127;
+
+    // Four interleaved histograms avoid store-to-load stalls on runs of equal pixels
+    quint32 hist[4][256] = {};
+    for (int y = 0; y < gray.height(); ++y) {
+        const uchar* row = gray.constScanLine(y);
+        int x = 0;
+        for (; x + 4 <= gray.width(); x += 4) {
+            ++hist[0][row[x]];
+            ++hist[1][row[x + 1]];
+            ++hist[2][row[x + 2]];
+            ++hist[3][row[x + 3]];
+        }
+        for (; x < gray.width(); ++x) {
+            ++hist[0][row[x]];
+        }
+    }
+
+    double total = 0, weightedTotal = 0;
+    double histogram[256];
+    for (int i = 0; i < 256; ++i) {
+        histogram[i] = double(hist[0][i]) + hist[1][i] + hist[2][i] + hist[3][i];
+        total += histogram[i];
+        weightedTotal += i * histogram[i];
+    }
+
+    double background = 0, weightedBackground = 0, bestVariance = -1;
+    int best = 127;
+    for (int t = 0; t < 256; ++t) {
+        background += histogram[t];
+        if (background == 0) continue;
+        const double foreground = total - background;
+        if (foreground == 0) break;
+        weightedBackground += t * histogram[t];
+        const double meanBackground = weightedBackground / background;
+        const double meanForeground = (weightedTotal - weightedBackground) / foreground;
+        const double variance = background * foreground * (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            best = t;
+        }
+    }
+    return best;
+}
+
+QImage OcrPreprocessor::threshold(const QImage& gray, int threshold, Kernel kernel)
+{
+    if (gray.isNull()) return QImage();
+    kernel = resolve(kernel);
+    QImage binary(gray.size(), QImage::Format_Grayscale8);
+    for (int y = 0; y < gray.height(); ++y) {
+        thresholdRow(kernel, gray.constScanLine(y), binary.scanLine(y), gray.width(), threshold);
+    }
+    return binary;
+}
+
+QImage OcrPreprocessor::sauvola(const QImage& gray, int radius, float k, Kernel kernel)
+{
+    if (gray.isNull()) return QImage();
+    kernel = resolve(kernel);
+    radius = qBound(1, radius, 127); // Window sums must fit in 32 bits
+    const int width = gray.width();
+    const int height = gray.height();
+    QImage binary(gray.size(), QImage::Format_Grayscale8);
+
+    // Per-column sums over the rows of the current window, updated one row at a time
+    QVector<quint32> colSum(width, 0);
+    QVector<quint32> colSq(width, 0);
+    int windowTop = 0;
+    int windowBottom = -1; // Inclusive; empty
+    constexpr double DynamicRange = 128.0;
+
+    for (int y = 0; y < height; ++y) {
+        const int top = qMax(0, y - radius);
+        const int bottom = qMin(height - 1, y + radius);
+        while (windowBottom < bottom) {
+            ++windowBottom;
+            accumulateRow(kernel, colSum.data(), colSq.data(), gray.constScanLine(windowBottom), width, false);
+        }
+        while (windowTop < top) {
+            accumulateRow(kernel, colSum.data(), colSq.data(), gray.constScanLine(windowTop), width, true);
+            ++windowTop;
+        }
+        const int rows = bottom - top + 1;
+
+        const uchar* src = gray.constScanLine(y);
+        uchar* dst = binary.scanLine(y);
+        quint64 sum = 0, sq = 0;
+        for (int x = 0; x <= qMin(radius, width - 1); ++x) {
+            sum += colSum[x];
+            sq += colSq[x];
+        }
+        for (int x = 0; x < width; ++x) {
+            if (x > 0) {
+                if (x + radius < width) {
+                    sum += colSum[x + radius];
+                    sq += colSq[x + radius];
+                }
+                if (x - radius - 1 >= 0) {
+                    sum -= colSum[x - radius - 1];
+                    sq -= colSq[x - radius - 1];
+                }
+            }
+            const int cols = qMin(width - 1, x + radius) - qMax(0, x - radius) + 1;
+            const double n = double(cols) * rows;
+            const double mean = sum / n;
+            const double variance = qMax(0.0, sq / n - mean * mean);
+            const double t = mean * (1.0 + k * (std::sqrt(variance) / DynamicRange - 1.0));
+            dst[x] = src[x] > t ? 255 : 0;
+        }
+    }
+    return binary;
+}
+
+qreal OcrPreprocessor::detectSkew(const QImage& gray, qreal maxDegrees)
+{
+    if (gray.isNull() || maxDegrees <= 0) return 0.0;
+
+    // Dark pixels of a subsampled copy; about a thousand columns are plenty
+    const int step = qMax(1, gray.width() / 1000);
+    const int t = otsuThreshold(gray);
+    QVector<QPoint> points;
+    for (int y = 0; y < gray.height(); y += step) {
+        const uchar* row = gray.constScanLine(y);
+        for (int x = 0; x < gray.width(); x += step) {
+            if (row[x] <= t) points.append(QPoint(x / step, y / step));
+        }
+    }
+    if (points.size() < 100) return 0.0;
+
+    const int width = gray.width() / step + 1;
+    const int height = gray.height() / step + 1;
+    QVector<int> bins;
+    auto search = [&](qreal from, qreal to, qreal increment) {
+        qreal best = 0.0;
+        double bestScore = -1;
+        for (qreal angle = from; angle <= to + 1e-9; angle += increment) {
+            const double score = profileScore(points, width, height, angle, bins);
+            if (score > bestScore) {
+                bestScore = score;
+                best = angle;
+            }
+        }
+        return best;
+    };
+
+    // Coarse sweep, then refine around the best angle
+    const qreal coarse = search(-maxDegrees, maxDegrees, 0.5);
+    return search(qMax(-maxDegrees, coarse - 0.5), qMin(maxDegrees, coarse + 0.5), 0.05);
+}
+
+QImage OcrPreprocessor::rotate(const QImage& gray, qreal degrees)
+{
+    if (gray.isNull() || degrees == 0.0) return gray;
+
+    // Inverse mapping with bilinear sampling; outside the source is white
+    const int width = gray.width();
+    const int height = gray.height();
+    QImage rotated(gray.size(), QImage::Format_Grayscale8);
+    const double radians = qDegreesToRadians(degrees);
+    const double c = std::cos(radians);
+    const double s = std::sin(radians);
+    const double cx = width / 2.0;
+    const double cy = height / 2.0;
+
+    for (int v = 0; v < height; ++v) {
+        uchar* dst = rotated.scanLine(v);
+        const double dy = v - cy;
+        for (int u = 0; u < width; ++u) {
+            const double dx = u - cx;
+            const double sx = cx + c * dx - s * dy;
+            const double sy = cy + s * dx + c * dy;
+            const int x0 = int(std::floor(sx));
+            const int y0 = int(std::floor(sy));
+            if (x0 < 0 || y0 < 0 || x0 + 1 >= width || y0 + 1 >= height) {
+                dst[u] = 255;
+                continue;
+            }
+            const double fx = sx - x0;
+            const double fy = sy - y0;
+            const uchar* r0 = gray.constScanLine(y0) + x0;
+            const uchar* r1 = gray.constScanLine(y0 + 1) + x0;
+            const double top = r0[0] + (r0[1] - r0[0]) * fx;
+            const double bottom = r1[0] + (r1[1] - r1[0]) * fx;
+            dst[u] = uchar(qBound(0.0, top + (bottom - top) * fy + 0.5, 255.0));
+        }
+    }
+    return rotated;
+}
+
+QImage OcrPreprocessor::despeckle(const QImage& binary, Kernel kernel)
+{
+    if (binary.isNull()) return QImage();
+    kernel = resolve(kernel);
+    const int height = binary.height();
+    QImage cleaned(binary.size(), QImage::Format_Grayscale8);
+    for (int y = 0; y < height; ++y) {
+        const uchar* up = y > 0 ? binary.constScanLine(y - 1) : nullptr;
+        const uchar* down = y + 1 < height ? binary.constScanLine(y + 1) : nullptr;
+        despeckleRow(kernel, up, binary.constScanLine(y), down, cleaned.scanLine(y), binary.width());
+    }
+    return cleaned;
+}
+
+Kernel OcrPreprocessor::bestKernel()
+{
+#ifdef QUANTILYX_X86_SIMD
+    static const Kernel best = cpuHasAvx2() ? Kernel::Avx2 : Kernel::Sse2;
+    return best;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+QString OcrPreprocessor::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Auto: return QStringLiteral("auto");
+    case Kernel::Scalar: return QStringLiteral("scalar");
+    case Kernel::Sse2: return QStringLiteral("sse2");
+    case Kernel::Avx2: return QStringLiteral("avx2");
+    }
+    return QString();
+}
+
+} // namespace QuantilyxDoc
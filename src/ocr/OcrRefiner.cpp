@@ -0,0 +1,175 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "OcrRefiner.h"
+#include "../core/Logger.h"
+#include <algorithm>
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr int MaxRefineDpi = 600; // Beyond this Tesseract gains nothing and memory grows fast
+
+// Two boxes share a line if they overlap vertically by half the smaller height
+bool sameLine(const QRectF& a, const QRectF& b)
+{
+    const qreal overlap = qMin(a.bottom(), b.bottom()) - qMax(a.top(), b.top());
+    return overlap > 0.5 * qMin(a.height(), b.height());
+}
+
+} // namespace
+
+OcrRefiner::OcrRefiner()
+    : m_options(OcrEngine::instance().refineOptions())
+    , m_threshold(OcrEngine::instance().confidenceThreshold())
+{
+}
+
+QList<QRectF> OcrRefiner::lowConfidenceLines(const QList<OcrWord>& words, float threshold)
+{
+    struct Segment {
+        QRectF box;
+        float confidenceSum;
+        int count;
+    };
+    QList<Segment> segments;
+    bool open = false;
+    for (const OcrWord& word : words) {
+        if (word.confidence >= threshold || word.box.isEmpty()) {
+            open = false; // A confident word ends the segment
+            continue;
+        }
+        Segment* last = open ? &segments.last() : nullptr;
+        if (last && sameLine(last->box, word.box) && word.box.left() > last->box.left()
+            && word.box.left() - last->box.right() < 3 * word.box.height()) {
+            last->box = last->box.united(word.box);
+            last->confidenceSum += word.confidence;
+            ++last->count;
+        } else {
+            segments.append(Segment{word.box, word.confidence, 1});
+            open = true;
+        }
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return a.confidenceSum / a.count < b.confidenceSum / b.count;
+    });
+    QList<QRectF> regions;
+    regions.reserve(segments.size());
+    for (const Segment& segment : segments) {
+        // Room for ascenders, descenders and letters the first pass cut off
+        const qreal margin = qMax<qreal>(2.0, segment.box.height() / 4);
+        regions.append(segment.box.adjusted(-margin, -margin, margin, margin));
+    }
+    return regions;
+}
+
+QString OcrRefiner::textFromWords(const QList<OcrWord>& words)
+{
+    QString text;
+    for (int i = 0; i < words.size(); ++i) {
+        if (i > 0) {
+            text += sameLine(words.at(i - 1).box, words.at(i).box) ? QLatin1Char(' ') : QLatin1Char('\n');
+        }
+        text += words.at(i).text;
+    }
+    return text;
+}
+
+int OcrRefiner::refine(OcrResult& result, const QSize& imageSize, int sourceDpi, const RegionRenderer& render) const
+{
+    if (!m_options.enabled || m_threshold <= 0.0f || result.words.isEmpty() || !render || sourceDpi <= 0) return 0;
+    const int dpi = m_options.dpi > 0 ? m_options.dpi : qMin(MaxRefineDpi, sourceDpi * 2);
+    if (dpi <= sourceDpi) return 0;
+
+    QList<QRectF> regions = lowConfidenceLines(result.words, m_threshold);
+    if (regions.isEmpty()) return 0;
+    if (regions.size() > m_options.maxRegions) {
+        regions = regions.mid(0, qMax(0, m_options.maxRegions));
+    }
+
+    OcrEngine& engine = OcrEngine::instance();
+    OcrPreprocessOptions preprocess = engine.preprocessOptions();
+    preprocess.targetDpi = dpi; // Rendered at the second-pass resolution already
+    preprocess.sauvolaRadius = preprocess.sauvolaRadius * dpi / qMax(1, engine.resolution());
+    preprocess.deskew = false;  // One line is too short to measure skew reliably
+    if (m_options.alternateBinarization) {
+        preprocess.enabled = true;
+        preprocess.binarization = preprocess.binarization == OcrPreprocessOptions::Binarization::Sauvola
+                                      ? OcrPreprocessOptions::Binarization::Otsu
+                                      : OcrPreprocessOptions::Binarization::Sauvola;
+    }
+
+    const QRectF bounds(QPointF(0, 0), QSizeF(imageSize));
+    int improved = 0;
+    for (const QRectF& margined : regions) {
+        const QRectF region = margined.intersected(bounds);
+        if (region.isEmpty()) continue;
+        QImage image = render(region, dpi);
+        if (image.isNull()) continue;
+        image.setDotsPerMeterX(qRound(dpi / 0.0254));
+        image.setDotsPerMeterY(qRound(dpi / 0.0254));
+        const OcrResult second = engine.recognizeDetailed(image, preprocess);
+        if (second.words.isEmpty()) continue;
+
+        QList<int> replaced; // Indices of the first-pass words the region covers
+        float oldSum = 0.0f;
+        for (int i = 0; i < result.words.size(); ++i) {
+            if (region.contains(result.words.at(i).box.center())) {
+                replaced.append(i);
+                oldSum += result.words.at(i).confidence;
+            }
+        }
+        if (replaced.isEmpty()) continue;
+
+        const qreal sx = region.width() / image.width();
+        const qreal sy = region.height() / image.height();
+        QList<OcrWord> fresh;
+        float newSum = 0.0f;
+        for (OcrWord word : second.words) {
+            word.box = QRectF(region.x() + word.box.x() * sx, region.y() + word.box.y() * sy,
+                              word.box.width() * sx, word.box.height() * sy);
+            fresh.append(word);
+            newSum += word.confidence;
+        }
+
+        // A reading that lost most of the words is not better, whatever its confidence
+        if (newSum / fresh.size() <= oldSum / replaced.size() || fresh.size() * 2 < replaced.size()) continue;
+
+        QList<OcrWord> merged;
+        merged.reserve(result.words.size() - replaced.size() + fresh.size());
+        int next = 0;
+        for (int i = 0; i < result.words.size(); ++i) {
+            if (next < replaced.size() && replaced.at(next) == i) {
+                if (next == 0) merged.append(fresh); // In place of the first replaced word
+                ++next;
+                continue;
+            }
+            merged.append(result.words.at(i));
+        }
+        result.words = merged;
+        ++improved;
+    }
+
+    if (improved > 0) {
+        result.boundingBoxes.clear();
+        float sum = 0.0f;
+        for (const OcrWord& word : result.words) {
+            result.boundingBoxes.append(word.box);
+            sum += word.confidence;
+        }
+        result.confidence = result.words.isEmpty() ? 0.0f : sum / result.words.size();
+        result.text = textFromWords(result.words);
+        LOG_DEBUG("OcrRefiner: Improved " << improved << " of " << regions.size() << " lines at " << dpi << " DPI.");
+    }
+    return improved;
+}
+
+} // namespace QuantilyxDoc
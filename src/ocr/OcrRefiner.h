@@ -0,0 +1,77 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_OCRREFINER_H
+#define QUANTILYX_OCRREFINER_H
+
+#include "OcrEngine.h"
+#include <QImage>
+#include <QList>
+#include <QRectF>
+#include <functional>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Second OCR pass over the words the first pass was unsure of.
+ *
+ * Words below OcrEngine::confidenceThreshold() are grouped into line
+ * segments. Each segment is rendered again at a higher resolution and
+ * recognized with alternative binarization. Where the new reading is more
+ * confident, its words replace the old ones. Only a few lines of a page are
+ * usually affected, so the accuracy gets close to high-resolution OCR of
+ * the whole page at a small part of its cost.
+ */
+class OcrRefiner
+{
+public:
+    /**
+     * @brief Renders a region of the first-pass image again.
+     * The rect is in pixels of the first-pass image; the returned image must
+     * cover exactly that rect at the given resolution.
+     */
+    using RegionRenderer = std::function<QImage(const QRectF& rect, int dpi)>;
+
+    /**
+     * @brief Constructor. Takes the options and threshold from OcrEngine.
+     */
+    OcrRefiner();
+
+    /**
+     * @brief Re-recognize the low-confidence lines of a result in place.
+     * @param result First-pass result; word boxes in pixels of an image at sourceDpi.
+     * @param imageSize Size of the first-pass image; regions are clipped to it.
+     * @param sourceDpi Resolution of the first-pass image.
+     * @param render Renders regions of the page at the second-pass resolution.
+     * @return Number of lines whose reading was replaced.
+     */
+    int refine(OcrResult& result, const QSize& imageSize, int sourceDpi, const RegionRenderer& render) const;
+
+    /**
+     * @brief Group low-confidence words into line segments.
+     * @param words Words in reading order.
+     * @param threshold Confidence below which a word is included.
+     * @return Segment boxes with a margin, lowest mean confidence first.
+     */
+    static QList<QRectF> lowConfidenceLines(const QList<OcrWord>& words, float threshold);
+
+    /**
+     * @brief Rebuild page text from words in reading order.
+     * Words on one line are joined with spaces, lines with newlines.
+     */
+    static QString textFromWords(const QList<OcrWord>& words);
+
+private:
+    OcrRefineOptions m_options;
+    float m_threshold;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_OCRREFINER_H
@@ -0,0 +1,663 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "PaddleOcrBackend.h"
+#include "OcrLayoutAnalyzer.h"
+#include "OcrRefiner.h"
+#include "../core/Logger.h"
+#include "../core/ThreadPool.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QTransform>
+#include <QWaitCondition>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#ifdef HAVE_PADDLEOCR
+#include <paddle_inference_api.h>
+#endif
+
+namespace QuantilyxDoc {
+
+namespace {
+
+constexpr int RecHeight = 48;                             // Input height of the PP-OCR recognition models
+constexpr int WidthBuckets[] = {80, 160, 320, 640, 1280}; // Longer lines are squeezed into the last bucket
+constexpr int BucketCount = sizeof(WidthBuckets) / sizeof(WidthBuckets[0]);
+constexpr int DetMaxSide = 960;         // Detection input limit; DB finds lines well below page resolution
+constexpr float DetThreshold = 0.3f;    // Probability map cells above this are text
+constexpr float DetBoxThreshold = 0.6f; // Mean probability a box needs to be kept
+constexpr qreal UnclipRatio = 1.5;      // DB shrinks text regions in training; grow them back
+constexpr qreal VerticalAspect = 1.5;   // Crops this much taller than wide are vertical text
+
+int bucketIndex(int width)
+{
+    for (int i = 0; i < BucketCount; ++i) {
+        if (width <= WidthBuckets[i]) return i;
+    }
+    return BucketCount - 1;
+}
+
+int ceilPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+int floorPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+QStringList loadDictionary(const QString& path)
+{
+    QStringList dictionary;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return dictionary;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd()) {
+        dictionary.append(in.readLine());
+    }
+    if (!dictionary.isEmpty()) dictionary.append(QStringLiteral(" ")); // Models are trained with a space class last
+    return dictionary;
+}
+
+} // namespace
+
+class PaddleOcrBackend::Private {
+public:
+    Private(PaddleOcrBackend* q_ptr)
+        : q(q_ptr), initialized(false), maxBatch(16), nextMaxBatch(16), latencyMs(10), intraOpThreads(0)
+        , stopping(true) {}
+
+    ~Private() {
+        stop();
+    }
+
+    PaddleOcrBackend* q;
+    mutable QMutex mutex; // Protects everything below except the predictors
+    bool initialized;
+    int maxBatch;     // Batch limit of the loaded recognizer; its shape cache is sized for it
+    int nextMaxBatch; // Takes effect at the next initialize()
+    int latencyMs;
+    int intraOpThreads;
+    PaddleOcrStats stats;
+    QStringList dictionary; // Class i + 1 is entry i; class 0 is the CTC blank
+
+    // A text line waiting for recognition. Results are written through the
+    // pointers, which stay valid until the caller sees pending reach zero.
+    struct Line {
+        QImage image;      // RGB888, RecHeight high, at most its bucket wide
+        qint64 queuedAt;   // clock time in milliseconds
+        QString* text;
+        float* confidence;
+        int* pending;
+        bool* failed;      // Set when the line could not be recognized
+    };
+    QList<Line> queues[BucketCount];
+    QWaitCondition queued;     // Lines were added, or stopping
+    QWaitCondition recognized; // A batch finished
+    bool stopping;             // No inference thread takes lines; true until start()
+    QElapsedTimer clock;
+    std::unique_ptr<QThread> thread;
+
+#ifdef HAVE_PADDLEOCR
+    // Predictors are not thread-safe. The prototype is only cloned (clones
+    // share its weights); each detecting thread leases a clone, and the
+    // recognizer is used by the inference thread alone.
+    std::shared_ptr<paddle_infer::Predictor> detPrototype;
+    QMutex detMutex;
+    QList<std::shared_ptr<paddle_infer::Predictor>> idleDetectors;
+    std::shared_ptr<paddle_infer::Predictor> recognizer;
+
+    static std::shared_ptr<paddle_infer::Predictor> createPredictor(const QString& prefix, int threads, int shapeCache) {
+        const QString model = prefix + ".pdmodel";
+        const QString params = prefix + ".pdiparams";
+        if (!QFile::exists(model) || !QFile::exists(params)) {
+            LOG_ERROR("PaddleOcrBackend: Missing model files " << model << " / " << params);
+            return nullptr;
+        }
+        paddle_infer::Config config;
+        config.SetModel(model.toStdString(), params.toStdString());
+        config.DisableGpu();
+        config.EnableMKLDNN();
+        config.SetMkldnnCacheCapacity(shapeCache); // One compiled kernel set per input shape
+        config.SetCpuMathLibraryNumThreads(threads);
+        config.SwitchIrOptim(true);
+        config.EnableMemoryOptim();
+        config.DisableGlogInfo();
+        return paddle_infer::CreatePredictor(config);
+    }
+
+    std::shared_ptr<paddle_infer::Predictor> acquireDetector() {
+        QMutexLocker locker(&detMutex);
+        if (!idleDetectors.isEmpty()) return idleDetectors.takeLast();
+        return std::shared_ptr<paddle_infer::Predictor>(detPrototype->Clone());
+    }
+
+    void releaseDetector(std::shared_ptr<paddle_infer::Predictor> detector) {
+        QMutexLocker locker(&detMutex);
+        idleDetectors.append(std::move(detector));
+    }
+#endif
+
+    int autoIntraOpThreads() const {
+        // Each ThreadPool worker detects a page of its own; let them have up
+        // to half the cores and give recognition batches the rest
+        const int cores = qMax(1, QThread::idealThreadCount());
+        const int workers = qMax(1, ThreadPool::instance().maxThreadCount());
+        return qMax(1, cores - qMin(workers, cores / 2));
+    }
+
+    int detectorThreads(int recThreads) const {
+        const int cores = qMax(1, QThread::idealThreadCount());
+        const int workers = qMax(1, ThreadPool::instance().maxThreadCount());
+        return qMax(1, (cores - recThreads) / workers);
+    }
+
+    void start() {
+        {
+            QMutexLocker locker(&mutex);
+            stopping = false;
+        }
+        thread.reset(QThread::create([this]() { run(); }));
+        thread->setObjectName(QStringLiteral("PaddleOcrInference"));
+        thread->start();
+    }
+
+    // Finish the queued lines and end the inference thread. recognize() queues
+    // nothing once stopping is set; lines the thread did not take are failed
+    // so that no caller waits for a thread that is gone.
+    void stop() {
+        {
+            QMutexLocker locker(&mutex);
+            stopping = true;
+            queued.wakeAll();
+        }
+        if (!thread) return;
+        thread->wait();
+        thread.reset();
+        QMutexLocker locker(&mutex);
+        bool failedLines = false;
+        for (QList<Line>& queue : queues) {
+            for (const Line& line : queue) {
+                *line.failed = true;
+                --*line.pending;
+                failedLines = true;
+            }
+            queue.clear();
+        }
+        if (failedLines) recognized.wakeAll();
+        if (stats.batches > 0) {
+            LOG_INFO("PaddleOcrBackend: " << stats.regions << " regions in " << stats.batches << " batches, "
+                     << stats.regionsPerSecond() << " regions/s.");
+        }
+    }
+
+    // Inference thread: run full batches at once, others when their oldest line is due
+    void run() {
+        QMutexLocker locker(&mutex);
+        for (;;) {
+            int bucket = -1;
+            for (;;) {
+                int oldestBucket = -1;
+                for (int b = 0; b < BucketCount; ++b) {
+                    if (queues[b].size() >= maxBatch) {
+                        bucket = b;
+                        break;
+                    }
+                    if (!queues[b].isEmpty()
+                        && (oldestBucket < 0 || queues[b].first().queuedAt < queues[oldestBucket].first().queuedAt)) {
+                        oldestBucket = b;
+                    }
+                }
+                if (bucket >= 0) break;
+                if (oldestBucket < 0) {
+                    if (stopping) return;
+                    queued.wait(&mutex);
+                    continue;
+                }
+                const qint64 waited = clock.elapsed() - queues[oldestBucket].first().queuedAt;
+                if (stopping || waited >= latencyMs) {
+                    bucket = oldestBucket;
+                    break;
+                }
+                queued.wait(&mutex, static_cast<unsigned long>(latencyMs - waited));
+            }
+
+            const int take = qMin(maxBatch, queues[bucket].size());
+            QList<Line> batch = queues[bucket].mid(0, take);
+            queues[bucket].erase(queues[bucket].begin(), queues[bucket].begin() + take);
+            const int slots = qMin(ceilPowerOfTwo(take), maxBatch);
+            const QStringList dict = dictionary;
+            locker.unlock();
+
+            QElapsedTimer timer;
+            timer.start();
+            recognizeBatch(batch, WidthBuckets[bucket], slots, dict);
+            const qint64 elapsed = timer.nsecsElapsed();
+
+            locker.relock();
+            stats.regions += take;
+            ++stats.batches;
+            stats.paddedSlots += slots - take;
+            stats.inferenceNs += elapsed;
+            for (const Line& line : batch) {
+                --*line.pending;
+            }
+            recognized.wakeAll();
+        }
+    }
+
+    // Pad the lines into a [slots, 3, RecHeight, width] tensor and CTC-decode the output
+    void recognizeBatch(const QList<Line>& batch, int width, int slots, const QStringList& dict) {
+        // Written before the caller is released, and only ever set, so no lock is needed
+        auto fail = [&batch]() {
+            for (const Line& line : batch) *line.failed = true;
+        };
+#ifdef HAVE_PADDLEOCR
+        // Zero is mid-gray after normalization, which is what the models are trained to see as padding
+        const size_t plane = size_t(RecHeight) * width;
+        std::vector<float> input(size_t(slots) * 3 * plane, 0.0f);
+        for (int i = 0; i < batch.size(); ++i) {
+            const QImage& image = batch.at(i).image;
+            float* blue = input.data() + i * 3 * plane; // BGR, as PaddleOCR reads images with OpenCV
+            float* green = blue + plane;
+            float* red = green + plane;
+            for (int y = 0; y < image.height(); ++y) {
+                const uchar* row = image.constScanLine(y);
+                for (int x = 0; x < image.width(); ++x) {
+                    red[y * width + x] = row[3 * x] / 127.5f - 1.0f;
+                    green[y * width + x] = row[3 * x + 1] / 127.5f - 1.0f;
+                    blue[y * width + x] = row[3 * x + 2] / 127.5f - 1.0f;
+                }
+            }
+        }
+
+        auto in = recognizer->GetInputHandle(recognizer->GetInputNames().front());
+        in->Reshape({slots, 3, RecHeight, width});
+        in->CopyFromCpu(input.data());
+        if (!recognizer->Run()) {
+            LOG_ERROR("PaddleOcrBackend: Recognition batch of " << batch.size() << " lines failed.");
+            fail();
+            return;
+        }
+        auto out = recognizer->GetOutputHandle(recognizer->GetOutputNames().front());
+        const std::vector<int> shape = out->shape(); // [slots, steps, classes]
+        if (shape.size() != 3) {
+            LOG_ERROR("PaddleOcrBackend: Unexpected recognition output of rank " << shape.size());
+            fail();
+            return;
+        }
+        const int steps = shape[1];
+        const int classes = shape[2];
+        std::vector<float> probs(size_t(shape[0]) * steps * classes);
+        out->CopyToCpu(probs.data());
+
+        // Greedy CTC: best class per step, repeats merged, blanks dropped
+        for (int i = 0; i < batch.size(); ++i) {
+            QString text;
+            float sum = 0.0f;
+            int count = 0;
+            int previous = 0;
+            for (int t = 0; t < steps; ++t) {
+                const float* p = probs.data() + (size_t(i) * steps + t) * classes;
+                const int best = int(std::max_element(p, p + classes) - p);
+                if (best != 0 && best != previous && best - 1 < dict.size()) {
+                    text += dict.at(best - 1);
+                    sum += p[best];
+                    ++count;
+                }
+                previous = best;
+            }
+            *batch.at(i).text = text.trimmed();
+            *batch.at(i).confidence = count > 0 ? sum / count : 0.0f;
+        }
+#else
+        Q_UNUSED(width);
+        Q_UNUSED(slots);
+        Q_UNUSED(dict);
+        fail();
+#endif
+    }
+
+    // DB text detection; returns line boxes in image pixels
+    QList<QRect> detect(const QImage& rgb) {
+        QList<QRect> boxes;
+#ifdef HAVE_PADDLEOCR
+        const qreal scale = qMin<qreal>(1.0, qreal(DetMaxSide) / qMax(rgb.width(), rgb.height()));
+        const int w = qMax(32, qRound(rgb.width() * scale / 32) * 32);
+        const int h = qMax(32, qRound(rgb.height() * scale / 32) * 32);
+        const QImage resized = rgb.scaled(w, h, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+        // Channel order and constants as in PaddleOCR's own deploy code
+        static const float mean[3] = {0.485f, 0.456f, 0.406f};
+        static const float stddev[3] = {0.229f, 0.224f, 0.225f};
+        const size_t plane = size_t(w) * h;
+        std::vector<float> input(3 * plane);
+        for (int y = 0; y < h; ++y) {
+            const uchar* row = resized.constScanLine(y);
+            for (int x = 0; x < w; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const uchar value = row[3 * x + 2 - c]; // BGR
+                    input[c * plane + y * w + x] = (value / 255.0f - mean[c]) / stddev[c];
+                }
+            }
+        }
+
+        std::shared_ptr<paddle_infer::Predictor> detector = acquireDetector();
+        auto in = detector->GetInputHandle(detector->GetInputNames().front());
+        in->Reshape({1, 3, h, w});
+        in->CopyFromCpu(input.data());
+        const bool ok = detector->Run();
+        std::vector<float> probs(plane);
+        if (ok) {
+            auto out = detector->GetOutputHandle(detector->GetOutputNames().front());
+            out->CopyToCpu(probs.data());
+        }
+        releaseDetector(std::move(detector));
+        if (!ok) {
+            LOG_ERROR("PaddleOcrBackend: Text detection failed.");
+            return boxes;
+        }
+
+        QVector<quint8> mask(w * h);
+        for (size_t i = 0; i < plane; ++i) {
+            mask[int(i)] = probs[i] > DetThreshold;
+        }
+
+        // Boxes are kept axis-aligned: document pages are deskewed before
+        // OCR, and rectangles crop without resampling
+        const qreal sx = qreal(rgb.width()) / w;
+        const qreal sy = qreal(rgb.height()) / h;
+        const QRect bounds = rgb.rect();
+        for (const QRect& component : OcrLayoutAnalyzer::connectedComponents(mask, w, h, 4)) {
+            if (qMin(component.width(), component.height()) < 3) continue;
+            double sum = 0.0;
+            for (int y = component.top(); y <= component.bottom(); ++y) {
+                const float* row = probs.data() + size_t(y) * w;
+                for (int x = component.left(); x <= component.right(); ++x) sum += row[x];
+            }
+            if (sum / (component.width() * component.height()) < DetBoxThreshold) continue;
+
+            const qreal area = component.width() * component.height();
+            const qreal grow = area * UnclipRatio / (2 * (component.width() + component.height()));
+            const QRectF unclipped = QRectF(component).adjusted(-grow, -grow, grow, grow);
+            const QRect box = QRectF(unclipped.x() * sx, unclipped.y() * sy, unclipped.width() * sx,
+                                     unclipped.height() * sy).toAlignedRect().intersected(bounds);
+            if (!box.isEmpty()) boxes.append(box);
+        }
+
+        // Reading order: top to bottom, left to right within a line
+        std::sort(boxes.begin(), boxes.end(), [](const QRect& a, const QRect& b) {
+            return a.top() != b.top() ? a.top() < b.top() : a.left() < b.left();
+        });
+        for (int i = 1; i < boxes.size(); ++i) {
+            for (int j = i; j > 0; --j) {
+                const QRect& above = boxes.at(j - 1);
+                const QRect& box = boxes.at(j);
+                const bool sameLine = qAbs(box.top() - above.top()) < qMin(box.height(), above.height()) / 2;
+                if (!sameLine || box.left() >= above.left()) break;
+                std::swap(boxes[j - 1], boxes[j]);
+            }
+        }
+#else
+        Q_UNUSED(rgb);
+#endif
+        return boxes;
+    }
+};
+
+// Static instance pointer
+PaddleOcrBackend* PaddleOcrBackend::s_instance = nullptr;
+
+PaddleOcrBackend& PaddleOcrBackend::instance()
+{
+    if (!s_instance) {
+        s_instance = new PaddleOcrBackend();
+    }
+    return *s_instance;
+}
+
+PaddleOcrBackend::PaddleOcrBackend(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    LOG_INFO("PaddleOcrBackend created.");
+}
+
+PaddleOcrBackend::~PaddleOcrBackend()
+{
+    LOG_INFO("PaddleOcrBackend destroyed.");
+}
+
+bool PaddleOcrBackend::initialize(const QString& modelDir)
+{
+    // Must not race recognize(); the queued lines are finished first
+    {
+        QMutexLocker locker(&d->mutex);
+        d->initialized = false;
+    }
+    d->stop();
+
+#ifdef HAVE_PADDLEOCR
+    const QDir dir(modelDir);
+    const QStringList dictionary = loadDictionary(dir.filePath(QStringLiteral("dict.txt")));
+    if (dictionary.isEmpty()) {
+        LOG_ERROR("PaddleOcrBackend: No character dictionary in " << modelDir);
+        return false;
+    }
+
+    const int recThreads = effectiveIntraOpThreads();
+    const int detThreads = d->detectorThreads(recThreads);
+    int batch;
+    {
+        QMutexLocker locker(&d->mutex);
+        batch = d->nextMaxBatch;
+    }
+    int batchShapes = 0; // Power-of-two batch sizes up to the maximum
+    for (int n = 1; n <= batch; n *= 2) ++batchShapes;
+
+    auto detector = Private::createPredictor(dir.filePath(QStringLiteral("det/inference")), detThreads, 10);
+    auto recognizer = Private::createPredictor(dir.filePath(QStringLiteral("rec/inference")), recThreads,
+                                               BucketCount * batchShapes);
+    if (!detector || !recognizer) return false;
+
+    {
+        QMutexLocker locker(&d->detMutex);
+        d->idleDetectors.clear();
+        d->detPrototype = std::move(detector);
+    }
+    d->recognizer = std::move(recognizer);
+    {
+        QMutexLocker locker(&d->mutex);
+        d->dictionary = dictionary;
+        d->maxBatch = batch;
+        d->stats = PaddleOcrStats();
+        d->clock.start();
+        d->initialized = true;
+    }
+    d->start();
+    LOG_INFO("PaddleOcrBackend: Loaded models from " << modelDir << " (Paddle " << engineVersion() << ", "
+             << recThreads << " recognition threads, " << detThreads << " per detector).");
+    return true;
+#else
+    Q_UNUSED(modelDir);
+    LOG_ERROR("PaddleOcrBackend: Built without PaddleOCR support (HAVE_PADDLEOCR).");
+    return false;
+#endif
+}
+
+bool PaddleOcrBackend::isReady() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->initialized;
+}
+
+OcrResult PaddleOcrBackend::recognize(const QImage& image) const
+{
+    OcrResult result;
+    if (image.isNull() || !isReady()) {
+        result.error = image.isNull() ? QStringLiteral("Empty image.") : QStringLiteral("PaddleOCR models not loaded.");
+        return result;
+    }
+
+    const QImage rgb = image.convertToFormat(QImage::Format_RGB888);
+    const QList<QRect> boxes = d->detect(rgb);
+    if (boxes.isEmpty()) {
+        result.ok = true; // Nothing that looks like text
+        return result;
+    }
+
+    // Crop and scale on this thread; the inference thread only builds tensors
+    std::vector<QString> texts(boxes.size());
+    std::vector<float> confidences(boxes.size(), 0.0f);
+    int pending = boxes.size();
+    bool failed = false;
+    QList<Private::Line> lines;
+    lines.reserve(boxes.size());
+    for (int i = 0; i < boxes.size(); ++i) {
+        QImage crop = rgb.copy(boxes.at(i));
+        if (crop.height() >= VerticalAspect * crop.width()) {
+            crop = crop.transformed(QTransform().rotate(-90));
+        }
+        const int width = qBound(1, qCeil(qreal(RecHeight) * crop.width() / crop.height()),
+                                 WidthBuckets[BucketCount - 1]);
+        lines.append(Private::Line{crop.scaled(width, RecHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation),
+                                   0, &texts[i], &confidences[i], &pending, &failed});
+    }
+
+    {
+        // Checked again under the lock: initialize() may have stopped the
+        // inference thread since isReady(), and nothing would take the lines
+        QMutexLocker locker(&d->mutex);
+        if (!d->initialized || d->stopping) {
+            result.error = QStringLiteral("PaddleOCR models not loaded.");
+            return result;
+        }
+        const qint64 now = d->clock.elapsed();
+        for (Private::Line& line : lines) {
+            line.queuedAt = now;
+            d->queues[bucketIndex(line.image.width())].append(line);
+        }
+        d->queued.wakeOne();
+        while (pending > 0) {
+            d->recognized.wait(&d->mutex);
+        }
+    }
+    if (failed) {
+        result.error = QStringLiteral("PaddleOCR recognition failed.");
+        return result;
+    }
+
+    float sum = 0.0f;
+    for (int i = 0; i < boxes.size(); ++i) {
+        if (texts[i].isEmpty()) continue;
+        OcrWord word;
+        word.text = texts[i];
+        word.box = QRectF(boxes.at(i));
+        word.confidence = confidences[i];
+        result.words.append(word);
+        result.boundingBoxes.append(word.box);
+        sum += word.confidence;
+    }
+    result.text = OcrRefiner::textFromWords(result.words);
+    result.confidence = result.words.isEmpty() ? 0.0f : sum / result.words.size();
+    result.ok = true;
+    LOG_DEBUG("PaddleOcrBackend: " << boxes.size() << " lines detected, " << result.words.size() << " recognized.");
+    return result;
+}
+
+int PaddleOcrBackend::maxBatchSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->nextMaxBatch;
+}
+
+void PaddleOcrBackend::setMaxBatchSize(int lines)
+{
+    // The recognizer's kernel cache holds one entry per batch shape, sized at
+    // initialize(); a larger batch now would recompile kernels on every run
+    QMutexLocker locker(&d->mutex);
+    d->nextMaxBatch = floorPowerOfTwo(qBound(1, lines, 256));
+    if (d->initialized && d->nextMaxBatch != d->maxBatch) {
+        LOG_INFO("PaddleOcrBackend: Batch size " << d->nextMaxBatch << " takes effect at the next initialize().");
+    }
+}
+
+int PaddleOcrBackend::batchLatency() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->latencyMs;
+}
+
+void PaddleOcrBackend::setBatchLatency(int msecs)
+{
+    QMutexLocker locker(&d->mutex);
+    d->latencyMs = qMax(0, msecs);
+    d->queued.wakeAll();
+}
+
+int PaddleOcrBackend::intraOpThreads() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->intraOpThreads;
+}
+
+void PaddleOcrBackend::setIntraOpThreads(int threads)
+{
+    QMutexLocker locker(&d->mutex);
+    d->intraOpThreads = qMax(0, threads);
+}
+
+int PaddleOcrBackend::effectiveIntraOpThreads() const
+{
+    const int threads = intraOpThreads();
+    return threads > 0 ? threads : d->autoIntraOpThreads();
+}
+
+PaddleOcrStats PaddleOcrBackend::stats() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->stats;
+}
+
+void PaddleOcrBackend::resetStats()
+{
+    QMutexLocker locker(&d->mutex);
+    d->stats = PaddleOcrStats();
+}
+
+QList<int> PaddleOcrBackend::widthBuckets()
+{
+    QList<int> buckets;
+    for (int width : WidthBuckets) buckets.append(width);
+    return buckets;
+}
+
+QString PaddleOcrBackend::engineVersion()
+{
+#ifdef HAVE_PADDLEOCR
+    return QString::fromStdString(paddle_infer::GetVersion());
+#else
+    return QStringLiteral("none");
+#endif
+}
+
+} // namespace QuantilyxDoc
@@ -0,0 +1,178 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#ifndef QUANTILYX_PADDLEOCRBACKEND_H
+#define QUANTILYX_PADDLEOCRBACKEND_H
+
+#include "OcrEngine.h"
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <memory>
+
+namespace QuantilyxDoc {
+
+/**
+ * @brief Recognition throughput counters of the PaddleOCR backend.
+ */
+struct PaddleOcrStats {
+    qint64 regions = 0;       // Text lines recognized
+    qint64 batches = 0;       // Recognition predictor runs
+    qint64 paddedSlots = 0;   // Batch slots filled with padding to keep shapes fixed
+    qint64 inferenceNs = 0;   // Time spent in recognition runs
+
+    /**
+     * @brief Get the recognition throughput.
+     * @return Regions per second of inference time, or 0 before the first batch.
+     */
+    double regionsPerSecond() const { return inferenceNs > 0 ? regions * 1e9 / inferenceNs : 0.0; }
+};
+
+/**
+ * @brief CPU inference backend running the PaddleOCR detection and recognition models.
+ *
+ * Detection (DB) runs once per page on the calling thread, on a predictor
+ * cloned per concurrent caller. The text lines it finds are not recognized
+ * one by one: they are queued to a single inference thread that collects
+ * lines from every page in flight and runs them through the recognition
+ * model in batches.
+ *
+ * To keep tensor shapes fixed, and with them the oneDNN kernel cache, each
+ * line is scaled to a height of 48 pixels and padded to the next width
+ * bucket (widthBuckets()). A batch holds lines of one bucket and is padded
+ * to a power-of-two size of at most maxBatchSize(), so only a handful of
+ * shapes ever reach the predictor. A batch runs when it is full, or once
+ * its oldest line has waited batchLatency() milliseconds.
+ *
+ * The recognition thread and the detection predictors share the CPU with
+ * the OCR pages running on the project ThreadPool; intraOpThreads() splits
+ * the cores between them.
+ *
+ * Expects PaddleOCR inference models in the model directory:
+ * det/inference.pdmodel, det/inference.pdiparams, rec/inference.pdmodel,
+ * rec/inference.pdiparams and the character dictionary dict.txt.
+ * Without HAVE_PADDLEOCR initialize() fails and nothing is recognized.
+ */
+class PaddleOcrBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor.
+     * @param parent Parent object.
+     */
+    explicit PaddleOcrBackend(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor. Stops the inference thread after the queued lines are done.
+     */
+    ~PaddleOcrBackend() override;
+
+    /**
+     * @brief Get singleton instance.
+     * @return Reference to the global PaddleOcrBackend instance.
+     */
+    static PaddleOcrBackend& instance();
+
+    /**
+     * @brief Load the models and start the inference thread.
+     * Thread settings take effect here; call again after changing them.
+     * @param modelDir Directory holding det/, rec/ and dict.txt.
+     * @return True if both models and the dictionary were loaded.
+     */
+    bool initialize(const QString& modelDir);
+
+    /**
+     * @brief Check if the models are loaded.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Detect and recognize the text lines of an image.
+     * Thread-safe; blocks until the lines of this image have been through
+     * a recognition batch, possibly together with lines of other images.
+     * @param image Page or region image, any format.
+     * @return One OcrWord per text line, boxes in image pixels, in reading order.
+     */
+    OcrResult recognize(const QImage& image) const;
+
+    /**
+     * @brief Get the largest recognition batch.
+     */
+    int maxBatchSize() const;
+
+    /**
+     * @brief Set the largest recognition batch (default 16, rounded down to a power of two).
+     * Takes effect at the next initialize(), which sizes the kernel cache for it.
+     */
+    void setMaxBatchSize(int lines);
+
+    /**
+     * @brief Get the longest a queued line waits for its batch to fill, in milliseconds.
+     */
+    int batchLatency() const;
+
+    /**
+     * @brief Set the longest a queued line waits for its batch to fill (default 10 ms).
+     */
+    void setBatchLatency(int msecs);
+
+    /**
+     * @brief Get the configured math library threads of the recognition predictor.
+     * @return Thread count, or 0 for automatic.
+     */
+    int intraOpThreads() const;
+
+    /**
+     * @brief Set the math library threads of the recognition predictor.
+     * With 0 (the default) the count is derived from the cores left over by
+     * the ThreadPool workers, see effectiveIntraOpThreads().
+     */
+    void setIntraOpThreads(int threads);
+
+    /**
+     * @brief Get the math library threads the recognition predictor uses.
+     * In automatic mode the ThreadPool workers, each detecting a page, get
+     * up to half the cores; recognition gets the rest.
+     */
+    int effectiveIntraOpThreads() const;
+
+    /**
+     * @brief Get the throughput counters since initialization or resetStats().
+     */
+    PaddleOcrStats stats() const;
+
+    /**
+     * @brief Reset the throughput counters.
+     */
+    void resetStats();
+
+    /**
+     * @brief Get the line widths recognition batches are padded to, in pixels.
+     */
+    static QList<int> widthBuckets();
+
+    /**
+     * @brief Get the version of the Paddle Inference library.
+     * @return Version string, or "none" when built without it.
+     */
+    static QString engineVersion();
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+
+    static PaddleOcrBackend* s_instance;
+};
+
+} // namespace QuantilyxDoc
+
+#endif // QUANTILYX_PADDLEOCRBACKEND_H
@@ -187,8 +187,24 @@ bool FullTextIndex::removeDocument(const QString& filePath)
         LOG_ERROR("FullTextIndex::removeDocument: Failed to delete document from FTS index: " << query.lastError().text() << ". File: " << filePath);
         return false;
     }
+    int removed = query.numRowsAffected();
+
+    // Page rows are found through the page map's (id, page) index
+    QSqlQuery pagesQuery(d->db);
+    pagesQuery.prepare("DELETE FROM pages_fts WHERE rowid IN (SELECT fts_rowid FROM pages WHERE id = ?);");
+    pagesQuery.addBindValue(docId);
+    QSqlQuery mapQuery(d->db);
+    mapQuery.prepare("DELETE FROM pages WHERE id = ?;");
+    mapQuery.addBindValue(docId);
+    if (!pagesQuery.exec() || !mapQuery.exec()) {
+        LOG_ERROR("FullTextIndex::removeDocument: Failed to delete pages from FTS index: "
+                  << (pagesQuery.lastError().isValid() ? pagesQuery.lastError().text() : mapQuery.lastError().text())
+                  << ". File: " << filePath);
+        return false;
+    }
+    removed += mapQuery.numRowsAffected();
 
-    if (query.numRowsAffected() > 0) {
+    if (removed > 0) {
         LOG_DEBUG("FullTextIndex: Removed document from index: " << filePath);
         emit documentIndexed(filePath, false); // Emit signal indicating removal
         return true;
@@ -214,11 +230,18 @@ QList<FullTextIndex::SearchResult> FullTextIndex::search(const QString& query, i
     // Use FTS5's built-in match function and snippet function for context.
     // The snippet function allows us to get a portion of the text around the match.
     // Syntax: snippet(table_name, column_number, start_match, end_match, ellipsis, max_tokens)
-    // Column numbers: 0=path, 1=content, 2=title, 3=author, 4=subject, 5=keywords (based on CREATE VIRTUAL TABLE statement)
-    // We'll snippet the 'content' column (index 1).
-    QString queryString = "SELECT path, snippet(documents_fts, 1, '[', ']', '...', 15) AS context_snippet FROM documents_fts WHERE documents_fts MATCH ? ORDER BY rank LIMIT ?;";
+    // Columns of documents_fts: 0=id, 1=path, 2=content, 3=title, ...; of pages_fts: 0=id, 1=path, 2=page, 3=content.
+    // Whole documents and single pages (e.g. from batch OCR) are searched together;
+    // both tables rank by BM25 (lower is better), so their ranks interleave.
+    QString queryString = "SELECT path, -1 AS page, snippet(documents_fts, 2, '[', ']', '...', 15), rank AS score "
+                          "FROM documents_fts WHERE documents_fts MATCH ? "
+                          "UNION ALL "
+                          "SELECT path, page, snippet(pages_fts, 3, '[', ']', '...', 15), rank AS score "
+                          "FROM pages_fts WHERE pages_fts MATCH ? "
+                          "ORDER BY score LIMIT ?;";
     searchQuery.prepare(queryString);
     searchQuery.addBindValue(query);
+    searchQuery.addBindValue(query);
     searchQuery.addBindValue(maxResults > 0 ? maxResults : 50); // Default to 50 if maxResults is 0 or negative
 
     if (!searchQuery.exec()) {
@@ -229,7 +252,8 @@ QList<FullTextIndex::SearchResult> FullTextIndex::search(const QString& query, i
     while (searchQuery.next()) {
         SearchResult result;
         result.filePath = searchQuery.value(0).toString(); // Path from 'path' column
-        result.snippet = searchQuery.value(1).toString();  // Snippet from 'content' column
+        result.pageIndex = searchQuery.value(1).toInt();   // -1 for a whole-document hit
+        result.snippet = searchQuery.value(2).toString();  // Snippet from 'content' column
         // The 'rank' is implicitly used by the 'ORDER BY rank' clause in SQLite FTS5.
         // FTS5 calculates its own rank based on BM25 or similar algorithm.
         // If needed, we could select the rank explicitly: SELECT ..., rank FROM ...
@@ -251,6 +275,80 @@ bool FullTextIndex::updateDocument(const QString& filePath, const QString& newCo
     return addDocument(filePath, newContent, newMetadata);
 }
 
+bool FullTextIndex::addPage(const QString& filePath, int pageIndex, const QString& text)
+{
+    if (!isInitialized() || filePath.isEmpty() || pageIndex < 0) {
+        LOG_ERROR("FullTextIndex::addPage: Index not initialized, file path is empty, or page index is invalid.");
+        return false;
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    QString docId = QString(QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha256).toHex());
+
+    // FTS5 tables have no unique constraint, and filtering on UNINDEXED
+    // columns scans the table. The page map gives the row of a page by its
+    // (id, page) key, so it is replaced by rowid.
+    QSqlQuery lookupQuery(d->db);
+    lookupQuery.prepare("SELECT fts_rowid FROM pages WHERE id = ? AND page = ?;");
+    lookupQuery.addBindValue(docId);
+    lookupQuery.addBindValue(pageIndex);
+    if (!lookupQuery.exec()) {
+        LOG_ERROR("FullTextIndex::addPage: Failed to look up old page text: " << lookupQuery.lastError().text() << ". File: " << filePath);
+        return false;
+    }
+    const QVariant oldRow = lookupQuery.next() ? lookupQuery.value(0) : QVariant();
+    if (oldRow.isValid()) {
+        QSqlQuery removeQuery(d->db);
+        removeQuery.prepare("DELETE FROM pages_fts WHERE rowid = ?;");
+        removeQuery.addBindValue(oldRow);
+        if (!removeQuery.exec()) {
+            LOG_ERROR("FullTextIndex::addPage: Failed to remove old page text: " << removeQuery.lastError().text() << ". File: " << filePath);
+            return false;
+        }
+    }
+    if (text.trimmed().isEmpty()) {
+        // Blank page: nothing to index
+        if (oldRow.isValid()) {
+            QSqlQuery unmapQuery(d->db);
+            unmapQuery.prepare("DELETE FROM pages WHERE fts_rowid = ?;");
+            unmapQuery.addBindValue(oldRow);
+            unmapQuery.exec();
+        }
+        return true;
+    }
+
+    // A new page gets its row number from the map
+    QVariant row = oldRow;
+    if (!row.isValid()) {
+        QSqlQuery mapQuery(d->db);
+        mapQuery.prepare("INSERT INTO pages (id, page) VALUES (?, ?);");
+        mapQuery.addBindValue(docId);
+        mapQuery.addBindValue(pageIndex);
+        if (!mapQuery.exec()) {
+            LOG_ERROR("FullTextIndex::addPage: Failed to map page: " << mapQuery.lastError().text() << ". File: " << filePath);
+            return false;
+        }
+        row = mapQuery.lastInsertId();
+    }
+
+    QSqlQuery query(d->db);
+    query.prepare("INSERT INTO pages_fts (rowid, id, path, page, content) VALUES (?, ?, ?, ?, ?);");
+    query.addBindValue(row);
+    query.addBindValue(docId);
+    query.addBindValue(filePath);
+    query.addBindValue(pageIndex);
+    query.addBindValue(text);
+
+    if (!query.exec()) {
+        LOG_ERROR("FullTextIndex::addPage: Failed to insert page into FTS index: " << query.lastError().text() << ". File: " << filePath);
+        return false;
+    }
+
+    LOG_DEBUG("FullTextIndex: Indexed page " << pageIndex << " of " << filePath);
+    return true;
+}
+
 bool FullTextIndex::isDocumentIndexed(const QString& filePath) const
 {
     if (!isInitialized() || filePath.isEmpty()) {
@@ -262,8 +360,10 @@ bool FullTextIndex::isDocumentIndexed(const QString& filePath) const
 
     QString docId = QString(QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha256).toHex());
 
+    // A document counts as indexed by its full text or by any of its pages
     QSqlQuery query(d->db);
-    query.prepare("SELECT COUNT(*) FROM documents_fts WHERE id = ?;");
+    query.prepare("SELECT EXISTS (SELECT 1 FROM pages WHERE id = ?) OR EXISTS (SELECT 1 FROM documents_fts WHERE id = ?);");
+    query.addBindValue(docId);
     query.addBindValue(docId);
 
     if (!query.exec() || !query.next()) {
@@ -349,7 +449,8 @@ bool FullTextIndex::optimize()
     // A common optimization command for FTS tables is: INSERT INTO table_name(table_name) VALUES('optimize');
     QSqlQuery optimizeQuery(d->db);
     QString optimizeSql = "INSERT INTO documents_fts(documents_fts) VALUES('optimize');";
-    if (!optimizeQuery.exec(optimizeSql)) {
+    if (!optimizeQuery.exec(optimizeSql)
+        || !optimizeQuery.exec("INSERT INTO pages_fts(pages_fts) VALUES('optimize');")) {
         LOG_WARN("FullTextIndex::optimize: Optimize command failed or not supported by this FTS setup: " << optimizeQuery.lastError().text());
         // Optimize failure might be non-critical.
         return false;
@@ -393,6 +494,45 @@ bool FullTextIndex::createIndexTable()
         success = false;
     }
 
+    // Per-page text, fed incrementally (e.g. by batch OCR) so hits carry a page number
+    QString createPagesTableSql = R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS pages_fts USING fts5(
+            id UNINDEXED,   -- Document identifier, same as documents_fts
+            path UNINDEXED, -- File path
+            page UNINDEXED, -- 0-based page index
+            content,        -- Page text
+            tokenize='porter'
+        );
+    )";
+
+    if (success && !query.exec(createPagesTableSql)) {
+        LOG_ERROR("FullTextIndex::createIndexTable: Failed to create page FTS5 table: " << query.lastError().text());
+        success = false;
+    }
+
+    // (document, page) -> pages_fts rowid, so a page is replaced or a
+    // document removed through an index instead of a table scan
+    QString createPageMapSql = R"(
+        CREATE TABLE IF NOT EXISTS pages (
+            fts_rowid INTEGER PRIMARY KEY, -- rowid of the page in pages_fts
+            id TEXT NOT NULL,              -- Document identifier
+            page INTEGER NOT NULL,         -- 0-based page index
+            UNIQUE (id, page)
+        );
+    )";
+
+    if (success && !query.exec(createPageMapSql)) {
+        LOG_ERROR("FullTextIndex::createIndexTable: Failed to create page map: " << query.lastError().text());
+        success = false;
+    }
+
+    // Indexes written before the page map existed: map their pages once
+    if (success && !query.exec("INSERT OR IGNORE INTO pages (fts_rowid, id, page) SELECT rowid, id, page FROM pages_fts "
+                               "WHERE NOT EXISTS (SELECT 1 FROM pages);")) {
+        LOG_ERROR("FullTextIndex::createIndexTable: Failed to map existing pages: " << query.lastError().text());
+        success = false;
+    }
+
     // Commit or rollback the transaction
     if (success) {
         if (!d->db.commit()) {
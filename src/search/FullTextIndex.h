@@ -98,8 +98,21 @@ public:
      */
     bool updateDocument(Document* document);
 
+    /**
+     * @brief Add or replace the text of a single page.
+     * Used by producers that finish pages one at a time, such as batch OCR.
+     * Must be called on the thread that owns the index.
+     * @param filePath Path of the document file.
+     * @param pageIndex 0-based page index.
+     * @param text Page text.
+     * @return True if the page was indexed.
+     */
+    bool addPage(const QString& filePath, int pageIndex, const QString& text);
+
     /**
      * @brief Query the index for a specific term or phrase.
+     * Whole documents and pages added with addPage() are searched together;
+     * page hits carry their page index, document hits -1.
      * @param query The search query string.
      * @param maxResults Maximum number of results to return.
      * @param contextLength Number of characters of context to include around the match.
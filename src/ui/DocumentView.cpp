@@ -18,11 +18,18 @@
 #include "../core/Logger.h"
 #include "../core/Selection.h" // Assuming this exists or will be adapted
 #include "../core/Clipboard.h" // Assuming this exists or we use QApplication::clipboard()
+#include "../annotations/AnnotationManager.h"
+#include "../annotations/Annotation.h"
+#include "../editing/AnnotationEditor.h"
+#include "../formats/pdf/PdfAnnotation.h"
 #include <QPainter>
+#include <QPainterPath>
 #include <QPaintEvent>
 #include <QResizeEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
+#include <QMouseEvent>
+#include <QTabletEvent>
 #include <QScrollBar>
 #include <QTimer>
 #include <QApplication>
@@ -31,10 +38,36 @@
 #include <QMenu>
 #include <QAction>
 #include <QCursor>
+#include <QRegion>
+#include <QTransform>
 #include <QDebug>
 
 namespace QuantilyxDoc {
 
+namespace {
+
+// Margin around annotation bounds repainted on change (strokes, antialiasing)
+constexpr int OverlayDamageMargin = 3;
+// Overlays kept for pages this far outside the visible range
+constexpr int OverlayKeepPages = 2;
+// Alpha of highlight fills, so the text underneath stays readable
+constexpr int HighlightAlpha = 100;
+// Size of the note icon of text annotations, in points (as in Acrobat)
+constexpr qreal NoteIconSize = 20.0;
+
+} // namespace
+
+/**
+ * Annotations drawn for one page at one zoom/rotation, composited over the
+ * cached page render. Only the dirty region is redrawn on the next paint.
+ */
+struct AnnotationOverlay {
+    QImage image;           // Transparent where there are no annotations; null if none yet
+    qreal zoomLevel = 0.0;
+    int rotation = -1;
+    QRegion dirty;          // Page pixel coordinates to redraw
+};
+
 class DocumentView::Private {
 public:
     Private(DocumentView* q_ptr)
@@ -42,7 +75,7 @@ public:
           zoomMode(FitPage), viewMode(SinglePage), rotation(0),
           pageSpacing(10), isPanning(false), lastPanPoint(0, 0),
           isSelecting(false), selectionStartPoint(0, 0), selectionEndPoint(0, 0),
-          renderRequestCounter(0) {}
+          renderRequestCounter(0), inkMode(false), inkPen(Qt::black, 2.0), inkPageIndex(-1) {}
 
     DocumentView* q;
     QPointer<Document> document; // Use QPointer for safety
@@ -72,6 +105,323 @@ public:
     // Cached page sizes for layout calculations
     mutable QHash<int, QSize> cachedPageSizePixels;
 
+    // Annotation overlays per page index, for the current document
+    QHash<int, AnnotationOverlay> overlays;
+
+    // Freehand ink input: pen and mouse drags draw strokes instead of panning
+    bool inkMode;
+    QPen inkPen;
+    int inkPageIndex; // Page of the stroke in progress, -1 if none
+
+    // Page coordinates (points) -> page pixel coordinates at the current zoom and rotation
+    QTransform pageTransform(int pageIndex) const {
+        QTransform t;
+        Page* page = document ? document->page(pageIndex) : nullptr;
+        if (!page) return t;
+        const QSizeF scaled = page->size() * zoomLevel;
+        switch (rotation) {
+            case 90: t.translate(scaled.height(), 0); t.rotate(90); break;
+            case 180: t.translate(scaled.width(), scaled.height()); t.rotate(180); break;
+            case 270: t.translate(0, scaled.width()); t.rotate(270); break;
+            default: break;
+        }
+        t.scale(zoomLevel, zoomLevel);
+        return t;
+    }
+
+    // Top of a page in document pixel coordinates
+    int pageTop(int pageIndex) const {
+        int y = 0;
+        for (int i = 0; i < pageIndex; ++i) {
+            y += calculatePageSizePixels(i).height() + pageSpacing;
+        }
+        return y;
+    }
+
+    // Draw one annotation in page coordinates. Display renders leave annotations
+    // out, so this is the only place they appear on screen.
+    static void paintAnnotation(QPainter& painter, Annotation* annot) {
+        const QRectF bounds = annot->bounds();
+        const QColor color = annot->color().isValid() ? annot->color() : QColor(Qt::yellow);
+        auto* pdfAnnot = dynamic_cast<PdfAnnotation*>(annot);
+        if (!pdfAnnot) {
+            paintBox(painter, bounds, color, 1.0);
+            return;
+        }
+        if (pdfAnnot->isHidden()) return;
+
+        painter.save();
+        painter.setOpacity(pdfAnnot->opacity());
+        const qreal width = qMax<qreal>(0.5, pdfAnnot->borderWidth());
+        QPen pen(color, width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+
+        switch (pdfAnnot->type()) {
+            case PdfAnnotation::Type::Ink:
+                painter.setPen(pen);
+                painter.setBrush(Qt::NoBrush);
+                for (const QList<QPointF>& path : pdfAnnot->inkPaths()) {
+                    if (path.size() == 1) {
+                        painter.drawPoint(path.first());
+                    } else {
+                        painter.drawPolyline(QPolygonF(path.toVector()));
+                    }
+                }
+                break;
+            case PdfAnnotation::Type::Highlight: {
+                QColor fill = color;
+                fill.setAlpha(HighlightAlpha);
+                painter.setPen(Qt::NoPen);
+                painter.setBrush(fill);
+                for (const QPolygonF& quad : pdfAnnot->quads()) {
+                    painter.drawPolygon(quad);
+                }
+                break;
+            }
+            case PdfAnnotation::Type::Underline:
+            case PdfAnnotation::Type::StrikeOut:
+            case PdfAnnotation::Type::Squiggly:
+                for (const QPolygonF& quad : pdfAnnot->quads()) {
+                    if (quad.size() < 4) continue;
+                    // Line thickness follows the text height, as viewers draw it
+                    const qreal height = QLineF(quad[0], quad[3]).length();
+                    pen.setWidthF(qMax<qreal>(0.5, height / 14.0));
+                    painter.setPen(pen);
+                    if (pdfAnnot->type() == PdfAnnotation::Type::StrikeOut) {
+                        painter.drawLine((quad[0] + quad[3]) / 2.0, (quad[1] + quad[2]) / 2.0);
+                    } else if (pdfAnnot->type() == PdfAnnotation::Type::Underline) {
+                        painter.drawLine(quad[3], quad[2]);
+                    } else {
+                        paintSquiggle(painter, quad[3], quad[2], height / 8.0);
+                    }
+                }
+                break;
+            case PdfAnnotation::Type::Line:
+            case PdfAnnotation::Type::PolyLine:
+            case PdfAnnotation::Type::Polygon: {
+                const QList<QPointF> vertices = pdfAnnot->vertices();
+                painter.setPen(pen);
+                painter.setBrush(Qt::NoBrush);
+                if (vertices.size() < 2) {
+                    painter.drawLine(bounds.topLeft(), bounds.bottomRight());
+                } else if (pdfAnnot->type() == PdfAnnotation::Type::Polygon) {
+                    painter.drawPolygon(QPolygonF(vertices.toVector()));
+                } else {
+                    painter.drawPolyline(QPolygonF(vertices.toVector()));
+                }
+                break;
+            }
+            case PdfAnnotation::Type::Square:
+                painter.setPen(pen);
+                painter.setBrush(Qt::NoBrush);
+                painter.drawRect(bounds.adjusted(width / 2, width / 2, -width / 2, -width / 2));
+                break;
+            case PdfAnnotation::Type::Circle:
+                painter.setPen(pen);
+                painter.setBrush(Qt::NoBrush);
+                painter.drawEllipse(bounds.adjusted(width / 2, width / 2, -width / 2, -width / 2));
+                break;
+            case PdfAnnotation::Type::Text:
+                paintNoteIcon(painter, bounds, color, pdfAnnot->iconName());
+                break;
+            case PdfAnnotation::Type::FreeText:
+                painter.setPen(QPen(color, width));
+                painter.setBrush(Qt::NoBrush);
+                painter.drawRect(bounds);
+                painter.setPen(Qt::black);
+                painter.drawText(bounds.adjusted(2, 2, -2, -2), Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap,
+                                 pdfAnnot->contents());
+                break;
+            case PdfAnnotation::Type::Stamp:
+                painter.setPen(QPen(color, 2.0));
+                painter.setBrush(Qt::NoBrush);
+                painter.drawRoundedRect(bounds.adjusted(1, 1, -1, -1), 4, 4);
+                painter.drawText(bounds, Qt::AlignCenter,
+                                 pdfAnnot->iconName().isEmpty() ? pdfAnnot->contents() : pdfAnnot->iconName());
+                break;
+            case PdfAnnotation::Type::Caret: {
+                painter.setPen(pen);
+                painter.setBrush(Qt::NoBrush);
+                const QPointF tip(bounds.center().x(), bounds.top());
+                painter.drawPolyline(QPolygonF() << bounds.bottomLeft() << tip << bounds.bottomRight());
+                break;
+            }
+            case PdfAnnotation::Type::Link:
+            case PdfAnnotation::Type::Popup:
+            case PdfAnnotation::Type::Widget:
+                // No appearance of their own (form fields stay in the page render)
+                break;
+            default:
+                paintBox(painter, bounds, color, width);
+                break;
+        }
+        painter.restore();
+    }
+
+    // Outlined, lightly filled box: annotations without a specific look
+    static void paintBox(QPainter& painter, const QRectF& bounds, QColor color, qreal width) {
+        painter.setPen(QPen(color, width));
+        color.setAlpha(80);
+        painter.setBrush(color);
+        painter.drawRect(bounds);
+    }
+
+    // Wavy line from a to b with the given amplitude
+    static void paintSquiggle(QPainter& painter, const QPointF& a, const QPointF& b, qreal amplitude) {
+        const qreal length = QLineF(a, b).length();
+        if (length <= 0.0 || amplitude <= 0.0) return;
+        const QPointF step = (b - a) / length * (2.0 * amplitude);
+        const QPointF normal(-step.y() / 2.0, step.x() / 2.0);
+        QPolygonF wave;
+        const int segments = qMax(1, qRound(length / (2.0 * amplitude)));
+        for (int i = 0; i <= segments; ++i) {
+            wave << a + step * i + ((i % 2) ? -normal : normal);
+        }
+        painter.drawPolyline(wave);
+    }
+
+    // Sticky note glyph in the top-left corner of a text annotation
+    static void paintNoteIcon(QPainter& painter, const QRectF& bounds, const QColor& color, const QString& iconName) {
+        const qreal side = qMin(bounds.width(), bounds.height());
+        const qreal size = side > 0.0 ? qMin(NoteIconSize, side) : NoteIconSize;
+        const QRectF icon(bounds.topLeft(), QSizeF(size, size));
+        painter.setPen(QPen(color.darker(160), 0.75));
+        painter.setBrush(color);
+        if (iconName == QLatin1String("Comment")) {
+            // Speech bubble
+            QPainterPath bubble;
+            bubble.addRoundedRect(icon.adjusted(0, 0, 0, -size / 4), size / 6, size / 6);
+            bubble.moveTo(icon.left() + size / 4, icon.bottom() - size / 4);
+            bubble.lineTo(icon.left() + size / 4, icon.bottom());
+            bubble.lineTo(icon.left() + size / 2, icon.bottom() - size / 4);
+            painter.drawPath(bubble.simplified());
+        } else {
+            // Note with a folded corner and ruled lines
+            const qreal fold = size / 4;
+            painter.drawPolygon(QPolygonF() << icon.topLeft() << icon.topRight()
+                                            << QPointF(icon.right(), icon.bottom() - fold)
+                                            << QPointF(icon.right() - fold, icon.bottom()) << icon.bottomLeft());
+            for (int line = 1; line <= 3; ++line) {
+                const qreal y = icon.top() + line * size / 5;
+                painter.drawLine(QPointF(icon.left() + size / 6, y), QPointF(icon.right() - size / 6, y));
+            }
+        }
+    }
+
+    // Bring a page's overlay up to date, redrawing only its dirty region
+    const QImage& updateOverlay(int pageIndex, const QSize& pageSize) {
+        AnnotationOverlay& overlay = overlays[pageIndex];
+        if (overlay.zoomLevel != zoomLevel || overlay.rotation != rotation
+            || (!overlay.image.isNull() && overlay.image.size() != pageSize)) {
+            overlay.image = QImage();
+            overlay.zoomLevel = zoomLevel;
+            overlay.rotation = rotation;
+            overlay.dirty = QRect(QPoint(0, 0), pageSize);
+        }
+        if (overlay.dirty.isEmpty()) return overlay.image;
+
+        const QTransform toPixels = pageTransform(pageIndex);
+        const QTransform toPage = toPixels.inverted();
+        AnnotationManager& manager = AnnotationManager::instance();
+
+        for (const QRect& rect : overlay.dirty) {
+            const QList<Annotation*> annots = manager.findAnnotationsInRect(document, pageIndex, toPage.mapRect(QRectF(rect)));
+            if (overlay.image.isNull()) {
+                // Nothing drawn yet: only allocate once there is something to draw
+                if (annots.isEmpty()) continue;
+                overlay.image = QImage(pageSize, QImage::Format_ARGB32_Premultiplied);
+                overlay.image.fill(Qt::transparent);
+            }
+
+            QPainter painter(&overlay.image);
+            painter.setClipRect(rect);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(rect, Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.setTransform(toPixels);
+            for (Annotation* annot : annots) {
+                paintAnnotation(painter, annot);
+            }
+        }
+        overlay.dirty = QRegion();
+        return overlay.image;
+    }
+
+    // Mark part of a page's overlay for redrawing and schedule a repaint of that area only
+    void invalidateOverlay(int pageIndex, const QRectF& pageRect) {
+        auto it = overlays.find(pageIndex);
+        if (it == overlays.end()) return; // Not drawn yet; built in full when it becomes visible
+
+        const QRect pixels = pageTransform(pageIndex).mapRect(pageRect).toAlignedRect()
+                             .adjusted(-OverlayDamageMargin, -OverlayDamageMargin,
+                                       OverlayDamageMargin, OverlayDamageMargin);
+        it->dirty += pixels;
+        q->viewport()->update(pixels.translated(QPoint(0, pageTop(pageIndex)) - documentOffset));
+    }
+
+    // Page under a viewport point, or -1 if the point is between or beside pages
+    int pageAt(const QPointF& viewportPos) const {
+        if (!document) return -1;
+        const QPointF docPos = viewportToDocument(viewportPos);
+        int top = 0;
+        for (int i = 0; i < document->pageCount(); ++i) {
+            const QSize size = calculatePageSizePixels(i);
+            if (docPos.y() < top) return -1;
+            if (docPos.y() < top + size.height()) {
+                return docPos.x() >= 0 && docPos.x() < size.width() ? i : -1;
+            }
+            top += size.height() + pageSpacing;
+        }
+        return -1;
+    }
+
+    // Viewport point -> page coordinates (points) of a page
+    QPointF viewportToPage(int pageIndex, const QPointF& viewportPos) const {
+        const QPointF pixel = viewportToDocument(viewportPos) - QPointF(0, pageTop(pageIndex));
+        return pageTransform(pageIndex).inverted().map(pixel);
+    }
+
+    // Start an ink stroke on the page under the point; the stroke buffer
+    // matches the page render so it composites at the page origin
+    bool beginInk(const QPointF& viewportPos, qreal pressure) {
+        const int pageIndex = pageAt(viewportPos);
+        if (pageIndex < 0) return false;
+        AnnotationEditor& editor = AnnotationEditor::instance();
+        if (!editor.beginInkStroke(document, pageIndex, inkPen, pageTransform(pageIndex),
+                                   calculatePageSizePixels(pageIndex))) {
+            return false;
+        }
+        inkPageIndex = pageIndex;
+        addInk(viewportPos, pressure);
+        return true;
+    }
+
+    void addInk(const QPointF& viewportPos, qreal pressure) {
+        if (inkPageIndex < 0) return;
+        const QRect changed = AnnotationEditor::instance().addInkPoint(viewportToPage(inkPageIndex, viewportPos), pressure);
+        if (!changed.isEmpty()) {
+            q->viewport()->update(changed.translated(QPoint(0, pageTop(inkPageIndex)) - documentOffset));
+        }
+    }
+
+    void finishInk() {
+        if (inkPageIndex < 0) return;
+        const int pageIndex = inkPageIndex;
+        inkPageIndex = -1;
+        // The annotation lands in the overlay through annotationAreaChanged;
+        // repaint the page for the buffer going away
+        AnnotationEditor::instance().finishInkStroke();
+        const QSize size = calculatePageSizePixels(pageIndex);
+        q->viewport()->update(QRect(QPoint(0, pageTop(pageIndex)) - documentOffset, size));
+    }
+
+    void cancelInk() {
+        if (inkPageIndex < 0) return;
+        inkPageIndex = -1;
+        AnnotationEditor::instance().cancelInkStroke();
+        q->viewport()->update();
+    }
+
     // Helper to calculate page size in pixels based on zoom/rotation
     QSize calculatePageSizePixels(int pageIndex) const {
         if (!document) return QSize();
@@ -235,6 +585,18 @@ DocumentView::DocumentView(QWidget* parent)
                 d->handleRenderResult(result);
             });
 
+    // Repaint only the annotation overlay area touched by an annotation change
+    connect(&AnnotationManager::instance(), &AnnotationManager::annotationAreaChanged,
+            this, [this](Document* doc, int pageIndex, const QRectF& rect) {
+                if (doc != d->document) return;
+                if (pageIndex < 0) {
+                    d->overlays.clear();
+                    viewport()->update();
+                } else {
+                    d->invalidateOverlay(pageIndex, rect);
+                }
+            });
+
     // Connect to Settings to react to changes (e.g., background color)
     // connect(&Settings::instance(), &Settings::valueChanged, this, &DocumentView::onSettingsChanged);
 
@@ -259,8 +621,10 @@ void DocumentView::setDocument(Document* document)
         // disconnect(d->document, ...);
     }
 
+    d->cancelInk();
     d->document = document; // Use QPointer
     d->currentPageIndex = 0; // Reset to first page
+    d->overlays.clear();
 
     if (document) {
         // Connect to new document signals
@@ -473,8 +837,17 @@ void DocumentView::paintEvent(QPaintEvent* event)
 
             QImage cachedImage = PageCache::instance().get(cacheKey);
             if (!cachedImage.isNull()) {
-                // Use cached image
-                painter.drawImage(pageRect.translated(-d->documentOffset).topLeft().toPoint(), cachedImage);
+                // Use cached image; annotations are composited from their own
+                // overlay so editing them never invalidates the page render
+                const QPoint pageOrigin = pageRect.translated(-d->documentOffset).topLeft().toPoint();
+                painter.drawImage(pageOrigin, cachedImage);
+                const QImage& overlay = d->updateOverlay(i, pageSize);
+                if (!overlay.isNull()) {
+                    painter.drawImage(pageOrigin, overlay);
+                }
+                if (i == d->inkPageIndex) {
+                    AnnotationEditor::instance().drawInkStroke(painter, pageOrigin);
+                }
             } else {
                 // No cache hit, request render via RenderThread
                 // Check if a request is already pending for this exact state
@@ -512,6 +885,14 @@ void DocumentView::paintEvent(QPaintEvent* event)
         currentY += pageSize.height() + d->pageSpacing; // Move to next page position
     }
 
+    // Drop overlays of pages scrolled well out of view
+    for (auto it = d->overlays.begin(); it != d->overlays.end();) {
+        const bool keep = firstVisiblePage >= 0
+                          && it.key() >= firstVisiblePage - OverlayKeepPages
+                          && it.key() <= lastVisiblePage + OverlayKeepPages;
+        it = keep ? std::next(it) : d->overlays.erase(it);
+    }
+
     // Draw selection rectangle if active
     if (d->isSelecting) {
         QRectF selRect = QRectF(d->selectionStartPoint, d->selectionEndPoint).normalized();
@@ -560,8 +941,66 @@ void DocumentView::wheelEvent(QWheelEvent* event)
     }
 }
 
+void DocumentView::setInkMode(bool enabled)
+{
+    if (d->inkMode == enabled) return;
+    if (!enabled) {
+        d->finishInk();
+    }
+    d->inkMode = enabled;
+    setCursor(enabled ? Qt::CrossCursor : Qt::ArrowCursor);
+    LOG_DEBUG("Ink mode " << (enabled ? "enabled" : "disabled"));
+}
+
+bool DocumentView::isInkMode() const
+{
+    return d->inkMode;
+}
+
+void DocumentView::setInkPen(const QPen& pen)
+{
+    d->inkPen = pen;
+}
+
+QPen DocumentView::inkPen() const
+{
+    return d->inkPen;
+}
+
+void DocumentView::tabletEvent(QTabletEvent* event)
+{
+    if (!d->inkMode || !d->document) {
+        event->ignore(); // Qt synthesizes mouse events instead
+        return;
+    }
+    switch (event->type()) {
+        case QEvent::TabletPress:
+            if (event->button() == Qt::LeftButton) {
+                d->beginInk(event->posF(), event->pressure());
+            }
+            break;
+        case QEvent::TabletMove:
+            d->addInk(event->posF(), event->pressure());
+            break;
+        case QEvent::TabletRelease:
+            if (event->button() == Qt::LeftButton) {
+                d->finishInk();
+            }
+            break;
+        default:
+            break;
+    }
+    // Accepted tablet events are not repeated as mouse events
+    event->accept();
+}
+
 void DocumentView::mousePressEvent(QMouseEvent* event)
 {
+    if (d->inkMode && event->button() == Qt::LeftButton) {
+        d->beginInk(event->localPos(), 1.0);
+        event->accept();
+        return;
+    }
     if (event->button() == Qt::LeftButton) {
         if (event->modifiers() & Qt::ShiftModifier) {
             // Start selection
@@ -610,7 +1049,9 @@ void DocumentView::mousePressEvent(QMouseEvent* event)
 
 void DocumentView::mouseMoveEvent(QMouseEvent* event)
 {
-    if (d->isPanning) {
+    if (d->inkPageIndex >= 0) {
+        d->addInk(event->localPos(), 1.0);
+    } else if (d->isPanning) {
         QPoint delta = event->pos() - d->lastPanPoint;
         d->documentOffset += delta;
         d->documentOffset.setX(qMax(0, d->documentOffset.x()));
@@ -671,7 +1112,11 @@ void DocumentView::mouseMoveEvent(QMouseEvent* event)
 void DocumentView::mouseReleaseEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton) {
-        if (d->isPanning) {
+        // A drag ends here; edits after it are a new undo step
+        AnnotationEditor::instance().endInteraction();
+        if (d->inkPageIndex >= 0) {
+            d->finishInk();
+        } else if (d->isPanning) {
             d->isPanning = false;
             setCursor(Qt::ArrowCursor);
         } else if (d->isSelecting) {
@@ -11,6 +11,7 @@
 #define QUANTILYX_DOCUMENTVIEW_H
 
 #include <QWidget>
+#include <QPen>
 #include <memory>
 
 namespace QuantilyxDoc {
@@ -134,6 +135,32 @@ public:
      */
     void setPageSpacing(int spacing);
 
+    /**
+     * @brief Enable freehand ink input
+     * While enabled, pen and left-button drags on a page draw an ink stroke
+     * (AnnotationEditor) instead of panning; releasing adds an Ink annotation.
+     * @param enabled True to draw, false to pan and select
+     */
+    void setInkMode(bool enabled);
+
+    /**
+     * @brief Check if freehand ink input is enabled
+     * @return True if drags draw ink
+     */
+    bool isInkMode() const;
+
+    /**
+     * @brief Set the pen for new ink strokes
+     * @param pen Pen; its width is in page units and scaled by pen pressure
+     */
+    void setInkPen(const QPen& pen);
+
+    /**
+     * @brief Get the pen for new ink strokes
+     * @return Ink pen
+     */
+    QPen inkPen() const;
+
 signals:
     /**
      * @brief Emitted when current page changes
@@ -177,6 +204,30 @@ protected:
      */
     void keyPressEvent(QKeyEvent* event) override;
 
+    /**
+     * @brief Handle mouse press event
+     * @param event Mouse event
+     */
+    void mousePressEvent(QMouseEvent* event) override;
+
+    /**
+     * @brief Handle mouse move event
+     * @param event Mouse event
+     */
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+    /**
+     * @brief Handle mouse release event
+     * @param event Mouse event
+     */
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+    /**
+     * @brief Handle tablet (pen) event; draws ink with pen pressure in ink mode
+     * @param event Tablet event
+     */
+    void tabletEvent(QTabletEvent* event) override;
+
 private slots:
     /**
      * @brief Handle document loading
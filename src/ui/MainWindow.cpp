@@ -15,6 +15,7 @@
 #include "../core/Settings.h"
 #include "../core/BackupManager.h"
 #include "../core/PageCache.h"
+#include "../annotations/AnnotationManager.h"
 #include "DocumentView.h"
 #include "PreferencesDialog.h"
 #include "AboutDialog.h"
@@ -41,6 +42,7 @@
 #include <QProgressBar>
 #include <QTimer>
 #include <QDir>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QMimeData>
 #include <QDragEnterEvent>
@@ -583,8 +585,25 @@ bool MainWindow::openDocument(const QString& filePath)
     if (doc) {
         // Register document with Application
         Application::instance().registerDocument(doc);
+        // Annotations in the file are drawn and edited through the manager
+        AnnotationManager::instance().registerDocument(doc);
         // Set the document in the view
         d->documentView->setDocument(doc);
+
+        // Edits journaled by a session that crashed are replayed over the saved file
+        UndoStack& undoStack = UndoStack::instance();
+        undoStack.setDocument(doc);
+        if (undoStack.hasRecoverableEdits()) {
+            const QMessageBox::StandardButton answer = QMessageBox::question(this, tr("Recover Edits"),
+                tr("%1 was not closed properly. Recover %2 unsaved edits?")
+                    .arg(QFileInfo(filePath).fileName()).arg(undoStack.recoverableEditCount()));
+            if (answer == QMessageBox::Yes) {
+                undoStack.recoverFromJournal();
+            } else {
+                undoStack.discardJournal();
+            }
+        }
+
         // Update UI
         d->updateUiForDocument(doc);
         // Add to recent files
@@ -0,0 +1,92 @@
+/**
+ * QuantilyxDoc - Professional Document Editor
+ * Copyright (C) 2025 R² Innovative Software
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+#include "core/UndoStack.h"
+#include "editing/EditCommands.h"
+#include "formats/pdf/PdfAnnotation.h"
+#include <QtTest>
+
+using namespace QuantilyxDoc;
+
+namespace {
+
+constexpr int StrokeCount = 4;
+constexpr int PointsPerStroke = 1000;
+
+QList<QList<QPointF>> makeStroke(int seed)
+{
+    QList<QPointF> points;
+    for (int i = 0; i < PointsPerStroke; ++i) {
+        points.append(QPointF(seed + i * 0.001, i * 0.0005));
+    }
+    return {points};
+}
+
+const AddAnnotationCommand* commandAt(int index)
+{
+    return static_cast<const AddAnnotationCommand*>(UndoStack::instance().command(index));
+}
+
+} // namespace
+
+class UndoSpillTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void spillsOverBudgetAndRestores();
+};
+
+void UndoSpillTest::cleanup()
+{
+    UndoStack::instance().clear();
+    UndoStack::instance().setMemoryBudget(256LL * 1024 * 1024);
+}
+
+// Without a document the commands never hand their annotation to a page, so
+// each keeps holding its stroke: the state the budget is about
+void UndoSpillTest::spillsOverBudgetAndRestores()
+{
+    UndoStack& stack = UndoStack::instance();
+    const qint64 strokeBytes = PointsPerStroke * qint64(sizeof(QPointF));
+    stack.setMemoryBudget(strokeBytes * 3 / 2);
+
+    for (int i = 0; i < StrokeCount; ++i) {
+        PdfAnnotation* ink = new PdfAnnotation(PdfAnnotation::Type::Ink, QRectF(0, 0, 1, 1), nullptr, 0);
+        ink->setInkPaths(makeStroke(i));
+        stack.push(new AddAnnotationCommand(nullptr, 0, ink));
+    }
+
+    // Only the command next to the index stays resident
+    QVERIFY(stack.residentBytes() <= stack.memoryBudget());
+    QVERIFY(stack.spilledBytes() > 0);
+    QVERIFY(commandAt(0)->isSpilled());
+    QVERIFY(!commandAt(StrokeCount - 1)->isSpilled());
+    auto* first = static_cast<PdfAnnotation*>(commandAt(0)->annotation());
+    QVERIFY(first->inkPaths().isEmpty());
+
+    // Undoing down to the first command reloads its points from the journal
+    for (int i = 0; i < StrokeCount; ++i) {
+        stack.undo();
+    }
+    QVERIFY(!commandAt(0)->isSpilled());
+    QCOMPARE(first->inkPaths(), makeStroke(0));
+    QVERIFY(stack.residentBytes() <= stack.memoryBudget());
+
+    // And redoing back up restores every other stroke
+    for (int i = 0; i < StrokeCount; ++i) {
+        stack.redo();
+        auto* ink = static_cast<PdfAnnotation*>(commandAt(i)->annotation());
+        QCOMPARE(ink->inkPaths(), makeStroke(i));
+    }
+}
+
+QTEST_GUILESS_MAIN(UndoSpillTest)
+#include "UndoSpillTest.moc"